@@ -23,6 +23,13 @@
 
 using namespace std;
 
+//filter fields with indices - FIELD_ADDR2 is a substring match, which affects
+//any button
+static const int IDX_FIELDS[] = {IncidentButton::FIELD_ADDRSTATE,
+                                 IncidentButton::FIELD_CATEGORY,
+                                 IncidentButton::FIELD_PRIORITY,
+                                 IncidentButton::FIELD_STATE};
+
 ActiveIncidents::ActiveIncidents(bool showFull, QWidget *parent) :
 QWidget(parent), ui(new Ui::ActiveIncidents)
 {
@@ -192,6 +199,8 @@ void ActiveIncidents::clear()
         delete it.second;
     }
     mIncidentMap.clear();
+    mFilterIdx.clear();
+    mIdxKeys.clear();
 }
 
 void ActiveIncidents::refreshIcons()
@@ -218,11 +227,7 @@ void ActiveIncidents::updateCase(IncidentData *data)
     int id = data->getId();
     if (data->isClosed())
     {
-        if (mIncidentMap.count(id) != 0)
-        {
-            delete mIncidentMap[id];
-            mIncidentMap.erase(id);
-        }
+        closeCase(id);
     }
     else if (mIncidentMap.count(id) == 0)
     {
@@ -231,12 +236,14 @@ void ActiveIncidents::updateCase(IncidentData *data)
                 [btn, this] { emit showData(btn); });
         mFlowLayout->addWidget(btn);
         mIncidentMap[id] = btn;
+        index(id, data);
         btn->setFilteredVisible();
     }
     else
     {
         auto *btn = mIncidentMap[id];
         btn->updateData(data);
+        index(id, data);
         btn->setFilteredVisible();
     }
 }
@@ -247,6 +254,7 @@ void ActiveIncidents::closeCase(int id)
     {
         delete mIncidentMap[id];
         mIncidentMap.erase(id);
+        index(id, 0);
     }
 }
 
@@ -330,12 +338,9 @@ void ActiveIncidents::addFilter(QMenu *topMenu, const QString &txt, int field)
         connect(chk, &QCheckBox::toggled, this,
                 [chk, this](bool isChecked)
                 {
-                    IncidentButton::updateFilter(chk->objectName().toInt(),
-                                                 chk->text(), isChecked);
-                    for (auto &it : mIncidentMap)
-                    {
-                        it.second->setFilteredVisible();
-                    }
+                    int fld = chk->objectName().toInt();
+                    IncidentButton::updateFilter(fld, chk->text(), isChecked);
+                    refreshFiltered(fld, chk->text());
                 });
         //on chk click, check chkAll if all boxes are checked, and uncheck
         //it if any is unchecked
@@ -366,3 +371,80 @@ void ActiveIncidents::addFilter(QMenu *topMenu, const QString &txt, int field)
     wAct->setDefaultWidget(gbox);
     menu->addAction(wAct);
 }
+
+void ActiveIncidents::index(int id, const IncidentData *data)
+{
+    auto it = mIdxKeys.find(id);
+    if (it != mIdxKeys.end())
+    {
+        int i = 0;
+        for (auto f : IDX_FIELDS)
+        {
+            auto &idx(mFilterIdx[f]);
+            auto iIt = idx.find(it->second.at(i++));
+            if (iIt != idx.end())
+            {
+                iIt->second.erase(id);
+                if (iIt->second.empty())
+                    idx.erase(iIt);
+            }
+        }
+        mIdxKeys.erase(it);
+    }
+    if (data == 0)
+        return;
+    QStringList &keys(mIdxKeys[id]);
+    for (auto f : IDX_FIELDS)
+    {
+        keys << getFilterKey(f, data);
+        mFilterIdx[f][keys.back()].insert(id);
+    }
+}
+
+void ActiveIncidents::refreshFiltered(int field, const QString &value)
+{
+    auto it = mFilterIdx.find(field);
+    if (it == mFilterIdx.end())
+        return;
+    auto iIt = it->second.find(getFilterKey(field, value));
+    if (iIt == it->second.end())
+        return;
+    for (auto id : iIt->second)
+    {
+        auto bIt = mIncidentMap.find(id);
+        if (bIt != mIncidentMap.end())
+            bIt->second->setFilteredVisible();
+    }
+}
+
+QString ActiveIncidents::getFilterKey(int field, const IncidentData *data)
+{
+    switch (field)
+    {
+        case IncidentButton::FIELD_ADDRSTATE:
+            return data->getAddrState();
+        case IncidentButton::FIELD_CATEGORY:
+            return data->getCategory();
+        case IncidentButton::FIELD_PRIORITY:
+            return QString::number(data->getPriority());
+        case IncidentButton::FIELD_STATE:
+            return QString::number(data->getState());
+        default:
+            break; //do nothing
+    }
+    return "";
+}
+
+QString ActiveIncidents::getFilterKey(int field, const QString &value)
+{
+    switch (field)
+    {
+        case IncidentButton::FIELD_PRIORITY:
+            return QString::number(IncidentData::getPriorityVal(value));
+        case IncidentButton::FIELD_STATE:
+            return QString::number(IncidentData::getStateVal(value));
+        default:
+            break; //do nothing
+    }
+    return value;
+}
@@ -11,6 +11,7 @@
 #define ACTIVEINCIDENTS_H
 
 #include <map>
+#include <set>
 #include <QList>
 #include <QMenu>
 #include <QStringList>
@@ -112,9 +113,51 @@ signals:
     void showData(IncidentButton *btn);
 
 private:
+    //key is field value as in getFilterKey(), value is incident IDs
+    typedef std::map<QString, std::set<int>> FilterIdxT;
+
     Ui::ActiveIncidents *ui;
     FlowLayout          *mFlowLayout;
     std::map<int, IncidentButton *> mIncidentMap; //key: ID
+    //filter indices, so that a filter change touches only the affected
+    //buttons - key is IncidentButton::eField
+    std::map<int, FilterIdxT>       mFilterIdx;
+    //key is ID, value is the indexed field values
+    std::map<int, QStringList>      mIdxKeys;
+
+    /**
+     * Updates the filter indices for an incident.
+     *
+     * @param[in] id   The incident ID.
+     * @param[in] data The incident data, or 0 to remove the incident.
+     */
+    void index(int id, const IncidentData *data);
+
+    /**
+     * Sets the filtered visibility of the buttons with a field value.
+     *
+     * @param[in] field The filter field - IncidentButton::eField.
+     * @param[in] value The value, as in the filter menu.
+     */
+    void refreshFiltered(int field, const QString &value);
+
+    /**
+     * Gets the filter index key of an incident field.
+     *
+     * @param[in] field The filter field - IncidentButton::eField.
+     * @param[in] data  The incident data.
+     * @return The key.
+     */
+    static QString getFilterKey(int field, const IncidentData *data);
+
+    /**
+     * Gets the filter index key of a filter menu value.
+     *
+     * @param[in] field The filter field - IncidentButton::eField.
+     * @param[in] value The value.
+     * @return The key.
+     */
+    static QString getFilterKey(int field, const QString &value);
 
     /**
      * Adds the position button menu, allowing positioning options within the
@@ -29,7 +29,8 @@ static const QString CODEC    ("audio/pcm");
 static const string  LOGPREFIX("AudioDevice:: ");
 
 AudioDevice::AudioDevice(int type, Logger *logger) :
-mType(type), mLogger(logger), mAudioIn(0), mAudioOut(0), mDevice(0), mTimer(0)
+mType(type), mLogger(logger), mAudioIn(0), mAudioOut(0), mDevice(0),
+mSource(0), mBufferMs(0), mTimer(0)
 {
     if (logger == 0 || (type != TYPE_INPUT && type != TYPE_OUTPUT))
     {
@@ -87,6 +88,11 @@ bool AudioDevice::start()
             return false;
         }
     }
+    else if (mSource != 0)
+    {
+        mAudioOut->setBufferSize(mFormat.bytesForDuration(mBufferMs * 1000));
+        mAudioOut->start(mSource);
+    }
     else
     {
         mDevice = mAudioOut->start();
@@ -94,8 +100,20 @@ bool AudioDevice::start()
     return true;
 }
 
+void AudioDevice::setSource(QIODevice *src, int bufferMs)
+{
+    assert(mType == TYPE_OUTPUT);
+    mSource = src;
+    mBufferMs = bufferMs;
+}
+
 void AudioDevice::stop()
 {
+    if (mSource != 0)
+    {
+        mAudioOut->stop();
+        return;
+    }
     if (mDevice != 0 && mDevice->isOpen())
     {
         mDevice->close();
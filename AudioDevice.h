@@ -1,6 +1,7 @@
 /**
  * A class that provides an interface of audio input and output devices.
- * As an output device, writes audio data to an audio output device.
+ * As an output device, writes audio data to an audio output device, or has
+ * the audio output device read from a source IO device.
  * As an input device, accepts data from QAudioInput and emits via a signal
  * without further processing.
  *
@@ -50,6 +51,17 @@ public:
      */
     bool start();
 
+    /**
+     * Sets a source IO device for the output to read from, instead of
+     * writeOutput(). Takes effect at the next start(). Only applicable to
+     * TYPE_OUTPUT.
+     *
+     * @param[in] src      The opened source. Caller retains ownership.
+     * @param[in] bufferMs The output buffer duration, which determines the
+     *                     latency.
+     */
+    void setSource(QIODevice *src, int bufferMs);
+
     /**
      * Stops device.
      */
@@ -168,6 +180,8 @@ private:
     QAudioInput  *mAudioIn;
     QAudioOutput *mAudioOut;
     QIODevice    *mDevice;
+    QIODevice    *mSource;    //output source, if any
+    int           mBufferMs;  //output buffer duration with mSource
     QTimer       *mTimer;
 
     /**
@@ -8,7 +8,10 @@
  * @author Ahmad Syukri
  */
 #include <assert.h>
+#include <stdlib.h>
 
+#include "Metrics.h"
+#include "Settings.h"
 #include "AudioManager.h"
 
 using namespace std;
@@ -16,10 +19,11 @@ using namespace std;
 static const int    AMI_MASK = 0x55;
 static const string LOGPREFIX("AudioManager:: ");
 
-set<AudioDevice *> AudioManager::sIdleOutDevs;
-
 AudioManager::AudioManager(Logger *logger) :
-mLogger(logger), mInDevice(0), mActiveRtp(0)
+mVad(Settings::instance().get<bool>(Props::FLD_CFG_AUDIO_VAD)),
+mTalkStart(true), mVadNoise(VAD_MIN_LEVEL), mVadSpeechTime(-VAD_HANG_MS),
+mLogger(logger), mInDevice(0), mOutDevice(0), mMixThread(0), mMixIo(0),
+mActiveRtp(0)
 {
     if (logger == 0)
     {
@@ -28,51 +32,92 @@ mLogger(logger), mInDevice(0), mActiveRtp(0)
     }
     connect(this, &AudioManager::deleteRtp, this,
             [](RtpSession *rtp) { delete rtp; });
+    mTxTimer.start();
     mInDevice = new AudioDevice(AudioDevice::TYPE_INPUT, mLogger);
     connect(mInDevice, &AudioDevice::received, this,
             [this](const char *data, qint64 len)
             {
+                static Metrics::Counter &suppressedCount(
+                      Metrics::counter("scad_audio_frames_suppressed_total"));
                 //receive audio data
                 if (mRtpSessionMap.empty())
                     return;
                 int n = len/2; //a-law output length is half from original
+                qint64 now = mTxTimer.elapsed();
                 char *b = new char[n];
+                RtpSession *txRtp = 0;
                 if (mActiveRtp != 0)
                 {
-                    char *p = b;
                     const short *q = (const short *) data;
-                    int i = n;
-                    for (; i>0; --i,++p,++q)
+                    if (!mVad || isSpeech(q, n, now))
+                    {
+                        char *p = b;
+                        int i = n;
+                        for (; i>0; --i,++p,++q)
+                        {
+                            *p = linearToAlaw(*q);
+                        }
+                        //marker on the first packet after silence
+                        mActiveRtp->send(b, n, mTalkStart);
+                        mTalkStart = false;
+                        txRtp = mActiveRtp;
+                    }
+                    else
                     {
-                        *p = linearToAlaw(*q);
+                        mTalkStart = true;
+                        suppressedCount.add();
                     }
-                    mActiveRtp->send(b, n);
                 }
                 //send silence packet which contains 0xD5 for A-law signed data
-                //to other sessions, otherwise no incoming data for those
-                //sessions
-                memset(b, 0xD5, n);
-                for (auto &it : mRtpSessionMap)
+                //to sessions without audio only every KEEPALIVE_MS, otherwise
+                //no incoming data for those sessions
+                bool isSilence = false;
+                for (auto &it : mSessionDataMap)
                 {
-                    if (it.second != mActiveRtp)
-                        it.second->send(b, n);
+                    if (it.first == txRtp)
+                    {
+                        it.second.txTime = now;
+                    }
+                    else if (now - it.second.txTime >= KEEPALIVE_MS)
+                    {
+                        if (!isSilence)
+                        {
+                            memset(b, 0xD5, n);
+                            isSilence = true;
+                        }
+                        it.first->send(b, n);
+                        it.second.txTime = now;
+                    }
+                    else
+                    {
+                        it.first->skip(); //keep the timestamp in real time
+                    }
                 }
                 delete [] b;
             });
-    //create and start pool of devices ready for immediate use, to avoid long
+    //start the single output device now and keep it running, to avoid long
     //delay at each call startup due to AudioDevice::start() execution, which
     //may cause missing initial audio
-    AudioDevice *dev;
-    int i = 3;
-    for (; i>0; --i)
-    {
-        dev = new AudioDevice(AudioDevice::TYPE_OUTPUT, mLogger);
-        sIdleOutDevs.insert(dev);
-        dev->start();
-        dev->activateOut(false);
-    }
-    LOGGER_DEBUG(mLogger, LOGPREFIX << "Started outDevs idle="
-                 << sIdleOutDevs.size());
+    //the device is created in the mixing thread so that the mix is read
+    //there, unaffected by a busy GUI thread
+    mMixThread = new QThread(this);
+    mMixThread->setObjectName("AudioMixer");
+    mMixThread->start(QThread::TimeCriticalPriority);
+    mMixIo = new MixerIo(&mMixer);
+    mMixIo->open(QIODevice::ReadOnly);
+    mMixIo->moveToThread(mMixThread);
+    QMetaObject::invokeMethod(mMixIo,
+                              [this]
+                              {
+                                  mOutDevice = new AudioDevice(
+                                                     AudioDevice::TYPE_OUTPUT,
+                                                     mLogger);
+                                  mOutDevice->setSource(mMixIo, OUT_BUFFER_MS);
+                                  mOutDevice->start();
+                              },
+                              Qt::BlockingQueuedConnection);
+    LOGGER_DEBUG(mLogger, LOGPREFIX << "Started outDev " << mOutDevice << ":"
+                 << mOutDevice->getState());
 }
 
 AudioManager::~AudioManager()
@@ -82,19 +127,11 @@ AudioManager::~AudioManager()
     {
         delete it.second;
     }
-    for (auto &it : mSessionDataMap)
-    {
-        delete it.second.device;
-    }
-    if (!sIdleOutDevs.empty())
-    {
-        LOGGER_DEBUG(mLogger, LOGPREFIX << "Deleting outDevs idle="
-                     << sIdleOutDevs.size());
-        for (auto d : sIdleOutDevs)
-        {
-            delete d;
-        }
-    }
+    QMetaObject::invokeMethod(mMixIo, [this] { delete mOutDevice; },
+                              Qt::BlockingQueuedConnection);
+    mMixThread->quit();
+    mMixThread->wait();
+    delete mMixIo;
 }
 
 void AudioManager::startRtp(int           id,
@@ -103,7 +140,8 @@ void AudioManager::startRtp(int           id,
                             void         *cbObj,
                             StatCbFn      cbFn,
                             const string &lclKey,
-                            const string &rmtKey)
+                            const string &rmtKey,
+                            bool          emergency)
 {
     LOGGER_DEBUG(mLogger, LOGPREFIX << "startRtp: " << id << " " << lclPort
                  << " " << rmtPort);
@@ -116,26 +154,14 @@ void AudioManager::startRtp(int           id,
                                mLogger, this, rtpRcvCb, rtpStatCb);
     rtp->setCryptoKey(lclKey, rmtKey);
     mRtpSessionMap[id] = rtp;
-    AudioDevice *dev;
-    if (sIdleOutDevs.empty())
-    {
-        //insufficient pool devices - add
-        dev = new AudioDevice(AudioDevice::TYPE_OUTPUT, mLogger);
-        dev->start();
-        LOGGER_DEBUG(mLogger, LOGPREFIX << "startRtp: New outDev " << dev << ":"
-                     << dev->getState());
-    }
-    else
-    {
-        dev = *(sIdleOutDevs.begin());
-        dev->activateOut(true);
-        //state 0=active, 1=suspended, 2=stopped, 3=idle, 4=interrupted
-        LOGGER_DEBUG(mLogger, LOGPREFIX << "startRtp: outDevs idle="
-                     << sIdleOutDevs.size() << ", resumed " << dev << ":"
-                     << dev->getState());
-        sIdleOutDevs.erase(dev);
-    }
-    mSessionDataMap[rtp] = {dev, true, cbObj, cbFn};
+    int stream = mMixer.addStream((emergency)? AudioMixer::PRIO_EMERGENCY:
+                                               AudioMixer::PRIO_NORMAL);
+    if (stream == AudioMixer::INVALID_STREAM)
+        LOGGER_ERROR(mLogger, LOGPREFIX << "startRtp: No mixer stream for "
+                     << id << ", max " << AudioMixer::MAX_STREAMS);
+    //send a keepalive at the first input frame
+    mSessionDataMap[rtp] = {stream, true, cbObj, cbFn,
+                            mTxTimer.elapsed() - KEEPALIVE_MS};
     if (mInDevice->getState() != QAudio::ActiveState)
         mInDevice->start();
 }
@@ -151,13 +177,11 @@ void AudioManager::stopRtp(int id)
         rtp->stop(); //stop receiving audio data
         if (mSessionDataMap.count(rtp) != 0)
         {
-            auto *dev = mSessionDataMap[rtp].device;
-            dev->activateOut(false);
-            sIdleOutDevs.insert(dev);
+            mMixer.removeStream(mSessionDataMap[rtp].stream);
             mSessionDataMap.erase(rtp);
-            LOGGER_DEBUG(mLogger, LOGPREFIX << "stopRtp: Suspended outDev "
-                         << dev << ":" << dev->getState() << ", idle="
-                         << sIdleOutDevs.size());
+            LOGGER_DEBUG(mLogger, LOGPREFIX << "stopRtp: Mix cost "
+                         << mMixer.getMixCostNs()
+                         << "ns per stream per 20ms");
         }
         if (mRtpSessionMap.empty())
             mInDevice->stop();
@@ -177,7 +201,11 @@ bool AudioManager::setActiveOutRtp(int id, bool activate)
         return false;
     }
     if (activate)
+    {
+        if (rtp != mActiveRtp)
+            mTalkStart = true;
         mActiveRtp = rtp;
+    }
     else if (rtp == mActiveRtp)
         mActiveRtp = 0;
     return true;
@@ -196,6 +224,27 @@ bool AudioManager::setActiveInRtp(int id, bool activate)
         return false;
     }
     mSessionDataMap[rtp].enabled = activate;
+    mMixer.setMute(mSessionDataMap[rtp].stream, !activate);
+    return true;
+}
+
+bool AudioManager::setRtpGain(int id, int percent)
+{
+    RtpSession *rtp = getRtpSession(id, false);
+    if (rtp == 0 || mSessionDataMap.count(rtp) == 0)
+        return false;
+    mMixer.setGain(mSessionDataMap[rtp].stream, percent);
+    return true;
+}
+
+bool AudioManager::setRtpPriority(int id, bool emergency)
+{
+    RtpSession *rtp = getRtpSession(id, false);
+    if (rtp == 0 || mSessionDataMap.count(rtp) == 0)
+        return false;
+    mMixer.setPriority(mSessionDataMap[rtp].stream,
+                       (emergency)? AudioMixer::PRIO_EMERGENCY:
+                                    AudioMixer::PRIO_NORMAL);
     return true;
 }
 
@@ -232,17 +281,13 @@ void AudioManager::onAudioInChanged(const QString &devName)
 
 void AudioManager::onAudioOutChanged(const QString &devName)
 {
-    for (auto &it : mSessionDataMap)
-    {
-        it.second.device->setDevice(devName);
-        it.second.device->start();
-    }
-    for (auto *d : sIdleOutDevs)
-    {
-        d->setDevice(devName);
-        d->start();
-        d->activateOut(false);
-    }
+    QMetaObject::invokeMethod(mMixIo,
+                              [this, devName]
+                              {
+                                  mOutDevice->setDevice(devName);
+                                  mOutDevice->start();
+                              },
+                              Qt::BlockingQueuedConnection);
 }
 
 inline RtpSession *AudioManager::getRtpSession(int id, bool doErase)
@@ -276,8 +321,7 @@ void AudioManager::rtpReceived(RtpSession *rtp, char *data, int len)
         {
             *p = alawToLinear(*q);
         }
-        mSessionDataMap[rtp].device->writeOutput((const char *) b,
-                                                 len * sizeof(short));
+        mMixer.push(mSessionDataMap[rtp].stream, b, len);
         delete [] b;
     }
 }
@@ -288,6 +332,41 @@ void AudioManager::rtpStat(RtpSession *rtp, int kbps)
         mSessionDataMap[rtp].cbFn(mSessionDataMap[rtp].cbObj, kbps);
 }
 
+bool AudioManager::isSpeech(const short *data, int n, qint64 now)
+{
+    if (n <= 0)
+        return false;
+    long long sum = 0;
+    int i = n;
+    for (; i>0; --i,++data)
+    {
+        sum += abs(*data);
+    }
+    float level = float(sum)/n;
+    //noise level falls fast and rises slowly, to follow the background but
+    //not speech
+    if (level < mVadNoise)
+        mVadNoise += (level - mVadNoise)/4;
+    else
+        mVadNoise += (level - mVadNoise)/256;
+    if (level > VAD_MIN_LEVEL && level > mVadNoise * VAD_SNR)
+        mVadSpeechTime = now;
+    return (now - mVadSpeechTime < VAD_HANG_MS);
+}
+
+qint64 AudioManager::MixerIo::bytesAvailable() const
+{
+    return QIODevice::bytesAvailable() +
+           AudioMixer::FRAME_SAMPLES * sizeof(short);
+}
+
+qint64 AudioManager::MixerIo::readData(char *data, qint64 len)
+{
+    len &= ~1LL; //whole samples
+    mMixer->mix(reinterpret_cast<short *>(data), len / sizeof(short));
+    return len;
+}
+
 short AudioManager::alawToLinear(unsigned char alaw)
 {
     alaw ^= AMI_MASK;
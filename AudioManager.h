@@ -1,5 +1,7 @@
 /**
  * A class that provides management of input and output audio devices.
+ * Received audio of all RTP sessions is mixed by AudioMixer into a single
+ * output device, which reads the mix in a dedicated thread.
  *
  * Copyright (C) Sapura Secured Technologies, 2014-2025. All Rights Reserved.
  *
@@ -10,9 +12,13 @@
 #ifndef AUDIOMANAGER_H
 #define AUDIOMANAGER_H
 
-#include <set>
+#include <map>
+#include <QElapsedTimer>
+#include <QIODevice>
+#include <QThread>
 
 #include "AudioDevice.h"
+#include "AudioMixer.h"
 #include "Logger.h"
 #include "RtpSession.h"
 
@@ -36,13 +42,15 @@ public:
     /**
      * Creates a new RTP session.
      *
-     * @param[in] id      Session ID.
-     * @param[in] lclPort Local port.
-     * @param[in] rmtPort Remote port.
-     * @param[in] cbObj   Callback function owner.
-     * @param[in] cbFn    Callback function for passing stream statistics.
-     * @param[in] lclKey  Local crypto key.
-     * @param[in] rmtKey  Remote crypto key.
+     * @param[in] id        Session ID.
+     * @param[in] lclPort   Local port.
+     * @param[in] rmtPort   Remote port.
+     * @param[in] cbObj     Callback function owner.
+     * @param[in] cbFn      Callback function for passing stream statistics.
+     * @param[in] lclKey    Local crypto key.
+     * @param[in] rmtKey    Remote crypto key.
+     * @param[in] emergency true for an emergency call, whose audio ducks
+     *                      the other sessions.
      */
     void startRtp(int                id,
                   int                lclPort,
@@ -50,7 +58,8 @@ public:
                   void              *cbObj,
                   StatCbFn           cbFn,
                   const std::string &lclKey = "",
-                  const std::string &rmtKey = "");
+                  const std::string &rmtKey = "",
+                  bool               emergency = false);
 
     /**
      * Ends and destroys an RTP session.
@@ -76,6 +85,25 @@ public:
      */
     bool setActiveInRtp(int id, bool activate);
 
+    /**
+     * Sets the output gain of an RTP session.
+     *
+     * @param[in] id      The RTP session ID.
+     * @param[in] percent The gain in percent, 100 for unity.
+     * @return true if successful.
+     */
+    bool setRtpGain(int id, int percent);
+
+    /**
+     * Sets the mixing priority of an RTP session. Emergency audio ducks
+     * other sessions.
+     *
+     * @param[in] id        The RTP session ID.
+     * @param[in] emergency true for emergency priority.
+     * @return true if successful.
+     */
+    bool setRtpPriority(int id, bool emergency);
+
     /**
      * Checks whether there is any active incoming or outgoing audio.
      *
@@ -121,25 +149,83 @@ public slots:
     void onAudioOutChanged(const QString &devName);
 
 private:
+    //output device source, which mixes on read
+    class MixerIo : public QIODevice
+    {
+    public:
+        /**
+         * Constructor.
+         *
+         * @param[in] mixer The mixer.
+         */
+        MixerIo(AudioMixer *mixer) : mMixer(mixer) {}
+
+        bool isSequential() const { return true; }
+
+        /**
+         * Always has data, silence if nothing to mix.
+         */
+        qint64 bytesAvailable() const;
+
+    protected:
+        /**
+         * Function called by QAudioOutput to read the mixed audio data.
+         *
+         * @param[out] data The audio data.
+         * @param[in]  len  The maximum data length in bytes.
+         * @return The data length in bytes.
+         */
+        qint64 readData(char *data, qint64 len);
+
+        /**
+         * Not used.
+         */
+        qint64 writeData(const char *, qint64) { return 0; }
+
+    private:
+        AudioMixer *mMixer;
+    }; //class MixerIo
+
     //data associated with an RtpSession
     struct SessionData
     {
-        AudioDevice *device;  //output device
-        bool         enabled; //output device status
-        void        *cbObj;   //callback function owner
-        StatCbFn     cbFn;    //stream statistics callback function
+        int       stream;  //mixer stream handle
+        bool      enabled; //output status
+        void     *cbObj;   //callback function owner
+        StatCbFn  cbFn;    //stream statistics callback function
+        qint64    txTime;  //last sending time in mTxTimer ms
     };
 
     typedef std::map<int, RtpSession *>         RtpSessionMapT;
     typedef std::map<RtpSession *, SessionData> SessionDataMapT;
 
+    //output buffer duration, which is the mixed output latency
+    static const int OUT_BUFFER_MS = 60;
+    //interval of silence packets to keep a session alive when not sending
+    //audio
+    static const int KEEPALIVE_MS  = 500;
+    //voice activity detection - minimum mean absolute sample level, and
+    //ratio to the noise level, for speech
+    static const int VAD_MIN_LEVEL = 100;
+    static const int VAD_SNR       = 3;
+    //duration to continue sending after the last speech frame, to avoid
+    //clipping word endings and short pauses
+    static const int VAD_HANG_MS   = 300;
+
+    bool             mVad;            //voice activity detection enabled
+    bool             mTalkStart;      //next sent audio starts a talkspurt
+    float            mVadNoise;       //background noise level
+    qint64           mVadSpeechTime;  //last speech frame time in mTxTimer ms
+    QElapsedTimer    mTxTimer;
     Logger          *mLogger;
     AudioDevice     *mInDevice;       //input device
+    AudioDevice     *mOutDevice;      //mixed output device, in mMixThread
+    QThread         *mMixThread;
+    MixerIo         *mMixIo;
     RtpSession      *mActiveRtp;
     RtpSessionMapT   mRtpSessionMap;  //indexed by called/calling SSI
     SessionDataMapT  mSessionDataMap;
-
-    static std::set<AudioDevice *> sIdleOutDevs;
+    AudioMixer       mMixer;
 
     /**
      * Gets an RTP session based on the given ID.
@@ -167,6 +253,18 @@ private:
      */
     void rtpStat(RtpSession *rtp, int kbps);
 
+    /**
+     * Detects speech in an input frame by comparing its level with the
+     * background noise level, which is updated. Speech is reported until
+     * VAD_HANG_MS after the last frame above the noise.
+     *
+     * @param[in] data The linear PCM samples.
+     * @param[in] n    The number of samples.
+     * @param[in] now  The current time in mTxTimer ms.
+     * @return true if speech.
+     */
+    bool isSpeech(const short *data, int n, qint64 now);
+
     /**
      * Converts a-law audio data to linear PCM.
      *
@@ -0,0 +1,283 @@
+/**
+ * Software audio mixer implementation.
+ *
+ * Copyright (C) Sapura Secured Technologies, 2026. All Rights Reserved.
+ *
+ * @file
+ * @version $Id$
+ * @author agent <agent@local>
+ */
+#include <chrono>
+#include <string.h>
+
+#include "AudioMixer.h"
+
+using namespace std;
+
+static const float DUCK_GAIN   = 0.25f;  //-12 dB
+static const float LIMIT       = 29200;  //about -1 dBFS
+//limiter gain recovery per frame, for about 0.4 s to recover from -6 dB
+static const float LIM_RELEASE = 0.05f;
+static const int   GEN_SHIFT   = 8;      //handle is gen << GEN_SHIFT | index
+static const int   INDEX_MASK  = (1 << GEN_SHIFT) - 1;
+
+/**
+ * Converts a mixed value to a sample, clipping if out of range.
+ *
+ * @param[in] v The value.
+ * @return The sample.
+ */
+static inline short toSample(float v)
+{
+    return (v >= 32767)? 32767: (v <= -32768)? -32768: short(v);
+}
+
+AudioMixer::AudioMixer() : mLimGain(1), mCostNs(0), mCostSamples(0)
+{
+    for (auto &s : mStreams)
+    {
+        s.state = STATE_FREE;
+        s.gen = 0;
+        s.gain = 100;
+        s.mute = false;
+        s.priority = PRIO_NORMAL;
+        s.head = 0;
+        s.tail = 0;
+        s.pushers = 0;
+        s.playing = false;
+        s.curGain = 0;
+    }
+}
+
+int AudioMixer::addStream(int priority)
+{
+    int i = 0;
+    for (auto &s : mStreams)
+    {
+        if (s.state.load(memory_order_acquire) == STATE_FREE)
+        {
+            //the queue was emptied on removal, so head and tail are left
+            //as they are for a late push to the old handle to fail on gen
+            int gen = (s.gen.load(memory_order_relaxed) + 1) & 0x7FFFFF;
+            s.gen.store(gen, memory_order_relaxed);
+            s.gain.store(100, memory_order_relaxed);
+            s.mute.store(false, memory_order_relaxed);
+            s.priority.store(priority, memory_order_relaxed);
+            s.state.store(STATE_ACTIVE, memory_order_release);
+            return ((gen << GEN_SHIFT) | i);
+        }
+        ++i;
+    }
+    return INVALID_STREAM;
+}
+
+void AudioMixer::removeStream(int handle)
+{
+    StreamT *s = getStream(handle);
+    if (s != 0)
+        s->state.store(STATE_REMOVED); //seq_cst, see push()
+}
+
+void AudioMixer::setGain(int handle, int percent)
+{
+    StreamT *s = getStream(handle);
+    if (s != 0)
+        s->gain.store((percent < 0)? 0: percent, memory_order_relaxed);
+}
+
+void AudioMixer::setMute(int handle, bool mute)
+{
+    StreamT *s = getStream(handle);
+    if (s != 0)
+        s->mute.store(mute, memory_order_relaxed);
+}
+
+void AudioMixer::setPriority(int handle, int priority)
+{
+    StreamT *s = getStream(handle);
+    if (s != 0)
+        s->priority.store(priority, memory_order_relaxed);
+}
+
+bool AudioMixer::push(int handle, const short *samples, int n)
+{
+    if (handle < 0 || (handle & INDEX_MASK) >= MAX_STREAMS || n <= 0)
+        return false;
+    //hold the stream before checking it, so that if removeStream() comes
+    //after the check, the mixing thread sees the hold and does not release
+    //the stream for reuse until the copy is done - both sides use seq_cst
+    StreamT *s = &mStreams[handle & INDEX_MASK];
+    s->pushers.fetch_add(1);
+    bool ok = (getStream(handle) == s);
+    unsigned int head = s->head.load(memory_order_relaxed);
+    if (ok && QUEUE_SIZE - (head - s->tail.load(memory_order_acquire)) <
+              (unsigned int) n)
+        ok = false;
+    if (ok)
+    {
+        int i = head & QUEUE_MASK;
+        int m = QUEUE_SIZE - i; //space before wrapping
+        if (m > n)
+            m = n;
+        memcpy(&s->buf[i], samples, m * sizeof(short));
+        if (m < n)
+            memcpy(s->buf, samples + m, (n - m) * sizeof(short));
+        s->head.store(head + n, memory_order_release);
+    }
+    s->pushers.fetch_sub(1, memory_order_release);
+    return ok;
+}
+
+void AudioMixer::mix(short *out, int n)
+{
+    auto start = chrono::steady_clock::now();
+    long long streamSamples = 0;
+    int m;
+    while (n > 0)
+    {
+        m = (n > FRAME_SAMPLES)? FRAME_SAMPLES: n;
+        streamSamples += (long long) mixFrame(out, m) * m;
+        out += m;
+        n -= m;
+    }
+    if (streamSamples != 0)
+    {
+        mCostNs.fetch_add(chrono::duration_cast<chrono::nanoseconds>(
+                                   chrono::steady_clock::now() - start).count(),
+                          memory_order_relaxed);
+        mCostSamples.fetch_add(streamSamples, memory_order_relaxed);
+    }
+}
+
+int AudioMixer::getMixCostNs() const
+{
+    long long n = mCostSamples.load(memory_order_relaxed);
+    if (n == 0)
+        return 0;
+    return int(mCostNs.load(memory_order_relaxed) * FRAME_SAMPLES / n);
+}
+
+AudioMixer::StreamT *AudioMixer::getStream(int handle)
+{
+    if (handle < 0 || (handle & INDEX_MASK) >= MAX_STREAMS)
+        return 0;
+    StreamT *s = &mStreams[handle & INDEX_MASK];
+    //state first - a reused stream gets its gen before becoming active
+    if (s->state.load() != STATE_ACTIVE ||
+        s->gen.load(memory_order_relaxed) != (handle >> GEN_SHIFT))
+        return 0;
+    return s;
+}
+
+int AudioMixer::mixFrame(short *out, int n)
+{
+    //find the highest priority with audio, for ducking the rest
+    int top = PRIO_NORMAL;
+    unsigned int avail;
+    int st;
+    for (auto &s : mStreams)
+    {
+        st = s.state.load();
+        if (st == STATE_REMOVED)
+        {
+            if (s.pushers.load() != 0)
+                continue; //release in a later frame
+            //discard the queue and release the stream
+            s.tail.store(s.head.load(memory_order_acquire),
+                         memory_order_release);
+            s.playing = false;
+            s.curGain = 0;
+            s.state.store(STATE_FREE, memory_order_release);
+        }
+        else if (st == STATE_ACTIVE && !s.mute.load(memory_order_relaxed) &&
+                 s.priority.load(memory_order_relaxed) > top)
+        {
+            avail = s.head.load(memory_order_acquire) -
+                    s.tail.load(memory_order_relaxed);
+            if (avail >= ((s.playing)? 1u: (unsigned int) PREBUFFER))
+                top = s.priority.load(memory_order_relaxed);
+        }
+    }
+    memset(mAcc, 0, n * sizeof(float));
+    int numMixed = 0;
+    unsigned int tail;
+    unsigned int m;
+    unsigned int i;
+    float g;
+    float step;
+    for (auto &s : mStreams)
+    {
+        if (s.state.load(memory_order_acquire) != STATE_ACTIVE)
+            continue;
+        tail = s.tail.load(memory_order_relaxed);
+        avail = s.head.load(memory_order_acquire) - tail;
+        if (!s.playing)
+        {
+            if (avail < (unsigned int) PREBUFFER)
+                continue;
+            s.playing = true;
+        }
+        if (avail > (unsigned int) MAX_QUEUED)
+        {
+            //producer ahead of the output clock - skip the oldest
+            tail += avail - PREBUFFER;
+            avail = PREBUFFER;
+        }
+        if (avail == 0)
+        {
+            s.playing = false; //underrun - prebuffer again
+            continue;
+        }
+        m = (avail < (unsigned int) n)? avail: n;
+        if (!s.mute.load(memory_order_relaxed))
+        {
+            g = s.gain.load(memory_order_relaxed) / 100.0f;
+            if (s.priority.load(memory_order_relaxed) < top)
+                g *= DUCK_GAIN;
+            //ramp to the new gain over the frame to avoid clicks
+            step = (g - s.curGain) / m;
+            for (i=0; i<m; ++i)
+            {
+                s.curGain += step;
+                mAcc[i] += s.buf[(tail + i) & QUEUE_MASK] * s.curGain;
+            }
+            s.curGain = g;
+            ++numMixed;
+        }
+        s.tail.store(tail + m, memory_order_release);
+    }
+    //limiter - reduce gain at once for a peak above the limit, and recover
+    //gradually
+    float peak = 0;
+    for (i=0; int(i)<n; ++i)
+    {
+        if (mAcc[i] > peak)
+            peak = mAcc[i];
+        else if (-mAcc[i] > peak)
+            peak = -mAcc[i];
+    }
+    float lim = mLimGain + (1 - mLimGain) * LIM_RELEASE;
+    if (peak * lim > LIMIT)
+        lim = LIMIT / peak;
+    if (lim < mLimGain)
+    {
+        //attack at once
+        for (i=0; int(i)<n; ++i)
+        {
+            out[i] = toSample(mAcc[i] * lim);
+        }
+    }
+    else
+    {
+        //release over the frame
+        step = (lim - mLimGain) / n;
+        g = mLimGain;
+        for (i=0; int(i)<n; ++i)
+        {
+            g += step;
+            out[i] = toSample(mAcc[i] * g);
+        }
+    }
+    mLimGain = lim;
+    return numMixed;
+}
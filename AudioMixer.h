@@ -0,0 +1,160 @@
+/**
+ * Platform-independent software mixer for 16-bit mono audio streams.
+ * Each stream has a lock-free single-producer single-consumer sample queue,
+ * so that a receiving thread adds samples while the output thread mixes,
+ * without either waiting for the other.
+ * The mix applies per-stream gain and mute, ducks streams below the highest
+ * priority that currently has audio, and limits the sum to keep headroom
+ * instead of clipping.
+ * Streams must be added, removed and controlled in one thread. Samples for a
+ * stream must be pushed from one thread, and mix() called from one thread.
+ *
+ * Copyright (C) Sapura Secured Technologies, 2026. All Rights Reserved.
+ *
+ * @file
+ * @version $Id$
+ * @author agent <agent@local>
+ */
+#ifndef AUDIOMIXER_H
+#define AUDIOMIXER_H
+
+#include <atomic>
+
+class AudioMixer
+{
+public:
+    enum ePriority
+    {
+        PRIO_NORMAL,
+        PRIO_EMERGENCY
+    };
+
+    static const int MAX_STREAMS    = 32;
+    static const int INVALID_STREAM = -1;
+    static const int FRAME_SAMPLES  = 160;  //20 ms at 8 kHz
+
+    AudioMixer();
+
+    /**
+     * Adds a stream.
+     *
+     * @param[in] priority The priority - ePriority.
+     * @return The stream handle, or INVALID_STREAM if at MAX_STREAMS.
+     */
+    int addStream(int priority = PRIO_NORMAL);
+
+    /**
+     * Removes a stream. Its queued samples are discarded. The stream is not
+     * reused while a push() to it is in progress.
+     *
+     * @param[in] handle The stream handle.
+     */
+    void removeStream(int handle);
+
+    /**
+     * Sets the gain of a stream.
+     *
+     * @param[in] handle  The stream handle.
+     * @param[in] percent The gain in percent, 100 for unity.
+     */
+    void setGain(int handle, int percent);
+
+    /**
+     * Mutes or unmutes a stream. A muted stream's samples are discarded.
+     *
+     * @param[in] handle The stream handle.
+     * @param[in] mute   true to mute.
+     */
+    void setMute(int handle, bool mute);
+
+    /**
+     * Sets the priority of a stream.
+     *
+     * @param[in] handle   The stream handle.
+     * @param[in] priority The priority - ePriority.
+     */
+    void setPriority(int handle, int priority);
+
+    /**
+     * Queues samples for a stream.
+     *
+     * @param[in] handle  The stream handle.
+     * @param[in] samples The samples.
+     * @param[in] n       The number of samples.
+     * @return false if dropped because of an invalid handle or a full queue.
+     */
+    bool push(int handle, const short *samples, int n);
+
+    /**
+     * Mixes queued samples of all streams. Produces silence if there are
+     * none.
+     *
+     * @param[out] out The mixed samples.
+     * @param[in]  n   The number of samples.
+     */
+    void mix(short *out, int n);
+
+    /**
+     * Gets the average time taken by mix() for one active stream, per
+     * FRAME_SAMPLES output samples.
+     *
+     * @return The time in nanoseconds.
+     */
+    int getMixCostNs() const;
+
+private:
+    enum eState
+    {
+        STATE_FREE,
+        STATE_ACTIVE,
+        STATE_REMOVED   //until the mixing thread discards the queue
+    };
+
+    //queue size in samples, a power of 2
+    static const int QUEUE_SIZE = 4096;
+    static const int QUEUE_MASK = QUEUE_SIZE - 1;
+    //queued samples before starting to play a stream, to absorb jitter
+    static const int PREBUFFER  = 2 * FRAME_SAMPLES;
+    //queued samples above which the oldest are skipped, to bound latency
+    static const int MAX_QUEUED = 8 * FRAME_SAMPLES;
+
+    struct StreamT
+    {
+        std::atomic<int>          state;
+        std::atomic<int>          gen;      //incremented on reuse
+        std::atomic<int>          gain;     //percent
+        std::atomic<bool>         mute;
+        std::atomic<int>          priority;
+        std::atomic<unsigned int> head;     //written by the producer
+        std::atomic<unsigned int> tail;     //written by the mixing thread
+        std::atomic<int>          pushers;  //threads in push()
+        //used only by the mixing thread
+        bool                      playing;  //prebuffered
+        float                     curGain;  //for ramping to gain changes
+        short                     buf[QUEUE_SIZE];
+    };
+
+    StreamT                mStreams[MAX_STREAMS];
+    float                  mAcc[FRAME_SAMPLES];
+    float                  mLimGain;     //used only by the mixing thread
+    std::atomic<long long> mCostNs;      //total mix() time
+    std::atomic<long long> mCostSamples; //total samples times active streams
+
+    /**
+     * Gets a stream by handle.
+     *
+     * @param[in] handle The stream handle.
+     * @return The stream, or 0 if the handle is not valid.
+     */
+    StreamT *getStream(int handle);
+
+    /**
+     * Mixes queued samples into mAcc, and outputs them with limiting.
+     *
+     * @param[out] out The mixed samples.
+     * @param[in]  n   The number of samples, up to FRAME_SAMPLES.
+     * @return The number of streams mixed.
+     */
+    int mixFrame(short *out, int n);
+};
+#endif //AUDIOMIXER_H
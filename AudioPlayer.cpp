@@ -15,12 +15,12 @@
 #include <QRect>
 #include <QStandardItemModel>
 #include <QTime>
+#include <QTimer>
 #include <QToolTip>
 #include <QVideoWidget>
 #include <QWidgetAction>
 
 #include "CmnTypes.h"
-#include "DbInt.h"
 #include "QtUtils.h"
 #include "Style.h"
 #include "ui_AudioPlayer.h"
@@ -34,7 +34,8 @@ static const QIcon  ICON_MUTE(":/Images/images/icon_speaker_mute.png");
 
 AudioPlayer::AudioPlayer(Logger *logger, QWidget *parent) :
 QDialog(parent), ui(new Ui::AudioPlayer), mLogger(logger),
-mMediaPlayer(new QMediaPlayer), mMsgDlg(0), mMovie(0), mRetry(0)
+mMediaPlayer(new QMediaPlayer), mMsgDlg(0), mMovie(0),
+mCache(new RecordingCache(logger, this)), mRetry(0), mHostWait(false)
 {
     if (logger == 0)
     {
@@ -122,6 +123,14 @@ mMediaPlayer(new QMediaPlayer), mMsgDlg(0), mMovie(0), mRetry(0)
                 if (mMediaPlayer->state() != QMediaPlayer::StoppedState)
                     mMediaPlayer->stop();
             });
+    connect(mCache, &RecordingCache::hostChecked, this,
+            [this](const QString &hostKey)
+            {
+                //continue the playback that was waiting for the host check
+                if (mHostWait &&
+                    RecordingCache::getHostKey(QUrl(mAudData.path)) == hostKey)
+                    setDetails(mAudData);
+            });
     connect(mMediaPlayer, &QMediaPlayer::durationChanged, this,
             [this](qint64 len)
             {
@@ -197,11 +206,18 @@ mMediaPlayer(new QMediaPlayer), mMsgDlg(0), mMovie(0), mRetry(0)
                         err = "Undefined error.";
                         break;
                 }
+                //a cached copy may be bad - retry from the source, after
+                //releasing the file from the player
+                bool stopped =
+                          (mMediaPlayer->state() == QMediaPlayer::StoppedState);
+                mMediaPlayer->stop();
+                mMediaPlayer->setMedia(QUrl());
+                mCache->remove(mAudData.path);
                 if (mRetry < 3)
                 {
                     ++mRetry;
-                    PalThread::sleep(1);
-                    setDetails(mAudData);
+                    QTimer::singleShot(1000, this,
+                                       [this] { setDetails(mAudData); });
                 }
                 else
                 {
@@ -214,7 +230,7 @@ mMediaPlayer(new QMediaPlayer), mMsgDlg(0), mMovie(0), mRetry(0)
                                           tr("Playback Error"),
                                           tr("Error encountered when attempting "
                                              "to open the media."));
-                    if (mMediaPlayer->state() != QMediaPlayer::StoppedState)
+                    if (!stopped)
                         ui->stopButton->click();
                 }
             });
@@ -232,8 +248,29 @@ AudioPlayer::~AudioPlayer()
 void AudioPlayer::setDetails(const QtTableUtils::AudioData &data)
 {
     mAudData = data;
+    mHostWait = false;
     QUrl url(data.path);
-    if (!url.isLocalFile() && !QtUtils::isHostAvailable(url))
+    QString f(mCache->getFile(data.path));
+    if (!f.isEmpty())
+    {
+        url = QUrl::fromLocalFile(f);
+    }
+    else if (!url.isLocalFile())
+    {
+        switch (mCache->getHostState(url))
+        {
+            case RecordingCache::HOST_UNKNOWN:
+                //continue on RecordingCache::hostChecked()
+                mHostWait = true;
+                return;
+            case RecordingCache::HOST_UP:
+                break;
+            default:
+                url.clear();
+                break;
+        }
+    }
+    if (url.isEmpty())
     {
         delete mMsgDlg;
         mMsgDlg = 0;
@@ -305,6 +342,29 @@ void AudioPlayer::setDetails(const QtTableUtils::AudioData &data)
     mMediaPlayer->setMedia(url);
 }
 
+void AudioPlayer::prefetch(const QtTableUtils::AudioData &data)
+{
+    mCache->prefetch(data.path, (data.gssi.isEmpty())? "": data.callKey);
+}
+
+void AudioPlayer::watch(QTableView *tv)
+{
+    if (tv == 0 || tv->selectionModel() == 0)
+    {
+        assert("Bad param in AudioPlayer::watch" == 0);
+        return;
+    }
+    disconnect(tv->selectionModel(), 0, this, 0);
+    connect(tv->selectionModel(), &QItemSelectionModel::currentRowChanged, this,
+            [this, tv](const QModelIndex &idx)
+            {
+                QtTableUtils::AudioData data;
+                if (idx.isValid() &&
+                    QtTableUtils::getCallAudioData(tv, idx.row(), data))
+                    prefetch(data);
+            });
+}
+
 void AudioPlayer::setTheme()
 {
     ui->audioSlider
@@ -375,37 +435,18 @@ inline QString AudioPlayer::getTimeString(int time)
 
 bool AudioPlayer::getPttData(const QString &callKey)
 {
-    auto *res = DbInt::instance().getPttHistory(callKey.toStdString());
-    if (res == 0)
+    if (!mCache->getPtt(callKey, mPttHistory))
         return false;
     auto *mdl = new QStandardItemModel();
-    QString tx;
-    string txParty;
-    int start;
-    int dur;
     int row = 0;
-    int i = res->getNumRows() - 1;
-    for (; i>=0; --i)
-    {
-        if (res->getFieldValue(DbInt::FIELD_TX_PARTY, txParty, i) &&
-            res->getFieldValue(DbInt::FIELD_START, start, i) &&
-            res->getFieldValue(DbInt::FIELD_CALL_DURATION, dur, i))
-        {
-            tx = QString::fromStdString(txParty);
-            mPttHistory.append(PttData(tx, start, start + dur));
-            mdl->setItem(row, QtTableUtils::COL_PTT_TIME,
-                         new QStandardItem(getTimeString(start * 1000)));
-            mdl->setItem(row, QtTableUtils::COL_PTT_SECONDS,
-                         new QStandardItem(QString::number(dur)));
-            mdl->setItem(row++, QtTableUtils::COL_PTT_TX,
-                         new QStandardItem(tx));
-        }
-    }
-    delete res;
-    if (row == 0)
+    for (const auto &p : mPttHistory)
     {
-        delete mdl;
-        return false;
+        mdl->setItem(row, QtTableUtils::COL_PTT_TIME,
+                     new QStandardItem(getTimeString(p.start * 1000)));
+        mdl->setItem(row, QtTableUtils::COL_PTT_SECONDS,
+                     new QStandardItem(QString::number(p.end - p.start)));
+        mdl->setItem(row++, QtTableUtils::COL_PTT_TX,
+                     new QStandardItem(p.txParty));
     }
     QtTableUtils::setupTable(QtTableUtils::TBLTYPE_PTT, mdl, ui->pttTable);
     return true;
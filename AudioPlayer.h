@@ -19,6 +19,7 @@
 #include "Logger.h"
 #include "MessageDialog.h"
 #include "QtTableUtils.h"
+#include "RecordingCache.h"
 
 namespace Ui {
 class AudioPlayer;
@@ -47,6 +48,23 @@ public:
      */
     void setDetails(const QtTableUtils::AudioData &data);
 
+    /**
+     * Prefetches the recording and PTT history in the background, for
+     * instant playback if selected next.
+     *
+     * @param[in] data Audio data.
+     */
+    void prefetch(const QtTableUtils::AudioData &data);
+
+    /**
+     * Prefetches the recording of the current row of a call table whenever
+     * the current row changes. Must be called again after the table model
+     * is replaced.
+     *
+     * @param[in] tv The call table.
+     */
+    void watch(QTableView *tv);
+
     /**
      * Applies color theme to UI components.
      */
@@ -64,26 +82,17 @@ private slots:
     void onAudioSliderMoved(int pos);
 
 private:
-    struct PttData
-    {
-        PttData(const QString &p, int s, int e) :
-            txParty(p), start(s), end(e) {}
-
-        QString txParty;
-        int     start;
-        int     end;
-    };
-    typedef QList<PttData> PttHistoryT;
-
-    Ui::AudioPlayer         *ui;
-    Logger                  *mLogger;
-    QMediaPlayer            *mMediaPlayer;
-    MessageDialog           *mMsgDlg; //shown while retrieving video data
-    QMovie                  *mMovie;  //animated GIF for mMsgDlg
-    int                      mRetry;
-    QString                  mPath;
-    PttHistoryT              mPttHistory;
-    QtTableUtils::AudioData  mAudData;
+    Ui::AudioPlayer             *ui;
+    Logger                      *mLogger;
+    QMediaPlayer                *mMediaPlayer;
+    MessageDialog               *mMsgDlg; //shown while retrieving video data
+    QMovie                      *mMovie;  //animated GIF for mMsgDlg
+    RecordingCache              *mCache;
+    int                          mRetry;
+    bool                         mHostWait; //waiting for host check
+    QString                      mPath;
+    RecordingCache::PttHistoryT  mPttHistory;
+    QtTableUtils::AudioData      mAudData;
 
     /**
      * Resets the UI.
@@ -99,7 +108,7 @@ private:
     QString getTimeString(int time);
 
     /**
-     * Gets PTT data from database for a particular call.
+     * Gets PTT data for a particular call, and shows it in the table.
      *
      * @param[in] callKey The call key.
      * @return true if successful.
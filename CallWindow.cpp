@@ -644,6 +644,7 @@ bool CallWindow::setConnected(const QString &txParty, int priority)
             if (priority == MsgSp::Value::CALL_PRIORITY_PREEMPTIVE_4_EMERGENCY)
                 ui->callDetailsFrame->setStyleSheet(STYLE_BGCOLOR_ACTIVE_EMERGENCY);
         }
+        setRtpMix();
     }
     if (mTimer.isActive())
     {
@@ -733,7 +734,7 @@ void CallWindow::setConnected(int           calledParty,
     {
         sAudioMgr->startRtp(calledParty, lclAudPort, rmtAudPort,
                             this, (isGrpCall())? 0: audStatCb, lclAudKey,
-                            rmtAudKey);
+                            rmtAudKey, isEmergency());
         if (!isGrpCall())
             ui->statFrame->show();
         setAudioEnabled((mTxGranted)? AUDIOTYPE_BOTH: AUDIOTYPE_IN, true, false,
@@ -763,7 +764,7 @@ void CallWindow::setConnected(bool owner, bool enablePtt, int txGrant)
     {
         sAudioMgr->startRtp(mCalledParty, mLocalAudRtpPort, mRemoteAudRtpPort,
                             this, (isGrpCall())? 0: audStatCb, mLocalAudRtpKey,
-                            mRemoteAudRtpKey);
+                            mRemoteAudRtpKey, isEmergency());
         if (!isGrpCall())
             ui->statFrame->show();
         setAudioEnabled((mTxGranted)? AUDIOTYPE_BOTH: AUDIOTYPE_IN, true, false,
@@ -853,6 +854,7 @@ void CallWindow::changeOwnership(const QString &callingPartyName, int priority)
           ->setChecked(mPriority >= MsgSp::Value::CALL_PRIORITY_PREEMPTIVE_1);
         if (mPriority == MsgSp::Value::CALL_PRIORITY_PREEMPTIVE_4_EMERGENCY)
             ui->callDetailsFrame->setStyleSheet(STYLE_BGCOLOR_ACTIVE_EMERGENCY);
+        setRtpMix();
     }
 }
 
@@ -1742,7 +1744,8 @@ void CallWindow::init()
                                 sAudioMgr->startRtp(mCallingParty, lclAport,
                                                     mRemoteAudRtpPort, this,
                                                     audStatCb, lclAkey,
-                                                    mRemoteAudRtpKey);
+                                                    mRemoteAudRtpKey,
+                                                    isEmergency());
                                 ui->statFrame->show();
                                 setAudioEnabled(AUDIOTYPE_BOTH, true);
 #ifndef NO_VIDEO
@@ -1795,7 +1798,8 @@ void CallWindow::init()
                             sAudioMgr->startRtp(mCallingParty, lclAport,
                                                 mRemoteAudRtpPort, this,
                                                 audStatCb, lclAkey,
-                                                mRemoteAudRtpKey);
+                                                mRemoteAudRtpKey,
+                                                isEmergency());
                             ui->statFrame->show();
                             setAudioEnabled(AUDIOTYPE_BOTH, true);
                         }
@@ -1892,6 +1896,8 @@ void CallWindow::init()
                     ui->speakerButton->click();
                 emit activeInCall(mCallId, getCallParty());
             });
+    connect(ui->volumeSlider, &QSlider::valueChanged, this,
+            [this] { setRtpMix(); });
     connect(ui->closeButton, &QPushButton::clicked, this,
             [this]
             {
@@ -2015,10 +2021,28 @@ void CallWindow::setAudioEnabled(CallWindow::AudioType type,
                 (mType == CmnTypes::CALLTYPE_MON_IND_DUPLEX ||
                  mType == CmnTypes::CALLTYPE_MON_IND_PTT))
                 sAudioMgr->setActiveInRtp(mCallingParty, enabled);
+            if (enabled)
+                setRtpMix(callParty);
         }
     }
 }
 
+void CallWindow::setRtpMix(int callParty)
+{
+    int cp = (callParty != 0)? callParty: getCallParty();
+    if (cp == 0)
+        return;
+    sAudioMgr->setRtpGain(cp, ui->volumeSlider->value());
+    sAudioMgr->setRtpPriority(cp, isEmergency());
+    if (callParty == 0 &&
+        (mType == CmnTypes::CALLTYPE_MON_IND_DUPLEX ||
+         mType == CmnTypes::CALLTYPE_MON_IND_PTT))
+    {
+        sAudioMgr->setRtpGain(mCallingParty, ui->volumeSlider->value());
+        sAudioMgr->setRtpPriority(mCallingParty, isEmergency());
+    }
+}
+
 void CallWindow::stopRtp()
 {
     switch (mType)
@@ -2158,7 +2182,7 @@ void CallWindow::onPttPress()
             emit incomingConnected(mCallingParty, mCallId);
             sAudioMgr->startRtp(mCallingParty, localAudRtpPort,
                                 mRemoteAudRtpPort, this, audStatCb, localAudKey,
-                                mRemoteAudRtpKey);
+                                mRemoteAudRtpKey, isEmergency());
             ui->statFrame->show();
             setAudioEnabled(AUDIOTYPE_BOTH, true);
             ui->endButton->setEnabled(true);
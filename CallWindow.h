@@ -447,6 +447,11 @@ public:
 
     int getPriority() const { return mPriority; }
 
+    bool isEmergency() const
+    {
+        return (mPriority == MsgSp::Value::CALL_PRIORITY_PREEMPTIVE_4_EMERGENCY);
+    }
+
     /**
      * Checks whether this object is for a group call.
      *
@@ -762,6 +767,15 @@ private:
                          bool      resetMic = true,
                          int       callParty = 0);
 
+    /**
+     * Applies the volume and emergency priority to incoming audio.
+     *
+     * @param[in] callParty The call party whose audio is affected. If not
+     *                      provided, uses the stored value, and for call
+     *                      listening, additionally the other call party.
+     */
+    void setRtpMix(int callParty = 0);
+
     /**
      * Stops the RTP session.
      */
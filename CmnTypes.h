@@ -48,6 +48,7 @@ namespace CmnTypes
         ACTIONTYPE_PB_DEL,
         ACTIONTYPE_PLAY,
         ACTIONTYPE_PLAY_VID,
+        ACTIONTYPE_PRINT_CSV,
         ACTIONTYPE_PRINT_EXCEL,
         ACTIONTYPE_PRINT_PDF,
         ACTIONTYPE_PRINT_PRV,
@@ -17,8 +17,10 @@
 #include <QImageReader>
 #include <QLabel>
 #include <QPushButton>
+#include <QScrollBar>
 #include <QTableWidget>
 #include <QTableWidgetItem>
+#include <QTimer>
 #include <QTreeWidget>
 #include <QVBoxLayout>
 #include <QWidgetAction>
@@ -26,10 +28,12 @@
 #include "CmnTypes.h"
 #include "DateTimeDelegate.h"
 #include "Document.h"
+#include "MsgJournal.h"
 #include "QtUtils.h"
 #include "ResourceData.h"
 #include "StatusCodes.h"
 #include "Style.h"
+#include "ThumbnailCache.h"
 #include "ui_CommsRegister.h"
 #include "CommsRegister.h"
 
@@ -97,6 +101,9 @@ enum eDelStat
 
 static const string LOGPREFIX("CommsRegister:: ");
 
+//number of messages to restore from MsgJournal
+static const int JOURNAL_LOAD_MAX = 100;
+
 map<int, QIcon> CommsRegister::mMmsIconMap;
 
 CommsRegister::CommsRegister(Logger *logger, int type, QWidget *parent) :
@@ -480,6 +487,9 @@ mUnreadCount(0), mMmsKey(0)
     connect(QtUtils::addMenuAction(*menu, CmnTypes::ACTIONTYPE_PRINT_EXCEL),
             &QAction::triggered, this,
             [this] { doPrint(Document::PRINTTYPE_EXCEL); });
+    connect(QtUtils::addMenuAction(*menu, CmnTypes::ACTIONTYPE_PRINT_CSV),
+            &QAction::triggered, this,
+            [this] { doPrint(Document::PRINTTYPE_CSV); });
     ui->printButton->setMenu(menu);
 }
 
@@ -499,6 +509,8 @@ void CommsRegister::setUser(const QString &name, int id)
     mUserId = (id == 0 && !name.isEmpty())? ResourceData::getId(name): id;
     if (name.isEmpty() && ui->floatButton->isChecked())
         ui->floatButton->click(); //force dock on logout
+    else if (mType != TYPE_CALL && !name.isEmpty())
+        loadJournal();
 }
 
 void CommsRegister::setTheme()
@@ -539,8 +551,10 @@ void CommsRegister::addCall(MsgSp *msg)
 
 QIcon CommsRegister::getIcon(const QString &filename)
 {
-    if (!QImageReader::imageFormat(filename).isEmpty())
-        return QIcon(QPixmap(filename).scaled(20, 20, Qt::KeepAspectRatio));
+    QPixmap pm;
+    if (ThumbnailCache::instance().get(filename, ThumbnailCache::ICON_SIZE,
+                                       pm))
+        return QIcon(pm);
     return QFileIconProvider().icon(QFileInfo(filename));
 }
 
@@ -838,6 +852,10 @@ bool CommsRegister::onNewMsg(MsgSp *msg, const QString &err)
         }
     }
     tw->setItem(0, COL_MSG_MESSAGE, itm);
+    if (type == CmnTypes::COMMS_MSG_STATUS)
+        addToJournal(type, msg->getFieldInt(MsgSp::Field::STATUS_CODE));
+    else if (type == CmnTypes::COMMS_MSG_SDS)
+        addToJournal(type, -1);
     tw->resizeRowsToContents();
     QtTableUtils::tableHighlight(tw, 0, true);
     tw->setSortingEnabled(true);
@@ -887,6 +905,8 @@ void CommsRegister::onOutMsg(int            msgType,
     itm->setData(USERROLE_MSGID, msgId);
     tw->setItem(0, COL_MSG_DELSTAT, itm);
     tw->setItem(0, COL_MSG_MESSAGE, newItem(txt));
+    if (msgType != CmnTypes::COMMS_MSG_MMS)
+        addToJournal(msgType, -1);
     tw->resizeRowsToContents();
     tw->setSortingEnabled(true);
     ui->printButton->setEnabled(true);
@@ -1282,6 +1302,8 @@ bool CommsRegister::mmsCheckTx(MsgSp         *msg,
 #define TC_FN 1 //filename
 #define TC_IM 1 //image icon
 #define TC_FP 2 //file path
+//item data role for the image path of a thumbnail not yet shown
+#define TC_THUMB_ROLE (Qt::UserRole + 1)
 
 void CommsRegister::mmsShowAtt(MessageDialog *md, int key, bool outgoing)
 {
@@ -1303,7 +1325,10 @@ void CommsRegister::mmsShowAtt(MessageDialog *md, int key, bool outgoing)
         li = new QTreeWidgetItem(w);
         li->setData(TC_ID, Qt::UserRole, it.first);
         li->setText(TC_FN, it.second.fname);
-        li->setIcon(TC_FN, getIcon(it.second.path));
+        //thumbnails are loaded only when scrolled into view
+        li->setIcon(TC_FN,
+                    QFileIconProvider().icon(QFileInfo(it.second.path)));
+        li->setData(TC_FN, TC_THUMB_ROLE, it.second.path);
         li->setToolTip(TC_FN, it.second.info);
         switch (it.second.state)
         {
@@ -1342,9 +1367,7 @@ void CommsRegister::mmsShowAtt(MessageDialog *md, int key, bool outgoing)
         {
             //show scaled image
             li2 = new QTreeWidgetItem(li);
-            li2->setData(TC_IM, Qt::DecorationRole,
-                         QPixmap(it.second.path)
-                             .scaled(300, 300, Qt::KeepAspectRatio));
+            li2->setData(TC_IM, TC_THUMB_ROLE, it.second.path);
             li2->setToolTip(TC_IM, it.second.info);
             //make unselectable because it would interfere with context actions
             li2->setFlags(li2->flags() & ~Qt::ItemIsSelectable);
@@ -1354,6 +1377,36 @@ void CommsRegister::mmsShowAtt(MessageDialog *md, int key, bool outgoing)
             li->setData(TC_FP, Qt::UserRole, it.second.path);
     }
     w->resizeColumnToContents(TC_ST);
+    auto loadThumbs = [w]
+    {
+        auto &tc(ThumbnailCache::instance());
+        QRect vr(w->viewport()->rect());
+        QPixmap pm;
+        QString path;
+        bool isImg;
+        for (QTreeWidgetItemIterator it(w); *it!=0; ++it)
+        {
+            //hidden child items have empty rectangles
+            path = (*it)->data(TC_FN, TC_THUMB_ROLE).toString();
+            if (path.isEmpty() || !w->visualItemRect(*it).intersects(vr))
+                continue;
+            isImg = ((*it)->parent() != 0);
+            if (!tc.get(path, (isImg)? ThumbnailCache::IMAGE_SIZE:
+                                       ThumbnailCache::ICON_SIZE, pm))
+                continue; //ready() will trigger a retry
+            if (isImg)
+                (*it)->setData(TC_IM, Qt::DecorationRole, pm);
+            else
+                (*it)->setIcon(TC_FN, QIcon(pm));
+            (*it)->setData(TC_FN, TC_THUMB_ROLE, QVariant());
+        }
+    };
+    connect(w->verticalScrollBar(), &QScrollBar::valueChanged, w, loadThumbs);
+    connect(w->verticalScrollBar(), &QScrollBar::rangeChanged, w, loadThumbs);
+    connect(w, &QTreeWidget::itemExpanded, w, loadThumbs);
+    connect(&ThumbnailCache::instance(), &ThumbnailCache::ready, w,
+            loadThumbs);
+    QTimer::singleShot(0, w, loadThumbs);
     w->setSelectionMode(QTreeWidget::ExtendedSelection);
     w->setContextMenuPolicy(Qt::CustomContextMenu);
     connect(w, &QTreeWidget::itemDoubleClicked, this,
@@ -1809,6 +1862,75 @@ void CommsRegister::setCellData(int col, int type)
     ui->msgTable->setCellWidget(0, col, lbl);
 }
 
+void CommsRegister::addToJournal(int type, int code)
+{
+    auto *tw = ui->msgTable;
+    MsgJournal::EntryT e;
+    e.time = QDateTime::currentSecsSinceEpoch();
+    e.type = type;
+    e.from = ResourceData::getTableItemId(tw->item(0, COL_MSG_FROM));
+    e.fromType = ResourceData::getTableItemType(tw->item(0, COL_MSG_FROM));
+    e.to = ResourceData::getTableItemId(tw->item(0, COL_MSG_TO));
+    e.toType = ResourceData::getTableItemType(tw->item(0, COL_MSG_TO));
+    e.code = code;
+    e.text = tw->item(0, COL_MSG_MESSAGE)->text();
+    //a Status without text is shown as its code
+    if (code >= 0 && e.text == QString::number(code))
+        e.text.clear();
+    MsgJournal::instance().add(e);
+}
+
+void CommsRegister::loadJournal()
+{
+    auto *tw = ui->msgTable;
+    if (tw->rowCount() != 0)
+        return; //already loaded in an earlier login
+    MsgJournal::EntriesT entries;
+    if (MsgJournal::instance().getLast(-1, 0, 0, false, JOURNAL_LOAD_MAX,
+                                       entries) == 0)
+        return;
+    tw->setSortingEnabled(false);
+    QTableWidgetItem *itm;
+    int dir;
+    //oldest first, to end up at the bottom
+    for (auto it=entries.rbegin(); it!=entries.rend(); ++it)
+    {
+        if (it->from == mUserId)
+            dir = CmnTypes::COMMS_DIR_OUT;
+        else if (it->to == mUserId)
+            dir = CmnTypes::COMMS_DIR_IN;
+        else
+            dir = CmnTypes::COMMS_DIR_MON;
+        tw->insertRow(0);
+        setCellData(COL_MSG_TYPE, it->type);
+        setCellData(COL_MSG_DIR, dir);
+        if (mMsgHideTypes.count(it->type) != 0)
+            QtTableUtils::updateFilteredRow(tw, 0, COL_MSG_TYPE, true,
+                                            ui->msgFilterButton);
+        if (mMsgHideDirs.count(dir) != 0)
+            QtTableUtils::updateFilteredRow(tw, 0, COL_MSG_DIR, true,
+                                            ui->msgFilterButton);
+        itm = newItem();
+        itm->setData(Qt::DisplayRole,
+                     QDateTime::fromSecsSinceEpoch(it->time));
+        tw->setItem(0, COL_MSG_TIME, itm);
+        tw->setItem(0, COL_MSG_FROM,
+                    ResourceData::createTableItem(it->from, it->fromType,
+                                                  (it->from == mUserId)?
+                                                      mUserName: ""));
+        tw->setItem(0, COL_MSG_TO,
+                    ResourceData::createTableItem(it->to, it->toType,
+                                                  (it->to == mUserId)?
+                                                      mUserName: ""));
+        tw->setItem(0, COL_MSG_MESSAGE,
+                    newItem((it->text.isEmpty() && it->code >= 0)?
+                            QString::number(it->code): it->text));
+    }
+    tw->resizeRowsToContents();
+    tw->setSortingEnabled(true);
+    ui->printButton->setEnabled(true);
+}
+
 int CommsRegister::getCellData(int row, int col)
 {
     auto *w = ui->msgTable->cellWidget(row, col);
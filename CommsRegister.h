@@ -63,8 +63,10 @@ public:
     void addCall(MsgSp *msg);
 
     /**
-     * Gets a file icon for a filename. If image file, icon is a thumbnail.
-     * Otherwise icon is system-provided.
+     * Gets a file icon for a filename. If image file, icon is a thumbnail
+     * from ThumbnailCache. Otherwise, or while the thumbnail is being
+     * generated, icon is system-provided - ThumbnailCache::ready() is emitted
+     * when the thumbnail is available.
      *
      * @param[in] filename The filename.
      * @return The icon.
@@ -310,6 +312,22 @@ private:
      */
     void setCellData(int col, int type);
 
+    /**
+     * Adds the SDS or Status Message in the first message table row to
+     * MsgJournal.
+     *
+     * @param[in] type The message type - CmnTypes::COMMS_MSG_SDS/
+     *                 COMMS_MSG_STATUS.
+     * @param[in] code The Status code, or -1 if not applicable.
+     */
+    void addToJournal(int type, int code);
+
+    /**
+     * Loads the latest messages of the user from MsgJournal into an empty
+     * message table.
+     */
+    void loadJournal();
+
     /**
      * Gets the type data from a message table cell that was stored using
      * setCellData().
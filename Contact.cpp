@@ -847,8 +847,9 @@ void Contact::monitor(bool isGrp, bool start, const ResourceData::IdsT &ids)
         if (ctc != 0)
             ctc->mMonitored = start;
     }
-    if ((start)? !sSession->monitorStart(s1, isGrp):
-                 !sSession->monitorStop(s1, isGrp))
+    IdRangeSet ids(s1);
+    if ((start)? !sSession->monitorStart(ids, isGrp):
+                 !sSession->monitorStop(ids, isGrp))
     {
         start = !start;
         for (auto i : s1)
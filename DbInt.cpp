@@ -10,6 +10,7 @@
 #include <assert.h>
 
 #include "Locker.h"
+#include "Metrics.h"
 #if defined(SNMP) && defined(SERVERAPP)
 #include "SnmpAgent.h"
 #else
@@ -74,6 +75,37 @@ static void *startConnectThread(void *arg)
     static_cast<DbInt *>(arg)->connectThread();
     return 0;
 }
+
+/**
+ * Gets the name of a query for metrics - the database function name if
+ * any, otherwise the SQL command.
+ *
+ * @param[in] query The query.
+ * @return The name.
+ */
+static string getQueryName(const string &query)
+{
+    size_t pos = query.find("fn_");
+    if (pos != string::npos)
+        return query.substr(pos, query.find_first_of("( ", pos) - pos);
+    return query.substr(0, query.find(' '));
+}
+
+/**
+ * Records the latency of a query.
+ *
+ * @param[in] query   The query.
+ * @param[in] startUs The start time. See Metrics::nowUs().
+ * @param[in] ok      true if successful.
+ */
+static void recordQuery(const string &query, long long startUs, bool ok)
+{
+    string name(getQueryName(query));
+    Metrics::histogram("scad_db_query_us", "fn", name)
+        .record(Metrics::nowUs() - startUs);
+    if (!ok)
+        Metrics::counter("scad_db_query_errors_total", "fn", name).add();
+}
 #endif
 
 bool DbInt::isValid(bool chkOnly)
@@ -95,11 +127,14 @@ DbInt::QResult *DbInt::queryExec(const string &query)
     int retry = 1;
     do
     {
+        long long startUs = Metrics::nowUs();
         PalLock::take(&sSingletonLock);
         QueryResultT *res = PQexec(mConn, query.c_str());
         PalLock::release(&sSingletonLock);
         ExecStatusType stat = PQresultStatus(res);
-        if (stat == PGRES_COMMAND_OK || stat == PGRES_TUPLES_OK)
+        bool ok = (stat == PGRES_COMMAND_OK || stat == PGRES_TUPLES_OK);
+        recordQuery(query, startUs, ok);
+        if (ok)
             return new QResult(res);
         LOGGER_ERROR(sLogger,
                      "DbInt::queryExec(string): Query failed, retry="
@@ -133,13 +168,16 @@ DbInt::QResult *DbInt::queryExec(const string       &query,
     int retry = 1;
     do
     {
+        long long startUs = Metrics::nowUs();
         PalLock::take(&sSingletonLock);
         QueryResultT *res = PQexecParams(mConn, query.c_str(),
                                          paramValues.size(), paramTypes,
                                          params, NULL, NULL, 1);
         PalLock::release(&sSingletonLock);
         ExecStatusType stat = PQresultStatus(res);
-        if (stat == PGRES_COMMAND_OK || stat == PGRES_TUPLES_OK)
+        bool ok = (stat == PGRES_COMMAND_OK || stat == PGRES_TUPLES_OK);
+        recordQuery(query, startUs, ok);
+        if (ok)
         {
             delete [] params;
             return new QResult(res);
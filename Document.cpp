@@ -4,6 +4,8 @@
  * 1. Prepares the content in HTML format.
  * 2. Prints to the paint device such as QPrinter and QPdfWriter class.
  * 3. Writes content to Excel file.
+ * 4. In streaming mode, writes table rows to Excel or CSV file in a worker
+ *    thread.
  *
  * Copyright (C) Sapura Secured Technologies, 2016-2024. All Rights Reserved.
  *
@@ -12,23 +14,65 @@
  * @author Zulzaidi Atan
  */
 #include <assert.h>
+#include <atomic>
+#include <deque>
+#include <QEventLoop>
 #include <QFileDialog>
 #include <QFileInfo>
+#include <QFutureWatcher>
 #include <QLabel>
 #include <QMessageBox>
+#include <QMutex>
 #include <QPdfWriter>
 #include <QPrintPreviewDialog>
+#include <QProgressDialog>
 #include <QStandardItemModel>
 #include <QTextDocument>
+#include <QTimer>
+#include <QWaitCondition>
+#include <QtConcurrent/QtConcurrent>
 
 #include "CmnTypes.h"
 #include "DateTimeDelegate.h"
 #include "QtUtils.h"
 #include "Style.h"
+#include "TableWriter.h"
 #include "Version.h"
 #include "Document.h"
 
 static const QString ICON_LOGO(":/Images/images/icon_main.png");
+//streaming mode - rows per page, maximum pages queued for the writer, and
+//interval to read the next page
+static const int     PAGE_ROWS  = 1000;
+static const int     MAX_QUEUED = 4;
+static const int     FEED_MS    = 5;
+
+//item for the streaming mode writer
+struct ExportItemT
+{
+    enum eType
+    {
+        TYPE_BEGIN,
+        TYPE_ROWS,
+        TYPE_END,
+        TYPE_FINISH
+    };
+
+    int                      type = TYPE_ROWS;
+    QString                  name;
+    QStringList              cols;
+    std::vector<QStringList> rows;
+};
+
+//queue from the GUI thread to the streaming mode writer
+struct ExportQueueT
+{
+    QMutex                  mutex;
+    QWaitCondition          cond;
+    std::deque<ExportItemT> items;
+    bool                    cancel = false;
+    std::atomic<int>        written{0};  //number of rows
+};
 
 const QString Document::LINEBREAK("<br>");
 
@@ -38,8 +82,12 @@ Document::Document(int            printType,
                    const QString &title,
                    const QString &desc,
                    int            type) :
+mStream(type == TYPE_TABLE &&
+        (printType == PRINTTYPE_CSV || printType == PRINTTYPE_EXCEL)),
 mPrintType(printType), mTitle(title), mDesc(desc), mExcel(0)
 {
+    if (mStream)
+        return;
     if (mPrintType == PRINTTYPE_EXCEL)
     {
         mExcel = new QXlsx::Document();
@@ -209,6 +257,11 @@ void Document::addTable(const QTableWidget *tw,
         assert("Invalid param in Document::addTable" == 0);
         return;
     }
+    if (mStream)
+    {
+        mSrcs.push_back({tw, 0, name, dtCol, tpCol, drCol, -1});
+        return;
+    }
     newTable(name);
     int colCount = tw->columnCount();
     int j = 0;
@@ -287,6 +340,11 @@ void Document::addTable(const QTableView *tv,
         assert("Invalid param in Document::addTable" == 0);
         return;
     }
+    if (mStream)
+    {
+        mSrcs.push_back({0, tv, name, dtCol, tpCol, -1, -1});
+        return;
+    }
     QStandardItemModel *mdl = qobject_cast<QStandardItemModel *>(tv->model());
     if (mdl == 0)
         return;
@@ -382,8 +440,14 @@ void Document::print(QWidget *parent, const QString &name)
 {
     switch (mPrintType)
     {
+        case PRINTTYPE_CSV:
+            exportTables(parent, name);
+            break;
         case PRINTTYPE_EXCEL:
-            saveToExcel(parent, name);
+            if (mStream)
+                exportTables(parent, name);
+            else
+                saveToExcel(parent, name);
             break;
         case PRINTTYPE_PDF:
             saveToPdf(parent, name);
@@ -510,12 +574,27 @@ void Document::saveToPdf(QWidget *parent, const QString &name)
     sSaveDir = QFileInfo(fn).absolutePath().append("/");
     if (!fn.endsWith(".pdf"))
         fn.append(".pdf");
-    QPdfWriter pdfWriter(fn);
-    pdfWriter.setCreator(Version::APP_NAME_VERSION);
-    pdfWriter.setPageSize(QPdfWriter::A4);
-    QTextDocument doc;
-    doc.setHtml(generateHtml());
-    doc.print(&pdfWriter);
+    //layout and rendering of a large document takes long, so do it in a
+    //worker thread while showing a busy indicator
+    QString html(generateHtml());
+    QProgressDialog pd(tr("Exporting to PDF..."), "", 0, 0, parent);
+    pd.setCancelButton(0);
+    pd.setWindowModality(Qt::WindowModal);
+    pd.setMinimumDuration(500);
+    QEventLoop loop;
+    QFutureWatcher<void> fw;
+    connect(&fw, &QFutureWatcher<void>::finished, &loop, &QEventLoop::quit);
+    fw.setFuture(QtConcurrent::run([fn, html]
+                 {
+                     QPdfWriter pdfWriter(fn);
+                     pdfWriter.setCreator(Version::APP_NAME_VERSION);
+                     pdfWriter.setPageSize(QPdfWriter::A4);
+                     QTextDocument doc;
+                     doc.setHtml(html);
+                     doc.print(&pdfWriter);
+                 }));
+    if (!fw.isFinished())
+        loop.exec();
 }
 
 void Document::saveToExcel(QWidget *parent, const QString &name)
@@ -535,6 +614,294 @@ void Document::saveToExcel(QWidget *parent, const QString &name)
                               tr("Failed to export to Excel file"));
 }
 
+void Document::exportTables(QWidget *parent, const QString &name)
+{
+    bool isCsv = (mPrintType == PRINTTYPE_CSV);
+    QString ext((isCsv)? ".csv": ".xlsx");
+    QString fn(sSaveDir);
+    fn.append(name)
+      .append(QDateTime::currentDateTime().toString("-yyMMddhhmm"));
+    fn = QFileDialog::getSaveFileName(parent,
+                                      (isCsv)? tr("Export to CSV"):
+                                               tr("Export to Excel"),
+                                      fn,
+                                      (isCsv)? "CSV (*.csv)":
+                                               "Excel Workbook (*.xlsx)");
+    if (fn.isEmpty())
+        return;
+    sSaveDir = QFileInfo(fn).absolutePath().append("/");
+    if (!fn.endsWith(ext))
+        fn.append(ext);
+    TableWriter writer((isCsv)? TableWriter::FORMAT_CSV:
+                                TableWriter::FORMAT_XLSX);
+    if (!writer.open(fn))
+    {
+        QMessageBox::critical(parent, tr("Export Error"),
+                              tr("Failed to export to file: %1")
+                                  .arg(writer.getError()));
+        return;
+    }
+    QStringList headings;
+    headings << Version::NWK_NAME
+             << Version::APP_NAME_VERSION + ", " + QtUtils::getTimestamp(false)
+             << mTitle;
+    if (!mDesc.isEmpty())
+        headings << mDesc;
+    //keep the next row indexes valid while the sources are being modified
+    QObject ctx;
+    int total = 0;
+    for (auto &src : mSrcs)
+    {
+        QAbstractItemModel *mdl = (src.tw != 0)? src.tw->model():
+                                                 src.tv->model();
+        if (mdl == 0)
+            continue;
+        total += mdl->rowCount();
+        SourceT *s = &src;
+        connect(mdl, &QAbstractItemModel::rowsInserted, &ctx,
+                [s](const QModelIndex &, int first, int last)
+                {
+                    if (first < s->next)
+                        s->next += last - first + 1;
+                });
+        connect(mdl, &QAbstractItemModel::rowsRemoved, &ctx,
+                [s](const QModelIndex &, int first, int last)
+                {
+                    if (first < s->next)
+                        s->next -= qMin(last, s->next - 1) - first + 1;
+                });
+    }
+    ExportQueueT q;
+    QFutureWatcher<bool> fw;
+    QEventLoop loop;
+    connect(&fw, &QFutureWatcher<bool>::finished, &loop, &QEventLoop::quit);
+    fw.setFuture(QtConcurrent::run([&q, &writer, headings]
+    {
+        ExportItemT item;
+        bool ok = true;
+        while (ok)
+        {
+            {
+                QMutexLocker locker(&q.mutex);
+                while (q.items.empty() && !q.cancel)
+                {
+                    q.cond.wait(&q.mutex);
+                }
+                if (q.cancel)
+                    return false;
+                item = std::move(q.items.front());
+                q.items.pop_front();
+            }
+            switch (item.type)
+            {
+                case ExportItemT::TYPE_BEGIN:
+                    ok = writer.beginTable(item.name, headings, item.cols);
+                    break;
+                case ExportItemT::TYPE_END:
+                    ok = writer.endTable();
+                    break;
+                case ExportItemT::TYPE_FINISH:
+                    return writer.close();
+                case ExportItemT::TYPE_ROWS:
+                default:
+                    for (const auto &r : item.rows)
+                    {
+                        if (!writer.addRow(r))
+                            return false;
+                    }
+                    q.written += int(item.rows.size());
+                    break;
+            }
+        }
+        return false;
+    }));
+    QProgressDialog pd(tr("Exporting %1 rows...").arg(total), tr("Cancel"),
+                       0, total, parent);
+    pd.setWindowModality(Qt::WindowModal);
+    pd.setMinimumDuration(500);
+    connect(&pd, &QProgressDialog::canceled, this,
+            [&q]
+            {
+                QMutexLocker locker(&q.mutex);
+                q.cancel = true;
+                q.cond.wakeAll();
+            });
+    //read the sources in pages while the writer keeps up
+    size_t srcIdx = 0;
+    QTimer timer;
+    connect(&timer, &QTimer::timeout, this,
+            [&]
+            {
+                pd.setValue(qMin(int(q.written), total));
+                {
+                    QMutexLocker locker(&q.mutex);
+                    if (q.items.size() >= size_t(MAX_QUEUED))
+                        return;
+                }
+                std::vector<ExportItemT> items(1);
+                if (srcIdx == mSrcs.size())
+                {
+                    items[0].type = ExportItemT::TYPE_FINISH;
+                    timer.stop();
+                }
+                else if (mSrcs[srcIdx].next < 0)
+                {
+                    SourceT &s(mSrcs[srcIdx]);
+                    s.next = 0;
+                    items[0].type = ExportItemT::TYPE_BEGIN;
+                    items[0].name = s.name;
+                    items[0].cols = getColumns(s);
+                }
+                else if (!getRows(mSrcs[srcIdx], PAGE_ROWS, items[0].rows))
+                {
+                    items.resize(2);
+                    items[1].type = ExportItemT::TYPE_END;
+                    ++srcIdx;
+                }
+                QMutexLocker locker(&q.mutex);
+                for (auto &item : items)
+                {
+                    if (item.type != ExportItemT::TYPE_ROWS ||
+                        !item.rows.empty())
+                        q.items.push_back(std::move(item));
+                }
+                q.cond.wakeAll();
+            });
+    timer.start(FEED_MS);
+    if (!fw.isFinished())
+        loop.exec();
+    timer.stop();
+    if (fw.result())
+        return;
+    //canceled or failed
+    writer.abort();
+    if (!q.cancel)
+        QMessageBox::critical(parent, tr("Export Error"),
+                              tr("Failed to export to file: %1")
+                                  .arg(writer.getError()));
+}
+
+QStringList Document::getColumns(const SourceT &src)
+{
+    QStringList cols;
+    int j = 0;
+    if (src.tw != 0)
+    {
+        for (; j<src.tw->columnCount(); ++j)
+        {
+            if (!src.tw->isColumnHidden(j))
+                cols << src.tw->horizontalHeaderItem(j)->text();
+        }
+        return cols;
+    }
+    auto *mdl = qobject_cast<QStandardItemModel *>(src.tv->model());
+    if (mdl != 0)
+    {
+        for (; j<mdl->columnCount(); ++j)
+        {
+            if (!src.tv->isColumnHidden(j))
+                cols << mdl->horizontalHeaderItem(j)->text();
+        }
+    }
+    return cols;
+}
+
+bool Document::getRows(SourceT                  &src,
+                       int                       count,
+                       std::vector<QStringList> &rows)
+{
+    QStringList row;
+    QString str;
+    int j;
+    if (src.tw != 0)
+    {
+        const QTableWidget *tw = src.tw;
+        QLabel *lbl;
+        QTableWidgetItem *item;
+        int colCount = tw->columnCount();
+        int rowCount = tw->rowCount();
+        for (; src.next<rowCount && count>0; ++src.next, --count)
+        {
+            if (tw->isRowHidden(src.next))
+                continue;
+            row.clear();
+            for (j=0; j<colCount; ++j)
+            {
+                if (tw->isColumnHidden(j))
+                    continue;
+                if (j == src.tpCol || j == src.drCol)
+                {
+                    lbl = qobject_cast<QLabel *>(tw->cellWidget(src.next, j));
+                    row << ((lbl == 0)? "":
+                            QtUtils::getCommsText(lbl->objectName().toInt()));
+                    continue;
+                }
+                item = tw->item(src.next, j);
+                if (item == 0)
+                {
+                    row << "";
+                }
+                else if (j == src.dtCol)
+                {
+                    row << DateTimeDelegate::getDateTime(
+                                                  item->data(Qt::DisplayRole));
+                }
+                else if (item->toolTip().isEmpty())
+                {
+                    row << item->text();
+                }
+                else
+                {
+                    str = item->text();
+                    if (!str.isEmpty())
+                        str.append(" ");
+                    row << str.append("(").append(item->toolTip()).append(")");
+                }
+            }
+            rows.push_back(row);
+        }
+        return (src.next < rowCount);
+    }
+    auto *mdl = qobject_cast<QStandardItemModel *>(src.tv->model());
+    if (mdl == 0)
+        return false;
+    QStandardItem *item;
+    int colCount = mdl->columnCount();
+    int rowCount = mdl->rowCount();
+    for (; src.next<rowCount && count>0; ++src.next, --count)
+    {
+        row.clear();
+        for (j=0; j<colCount; ++j)
+        {
+            if (src.tv->isColumnHidden(j))
+                continue;
+            item = mdl->item(src.next, j);
+            if (item == 0)
+            {
+                row << "";
+            }
+            else if (j == src.dtCol)
+            {
+                row << DateTimeDelegate::getDateTime(
+                                                  item->data(Qt::DisplayRole));
+            }
+            else if (j == src.tpCol || item->toolTip().isEmpty())
+            {
+                row << item->text();
+            }
+            else
+            {
+                str = item->text();
+                if (!str.isEmpty())
+                    str.append(" ");
+                row << str.append(item->toolTip());
+            }
+        }
+        rows.push_back(row);
+    }
+    return (src.next < rowCount);
+}
+
 void Document::printPreview(QWidget *parent)
 {
     QPrinter p;
@@ -6,6 +6,11 @@
  *   -a description, if provided,
  *   -one or more tables (in separate worksheets in Excel).
  *
+ * CSV, and Excel with only common format tables, are exported in streaming
+ * mode - table rows are read in pages from the data sources in the GUI
+ * thread, and written to the file in a worker thread, with progress and
+ * cancel.
+ *
  * Copyright (C) Sapura Secured Technologies, 2016-2024. All Rights Reserved.
  *
  * @file
@@ -29,6 +34,7 @@ class Document : public QObject
 public:
     enum ePrintType
     {
+        PRINTTYPE_CSV,
         PRINTTYPE_EXCEL,
         PRINTTYPE_PDF,
         PRINTTYPE_PREVIEW
@@ -50,6 +56,9 @@ public:
      * @param[in] desc      The description.
      * @param[in] type      The first table type - eType.
      *                      Creates the first table if this is not TYPE_TABLE.
+     *                      Streaming mode is used if this is TYPE_TABLE with
+     *                      PRINTTYPE_CSV or PRINTTYPE_EXCEL, and in that mode
+     *                      only addTable() may be used to add content.
      */
     Document(int            printType,
              const QString &title,
@@ -116,7 +125,8 @@ public:
                      bool           multi2 = false);
 
     /**
-     * Adds and fills up a table.
+     * Adds and fills up a table. In streaming mode, only records the data
+     * source, which must remain valid until print() returns.
      *
      * @param[in] tw    The data source.
      * @param[in] name  The table name.
@@ -132,7 +142,7 @@ public:
                   int                 drCol = -1);
 
     /**
-     * Adds and fills up a table.
+     * Adds and fills up a table. See the other addTable().
      *
      * @param[in] tv    The data source.
      * @param[in] name  The table name.
@@ -150,7 +160,7 @@ public:
      */
     void endTable();
 
-    bool empty() { return mTbls.empty(); }
+    bool empty() { return (mTbls.empty() && mSrcs.empty()); }
 
     /**
      * Either shows print preview or saves to file.
@@ -189,10 +199,24 @@ private:
         ExcelData excelData;
     };
 
+    //table data source for streaming mode
+    struct SourceT
+    {
+        const QTableWidget *tw;
+        const QTableView   *tv;
+        QString             name;
+        int                 dtCol;
+        int                 tpCol;
+        int                 drCol;
+        int                 next;  //next row to read, -1 if not started
+    };
+
+    bool                    mStream;
     int                     mPrintType;
     QString                 mTitle;
     QString                 mDesc;
     std::vector<TableData>  mTbls;
+    std::vector<SourceT>    mSrcs;
     QXlsx::Format           mFmt;
     QXlsx::Document        *mExcel;
 
@@ -238,6 +262,36 @@ private:
      */
     void saveToExcel(QWidget *parent, const QString &name);
 
+    /**
+     * Exports the table data sources in streaming mode.
+     *
+     * @param[in] parent The parent widget.
+     * @param[in] name   See print().
+     */
+    void exportTables(QWidget *parent, const QString &name);
+
+    /**
+     * Gets the visible column names of a data source.
+     *
+     * @param[in] src The data source.
+     * @return The names.
+     */
+    static QStringList getColumns(const SourceT &src);
+
+    /**
+     * Reads the next rows of a data source, in the same text format as
+     * addTable() for Excel.
+     *
+     * @param[in,out] src   The data source. Its next row is advanced.
+     * @param[in]     count The maximum number of rows to read, including
+     *                      hidden rows that are skipped.
+     * @param[out]    rows  The rows.
+     * @return true if there are more rows.
+     */
+    static bool getRows(SourceT                  &src,
+                        int                       count,
+                        std::vector<QStringList> &rows);
+
     /**
      * Shows print preview dialog.
      *
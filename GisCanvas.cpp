@@ -12,6 +12,7 @@
 #include <QMessageBox>
 #include <QtQuick>
 #include <QWidgetAction>
+#include <QtConcurrent/QtConcurrent>
 
 #include "GisMenuTerminal.h"
 #include "GisMenuUserPoi.h"
@@ -84,8 +85,8 @@ QGraphicsView(parent), mOverview(overview), mValid(false),
 #ifdef INCIDENT
 mLockedIncidentId(0),
 #endif
-mTypeId(GisQmlInt::TYPEID_NONE), mSrchRadius(0), mUserName(userName),
-mLogger(logger)
+mTypeId(GisQmlInt::TYPEID_NONE), mSrchRadius(0), mZoom(-1),
+mUserName(userName), mLogger(logger)
 {
     if (logger == 0 || qw == 0)
     {
@@ -93,6 +94,12 @@ mLogger(logger)
         return;
     }
     qw->setResizeMode(QQuickWidget::SizeRootObjectToView);
+#ifdef GIS_SEAMAP
+    Settings &cfg(Settings::instance());
+    GisQmlInt::setSeaTileConfig(QString::fromStdString(
+                                 cfg.get<string>(Props::FLD_CFG_MAP_SEA_SVR)),
+                                cfg.get<int>(Props::FLD_CFG_MAP_TILECACHE));
+#endif
     //register GisQmlInt with QML
     qmlRegisterType<GisQmlInt>("gisInt", 1, 0, "GisQmlInt");
     qw->setSource(QUrl(QML_FILE)); //load QML file to widget
@@ -126,10 +133,14 @@ mLogger(logger)
         connect(mMap, SIGNAL(mapLayerLoaded()), SLOT(onMapLayerLoaded()));
         connect(mMap, SIGNAL(mapZoomChanged(double)),
                 SIGNAL(zoomChanged(double)));
+        connect(mMap, SIGNAL(mapZoomChanged(double)),
+                SLOT(onZoomChanged(double)));
         connect(mMap, SIGNAL(overviewRectChanged(double,double,double,double)),
                 SIGNAL(mapRectChanged(double,double,double,double)));
         connect(mMap, SIGNAL(mapViewChanged(QPointF,double)),
                 SIGNAL(viewChanged(QPointF,double)));
+        connect(mMap, SIGNAL(mapViewChanged(QPointF,double)),
+                SLOT(onViewChanged(QPointF,double)));
         connect(mMap, SIGNAL(customContextMenuRequested(QPointF,QVariant)),
                 SLOT(onContextMenu(QPointF,QVariant)));
         connect(mMap, SIGNAL(rscSelect(QVariant)), SLOT(onRscSelect(QVariant)));
@@ -139,6 +150,10 @@ mLogger(logger)
                 SLOT(onSearchDone(QVariant,QVariant)));
         connect(mMap, SIGNAL(searchCtrDone(QVariant,QVariant,QPointF,QString)),
                 SLOT(onSearchCtrDone(QVariant,QVariant,QPointF,QString)));
+        connect(mMap, SIGNAL(terminalRemoved(int)),
+                SLOT(onTerminalRemoved(int)));
+        connect(mMap, SIGNAL(terminalStateChanged(int,QString)),
+                SLOT(onTerminalStateChanged(int,QString)));
 #ifdef DEBUG
         connect(mMap, SIGNAL(mouseMovedDbg(double,double,double,double)),
                 SIGNAL(mapCoordinates(double,double,double,double)));
@@ -146,11 +161,32 @@ mLogger(logger)
         connect(mMap, SIGNAL(mouseMoved(double,double)),
                 SIGNAL(mapCoordinates(double,double)));
 #endif
+        //building the road network from the extract takes minutes the first
+        //time, so do it in the background
+        string roadNet(Settings::instance()
+                       .get<string>(Props::FLD_CFG_MAP_ROADNET));
+        if (!roadNet.empty())
+            mRoadNetLoad = QtConcurrent::run([this, roadNet]
+            {
+                string err;
+                if (!mRoadNet.load(roadNet, err))
+                {
+                    LOGGER_ERROR(mLogger, "GisCanvas: Road network " << roadNet
+                                 << " not loaded: " << err);
+                    return;
+                }
+                if (!err.empty())
+                    LOGGER_WARNING(mLogger, "GisCanvas: " << err);
+                LOGGER_INFO(mLogger, "GisCanvas: Road network " << roadNet
+                            << " loaded");
+            });
     } //if (!mOverview)
 }
 
 GisCanvas::~GisCanvas()
 {
+    mRoadNet.abort();
+    mRoadNetLoad.waitForFinished();
     delete mMap;
 }
 
@@ -291,6 +327,32 @@ void GisCanvas::incidentUpdate(IncidentData *data, int typeId)
                                   Q_ARG(double, data->getLon()));
 }
 
+void GisCanvas::incidentLoad(const QList<IncidentData *> &data, int typeId)
+{
+    if (typeId != GisQmlInt::TYPEID_INCIDENT &&
+        typeId != GisQmlInt::TYPEID_INCIDENT_REPORT)
+    {
+        assert("Bad param in GisCanvas::incidentLoad" == 0);
+        return;
+    }
+    if (!mValid)
+        return;
+    //packed as in Canvas.qml incidentLoad()
+    QVariantList l;
+    l.reserve(data.size() * 5);
+    for (auto d : data)
+    {
+        if (d == 0 || !d->hasLocation())
+            continue;
+        l << d->getId()
+          << ((d->getCategory() == "Others")? "default": d->getCategory())
+          << d->getState() << d->getLat() << d->getLon();
+    }
+    if (!l.isEmpty())
+        QMetaObject::invokeMethod(mMap, "incidentLoad", Q_ARG(int, typeId),
+                                  Q_ARG(QVariant, QVariant(l)));
+}
+
 void GisCanvas::incidentClose(int id)
 {
     if (mValid)
@@ -319,6 +381,8 @@ void GisCanvas::setRscInCall(int issi, bool start)
 {
     QMetaObject::invokeMethod(mMap, "setRscInCall", Q_ARG(int, issi),
                               Q_ARG(bool, start));
+    mCluster.setState(issi, GisCluster::STATE_INCALL, start);
+    showClusters();
 }
 
 void GisCanvas::setCtrRscInCall(bool enable)
@@ -365,13 +429,22 @@ void GisCanvas::terminalUpdate(bool          isValid,
                               Q_ARG(QString, getTerminalIconPfx(type)),
                               Q_ARG(QString, QString::fromStdString(timestamp)),
                               Q_ARG(QString, QString::fromStdString(s)));
-
+    mCluster.update(issi, type, lat, lon);
+    showClusters();
+    auto it = mTrails.find(issi);
+    if (isValid && it != mTrails.end())
+    {
+        it->second.add(lat, lon, time(0));
+        showPath(GisQmlInt::TYPEID_TRAILING, issi, &it->second);
+    }
 }
 
 void GisCanvas::terminalsShow(bool show, int type)
 {
     QMetaObject::invokeMethod(mMap, "terminalsShow", Q_ARG(bool, show),
                               Q_ARG(int, type));
+    mCluster.setTypeVisible(type, show);
+    showClusters();
 }
 
 void GisCanvas::terminalsFilter(const set<int> *issis)
@@ -385,6 +458,8 @@ void GisCanvas::terminalsFilter(const set<int> *issis)
         }
     }
     mMap->setProperty("mRscFilter", l);
+    mCluster.setFilter(issis);
+    showClusters();
 }
 
 void GisCanvas::terminalUpdateType(int issi, int type)
@@ -394,17 +469,26 @@ void GisCanvas::terminalUpdateType(int issi, int type)
     QMetaObject::invokeMethod(mMap, "terminalSetType", Q_ARG(int, issi),
                               Q_ARG(int, type),
                               Q_ARG(QString, getTerminalIconPfx(type)));
+    mCluster.setType(issi, type);
+    showClusters();
 }
 
 void GisCanvas::terminalRemove(int issi)
 {
     if (issi == 0)
+    {
         QMetaObject::invokeMethod(mMap, "deleteItems",
                                   Q_ARG(int, GisQmlInt::TYPEID_TERMINAL));
+        mCluster.clear();
+    }
     else
+    {
         QMetaObject::invokeMethod(mMap, "deleteItem",
                                   Q_ARG(int, GisQmlInt::TYPEID_TERMINAL),
                                   Q_ARG(int, issi));
+        mCluster.remove(issi);
+    }
+    showClusters();
 }
 
 void GisCanvas::terminalRemove(bool rmList, const set<int> &issis)
@@ -430,9 +514,15 @@ void GisCanvas::terminalRemove(bool rmList, const set<int> &issis)
                 l << i;
         }
     }
-    if (!l.isEmpty())
-        QMetaObject::invokeMethod(mMap, "terminalsErase",
-                                  Q_ARG(QVariant, QVariant::fromValue(l)));
+    if (l.isEmpty())
+        return;
+    QMetaObject::invokeMethod(mMap, "terminalsErase",
+                              Q_ARG(QVariant, QVariant::fromValue(l)));
+    for (auto &i : l)
+    {
+        mCluster.remove(i.toInt());
+    }
+    showClusters();
 }
 
 void GisCanvas::terminalCheckTimeChanged()
@@ -449,9 +539,34 @@ void GisCanvas::terminalCheckTimeChanged()
 
 void GisCanvas::terminalTrailing(int id, bool enabled)
 {
-    if (mValid)
-        QMetaObject::invokeMethod(mMap, "terminalTrailing", Q_ARG(int, id),
-                                  Q_ARG(bool, enabled));
+    if (!mValid)
+        return;
+    if (!enabled)
+    {
+        if (mTrails.erase(id) != 0)
+            showPath(GisQmlInt::TYPEID_TRAILING, id, 0);
+        return;
+    }
+    if (mTrails.count(id) != 0)
+        return;
+    const Settings &cfg(Settings::instance());
+    int maxPts = cfg.get<int>(Props::FLD_CFG_MAP_TRAIL_MAXPTS);
+    if (maxPts <= 0)
+        maxPts = GisTrail::DEF_MAX_POINTS;
+    int maxAge = cfg.get<int>(Props::FLD_CFG_MAP_TRAIL_MAXAGE);
+    if (maxAge <= 0)
+        maxAge = GisTrail::DEF_MAX_AGE_MIN;
+    GisTrail &trail(mTrails.emplace(id, GisTrail(maxPts, maxAge * 60))
+                    .first->second);
+    trail.setZoom(mZoom);
+    //start from the current position
+    QVariant ret;
+    QMetaObject::invokeMethod(mMap, "getTerminalCoords",
+                              Q_RETURN_ARG(QVariant, ret), Q_ARG(int, id));
+    QVariantList l(ret.toList());
+    if (l.size() == 2)
+        trail.add(l.at(0).toDouble(), l.at(1).toDouble(), time(0));
+    showPath(GisQmlInt::TYPEID_TRAILING, id, &trail);
 }
 
 bool GisCanvas::hasTerminals()
@@ -472,10 +587,9 @@ bool GisCanvas::getTerminalTrailing(set<int> &terms, set<int> &trail)
     {
         terms.insert(str.toInt());
     }
-    QMetaObject::invokeMethod(mMap, "getTrailings", Q_RETURN_ARG(QVariant, ret));
-    foreach (QString str, QtUtils::tokenize(ret.toString()))
+    for (auto &it : mTrails)
     {
-        trail.insert(str.toInt());
+        trail.insert(it.first);
     }
     return true;
 }
@@ -557,29 +671,46 @@ void GisCanvas::getTerminalsNearby(const QPointF &pt, const QString &radius)
                               Q_ARG(double, pt.x()));
 }
 
-void GisCanvas::addTrackingLine(int issi, const string &coord, bool isFirst)
+void GisCanvas::addTrackingLines(int                 issi,
+                                 const QVariantList &coords,
+                                 bool                isFirst)
 {
-    if (!mValid)
+    if (!mValid || coords.size() < 2)
         return;
-    size_t pos = coord.find(",");
-    QString lat(coord.substr(0, pos).c_str());
-    QString lon(coord.substr(pos + 1).c_str());
-    QMetaObject::invokeMethod(mMap, "addTrackingLine", Q_ARG(int, issi),
-                              Q_ARG(double, lat.toDouble()),
-                              Q_ARG(double, lon.toDouble()));
+    auto it = mTracks.find(issi);
+    if (it == mTracks.end())
+    {
+        it = mTracks.emplace(issi, GisTrail()).first;
+        it->second.setZoom(mZoom);
+    }
+    int i = 0;
+    for (; i<coords.size()-1; i+=2)
+    {
+        it->second.add(coords.at(i).toDouble(), coords.at(i + 1).toDouble());
+    }
+    showPath(GisQmlInt::TYPEID_TRACKING, issi, &it->second);
     if (isFirst) //center view for first point only
-        setGeomCenter(QPointF(lon.toDouble(), lat.toDouble()),
+        setGeomCenter(QPointF(coords.at(1).toDouble(),
+                              coords.at(0).toDouble()),
                       GisQmlInt::ZOOM_TRACK);
 }
 
 void GisCanvas::deleteTrackingLineSegments(int issi, int num)
 {
-    if (num < 0)
-        QMetaObject::invokeMethod(mMap, "deleteItems",
-                                  Q_ARG(int, GisQmlInt::TYPEID_TRACKING));
-    else if (num != 0)
-        QMetaObject::invokeMethod(mMap, "deleteItemLastNodes", Q_ARG(int, issi),
-                                  Q_ARG(int, num));
+    auto it = mTracks.find(issi);
+    if (it == mTracks.end() || num == 0)
+        return;
+    if (num > 0)
+        it->second.removeLast(num);
+    if (num < 0 || it->second.isEmpty())
+    {
+        mTracks.erase(it);
+        showPath(GisQmlInt::TYPEID_TRACKING, issi, 0);
+    }
+    else
+    {
+        showPath(GisQmlInt::TYPEID_TRACKING, issi, &it->second);
+    }
 }
 
 void GisCanvas::updateMeasurements(int unit)
@@ -598,10 +729,32 @@ void GisCanvas::updateView(bool label, bool show, const QString &layer)
 
 void GisCanvas::poiLoad(Props::ValueMapsT &prs)
 {
-    for (auto &it : prs)
+    //packed as in Canvas.qml poiLoad()
+    QVariantList l;
+    l.reserve(prs.size() * 10);
+    for (auto &pr : prs)
     {
-        poiLoad(it);
+        if (pr.count(Props::FLD_KEY_NEW) != 0)
+        {
+            Props::set(pr, Props::FLD_KEY, Props::get(pr, Props::FLD_KEY_NEW));
+            pr.erase(Props::FLD_KEY_NEW);
+        }
+        l << Props::get<int>(pr, Props::FLD_KEY)
+          << Props::get<bool>(pr, Props::FLD_IS_PUBLIC)
+          << QString::fromStdString(Props::get(pr, Props::FLD_USERPOI_NAME))
+          << QString::fromStdString(
+                                  Props::get(pr, Props::FLD_USERPOI_SHORTNAME))
+          << QString::fromStdString(
+                                   Props::get(pr, Props::FLD_USERPOI_CATEGORY))
+          << QString::fromStdString(Props::get(pr, Props::FLD_USERPOI_ADDR))
+          << QString::fromStdString(Props::get(pr, Props::FLD_USERPOI_DESC))
+          << QString::fromStdString(Props::get(pr, Props::FLD_OWNER))
+          << Props::get<double>(pr, Props::FLD_LAT)
+          << Props::get<double>(pr, Props::FLD_LON);
     }
+    if (!l.isEmpty())
+        QMetaObject::invokeMethod(mMap, "poiLoad",
+                                  Q_ARG(QVariant, QVariant(l)));
 }
 
 void GisCanvas::poiLoad(Props::ValueMapT &pr)
@@ -722,9 +875,46 @@ void GisCanvas::onMapLayerLoaded()
     QMetaObject::invokeMethod(mMap, "timerStart",
                               Q_ARG(int, TIMER_TERMINAL_MIN_MS));
     terminalCheckTimeChanged();
+    onZoomChanged(getZoomLevel());
     emit mapLoadComplete();
 }
 
+void GisCanvas::onZoomChanged(double zl)
+{
+    mZoom = zl;
+    if (mCluster.setZoom(zl))
+        showClusters();
+    for (auto &it : mTrails)
+    {
+        if (it.second.setZoom(zl))
+            showPath(GisQmlInt::TYPEID_TRAILING, it.first, &it.second);
+    }
+    for (auto &it : mTracks)
+    {
+        if (it.second.setZoom(zl))
+            showPath(GisQmlInt::TYPEID_TRACKING, it.first, &it.second);
+    }
+}
+
+void GisCanvas::onViewChanged(QPointF, double zl)
+{
+    onZoomChanged(zl);
+}
+
+void GisCanvas::onTerminalRemoved(int issi)
+{
+    mCluster.remove(issi);
+    showClusters();
+}
+
+void GisCanvas::onTerminalStateChanged(int issi, const QString &state)
+{
+    //state values from Canvas.qml
+    mCluster.setState(issi, GisCluster::STATE_STALE, state == "_stale1");
+    mCluster.setState(issi, GisCluster::STATE_INVALID, state == "_invalid");
+    showClusters();
+}
+
 void GisCanvas::onRscSelect(QVariant rscList)
 {
     int id;
@@ -786,7 +976,9 @@ void GisCanvas::onSearchCtrDone(QVariant       key,
     if (mTypeId == GisQmlInt::TYPEID_INCIDENT)
     {
         ResourceData::IdsT ids;
+        vector<int> issis; //in ETA order if ranked
         QStringList res(resList.toStringList());
+        bool ranked = rankByEta(ctr, res);
         int n = res.count();
         if (n > 0)
         {
@@ -801,9 +993,10 @@ void GisCanvas::onSearchCtrDone(QVariant       key,
                 //need only the ISSIs from the results
                 id = Utils::fromString<int>(l[1].toStdString());
                 tp = ResourceData::getType(id);
-                if (tp == ResourceData::TYPE_SUBSCRIBER ||
-                    tp == ResourceData::TYPE_MOBILE)
-                    ids.insert(id);
+                if ((tp == ResourceData::TYPE_SUBSCRIBER ||
+                     tp == ResourceData::TYPE_MOBILE) &&
+                    ids.insert(id).second)
+                    issis.push_back(id);
             }
         }
         if (ids.empty())
@@ -814,7 +1007,17 @@ void GisCanvas::onSearchCtrDone(QVariant       key,
         {
             auto *mdl = ResourceData::createModel(
                                              ResourceData::TYPE_SUBS_OR_MOBILE);
-            ResourceData::addIds(mdl, ids);
+            if (ranked)
+            {
+                for (auto id : issis)
+                {
+                    ResourceData::addId(mdl, id);
+                }
+            }
+            else
+            {
+                ResourceData::addIds(mdl, ids);
+            }
             emit resourceAssign(mdl);
         }
         mTypeId = GisQmlInt::TYPEID_NONE;
@@ -822,7 +1025,10 @@ void GisCanvas::onSearchCtrDone(QVariant       key,
     else
 #endif //INCIDENT
     {
-        showSearchRes(key.toString(), resList.toStringList(), &ctr, &lbl);
+        QStringList res(resList.toStringList());
+        if (key.toString().isEmpty())
+            rankByEta(ctr, res);
+        showSearchRes(key.toString(), res, &ctr, &lbl);
     }
 }
 
@@ -1109,10 +1315,7 @@ void GisCanvas::onContextMenu(const QPointF &pos, QVariant itmList)
                     act->setObjectName(nm);
                     act->setData(QVariant::fromValue(
                                                 ActionData(ACTION_RSC_MON, i)));
-                    QMetaObject::invokeMethod(mMap, "isTrailing",
-                                              Q_RETURN_ARG(QVariant, ret),
-                                              Q_ARG(int, i));
-                    if (ret.toBool())
+                    if (mTrails.count(i) != 0)
                     {
                         cmenu3->addAction(QIcon(ICON_TRAIL),
                                           tr("Disable Trailing"))
@@ -1406,7 +1609,7 @@ void GisCanvas::showSearchRes(const QString &key,
     for (; i<n; ++i)
     {
         l = res[i].split(';');
-        //format: layer;id;lat;lon;name/address[;distance]
+        //format: layer;id;lat;lon;name/address[;distance[;eta]]
         mdl->setData(mdl->index(i, InputDialog::COL_LAYER), l[0]);
         mdl->setData(mdl->index(i, InputDialog::COL_ID), l[1]);
         mdl->setData(mdl->index(i, InputDialog::COL_LAT), l[2]);
@@ -1414,13 +1617,59 @@ void GisCanvas::showSearchRes(const QString &key,
         mdl->setData(mdl->index(i, InputDialog::COL_NAME), l[4]);
         if (l.size() > 5)
             mdl->setData(mdl->index(i, InputDialog::COL_DISTANCE), l[5]);
+        //in whole minutes, and left empty if not reachable to sort last
+        if (l.size() > 6 && !l[6].isEmpty())
+            mdl->setData(mdl->index(i, InputDialog::COL_TERM_ETA),
+                         (l[6].toInt() + 59) / 60);
     }
+    if (l.size() > 6)
+        mdl->setHeaderData(InputDialog::COL_TERM_ETA, Qt::Horizontal,
+                           tr("ETA") + " (min)");
     auto *d = new InputDialog(key, mdl, c, (lbl == 0)? "": *lbl, "", this);
     connect(d, SIGNAL(showItem(Props::ValueMapT,string,string)),
             SLOT(onShowItem(Props::ValueMapT,string,string)));
     d->show();
 }
 
+bool GisCanvas::rankByEta(const QPointF &ctr, QStringList &res)
+{
+    if (!mRoadNet.isReady() || res.isEmpty())
+        return false;
+    vector<double> srcs;
+    srcs.reserve(res.size() * 2);
+    QStringList l;
+    for (const auto &r : res)
+    {
+        l = r.split(';');
+        srcs.push_back(l[2].toDouble());
+        srcs.push_back(l[3].toDouble());
+    }
+    vector<int> secs;
+    mRoadNet.getEtas(ctr.y(), ctr.x(), srcs, secs);
+    vector<int> idx(secs.size());
+    int i = 0;
+    for (auto &x : idx)
+    {
+        x = i++;
+    }
+    //unreachable ones last, in their original order
+    stable_sort(idx.begin(), idx.end(),
+                [&secs](int a, int b)
+                {
+                    return (secs[a] != GisRoadNet::ETA_NONE &&
+                            (secs[b] == GisRoadNet::ETA_NONE ||
+                             secs[a] < secs[b]));
+                });
+    QStringList sorted;
+    for (auto x : idx)
+    {
+        sorted << res[x] + ';' + ((secs[x] == GisRoadNet::ETA_NONE)?
+                                  QString(): QString::number(secs[x]));
+    }
+    res.swap(sorted);
+    return true;
+}
+
 bool GisCanvas::checkLayerVisible(int layer)
 {
     assert(layer != 0);
@@ -1487,3 +1736,56 @@ void GisCanvas::showDialog()
         terminal->show();
     }
 }
+
+void GisCanvas::showPath(int type, int issi, const GisTrail *trail)
+{
+    QVariantList l;
+    if (trail != 0)
+    {
+        vector<double> coords;
+        trail->getPath(coords);
+        l.reserve(coords.size());
+        for (auto c : coords)
+        {
+            l << c;
+        }
+    }
+    QMetaObject::invokeMethod(mMap, "pathUpdate", Q_ARG(int, type),
+                              Q_ARG(int, issi),
+                              Q_ARG(QVariant, QVariant::fromValue(l)));
+}
+
+void GisCanvas::showClusters()
+{
+    vector<GisCluster::ClusterT> clusters;
+    vector<int>                  removed;
+    vector<pair<int, bool>>      members;
+    mCluster.getChanges(clusters, removed, members);
+    if (clusters.empty() && removed.empty() && members.empty())
+        return;
+    QVariantList cl;
+    QVariantMap m;
+    for (auto &c : clusters)
+    {
+        m["id"] = c.id;
+        m["count"] = c.count;
+        m["states"] = c.states;
+        m["lat"] = c.lat;
+        m["lon"] = c.lon;
+        cl << m;
+    }
+    QVariantList rl;
+    for (auto i : removed)
+    {
+        rl << i;
+    }
+    QVariantList ml;
+    for (auto &i : members)
+    {
+        ml << i.first << i.second;
+    }
+    QMetaObject::invokeMethod(mMap, "clusterUpdate",
+                              Q_ARG(QVariant, QVariant::fromValue(cl)),
+                              Q_ARG(QVariant, QVariant::fromValue(rl)),
+                              Q_ARG(QVariant, QVariant::fromValue(ml)));
+}
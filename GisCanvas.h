@@ -12,14 +12,19 @@
 #ifndef GISCANVAS_H
 #define GISCANVAS_H
 
+#include <QFuture>
 #include <QGraphicsView>
 #include <QObject>
 #include <QQuickWidget>
 #include <QWidget>
+#include <map>
 #include <set>
 
 #include "DbInt.h"
+#include "GisCluster.h"
 #include "GisQmlInt.h"
+#include "GisRoadNet.h"
+#include "GisTrail.h"
 #ifdef INCIDENT
 #include "IncidentData.h"
 #endif
@@ -157,6 +162,15 @@ public:
      */
     void incidentUpdate(IncidentData *data, int typeId);
 
+    /**
+     * Adds/updates incident points in a single transfer to the map.
+     * Incidents without location are skipped.
+     *
+     * @param[in] data   The incidents.
+     * @param[in] typeId TYPEID_INCIDENT or TYPEID_INCIDENT_REPORT.
+     */
+    void incidentLoad(const QList<IncidentData *> &data, int typeId);
+
     /**
      * Deletes incident point.
      *
@@ -313,7 +327,9 @@ public:
                 const QString &label = "");
 
     /**
-     * Finds terminals near a point.
+     * Finds terminals near a point, and emits resourceAssign() with them
+     * ranked by travel time on the road network if it is loaded, otherwise
+     * by straight-line distance.
      *
      * @param[in] pt     The point.
      * @param[in] radius The search radius in km.
@@ -321,16 +337,16 @@ public:
     void getTerminalsNearby(const QPointF &pt, const QString &radius);
 
     /**
-     * Adds a tracking line for an ISSI to a particular position.
-     * For the first line, centers view on the position and sets the
+     * Adds tracking lines for an ISSI through a sequence of positions.
+     * For the first line, centers view on the first position and sets the
      * appropriate zoom level.
      *
      * @param[in] issi    The ISSI.
-     * @param[in] coord   The position coordinates as "latitude,longitude",
-     *                    e.g. "3.189073,101.734268".
+     * @param[in] coords  The position coordinates as
+     *                    [lat1, lon1, lat2, lon2, ...].
      * @param[in] isFirst true for the first line.
      */
-    void addTrackingLine(int issi, const std::string &coord, bool isFirst);
+    void addTrackingLines(int issi, const QVariantList &coords, bool isFirst);
 
     /**
      * Deletes tracking line segments for an ISSI.
@@ -358,7 +374,7 @@ public:
     void updateView(bool label, bool show, const QString &layer);
 
     /**
-     * Loads POI collection to map.
+     * Loads POI collection to map in a single transfer.
      *
      * @param[in] prs The POI collection.
      */
@@ -463,6 +479,37 @@ private slots:
      */
     void onMapLayerLoaded();
 
+    /**
+     * Simplifies the trailing and tracking paths for a new zoom level.
+     *
+     * @param[in] zl The zoom level.
+     */
+    void onZoomChanged(double zl);
+
+    /**
+     * Calls onZoomChanged() after a map view change.
+     *
+     * @param[in] ctr The map center.
+     * @param[in] zl  The zoom level.
+     */
+    void onViewChanged(QPointF ctr, double zl);
+
+    /**
+     * Removes a terminal from clustering after its removal in QML.
+     *
+     * @param[in] issi The ISSI.
+     */
+    void onTerminalRemoved(int issi);
+
+    /**
+     * Updates the clustering state of a terminal after a state change in
+     * QML.
+     *
+     * @param[in] issi  The ISSI.
+     * @param[in] state The state suffix of the icon, e.g. "_stale1".
+     */
+    void onTerminalStateChanged(int issi, const QString &state);
+
     /**
      * Handles resource selection on map for DGNA or Incident assignment.
      *
@@ -512,6 +559,9 @@ private slots:
     void onContextMenu(const QPointF &pos, QVariant itmList);
 
 private:
+    //key is ISSI
+    typedef std::map<int, GisTrail> TrailMapT;
+
     bool                   mOverview;
     bool                   mValid;
 #ifdef INCIDENT
@@ -519,12 +569,18 @@ private:
 #endif
     int                    mTypeId;
     int                    mSrchRadius; //nearby search radius in km
+    double                 mZoom;       //for trail simplification
     DbInt::Int2StringMapT  mTerminalTypes;
     QString                mUserName;
     QObject               *mMap;
     LayerModelsT           mLayerModels;
     Logger                *mLogger;
     Props::ValueMapT       mProps;
+    TrailMapT              mTrails;     //trailing
+    TrailMapT              mTracks;     //tracking replay
+    GisCluster             mCluster;
+    GisRoadNet             mRoadNet;
+    QFuture<void>          mRoadNetLoad;
 
     /**
      * Displays search results.
@@ -539,6 +595,17 @@ private:
                        QPointF       *ctr = 0,
                        const QString *lbl = 0);
 
+    /**
+     * Sorts terminal search results by travel time on the road network from
+     * each terminal to the search center, and appends the time in seconds
+     * to each result, or an empty field if not reachable.
+     *
+     * @param[in]     ctr The search center coordinates.
+     * @param[in,out] res The results, in format layer;id;lat;lon;name;distance.
+     * @return true if sorted, false if the road network is not loaded.
+     */
+    bool rankByEta(const QPointF &ctr, QStringList &res);
+
     /**
      * Checks a layer's visibility, and shows an error dialog if not visible.
      *
@@ -561,5 +628,20 @@ private:
      * Displays item dialog.
      */
     void showDialog();
+
+    /**
+     * Shows the simplified path of a trailing or tracking terminal, or
+     * removes it.
+     *
+     * @param[in] type  GisQmlInt::TYPEID_TRAILING or TYPEID_TRACKING.
+     * @param[in] issi  The ISSI.
+     * @param[in] trail The points. 0 to remove.
+     */
+    void showPath(int type, int issi, const GisTrail *trail);
+
+    /**
+     * Sends the terminal clustering changes to QML.
+     */
+    void showClusters();
 };
 #endif //GISCANVAS_H
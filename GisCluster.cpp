@@ -0,0 +1,292 @@
+/**
+ * Terminal grid clustering implementation.
+ *
+ * Copyright (C) Sapura Secured Technologies, 2026. All Rights Reserved.
+ *
+ * @file
+ * @version $Id$
+ * @author agent <agent@local>
+ */
+#include <math.h>
+
+#include "GisCluster.h"
+
+using namespace std;
+
+static const double PI = 3.14159265358979;
+static const int    TILE_PX = 256; //web mercator world size at zoom level 0
+
+GisCluster::GisCluster() : mZoom(MAX_ZOOM), mLastId(0)
+{
+}
+
+void GisCluster::update(int id, int type, double lat, double lon)
+{
+    auto it = mMembers.find(id);
+    if (it == mMembers.end())
+    {
+        MemberT m = { type, 0, false, false, lat, lon, CELL_NONE };
+        it = mMembers.insert(make_pair(id, m)).first;
+    }
+    else
+    {
+        MemberT &m(it->second);
+        if (m.type == type && m.lat == lat && m.lon == lon)
+            return;
+        unplace(id, m);
+        m.type = type;
+        m.lat = lat;
+        m.lon = lon;
+    }
+    place(id, it->second);
+}
+
+void GisCluster::setType(int id, int type)
+{
+    auto it = mMembers.find(id);
+    if (it != mMembers.end() && it->second.type != type)
+    {
+        unplace(id, it->second);
+        it->second.type = type;
+        place(id, it->second);
+    }
+}
+
+void GisCluster::setState(int id, int state, bool on)
+{
+    auto it = mMembers.find(id);
+    if (it == mMembers.end())
+        return;
+    MemberT &m(it->second);
+    int states = (on)? (m.states | state): (m.states & ~state);
+    if (states == m.states)
+        return;
+    if (m.cell != CELL_NONE)
+    {
+        CellT &c(mCells[m.cell]);
+        countStates(c, m.states, -1);
+        countStates(c, states, 1);
+        mDirty.insert(m.cell);
+    }
+    m.states = states;
+}
+
+void GisCluster::remove(int id)
+{
+    auto it = mMembers.find(id);
+    if (it != mMembers.end())
+    {
+        unplace(id, it->second);
+        mMembers.erase(it);
+        mChanged.erase(id);
+    }
+}
+
+void GisCluster::clear()
+{
+    for (auto &it : mCells)
+    {
+        if (it.second.id != 0)
+            mRemoved.push_back(it.second.id);
+    }
+    mCells.clear();
+    mMembers.clear();
+    mDirty.clear();
+    mChanged.clear();
+}
+
+void GisCluster::setTypeVisible(int type, bool show)
+{
+    if ((show && mHiddenTypes.erase(type) == 0) ||
+        (!show && !mHiddenTypes.insert(type).second))
+        return;
+    for (auto &it : mMembers)
+    {
+        if (it.second.type == type)
+        {
+            unplace(it.first, it.second);
+            place(it.first, it.second);
+        }
+    }
+}
+
+void GisCluster::setFilter(const set<int> *ids)
+{
+    if (ids == 0)
+    {
+        if (mFilter.empty())
+            return;
+        mFilter.clear();
+    }
+    else
+    {
+        mFilter = *ids;
+    }
+    regroup();
+}
+
+bool GisCluster::setZoom(double zoom)
+{
+    int z = (int) floor(zoom);
+    if (z > MAX_ZOOM)
+        z = MAX_ZOOM;
+    if (z == mZoom)
+        return false;
+    mZoom = z;
+    regroup();
+    return true;
+}
+
+void GisCluster::getChanges(vector<ClusterT>        &clusters,
+                            vector<int>             &removed,
+                            vector<pair<int, bool>> &members)
+{
+    clusters.clear();
+    removed.swap(mRemoved);
+    mRemoved.clear();
+    members.clear();
+    bool isCluster;
+    int i;
+    for (auto key : mDirty)
+    {
+        auto it = mCells.find(key);
+        if (it == mCells.end())
+            continue;
+        CellT &c(it->second);
+        isCluster = (c.members.size() >= MIN_COUNT);
+        if (isCluster)
+        {
+            if (c.id == 0)
+                c.id = ++mLastId;
+            ClusterT cl = { c.id, (int) c.members.size(), 0,
+                            c.latSum / c.members.size(),
+                            c.lonSum / c.members.size() };
+            for (i=0; i<3; ++i)
+            {
+                if (c.stateCount[i] > 0)
+                    cl.states |= (1 << i);
+            }
+            clusters.push_back(cl);
+        }
+        else if (c.id != 0)
+        {
+            removed.push_back(c.id);
+            c.id = 0;
+        }
+        for (auto id : c.members)
+        {
+            MemberT &m(mMembers[id]);
+            if (m.clustered != isCluster)
+            {
+                m.clustered = isCluster;
+                mChanged.insert(id);
+            }
+        }
+    }
+    mDirty.clear();
+    for (auto id : mChanged)
+    {
+        auto it = mMembers.find(id);
+        if (it != mMembers.end() && it->second.clustered != it->second.sent)
+        {
+            it->second.sent = it->second.clustered;
+            members.push_back(make_pair(id, it->second.clustered));
+        }
+    }
+    mChanged.clear();
+}
+
+bool GisCluster::isClusterable(int id, const MemberT &m) const
+{
+    return (mZoom < MAX_ZOOM && mHiddenTypes.count(m.type) == 0 &&
+            (mFilter.empty() || mFilter.count(id) != 0));
+}
+
+GisCluster::CellKeyT GisCluster::getCell(double lat, double lon) const
+{
+    //web mercator pixel coordinates at the current zoom level
+    double size = ldexp((double) TILE_PX, mZoom);
+    double x = (lon + 180) / 360 * size;
+    double s = sin(lat * PI / 180);
+    if (s > 0.9999)
+        s = 0.9999;
+    else if (s < -0.9999)
+        s = -0.9999;
+    double y = (0.5 - log((1 + s) / (1 - s)) / (4 * PI)) * size;
+    return (((CellKeyT) floor(y / CELL_PX)) << 32) +
+           (CellKeyT) floor(x / CELL_PX);
+}
+
+void GisCluster::place(int id, MemberT &m)
+{
+    if (!isClusterable(id, m))
+    {
+        m.cell = CELL_NONE;
+        if (m.clustered)
+        {
+            m.clustered = false;
+            mChanged.insert(id);
+        }
+        return;
+    }
+    m.cell = getCell(m.lat, m.lon);
+    CellT &c(mCells[m.cell]);
+    c.members.insert(id);
+    c.latSum += m.lat;
+    c.lonSum += m.lon;
+    countStates(c, m.states, 1);
+    mDirty.insert(m.cell);
+}
+
+void GisCluster::unplace(int id, MemberT &m)
+{
+    if (m.cell == CELL_NONE)
+        return;
+    auto it = mCells.find(m.cell);
+    if (it != mCells.end())
+    {
+        CellT &c(it->second);
+        c.members.erase(id);
+        if (c.members.empty())
+        {
+            if (c.id != 0)
+                mRemoved.push_back(c.id);
+            mCells.erase(it);
+        }
+        else
+        {
+            c.latSum -= m.lat;
+            c.lonSum -= m.lon;
+            countStates(c, m.states, -1);
+            mDirty.insert(m.cell);
+        }
+    }
+    m.cell = CELL_NONE;
+    if (m.clustered)
+    {
+        m.clustered = false;
+        mChanged.insert(id);
+    }
+}
+
+void GisCluster::countStates(CellT &c, int states, int inc)
+{
+    int i = 0;
+    for (; i<3; ++i)
+    {
+        if ((states & (1 << i)) != 0)
+            c.stateCount[i] += inc;
+    }
+}
+
+void GisCluster::regroup()
+{
+    for (auto &it : mMembers)
+    {
+        unplace(it.first, it.second);
+    }
+    for (auto &it : mMembers)
+    {
+        place(it.first, it.second);
+    }
+}
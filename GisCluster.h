@@ -0,0 +1,212 @@
+/**
+ * Platform-independent grid clustering of terminals on the map.
+ * Below a threshold zoom level, the map is divided into square cells of a
+ * fixed pixel size, and the visible terminals in a cell with at least two
+ * of them are represented by one cluster at their centroid, with the count
+ * and the aggregated states. Changes are tracked per cell, so that a
+ * location update only affects the cells it leaves and enters, while a zoom
+ * level change regroups all terminals.
+ * Not thread-safe.
+ *
+ * Copyright (C) Sapura Secured Technologies, 2026. All Rights Reserved.
+ *
+ * @file
+ * @version $Id$
+ * @author agent <agent@local>
+ */
+#ifndef GISCLUSTER_H
+#define GISCLUSTER_H
+
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+class GisCluster
+{
+public:
+    //terminal state flags
+    enum eState
+    {
+        STATE_INCALL  = 0x01,
+        STATE_STALE   = 0x02,
+        STATE_INVALID = 0x04
+    };
+
+    struct ClusterT
+    {
+        int    id;
+        int    count;
+        int    states;  //eState flags of any member
+        double lat;     //centroid
+        double lon;
+    };
+
+    //clustering is done below this zoom level
+    static const int MAX_ZOOM = 14;
+
+    GisCluster();
+
+    /**
+     * Adds a terminal or updates its position and type.
+     *
+     * @param[in] id   The terminal ID.
+     * @param[in] type The terminal type.
+     * @param[in] lat  The latitude.
+     * @param[in] lon  The longitude.
+     */
+    void update(int id, int type, double lat, double lon);
+
+    /**
+     * Sets the type of a terminal, which affects its visibility.
+     *
+     * @param[in] id   The terminal ID.
+     * @param[in] type The type.
+     */
+    void setType(int id, int type);
+
+    /**
+     * Sets or clears a state flag of a terminal.
+     *
+     * @param[in] id    The terminal ID.
+     * @param[in] state eState.
+     * @param[in] on    true to set.
+     */
+    void setState(int id, int state, bool on);
+
+    /**
+     * Removes a terminal.
+     *
+     * @param[in] id The terminal ID.
+     */
+    void remove(int id);
+
+    /**
+     * Removes all terminals.
+     */
+    void clear();
+
+    /**
+     * Shows or hides terminals of a type. Hidden terminals are not
+     * clustered.
+     *
+     * @param[in] type The type.
+     * @param[in] show true to show.
+     */
+    void setTypeVisible(int type, bool show);
+
+    /**
+     * Sets the terminals to show. Other terminals are not clustered.
+     *
+     * @param[in] ids The terminal IDs. 0 or empty to show all.
+     */
+    void setFilter(const std::set<int> *ids);
+
+    /**
+     * Sets the map zoom level, and regroups all terminals if the integer
+     * level changes.
+     *
+     * @param[in] zoom The zoom level.
+     * @return true if regrouped.
+     */
+    bool setZoom(double zoom);
+
+    /**
+     * Gets the changes since the last call.
+     *
+     * @param[out] clusters The new or changed clusters.
+     * @param[out] removed  The removed cluster IDs.
+     * @param[out] members  The terminals whose clustered status changed,
+     *                      with true if now in a cluster.
+     */
+    void getChanges(std::vector<ClusterT>             &clusters,
+                    std::vector<int>                  &removed,
+                    std::vector<std::pair<int, bool>> &members);
+
+private:
+    typedef long long CellKeyT;
+
+    struct MemberT
+    {
+        int      type;
+        int      states;
+        bool     clustered;
+        bool     sent;     //clustered status last reported
+        double   lat;
+        double   lon;
+        CellKeyT cell;     //CELL_NONE if not in any
+    };
+
+    struct CellT
+    {
+        int           id;            //0 if not reported as a cluster
+        int           stateCount[3]; //members per eState bit
+        double        latSum;
+        double        lonSum;
+        std::set<int> members;
+    };
+
+    static const CellKeyT CELL_NONE = -1;
+    static const int      CELL_PX   = 64;   //cell size in pixels
+    static const int      MIN_COUNT = 2;    //minimum members in a cluster
+
+    int                       mZoom;
+    int                       mLastId;    //last cluster ID
+    std::set<int>             mFilter;
+    std::set<int>             mHiddenTypes;
+    std::map<int, MemberT>    mMembers;   //key is terminal ID
+    std::map<CellKeyT, CellT> mCells;
+    std::set<CellKeyT>        mDirty;     //cells with changes
+    std::set<int>             mChanged;   //members with possible changes
+    std::vector<int>          mRemoved;   //cluster IDs of erased cells
+
+    /**
+     * Checks whether a terminal is visible and clustering is active.
+     *
+     * @param[in] id The terminal ID.
+     * @param[in] m  The terminal.
+     * @return true if the terminal belongs in a cell.
+     */
+    bool isClusterable(int id, const MemberT &m) const;
+
+    /**
+     * Gets the cell key of a position at the current zoom level.
+     *
+     * @param[in] lat The latitude.
+     * @param[in] lon The longitude.
+     * @return The key.
+     */
+    CellKeyT getCell(double lat, double lon) const;
+
+    /**
+     * Puts a terminal into the cell of its position, or out of any cell,
+     * depending on isClusterable().
+     *
+     * @param[in] id The terminal ID.
+     * @param[in] m  The terminal.
+     */
+    void place(int id, MemberT &m);
+
+    /**
+     * Takes a terminal out of its cell, if any.
+     *
+     * @param[in] id The terminal ID.
+     * @param[in] m  The terminal.
+     */
+    void unplace(int id, MemberT &m);
+
+    /**
+     * Adds or subtracts the states of a terminal in its cell.
+     *
+     * @param[in] c      The cell.
+     * @param[in] states eState flags.
+     * @param[in] inc    1 to add, -1 to subtract.
+     */
+    static void countStates(CellT &c, int states, int inc);
+
+    /**
+     * Places all terminals again.
+     */
+    void regroup();
+};
+#endif //GISCLUSTER_H
@@ -8,9 +8,6 @@
  * @author Rosnin Mustaffa
  */
 #include <QGuiApplication>
-#include <QNetworkRequest>
-#include <QStandardPaths>
-#include <QUrl>
 
 #include "GisQmlInt.h"
 
@@ -19,9 +16,7 @@ using namespace std;
 static const string  SYSPREFIX  ("sys_");
 static const QString IMG_ROUTE  (":/Images/images/cursor_route.png");
 static const QString IMG_SEL_RSC(":/Images/images/cursor_sel_resource.png");
-static const QString CACHE_DIR  (QStandardPaths::writableLocation(
-                                         QStandardPaths::GenericCacheLocation) +
-                                 "/QtLocation/seaTiles/");
+static const QString SEATILE_SVR("https://tiles.openseamap.org/");
 
 const double GisQmlInt::ZOOM_MAX    = 20.0;
 const double GisQmlInt::ZOOM_MIN    =  5.0;
@@ -48,34 +43,20 @@ const string GisQmlInt::SYS_ATTR_VALUE     (SYSPREFIX + "CATEGORY");
 const time_t GisQmlInt::TERMINAL_TIME_THRESHOLD = 30 * 60; //seconds
 
 QString GisQmlInt::sMapPath;
+QString GisQmlInt::sSeaTilePath(SEATILE_SVR);
 
-void GisQmlInt::downloadTile(const QString &url, const QString &filepath)
+GisQmlInt::GisQmlInt(QObject *parent) : QObject(parent)
 {
-    if (mDownloads.contains(filepath))
-        return;
-    mDownloads.insert(filepath);
-    QNetworkReply *reply = mNwkManager->get(QNetworkRequest(QUrl(url)));
-    connect(reply, &QNetworkReply::finished, this,
-            [this, filepath, reply] { handleReply(reply, filepath); });
-}
-
-void GisQmlInt::clearTiles()
-{
-    QDir dir(CACHE_DIR);
-    dir.setNameFilters(QStringList() << "*.png");
-    dir.setFilter(QDir::Files);
-    foreach(QString f, dir.entryList())
-    {
-        dir.remove(f);
-    }
+    GisTileCache &tc(GisTileCache::instance());
+    connect(&tc, &GisTileCache::tileDownloaded, this,
+            &GisQmlInt::tileDownloaded);
+    connect(&tc, &GisTileCache::tileDownloadFailed, this,
+            &GisQmlInt::tileDownloadFailed);
 }
 
 QString GisQmlInt::getCachePath()
 {
-    QDir dir(CACHE_DIR);
-    if (!dir.exists())
-        dir.mkpath(".");
-    return CACHE_DIR;
+    return GisTileCache::instance().getPath();
 }
 
 QString GisQmlInt::getModelName(int typeId)
@@ -132,58 +113,13 @@ bool GisQmlInt::setMapPath(const QString &path)
     return true;
 }
 
-void GisQmlInt::handleReply(QNetworkReply *reply, const QString &filepath)
-{
-    if (isRedirect(reply))
-        openUrl(reply, filepath);
-    else if (reply->error() == QNetworkReply::NoError)
-        saveTile(reply, filepath);
-    else
-        emit tileDownloadFailed(filepath, "Failed to save tile.");
-    reply->deleteLater();
-    mDownloads.remove(filepath);
-}
-
-bool GisQmlInt::isRedirect(QNetworkReply *reply)
-{
-    return !reply->attribute(QNetworkRequest::RedirectionTargetAttribute)
-                  .isNull();
-}
-
-void GisQmlInt::openUrl(QNetworkReply *reply, const QString &filepath)
+void GisQmlInt::setSeaTileConfig(const QString &path, int cacheMb)
 {
-    QUrl url(reply->attribute(QNetworkRequest::RedirectionTargetAttribute)
-                   .toUrl());
-    if (url.isRelative())
-        url = reply->url().resolved(url);
-    QNetworkReply *urlReply = mNwkManager->get(QNetworkRequest(url));
-    connect(urlReply, &QNetworkReply::finished, this,
-            [this, filepath, urlReply] { handleReply(urlReply, filepath); });
-}
-
-void GisQmlInt::saveTile(QNetworkReply *reply, const QString &filepath)
-{
-    QByteArray data(reply->readAll());
-    if (!(data.startsWith("\x89PNG") || data.startsWith("\xFF\xD8")))
-    {
-        emit tileDownloadFailed(filepath, "Invalid image file");
-        return;
-    }
-    if (writeTile(filepath, data))
-        emit tileDownloaded(filepath);
+    if (path.isEmpty())
+        sSeaTilePath = SEATILE_SVR;
+    else if (path.endsWith('/'))
+        sSeaTilePath = path;
     else
-        emit tileDownloadFailed(filepath, "Failed to write");
-}
-
-bool GisQmlInt::writeTile(const QString &filepath, const QByteArray &data)
-{
-    QFile file(filepath);
-    if (!file.open(QIODevice::WriteOnly))
-    {
-        emit tileDownloadFailed(filepath, file.errorString());
-        return false;
-    }
-    file.write(data);
-    file.close();
-    return true;
+        sSeaTilePath = path + "/";
+    GisTileCache::instance().setQuota(cacheMb);
 }
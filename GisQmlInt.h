@@ -11,12 +11,11 @@
 #define GISQMLINT_H
 
 #include <QFile>
-#include <QNetworkAccessManager>
-#include <QNetworkReply>
 #include <QObject>
 #include <QtPositioning>
 
 #include "GisLocation.h"
+#include "GisTileCache.h"
 #include "ResourceData.h"
 #include "Style.h"
 
@@ -92,14 +91,20 @@ public:
     };
     Q_ENUM(eMeasureUnit)
 
+    enum eTilePriority
+    {
+        TILE_PRIO_VIEW     = GisTileCache::PRIO_VIEW,
+        TILE_PRIO_PREFETCH = GisTileCache::PRIO_PREFETCH
+    };
+    Q_ENUM(eTilePriority)
+
     /**
      * Constructor.
      * Creates GIS interface to QML.
      *
      * @param[in] parent Parent widget, if any.
      */
-    explicit GisQmlInt(QObject *parent = 0) :
-    QObject(parent), mNwkManager(new QNetworkAccessManager(this)) {}
+    explicit GisQmlInt(QObject *parent = 0);
 
     /**
      * Gets the resource map label.
@@ -109,7 +114,7 @@ public:
      */
     Q_INVOKABLE QString rscLbl(int issi)
     {
-        return QString::fromStdString(ResourceData::getMapSubsLbl(issi));
+        return ResourceData::getMapSubsLblTxt(issi);
     }
 
     /**
@@ -158,17 +163,41 @@ public:
     }
 
     /**
-     * Starts tile downloading process and saves to file if successful.
+     * Checks whether a tile is in the cache, and marks it as recently used.
+     *
+     * @param[in] filepath The filepath.
+     * @return true if cached.
+     */
+    Q_INVOKABLE bool isTileCached(const QString &filepath)
+    {
+        return GisTileCache::instance().isCached(filepath);
+    }
+
+    /**
+     * Queues a tile for download, to be saved to file if successful.
+     * Emits tileDownloaded() or tileDownloadFailed() on completion.
      *
      * @param[in] url      Tile server URL.
      * @param[in] filepath The filepath.
+     * @param[in] priority The priority - eTilePriority.
      */
-    Q_INVOKABLE void downloadTile(const QString &url, const QString &filepath);
+    Q_INVOKABLE void downloadTile(const QString &url,
+                                  const QString &filepath,
+                                  int            priority = TILE_PRIO_VIEW)
+    {
+        GisTileCache::instance().request(url, filepath, priority);
+    }
+
+    /**
+     * Starts a new tile viewport. Tiles requested after this are downloaded
+     * before those requested earlier at the same priority.
+     */
+    Q_INVOKABLE void newTileView() { GisTileCache::instance().newView(); }
 
     /**
      * Clears seadepth and seamark tiles.
      */
-    Q_INVOKABLE void clearTiles();
+    Q_INVOKABLE void clearTiles() { GisTileCache::instance().clear(); }
 
     Q_INVOKABLE bool isDarkMode()
     {
@@ -199,58 +228,24 @@ public:
 
     Q_INVOKABLE QString getMapPath() { return sMapPath; }
 
+    Q_INVOKABLE QString getSeaTilePath() { return sSeaTilePath; }
+
     static bool setMapPath(const QString &path);
 
+    /**
+     * Sets the seamark tile server and tile cache size.
+     *
+     * @param[in] path    The tile server path. Empty for default.
+     * @param[in] cacheMb The maximum tile cache size in MB. 0 for default.
+     */
+    static void setSeaTileConfig(const QString &path, int cacheMb);
+
 signals:
     void tileDownloaded(const QString &filePath);
     void tileDownloadFailed(const QString &url, const QString &err);
 
 private:
-    QNetworkAccessManager *mNwkManager;
-    QSet<QString>          mDownloads; //download tiles filepath list
-
     static QString sMapPath;
-
-    /**
-     * Handles network reply for tile download request. If available, saves
-     * tile to file.
-     *
-     * @param[in] reply    The reply from network.
-     * @param[in] filepath The filepath.
-     */
-    void handleReply(QNetworkReply *reply, const QString &filepath);
-
-    /**
-     * Checks whether network reply contains redirect URL.
-     *
-     * @param[in] reply The reply from network.
-     * @return true if reply contains redirect URL.
-     */
-    bool isRedirect(QNetworkReply *reply);
-
-    /**
-     * Handles URL redirection.
-     *
-     * @param[in] reply    The reply from network.
-     * @param[in] filepath The filepath.
-     */
-    void openUrl(QNetworkReply *reply, const QString &filepath);
-
-    /**
-     * Saves downloaded tile to file. Accepts only "*.png", discards others.
-     *
-     * @param[in] reply    The reply from network.
-     * @param[in] filepath The filepath.
-     */
-    void saveTile(QNetworkReply *reply, const QString &filepath);
-
-    /**
-     * Writes tile data to file.
-     *
-     * @param[in] filepath The filepath.
-     * @param[in] data     The binary data.
-     * @return true if file is successfully created.
-     */
-    bool writeTile(const QString &filepath, const QByteArray &data);
+    static QString sSeaTilePath;
 };
 #endif // GISQMLINT_H
@@ -0,0 +1,901 @@
+/**
+ * Road routing implementation.
+ *
+ * Copyright (C) Sapura Secured Technologies, 2026. All Rights Reserved.
+ *
+ * @file
+ * @version $Id$
+ * @author agent <agent@local>
+ */
+#include <algorithm>
+#include <climits>
+#include <fstream>
+#include <functional>
+#include <math.h>
+#include <queue>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <utility>
+
+#include "GisRoadNet.h"
+
+using namespace std;
+
+typedef pair<int, int> HeapItemT;  //weight or priority, node
+typedef priority_queue<HeapItemT, vector<HeapItemT>, greater<HeapItemT>>
+        HeapT;
+
+static const double PI = 3.14159265358979;
+static const double EARTH_RADIUS_M = 6371008.8;
+static const double MICRODEG = 1000000.0;
+static const double GRID_CELLS_PER_DEG = 100.0;
+static const int    NO_COORD = INT_MIN;
+static const char   CACHE_MAGIC[] = "PHXRNET";
+
+//speeds in km/h for the routable highway classes
+static const struct
+{
+    const char *type;
+    int         kmh;
+} SPEEDS[] =
+{
+    { "motorway",       90 },
+    { "motorway_link",  50 },
+    { "trunk",          80 },
+    { "trunk_link",     45 },
+    { "primary",        65 },
+    { "primary_link",   40 },
+    { "secondary",      55 },
+    { "secondary_link", 35 },
+    { "tertiary",       45 },
+    { "tertiary_link",  30 },
+    { "unclassified",   35 },
+    { "residential",    25 },
+    { "road",           25 },
+    { "service",        15 },
+    { "living_street",  10 }
+};
+
+const int    GisRoadNet::ETA_NONE;
+const char  *GisRoadNet::CACHE_EXT = ".rnet";
+const double GisRoadNet::OFFROAD_KMH = 20.0;
+
+/**
+ * Gets an attribute value from an XML element.
+ *
+ * @param[in]  elem The element text without the angle brackets.
+ * @param[in]  name The attribute name.
+ * @param[out] val  The value.
+ * @return true if found.
+ */
+static bool getAttr(const string &elem, const char *name, string &val)
+{
+    string key(" ");
+    key.append(name).append("=");
+    size_t p = elem.find(key);
+    if (p == string::npos)
+        return false;
+    p += key.size();
+    if (p >= elem.size())
+        return false;
+    char q = elem[p];
+    size_t e = elem.find(q, ++p);
+    if (e == string::npos)
+        return false;
+    val = elem.substr(p, e - p);
+    return true;
+}
+
+/**
+ * Gets the next XML element from a stream.
+ *
+ * @param[in]  is   The stream.
+ * @param[out] elem The element text without the angle brackets, or empty
+ *                  for a comment or declaration.
+ * @return false at the end of the stream.
+ */
+static bool getElement(istream &is, string &elem)
+{
+    if (!getline(is, elem, '>'))
+        return false;
+    size_t p = elem.find('<');
+    if (p == string::npos || p + 1 >= elem.size() || elem[p + 1] == '?' ||
+        elem[p + 1] == '!')
+        elem.clear();
+    else
+        elem.erase(0, p + 1);
+    return true;
+}
+
+/**
+ * Checks whether an XML element has a name.
+ *
+ * @param[in] elem The element text.
+ * @param[in] name The name, with a trailing space for a start tag.
+ * @return true if matching.
+ */
+static inline bool isElement(const string &elem, const char *name)
+{
+    return (elem.compare(0, strlen(name), name) == 0);
+}
+
+/**
+ * Adds an edge, or lowers the weight of an existing one between the same
+ * nodes.
+ *
+ * @param[in] out  The outgoing edges.
+ * @param[in] in   The incoming edges, with the source in EdgeT::node.
+ * @param[in] from The source node.
+ * @param[in] to   The target node.
+ * @param[in] w    The weight.
+ * @param[in] mid  The contracted node, or -1.
+ */
+template<class T>
+static void addEdge(vector<vector<T>> &out,
+                    vector<vector<T>> &in,
+                    int                from,
+                    int                to,
+                    int                w,
+                    int                mid)
+{
+    for (auto &e : out[from])
+    {
+        if (e.node == to)
+        {
+            if (w < e.w)
+            {
+                e.w = w;
+                e.mid = mid;
+                for (auto &e2 : in[to])
+                {
+                    if (e2.node == from)
+                    {
+                        e2.w = w;
+                        e2.mid = mid;
+                        break;
+                    }
+                }
+            }
+            return;
+        }
+    }
+    T e = { to, w, mid };
+    out[from].push_back(e);
+    e.node = from;
+    in[to].push_back(e);
+}
+
+/**
+ * Removes the edges to a node.
+ *
+ * @param[in] edges The edges.
+ * @param[in] node  The node.
+ */
+template<class T>
+static void removeEdges(vector<T> &edges, int node)
+{
+    edges.erase(remove_if(edges.begin(), edges.end(),
+                          [node](const T &e) { return e.node == node; }),
+                edges.end());
+}
+
+GisRoadNet::GisRoadNet() : mAbort(false), mReady(false)
+{
+}
+
+bool GisRoadNet::load(const string &osmFile, string &err)
+{
+    struct stat st;
+    if (stat(osmFile.c_str(), &st) != 0)
+    {
+        err = "Failed to open " + osmFile;
+        return false;
+    }
+    //an edited extract may keep its size, so check its time too
+    long long size = st.st_size;
+    long long mtime = st.st_mtime;
+    string cacheFile(osmFile + CACHE_EXT);
+    if (!loadCache(cacheFile, size, mtime))
+    {
+        vector<RawEdgeT> edges;
+        if (!readOsm(osmFile, edges, err))
+            return false;
+        if (edges.empty())
+        {
+            err = "No roads in " + osmFile;
+            return false;
+        }
+        if (!contract(edges))
+        {
+            err = "Aborted";
+            return false;
+        }
+        if (!saveCache(cacheFile, size, mtime))
+            err = "Failed to save " + cacheFile;  //not fatal
+    }
+    buildGrid();
+    mReady = true;
+    return true;
+}
+
+bool GisRoadNet::route(double  srcLat,
+                       double  srcLon,
+                       double  dstLat,
+                       double  dstLon,
+                       RouteT &res) const
+{
+    int src;
+    int dst;
+    double srcM;
+    double dstM;
+    if (!mReady || !snap(srcLat, srcLon, src, srcM) ||
+        !snap(dstLat, dstLon, dst, dstM))
+        return false;
+    SearchT fwd;
+    SearchT bwd;
+    search(mUp, src, fwd);
+    search(mDown, dst, bwd);
+    int best = INT_MAX;
+    int meet = -1;
+    for (const auto &it : fwd)
+    {
+        auto it2 = bwd.find(it.first);
+        if (it2 != bwd.end() && it.second.dist + it2->second.dist < best)
+        {
+            best = it.second.dist + it2->second.dist;
+            meet = it.first;
+        }
+    }
+    if (meet < 0)
+        return false;
+    //collect the hierarchy edges from the meeting node back to the source
+    vector<int> up;
+    int n;
+    for (n=meet; n!=src; n=fwd[n].parent)
+    {
+        up.push_back(n);
+    }
+    vector<int> path(1, src);
+    int from = src;
+    for (auto it=up.rbegin(); it!=up.rend(); ++it)
+    {
+        unpack(from, *it, fwd[*it].mid, path);
+        from = *it;
+    }
+    for (n=meet; n!=dst; n=bwd[n].parent)
+    {
+        unpack(n, bwd[n].parent, bwd[n].mid, path);
+    }
+    res.coords.clear();
+    res.coords.reserve(path.size() * 2 + 4);
+    res.coords.push_back(srcLat);
+    res.coords.push_back(srcLon);
+    double m = srcM + dstM;
+    for (size_t i=0; i<path.size(); ++i)
+    {
+        res.coords.push_back(mLats[path[i]] / MICRODEG);
+        res.coords.push_back(mLons[path[i]] / MICRODEG);
+        if (i > 0)
+            m += getDistance(mLats[path[i - 1]] / MICRODEG,
+                             mLons[path[i - 1]] / MICRODEG,
+                             mLats[path[i]] / MICRODEG,
+                             mLons[path[i]] / MICRODEG);
+    }
+    res.coords.push_back(dstLat);
+    res.coords.push_back(dstLon);
+    res.km = m / 1000;
+    res.secs = (best + 5) / 10 +
+               (int) ((srcM + dstM) / (OFFROAD_KMH / 3.6) + 0.5);
+    return true;
+}
+
+void GisRoadNet::getEtas(double                dstLat,
+                         double                dstLon,
+                         const vector<double> &srcs,
+                         vector<int>          &secs) const
+{
+    secs.assign(srcs.size() / 2, ETA_NONE);
+    int dst;
+    double dstM;
+    if (!mReady || !snap(dstLat, dstLon, dst, dstM))
+        return;
+    SearchT bwd;
+    search(mDown, dst, bwd);
+    SearchT fwd;
+    int src;
+    int best;
+    double srcM;
+    for (size_t i=0; i<secs.size(); ++i)
+    {
+        if (!snap(srcs[i * 2], srcs[i * 2 + 1], src, srcM))
+            continue;
+        search(mUp, src, fwd);
+        best = INT_MAX;
+        for (const auto &it : fwd)
+        {
+            auto it2 = bwd.find(it.first);
+            if (it2 != bwd.end() && it.second.dist + it2->second.dist < best)
+                best = it.second.dist + it2->second.dist;
+        }
+        if (best != INT_MAX)
+            secs[i] = (best + 5) / 10 +
+                      (int) ((srcM + dstM) / (OFFROAD_KMH / 3.6) + 0.5);
+    }
+}
+
+bool GisRoadNet::readOsm(const string     &osmFile,
+                         vector<RawEdgeT> &edges,
+                         string           &err)
+{
+    ifstream is(osmFile.c_str(), ios::binary);
+    if (!is)
+    {
+        err = "Failed to open " + osmFile;
+        return false;
+    }
+    //first pass: the ways with their node references
+    struct WayT
+    {
+        size_t first;   //in refs
+        size_t count;
+        int    kmh;
+        int    dir;     //1 forward only, -1 backward only, 0 both
+    };
+    vector<WayT> ways;
+    vector<long long> refs;
+    WayT way = { 0, 0, 0, 0 };
+    bool inWay = false;
+    int maxSpeed = 0;
+    unsigned long count = 0;
+    string elem;
+    string k;
+    string v;
+    size_t i;
+    while (getElement(is, elem))
+    {
+        if ((++count & 0xFFFFF) == 0 && mAbort)
+        {
+            err = "Aborted";
+            return false;
+        }
+        if (isElement(elem, "way "))
+        {
+            inWay = (elem.back() != '/');
+            way.first = refs.size();
+            way.kmh = 0;
+            way.dir = 0;
+            maxSpeed = 0;
+        }
+        else if (!inWay)
+        {
+            continue;
+        }
+        else if (isElement(elem, "nd ") && getAttr(elem, "ref", v))
+        {
+            refs.push_back(atoll(v.c_str()));
+        }
+        else if (isElement(elem, "tag ") && getAttr(elem, "k", k) &&
+                 getAttr(elem, "v", v))
+        {
+            if (k == "highway")
+            {
+                for (const auto &s : SPEEDS)
+                {
+                    if (v == s.type)
+                    {
+                        way.kmh = s.kmh;
+                        if (v == "motorway")
+                            way.dir = 1;
+                        break;
+                    }
+                }
+            }
+            else if (k == "oneway")
+            {
+                if (v == "yes" || v == "1" || v == "true")
+                    way.dir = 1;
+                else if (v == "-1" || v == "reverse")
+                    way.dir = -1;
+                else if (v == "no")
+                    way.dir = 0;
+            }
+            else if (k == "junction")
+            {
+                if (v == "roundabout" || v == "circular")
+                    way.dir = 1;
+            }
+            else if (k == "maxspeed")
+            {
+                maxSpeed = atoi(v.c_str());
+                if (v.find("mph") != string::npos)
+                    maxSpeed = maxSpeed * 1609 / 1000;
+            }
+        }
+        else if (isElement(elem, "/way"))
+        {
+            inWay = false;
+            way.count = refs.size() - way.first;
+            if (way.kmh == 0 || way.count < 2)
+            {
+                refs.resize(way.first);
+                continue;
+            }
+            //a sign is the legal limit, not the typical speed
+            if (maxSpeed > 0 && maxSpeed * 8 / 10 < way.kmh)
+                way.kmh = max(5, maxSpeed * 8 / 10);
+            ways.push_back(way);
+        }
+    }
+    if (ways.empty())
+        return true;
+    //second pass: the coordinates of the referenced nodes
+    vector<long long> ids(refs);
+    sort(ids.begin(), ids.end());
+    ids.erase(unique(ids.begin(), ids.end()), ids.end());
+    mLats.assign(ids.size(), NO_COORD);
+    mLons.assign(ids.size(), NO_COORD);
+    is.clear();
+    is.seekg(0);
+    while (getElement(is, elem))
+    {
+        if ((++count & 0xFFFFF) == 0 && mAbort)
+        {
+            err = "Aborted";
+            return false;
+        }
+        if (isElement(elem, "way ") || isElement(elem, "relation "))
+            break;  //nodes come first in an extract
+        if (!isElement(elem, "node ") || !getAttr(elem, "id", v))
+            continue;
+        auto it = lower_bound(ids.begin(), ids.end(), atoll(v.c_str()));
+        if (it == ids.end() || *it != atoll(v.c_str()) ||
+            !getAttr(elem, "lat", k) || !getAttr(elem, "lon", v))
+            continue;
+        i = it - ids.begin();
+        mLats[i] = (int) floor(atof(k.c_str()) * MICRODEG + 0.5);
+        mLons[i] = (int) floor(atof(v.c_str()) * MICRODEG + 0.5);
+    }
+    //segments between consecutive nodes
+    int a;
+    int b;
+    int w;
+    RawEdgeT e;
+    for (const auto &wy : ways)
+    {
+        for (i=wy.first+1; i<wy.first+wy.count; ++i)
+        {
+            a = lower_bound(ids.begin(), ids.end(), refs[i - 1]) - ids.begin();
+            b = lower_bound(ids.begin(), ids.end(), refs[i]) - ids.begin();
+            if (a == b || mLats[a] == NO_COORD || mLats[b] == NO_COORD)
+                continue;
+            //deciseconds
+            w = max(1, (int) (getDistance(mLats[a] / MICRODEG,
+                                          mLons[a] / MICRODEG,
+                                          mLats[b] / MICRODEG,
+                                          mLons[b] / MICRODEG) /
+                              (wy.kmh / 3.6) * 10 + 0.5));
+            if (wy.dir >= 0)
+            {
+                e.from = a;
+                e.to = b;
+                e.w = w;
+                edges.push_back(e);
+            }
+            if (wy.dir <= 0)
+            {
+                e.from = b;
+                e.to = a;
+                e.w = w;
+                edges.push_back(e);
+            }
+        }
+    }
+    return true;
+}
+
+bool GisRoadNet::contract(const vector<RawEdgeT> &raw)
+{
+    int n = (int) mLats.size();
+    vector<vector<EdgeT>> out(n);
+    vector<vector<EdgeT>> in(n);
+    for (const auto &e : raw)
+    {
+        addEdge(out, in, e.from, e.to, e.w, -1);
+    }
+    vector<vector<EdgeT>> up(n);
+    vector<vector<EdgeT>> down(n);
+    vector<int> deleted(n, 0);  //contracted neighbors
+    //witness search scratch
+    vector<int> dist(n, INT_MAX);
+    vector<int> touched;
+    vector<int> targets(n, -1);  //stamp for the out neighbors of a node
+    int stamp = 0;
+    vector<RawEdgeT> shortcuts;
+    //finds the shortcuts needed to contract v from the remaining graph
+    auto findShortcuts = [&](int v)
+    {
+        shortcuts.clear();
+        if (in[v].empty() || out[v].empty())
+            return;
+        int maxOut = 0;
+        ++stamp;
+        for (const auto &e : out[v])
+        {
+            maxOut = max(maxOut, e.w);
+            targets[e.node] = stamp;
+        }
+        HeapT heap;
+        int d;
+        int u;
+        int settled;
+        int left;
+        for (const auto &ei : in[v])
+        {
+            //shortest paths from the source avoiding v, up to the longest
+            //possible path via v or until all targets are settled
+            int limit = ei.w + maxOut;
+            dist[ei.node] = 0;
+            touched.push_back(ei.node);
+            heap.push(HeapItemT(0, ei.node));
+            settled = 0;
+            left = (int) out[v].size() - ((targets[ei.node] == stamp)? 1: 0);
+            while (!heap.empty() && left > 0)
+            {
+                d = heap.top().first;
+                u = heap.top().second;
+                heap.pop();
+                if (d > dist[u])
+                    continue;
+                if (d > limit || ++settled > WITNESS_LIMIT)
+                    break;
+                if (targets[u] == stamp && u != ei.node)
+                    --left;
+                for (const auto &e : out[u])
+                {
+                    if (e.node != v && d + e.w < dist[e.node])
+                    {
+                        if (dist[e.node] == INT_MAX)
+                            touched.push_back(e.node);
+                        dist[e.node] = d + e.w;
+                        heap.push(HeapItemT(d + e.w, e.node));
+                    }
+                }
+            }
+            for (const auto &eo : out[v])
+            {
+                if (eo.node != ei.node && ei.w + eo.w < dist[eo.node])
+                {
+                    RawEdgeT s = { ei.node, eo.node, ei.w + eo.w };
+                    shortcuts.push_back(s);
+                }
+            }
+            for (auto t : touched)
+            {
+                dist[t] = INT_MAX;
+            }
+            touched.clear();
+            heap = HeapT();
+        }
+    };
+    //weighted edge difference plus contracted neighbors, to contract evenly
+    auto getPriority = [&](int v)
+    {
+        findShortcuts(v);
+        return 2 * (int) shortcuts.size() -
+               (int) (in[v].size() + out[v].size()) + deleted[v];
+    };
+    HeapT queue;
+    vector<int> prio(n);
+    int v;
+    for (v=0; v<n; ++v)
+    {
+        if ((v & 0xFFFF) == 0 && mAbort)
+            return false;
+        prio[v] = getPriority(v);
+        queue.push(HeapItemT(prio[v], v));
+    }
+    vector<bool> done(n, false);
+    vector<int> nbrs;
+    while (!queue.empty())
+    {
+        if (mAbort)
+            return false;
+        v = queue.top().second;
+        if (done[v] || queue.top().first != prio[v])
+        {
+            queue.pop();  //outdated entry
+            continue;
+        }
+        queue.pop();
+        //lazy update: requeue if no longer the minimum
+        prio[v] = getPriority(v);
+        if (!queue.empty() && prio[v] > queue.top().first)
+        {
+            queue.push(HeapItemT(prio[v], v));
+            continue;
+        }
+        //shortcuts are from the last getPriority()
+        up[v] = out[v];
+        down[v] = in[v];
+        nbrs.clear();
+        for (const auto &e : out[v])
+        {
+            removeEdges(in[e.node], v);
+            nbrs.push_back(e.node);
+        }
+        for (const auto &e : in[v])
+        {
+            removeEdges(out[e.node], v);
+            nbrs.push_back(e.node);
+        }
+        for (const auto &s : shortcuts)
+        {
+            addEdge(out, in, s.from, s.to, s.w, v);
+        }
+        vector<EdgeT>().swap(out[v]);
+        vector<EdgeT>().swap(in[v]);
+        done[v] = true;
+        sort(nbrs.begin(), nbrs.end());
+        nbrs.erase(unique(nbrs.begin(), nbrs.end()), nbrs.end());
+        for (auto u : nbrs)
+        {
+            ++deleted[u];
+            prio[u] = getPriority(u);
+            queue.push(HeapItemT(prio[u], u));
+        }
+    }
+    //flatten into the search graphs
+    mUp.first.assign(n + 1, 0);
+    mDown.first.assign(n + 1, 0);
+    mUp.edges.clear();
+    mDown.edges.clear();
+    for (v=0; v<n; ++v)
+    {
+        mUp.first[v] = mUp.edges.size();
+        mUp.edges.insert(mUp.edges.end(), up[v].begin(), up[v].end());
+        mDown.first[v] = mDown.edges.size();
+        mDown.edges.insert(mDown.edges.end(), down[v].begin(), down[v].end());
+    }
+    mUp.first[n] = mUp.edges.size();
+    mDown.first[n] = mDown.edges.size();
+    return true;
+}
+
+bool GisRoadNet::saveCache(const string &file,
+                           long long     srcSize,
+                           long long     srcTime) const
+{
+    ofstream os(file.c_str(), ios::binary | ios::trunc);
+    if (!os)
+        return false;
+    int version = CACHE_VERSION;
+    unsigned int n = mLats.size();
+    unsigned int nUp = mUp.edges.size();
+    unsigned int nDown = mDown.edges.size();
+    os.write(CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    os.write((const char *) &version, sizeof(version));
+    os.write((const char *) &srcSize, sizeof(srcSize));
+    os.write((const char *) &srcTime, sizeof(srcTime));
+    os.write((const char *) &n, sizeof(n));
+    os.write((const char *) &nUp, sizeof(nUp));
+    os.write((const char *) &nDown, sizeof(nDown));
+    os.write((const char *) mLats.data(), n * sizeof(int));
+    os.write((const char *) mLons.data(), n * sizeof(int));
+    os.write((const char *) mUp.first.data(), (n + 1) * sizeof(unsigned int));
+    os.write((const char *) mUp.edges.data(), nUp * sizeof(EdgeT));
+    os.write((const char *) mDown.first.data(),
+             (n + 1) * sizeof(unsigned int));
+    os.write((const char *) mDown.edges.data(), nDown * sizeof(EdgeT));
+    return os.good();
+}
+
+bool GisRoadNet::loadCache(const string &file,
+                           long long     srcSize,
+                           long long     srcTime)
+{
+    ifstream is(file.c_str(), ios::binary);
+    if (!is)
+        return false;
+    char magic[sizeof(CACHE_MAGIC)];
+    int version = 0;
+    long long size = 0;
+    long long time = 0;
+    unsigned int n = 0;
+    unsigned int nUp = 0;
+    unsigned int nDown = 0;
+    is.read(magic, sizeof(magic));
+    is.read((char *) &version, sizeof(version));
+    is.read((char *) &size, sizeof(size));
+    is.read((char *) &time, sizeof(time));
+    is.read((char *) &n, sizeof(n));
+    is.read((char *) &nUp, sizeof(nUp));
+    is.read((char *) &nDown, sizeof(nDown));
+    if (!is || memcmp(magic, CACHE_MAGIC, sizeof(magic)) != 0 ||
+        version != CACHE_VERSION || size != srcSize || time != srcTime)
+        return false;
+    mLats.resize(n);
+    mLons.resize(n);
+    mUp.first.resize(n + 1);
+    mUp.edges.resize(nUp);
+    mDown.first.resize(n + 1);
+    mDown.edges.resize(nDown);
+    is.read((char *) mLats.data(), n * sizeof(int));
+    is.read((char *) mLons.data(), n * sizeof(int));
+    is.read((char *) mUp.first.data(), (n + 1) * sizeof(unsigned int));
+    is.read((char *) mUp.edges.data(), nUp * sizeof(EdgeT));
+    is.read((char *) mDown.first.data(), (n + 1) * sizeof(unsigned int));
+    is.read((char *) mDown.edges.data(), nDown * sizeof(EdgeT));
+    if (is && mUp.first[n] == nUp && mDown.first[n] == nDown)
+        return true;
+    mLats.clear();
+    mLons.clear();
+    mUp = GraphT();
+    mDown = GraphT();
+    return false;
+}
+
+/**
+ * Gets the grid cell key of a position.
+ *
+ * @param[in] lat The latitude.
+ * @param[in] lon The longitude.
+ * @return The key.
+ */
+static inline long long getCell(double lat, double lon)
+{
+    return ((long long) floor((lat + 90) * GRID_CELLS_PER_DEG) << 32) +
+           (long long) floor((lon + 180) * GRID_CELLS_PER_DEG);
+}
+
+void GisRoadNet::buildGrid()
+{
+    mGrid.clear();
+    int n = (int) mLats.size();
+    for (int i=0; i<n; ++i)
+    {
+        //skip nodes not on any road, or without coordinates
+        if (mLats[i] != NO_COORD &&
+            (mUp.first[i] != mUp.first[i + 1] ||
+             mDown.first[i] != mDown.first[i + 1]))
+            mGrid.push_back(make_pair(getCell(mLats[i] / MICRODEG,
+                                              mLons[i] / MICRODEG), i));
+    }
+    sort(mGrid.begin(), mGrid.end());
+}
+
+bool GisRoadNet::snap(double lat, double lon, int &node, double &m) const
+{
+    long long key = getCell(lat, lon);
+    long long row = key >> 32;
+    long long col = key & 0xFFFFFFFF;
+    //smallest cell width, which is along the longitude
+    double cellM = getDistance(lat, lon, lat, lon + 1 / GRID_CELLS_PER_DEG);
+    double d;
+    m = -1;
+    //rings of cells around the position; a node in ring r may be beaten by
+    //one in ring r + 1, so continue one ring after the first match
+    for (int r=0; r<=SNAP_CELLS; ++r)
+    {
+        for (long long y=row-r; y<=row+r; ++y)
+        {
+            for (long long x=col-r; x<=col+r; ++x)
+            {
+                if (y != row - r && y != row + r && x != col - r &&
+                    x != col + r)
+                    continue;  //inner cell, done in a previous ring
+                key = (y << 32) + x;
+                for (auto it=lower_bound(mGrid.begin(), mGrid.end(),
+                                         make_pair(key, INT_MIN));
+                     it!=mGrid.end() && it->first==key; ++it)
+                {
+                    d = getDistance(lat, lon, mLats[it->second] / MICRODEG,
+                                    mLons[it->second] / MICRODEG);
+                    if (m < 0 || d < m)
+                    {
+                        m = d;
+                        node = it->second;
+                    }
+                }
+            }
+        }
+        if (m >= 0 && m < r * cellM)
+            break;  //farther rings are at least r cells away
+    }
+    return (m >= 0);
+}
+
+void GisRoadNet::search(const GraphT &g, int start, SearchT &res)
+{
+    res.clear();
+    LabelT l = { 0, -1, -1 };
+    res[start] = l;
+    HeapT heap;
+    heap.push(HeapItemT(0, start));
+    int d;
+    int u;
+    unsigned int i;
+    while (!heap.empty())
+    {
+        d = heap.top().first;
+        u = heap.top().second;
+        heap.pop();
+        if (d > res[u].dist)
+            continue;
+        for (i=g.first[u]; i<g.first[u + 1]; ++i)
+        {
+            const EdgeT &e(g.edges[i]);
+            auto it = res.find(e.node);
+            if (it == res.end() || d + e.w < it->second.dist)
+            {
+                l.dist = d + e.w;
+                l.parent = u;
+                l.mid = e.mid;
+                res[e.node] = l;
+                heap.push(HeapItemT(l.dist, e.node));
+            }
+        }
+    }
+}
+
+const GisRoadNet::EdgeT *GisRoadNet::findEdge(const GraphT &g,
+                                              int           from,
+                                              int           node)
+{
+    for (unsigned int i=g.first[from]; i<g.first[from + 1]; ++i)
+    {
+        if (g.edges[i].node == node)
+            return &g.edges[i];
+    }
+    return 0;
+}
+
+void GisRoadNet::unpack(int from, int to, int mid, vector<int> &path) const
+{
+    //iterative, since a shortcut may nest many levels deep
+    struct PartT
+    {
+        int from;
+        int to;
+        int mid;
+    };
+    vector<PartT> stack;
+    PartT p = { from, to, mid };
+    stack.push_back(p);
+    const EdgeT *e1;
+    const EdgeT *e2;
+    while (!stack.empty())
+    {
+        p = stack.back();
+        stack.pop_back();
+        if (p.mid < 0)
+        {
+            path.push_back(p.to);
+            continue;
+        }
+        //the mid node is lower than both ends, so its edges are in its own
+        //lists
+        e1 = findEdge(mDown, p.mid, p.from);
+        e2 = findEdge(mUp, p.mid, p.to);
+        if (e1 == 0 || e2 == 0)
+        {
+            path.push_back(p.to);  //should not happen
+            continue;
+        }
+        PartT p2 = { p.mid, p.to, e2->mid };
+        stack.push_back(p2);
+        PartT p1 = { p.from, p.mid, e1->mid };
+        stack.push_back(p1);
+    }
+}
+
+double GisRoadNet::getDistance(double lat1, double lon1, double lat2,
+                               double lon2)
+{
+    double dLat = (lat2 - lat1) * PI / 180;
+    double dLon = (lon2 - lon1) * PI / 180;
+    double a = sin(dLat / 2) * sin(dLat / 2) +
+               cos(lat1 * PI / 180) * cos(lat2 * PI / 180) *
+               sin(dLon / 2) * sin(dLon / 2);
+    return 2 * EARTH_RADIUS_M * atan2(sqrt(a), sqrt(1 - a));
+}
@@ -0,0 +1,242 @@
+/**
+ * Platform-independent in-process road routing.
+ * The road network is read from a local OpenStreetMap XML extract and
+ * preprocessed into contraction hierarchies, which are saved to a cache file
+ * next to the extract, so that later loads skip the slow preprocessing.
+ * Queries then only search upwards in the hierarchy from both ends, which
+ * takes milliseconds for point-to-point routes, and a target search can be
+ * reused for travel times from many sources to one point.
+ * Edge weights are travel times at typical speeds for the road classes.
+ * Positions off the road network are connected to the nearest road node
+ * at a fixed off-road speed.
+ * Queries are thread-safe once loaded.
+ *
+ * Copyright (C) Sapura Secured Technologies, 2026. All Rights Reserved.
+ *
+ * @file
+ * @version $Id$
+ * @author agent <agent@local>
+ */
+#ifndef GISROADNET_H
+#define GISROADNET_H
+
+#include <atomic>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class GisRoadNet
+{
+public:
+    struct RouteT
+    {
+        int                 secs;   //travel time
+        double              km;     //distance
+        std::vector<double> coords; //[lat1, lon1, lat2, lon2, ...]
+    };
+
+    static const int ETA_NONE = -1;
+
+    GisRoadNet();
+
+    /**
+     * Loads the network from the cache file if it is up to date, otherwise
+     * builds it from the extract and saves the cache file. Takes minutes
+     * for a large extract, so should be called in a worker thread.
+     *
+     * @param[in]  osmFile The OpenStreetMap XML extract path. The cache file
+     *                     has the same path with CACHE_EXT appended.
+     * @param[out] err     The error message on failure.
+     * @return true if successful.
+     */
+    bool load(const std::string &osmFile, std::string &err);
+
+    /**
+     * Makes a running load() fail early.
+     */
+    void abort() { mAbort = true; }
+
+    bool isReady() const { return mReady; }
+
+    /**
+     * Finds the fastest route between two points.
+     *
+     * @param[in]  srcLat The source latitude.
+     * @param[in]  srcLon The source longitude.
+     * @param[in]  dstLat The destination latitude.
+     * @param[in]  dstLon The destination longitude.
+     * @param[out] res    The route.
+     * @return true if found.
+     */
+    bool route(double  srcLat,
+               double  srcLon,
+               double  dstLat,
+               double  dstLon,
+               RouteT &res) const;
+
+    /**
+     * Gets the travel times from many sources to one destination.
+     *
+     * @param[in]  dstLat The destination latitude.
+     * @param[in]  dstLon The destination longitude.
+     * @param[in]  srcs   The source coordinates as [lat1, lon1, ...].
+     * @param[out] secs   The travel time in seconds for each source, or
+     *                    ETA_NONE if not reachable.
+     */
+    void getEtas(double                     dstLat,
+                 double                     dstLon,
+                 const std::vector<double> &srcs,
+                 std::vector<int>          &secs) const;
+
+private:
+    //edge to a higher ranked node, with travel time in deciseconds, and
+    //the contracted node for a shortcut, or -1
+    struct EdgeT
+    {
+        int node;
+        int w;
+        int mid;
+    };
+
+    struct RawEdgeT
+    {
+        int from;
+        int to;
+        int w;
+    };
+
+    //search graph with the edges of node i at [first[i], first[i + 1])
+    struct GraphT
+    {
+        std::vector<unsigned int> first;
+        std::vector<EdgeT>        edges;
+    };
+
+    //search result of a node
+    struct LabelT
+    {
+        int dist;
+        int parent; //-1 for the start node
+        int mid;    //of the edge from parent
+    };
+
+    typedef std::unordered_map<int, LabelT> SearchT;
+
+    static const char  *CACHE_EXT;
+    static const int    CACHE_VERSION = 2;
+    static const int    WITNESS_LIMIT = 500;  //settled nodes
+    static const int    SNAP_CELLS    = 3;    //search rings for nearest node
+    static const double OFFROAD_KMH;
+
+    std::atomic<bool>    mAbort;
+    std::atomic<bool>    mReady;
+    std::vector<int>     mLats;  //in micro-degrees
+    std::vector<int>     mLons;
+    GraphT               mUp;    //edges from a node to higher ranked nodes
+    GraphT               mDown;  //edges to a node from higher ranked nodes
+    //node indexes sorted by grid cell key
+    std::vector<std::pair<long long, int>> mGrid;
+
+    /**
+     * Reads the road network from an OpenStreetMap XML extract.
+     *
+     * @param[in]  osmFile The file path.
+     * @param[out] edges   The directed road segments.
+     * @param[out] err     The error message on failure.
+     * @return true if successful.
+     */
+    bool readOsm(const std::string     &osmFile,
+                 std::vector<RawEdgeT> &edges,
+                 std::string           &err);
+
+    /**
+     * Builds the contraction hierarchies.
+     *
+     * @param[in] raw The directed road segments.
+     * @return false if aborted.
+     */
+    bool contract(const std::vector<RawEdgeT> &raw);
+
+    /**
+     * Saves the network to the cache file.
+     *
+     * @param[in] file     The cache file path.
+     * @param[in] srcSize  The extract file size.
+     * @param[in] srcTime  The extract file modification time.
+     * @return true if successful.
+     */
+    bool saveCache(const std::string &file,
+                   long long          srcSize,
+                   long long          srcTime) const;
+
+    /**
+     * Loads the network from the cache file.
+     *
+     * @param[in] file    The cache file path.
+     * @param[in] srcSize The expected extract file size.
+     * @param[in] srcTime The expected extract file modification time.
+     * @return true if successful.
+     */
+    bool loadCache(const std::string &file,
+                   long long          srcSize,
+                   long long          srcTime);
+
+    /**
+     * Builds the grid index for nearest node lookup.
+     */
+    void buildGrid();
+
+    /**
+     * Finds the nearest road node.
+     *
+     * @param[in]  lat  The latitude.
+     * @param[in]  lon  The longitude.
+     * @param[out] node The node index.
+     * @param[out] m    The distance in meters.
+     * @return true if found within SNAP_CELLS.
+     */
+    bool snap(double lat, double lon, int &node, double &m) const;
+
+    /**
+     * Searches a graph upwards from a node until exhausted.
+     *
+     * @param[in]  g     mUp for a forward search, mDown for a backward
+     *                   search.
+     * @param[in]  start The start node.
+     * @param[out] res   The reached nodes.
+     */
+    static void search(const GraphT &g, int start, SearchT &res);
+
+    /**
+     * Finds an edge in a search graph.
+     *
+     * @param[in] g    The graph.
+     * @param[in] from The lower ranked node.
+     * @param[in] node The other node.
+     * @return The edge, or 0 if not found.
+     */
+    static const EdgeT *findEdge(const GraphT &g, int from, int node);
+
+    /**
+     * Expands an edge into the original road nodes.
+     *
+     * @param[in]     from The start node.
+     * @param[in]     to   The end node.
+     * @param[in]     mid  The contracted node, or -1 for a road segment.
+     * @param[in,out] path The nodes after from, up to to, are appended.
+     */
+    void unpack(int from, int to, int mid, std::vector<int> &path) const;
+
+    /**
+     * Gets the great-circle distance between two nodes or points.
+     *
+     * @param[in] lat1 The first latitude.
+     * @param[in] lon1 The first longitude.
+     * @param[in] lat2 The second latitude.
+     * @param[in] lon2 The second longitude.
+     * @return The distance in meters.
+     */
+    static double getDistance(double lat1, double lon1, double lat2,
+                              double lon2);
+};
+#endif //GISROADNET_H
@@ -0,0 +1,265 @@
+/**
+ * Map tile cache manager implementation.
+ *
+ * Copyright (C) Sapura Secured Technologies, 2026. All Rights Reserved.
+ *
+ * @file
+ * @version $Id$
+ * @author agent <agent@local>
+ */
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QNetworkRequest>
+#include <QStandardPaths>
+#include <QUrl>
+
+#include "GisTileCache.h"
+
+using namespace std;
+
+static const QString CACHE_DIR(QStandardPaths::writableLocation(
+                                         QStandardPaths::GenericCacheLocation) +
+                               "/QtLocation/seaTiles/");
+
+GisTileCache *GisTileCache::sInstance = 0;
+
+GisTileCache::GisTileCache() :
+QObject(), mNwkManager(new QNetworkAccessManager(this)), mScanned(false),
+mMaxBytes(qint64(DEF_MAX_MB) << 20), mMaxAge(DEF_MAX_AGE_DAYS * 86400LL),
+mTotalSize(0), mSeq(0), mView(0), mPath(CACHE_DIR)
+{
+}
+
+GisTileCache &GisTileCache::instance()
+{
+    if (sInstance == 0)
+        sInstance = new GisTileCache();
+    return *sInstance;
+}
+
+void GisTileCache::destroy()
+{
+    delete sInstance;
+    sInstance = 0;
+}
+
+void GisTileCache::setQuota(int maxMb, int maxAgeDays)
+{
+    mMaxBytes = qint64((maxMb > 0)? maxMb: DEF_MAX_MB) << 20;
+    mMaxAge = ((maxAgeDays > 0)? maxAgeDays: DEF_MAX_AGE_DAYS) * 86400LL;
+    if (mScanned)
+        evict();
+}
+
+const QString &GisTileCache::getPath()
+{
+    QDir dir(mPath);
+    if (!dir.exists())
+        dir.mkpath(".");
+    return mPath;
+}
+
+bool GisTileCache::isCached(const QString &filepath)
+{
+    scan();
+    auto it = mEntries.find(filepath);
+    if (it == mEntries.end())
+        return false;
+    if (QDateTime::currentSecsSinceEpoch() - it->time > mMaxAge)
+    {
+        remove(filepath);
+        return false;
+    }
+    mLru.erase(it->seq);
+    it->seq = ++mSeq;
+    mLru[it->seq] = filepath;
+    return true;
+}
+
+void GisTileCache::request(const QString &url,
+                           const QString &filepath,
+                           int            priority)
+{
+    if (mActive.contains(filepath))
+        return;
+    QueueKeyT key(priority, mView, ++mSeq);
+    auto it = mPending.find(filepath);
+    if (it != mPending.end())
+    {
+        if (!(key < it->key))
+            return;
+        //raise priority
+        mQueue.erase(it->key);
+        it->key = key;
+    }
+    else
+    {
+        mPending.insert(filepath, PendingT(url, key));
+    }
+    mQueue[key] = filepath;
+    if (mQueue.size() > size_t(MAX_PENDING))
+    {
+        //drop lowest priority
+        auto qIt = --mQueue.end();
+        mPending.remove(qIt->second);
+        mQueue.erase(qIt);
+    }
+    startNext();
+}
+
+void GisTileCache::clear()
+{
+    mQueue.clear();
+    mPending.clear();
+    //abort after clearing so that handleReply() discards the replies
+    ActiveMapT active;
+    active.swap(mActive);
+    for (auto reply : active)
+    {
+        reply->abort();
+    }
+    mEntries.clear();
+    mLru.clear();
+    mTotalSize = 0;
+    QDir dir(mPath);
+    dir.setNameFilters(QStringList() << "*.png");
+    dir.setFilter(QDir::Files);
+    foreach(QString f, dir.entryList())
+    {
+        dir.remove(f);
+    }
+    mScanned = true;
+}
+
+void GisTileCache::scan()
+{
+    if (mScanned)
+        return;
+    mScanned = true;
+    QDir dir(getPath());
+    dir.setNameFilters(QStringList() << "*.png");
+    dir.setFilter(QDir::Files);
+    dir.setSorting(QDir::Time | QDir::Reversed); //oldest first
+    qint64 now = QDateTime::currentSecsSinceEpoch();
+    qint64 t;
+    for (const auto &fi : dir.entryInfoList())
+    {
+        t = fi.lastModified().toSecsSinceEpoch();
+        if (now - t > mMaxAge)
+            dir.remove(fi.fileName());
+        else
+            add(mPath + fi.fileName(), fi.size(), t);
+    }
+}
+
+void GisTileCache::add(const QString &filepath, qint64 size, qint64 time)
+{
+    auto it = mEntries.find(filepath);
+    if (it != mEntries.end())
+    {
+        mTotalSize -= it->size;
+        mLru.erase(it->seq);
+    }
+    EntryT &e(mEntries[filepath]);
+    e.size = size;
+    e.time = time;
+    e.seq = ++mSeq;
+    mLru[e.seq] = filepath;
+    mTotalSize += size;
+    evict();
+}
+
+void GisTileCache::remove(const QString &filepath)
+{
+    auto it = mEntries.find(filepath);
+    if (it != mEntries.end())
+    {
+        mTotalSize -= it->size;
+        mLru.erase(it->seq);
+        mEntries.erase(it);
+    }
+    QFile::remove(filepath);
+}
+
+void GisTileCache::evict()
+{
+    //keep the most recent tile even if it alone exceeds the quota
+    while (mTotalSize > mMaxBytes && mLru.size() > 1)
+    {
+        remove(mLru.begin()->second);
+    }
+}
+
+void GisTileCache::startNext()
+{
+    while (mActive.size() < MAX_ACTIVE && !mQueue.empty())
+    {
+        auto it = mQueue.begin();
+        QString filepath(it->second);
+        mQueue.erase(it);
+        auto pIt = mPending.find(filepath);
+        if (pIt == mPending.end())
+            continue; //should not happen
+        QUrl url(pIt->url);
+        mPending.erase(pIt);
+        get(url, filepath);
+    }
+}
+
+void GisTileCache::get(const QUrl &url, const QString &filepath)
+{
+    QNetworkReply *reply = mNwkManager->get(QNetworkRequest(url));
+    mActive[filepath] = reply;
+    connect(reply, &QNetworkReply::finished, this,
+            [this, filepath, reply] { handleReply(reply, filepath); });
+}
+
+void GisTileCache::handleReply(QNetworkReply *reply, const QString &filepath)
+{
+    reply->deleteLater();
+    auto it = mActive.find(filepath);
+    if (it == mActive.end() || it.value() != reply)
+        return; //aborted by clear()
+    QVariant redir(reply->attribute(
+                                QNetworkRequest::RedirectionTargetAttribute));
+    if (!redir.isNull())
+    {
+        //still active
+        QUrl url(redir.toUrl());
+        if (url.isRelative())
+            url = reply->url().resolved(url);
+        get(url, filepath);
+        return;
+    }
+    if (reply->error() != QNetworkReply::NoError)
+    {
+        emit tileDownloadFailed(filepath, reply->errorString());
+    }
+    else
+    {
+        QByteArray data(reply->readAll());
+        if (!(data.startsWith("\x89PNG") || data.startsWith("\xFF\xD8")))
+            emit tileDownloadFailed(filepath, "Invalid image file");
+        else if (writeTile(filepath, data))
+            emit tileDownloaded(filepath);
+    }
+    mActive.remove(filepath);
+    startNext();
+}
+
+bool GisTileCache::writeTile(const QString &filepath, const QByteArray &data)
+{
+    QFile file(filepath);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        emit tileDownloadFailed(filepath, file.errorString());
+        return false;
+    }
+    file.write(data);
+    file.close();
+    scan();
+    add(filepath, data.size(), QDateTime::currentSecsSinceEpoch());
+    return true;
+}
@@ -0,0 +1,224 @@
+/**
+ * Map tile cache manager.
+ * Downloads tiles with a limit on concurrent requests, prioritizing tiles in
+ * the current viewport over prefetched ones, and coalescing requests for the
+ * same tile. Keeps the tiles in a directory with a size and age quota,
+ * evicting the least recently used tiles.
+ * Must be used in the GUI thread only.
+ *
+ * Copyright (C) Sapura Secured Technologies, 2026. All Rights Reserved.
+ *
+ * @file
+ * @version $Id$
+ * @author agent <agent@local>
+ */
+#ifndef GISTILECACHE_H
+#define GISTILECACHE_H
+
+#include <map>
+#include <QHash>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QObject>
+#include <QString>
+
+class GisTileCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum ePriority
+    {
+        PRIO_VIEW,      //in current viewport
+        PRIO_PREFETCH   //adjacent area or zoom level, or near incidents
+    };
+
+    //defaults for setQuota()
+    static const int DEF_MAX_MB       = 256;
+    static const int DEF_MAX_AGE_DAYS = 30;
+
+    /**
+     * Instantiates the singleton if it has not been created.
+     *
+     * @return The instance.
+     */
+    static GisTileCache &instance();
+
+    /**
+     * Deletes the single instance.
+     */
+    static void destroy();
+
+    /**
+     * Sets the cache quota, and evicts tiles beyond it.
+     *
+     * @param[in] maxMb      Maximum total size in MB. 0 for default.
+     * @param[in] maxAgeDays Maximum tile age in days. 0 for default.
+     */
+    void setQuota(int maxMb, int maxAgeDays = 0);
+
+    /**
+     * Gets the cache directory path, creating it if necessary.
+     *
+     * @return The path, with trailing separator.
+     */
+    const QString &getPath();
+
+    /**
+     * Checks whether a tile is in the cache, and marks it as recently used.
+     * A tile beyond the age quota is deleted.
+     *
+     * @param[in] filepath The tile filepath.
+     * @return true if cached.
+     */
+    bool isCached(const QString &filepath);
+
+    /**
+     * Requests a tile download. Does nothing if the tile is already being
+     * downloaded, but raises the priority if it is still queued.
+     * Emits tileDownloaded() or tileDownloadFailed() on completion.
+     *
+     * @param[in] url      The tile URL.
+     * @param[in] filepath The filepath.
+     * @param[in] priority The priority - ePriority.
+     */
+    void request(const QString &url, const QString &filepath, int priority);
+
+    /**
+     * Starts a new viewport. Queued requests for the new viewport are
+     * served before those for older ones at the same priority.
+     */
+    void newView() { ++mView; }
+
+    /**
+     * Deletes all cached tiles and queued requests, and aborts the active
+     * downloads.
+     */
+    void clear();
+
+signals:
+    void tileDownloaded(const QString &filePath);
+    void tileDownloadFailed(const QString &url, const QString &err);
+
+private:
+    //queue order - priority, then newer viewport, then request order
+    struct QueueKeyT
+    {
+        QueueKeyT(int p, quint64 v, quint64 s) : prio(p), view(v), seq(s) {}
+
+        bool operator<(const QueueKeyT &rhs) const
+        {
+            if (prio != rhs.prio)
+                return (prio < rhs.prio);
+            if (view != rhs.view)
+                return (view > rhs.view);
+            return (seq < rhs.seq);
+        }
+
+        int     prio;
+        quint64 view;
+        quint64 seq;
+    };
+
+    struct EntryT
+    {
+        qint64  size;
+        qint64  time;   //write time, in seconds since epoch
+        quint64 seq;    //last use sequence number
+    };
+
+    struct PendingT
+    {
+        PendingT(const QString &u, const QueueKeyT &k) : url(u), key(k) {}
+
+        QString   url;
+        QueueKeyT key;
+    };
+
+    typedef std::map<QueueKeyT, QString>    QueueT;      //value is filepath
+    typedef QHash<QString, PendingT>        PendingMapT; //key is filepath
+    typedef QHash<QString, QNetworkReply *> ActiveMapT;  //key is filepath
+
+    //maximum number of concurrent downloads
+    static const int MAX_ACTIVE  = 4;
+    //maximum number of queued requests - lowest priority ones are dropped
+    static const int MAX_PENDING = 512;
+
+    QNetworkAccessManager     *mNwkManager;
+    bool                       mScanned;
+    qint64                     mMaxBytes;
+    qint64                     mMaxAge;     //seconds
+    qint64                     mTotalSize;
+    quint64                    mSeq;        //for LRU and queue order
+    quint64                    mView;
+    QString                    mPath;
+    QHash<QString, EntryT>     mEntries;    //key is filepath
+    std::map<quint64, QString> mLru;        //oldest first, value is filepath
+    QueueT                     mQueue;
+    PendingMapT                mPending;    //queued, key is filepath
+    ActiveMapT                 mActive;     //being downloaded
+
+    static GisTileCache *sInstance;
+
+    GisTileCache();
+
+    /**
+     * Builds the cache index from the cache directory, if not yet done.
+     * Deletes tiles beyond the age quota.
+     */
+    void scan();
+
+    /**
+     * Adds a tile to the cache index, and evicts tiles beyond the size
+     * quota.
+     *
+     * @param[in] filepath The filepath.
+     * @param[in] size     The file size.
+     * @param[in] time     The file write time.
+     */
+    void add(const QString &filepath, qint64 size, qint64 time);
+
+    /**
+     * Removes a tile from the cache index and deletes the file.
+     *
+     * @param[in] filepath The filepath.
+     */
+    void remove(const QString &filepath);
+
+    /**
+     * Deletes least recently used tiles until within the size quota.
+     */
+    void evict();
+
+    /**
+     * Starts queued downloads up to the concurrent limit.
+     */
+    void startNext();
+
+    /**
+     * Starts a download.
+     *
+     * @param[in] url      The URL.
+     * @param[in] filepath The filepath.
+     */
+    void get(const QUrl &url, const QString &filepath);
+
+    /**
+     * Handles network reply for tile download request. Follows redirection,
+     * or saves a valid image tile to file.
+     *
+     * @param[in] reply    The reply from network.
+     * @param[in] filepath The filepath.
+     */
+    void handleReply(QNetworkReply *reply, const QString &filepath);
+
+    /**
+     * Writes tile data to file and adds it to the cache.
+     *
+     * @param[in] filepath The filepath.
+     * @param[in] data     The binary data.
+     * @return true if file is successfully created.
+     */
+    bool writeTile(const QString &filepath, const QByteArray &data);
+};
+#endif //GISTILECACHE_H
@@ -8,7 +8,10 @@
  * @author Zunnur Zafirah
  */
 #include <QDateTime>
+#include <algorithm>    //sort, unique, upper_bound
 #include <assert.h>
+#include <math.h>       //lround
+#include <stdlib.h>     //strtod
 
 #include "Style.h"
 #include "GisTrackingReplay.h"
@@ -17,9 +20,76 @@
 using namespace std;
 
 static const QString FMT("dd/MM/yyyy HH:mm:ss");
+static const QString FMT_DATE("dd/MM/yyyy");
+
+/**
+ * Converts a 2-digit string to an integer.
+ *
+ * @param[in] s The string.
+ * @return The value, or -1 if not 2 digits.
+ */
+static inline int toInt2(const char *s)
+{
+    if (s[0] < '0' || s[0] > '9' || s[1] < '0' || s[1] > '9')
+        return -1;
+    return (s[0] - '0') * 10 + s[1] - '0';
+}
+
+/**
+ * Converts a FMT time string to time_t.
+ * The date part conversion is cached because consecutive points are mostly
+ * on the same day.
+ *
+ * @param[in]     str      The time string.
+ * @param[in,out] day      The cached date string.
+ * @param[in,out] dayStart The cached time_t at the start of the cached date.
+ * @return The time_t.
+ */
+static uint toTime(const string &str, string &day, uint &dayStart)
+{
+    int h;
+    int m;
+    int sec;
+    if (str.size() != 19 || str[10] != ' ' ||
+        (h = toInt2(&str[11])) < 0 || (m = toInt2(&str[14])) < 0 ||
+        (sec = toInt2(&str[17])) < 0)
+        return QDateTime::fromString(QString::fromStdString(str), FMT)
+                   .toTime_t();
+    if (str.compare(0, 10, day) != 0)
+    {
+        day.assign(str, 0, 10);
+        dayStart = QDateTime(QDate::fromString(QString::fromStdString(day),
+                                               FMT_DATE))
+                       .toTime_t();
+    }
+    return dayStart + h * 3600 + m * 60 + sec;
+}
+
+/**
+ * Converts a coordinate value to microdegrees.
+ *
+ * @param[in] str The coordinate string.
+ * @return The value.
+ */
+static inline qint32 toMicroDeg(const char *str)
+{
+    return static_cast<qint32>(lround(strtod(str, 0) * 1000000));
+}
+
+/**
+ * Converts microdegrees to a coordinate string.
+ *
+ * @param[in] val The value.
+ * @return The string.
+ */
+static inline QString toDegStr(qint32 val)
+{
+    return QString::number(val / 1000000.0, 'f', 6);
+}
 
 GisTrackingReplay::GisTrackingReplay(GisCanvas *canvas, QWidget *parent) :
-QDialog(parent), ui(new Ui::GisTrackingReplay), mCanvas(canvas)
+QDialog(parent), ui(new Ui::GisTrackingReplay), mCanvas(canvas),
+mDoZoom(false), mPointNum(0), mTimeStart(0), mTimeEnd(0)
 {
     ui->setupUi(this);
     setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint);
@@ -60,68 +130,15 @@ QDialog(parent), ui(new Ui::GisTrackingReplay), mCanvas(canvas)
             });
     connect(ui->stopButton, &QPushButton::clicked, this,
             [this] { stop(true); });
-    connect(ui->replaySlider, &QSlider::sliderMoved, this,
-            [this](int pos)
-            {
-                //if moved backward, delete tracking lines beyond current
-                //position, and set replay point to the position
-                time_t curr = mTimeStart + pos;
-                if (curr < mIt.key())
-                {
-                    //moved backward - delete points beyond current time
-                    QMap<int, int> issiNum;
-                    int issi;
-                    int num = 1;
-                    auto it = mIt;
-                    foreach (issi, it.value().keys())
-                    {
-                        issiNum[issi] = 1;
-                    }
-                    //loop to count difference for each issi
-                    for (--it; it.key()>curr; --it,++num)
-                    {
-                        foreach (issi, it.value().keys())
-                        {
-                            if (issiNum.contains(issi))
-                                ++(issiNum[issi]);
-                            else
-                                issiNum[issi] = 1;
-                        }
-                    }
-                    auto nIt = issiNum.begin();
-                    for (; nIt!=issiNum.end(); ++nIt)
-                    {
-                        mCanvas->deleteTrackingLineSegments(nIt.key(),
-                                                            nIt.value());
-                    }
-                    mIt = it;
-                    mPointNum -= num;
-                    updatePositionLabel();
-                }
-                //this is followed by invocation of replaySlider valueChanged()
-            });
     connect(ui->replaySlider, &QSlider::valueChanged, this,
             [this](int val)
             {
-                //add tracking lines up to current position, pause replay at
-                //slider end
+                //plot tracking lines up to current position, forward or
+                //backward, pause replay at slider end
                 time_t curr = mTimeStart + val;
                 ui->currTimeLbl
                   ->setText(QDateTime::fromTime_t(curr).toString(FMT));
-                auto it = mIt + 1;
-                if (it == mTrackpoints.end() || it.key() > curr)
-                    return;
-                IssiPointsT::iterator pIt;
-                for (; it!=mTrackpoints.end() && it.key()<=curr;
-                     ++it,++mPointNum)
-                {
-                    ++mIt;
-                    for (pIt=it.value().begin(); pIt!=it.value().end(); ++pIt)
-                    {
-                        mCanvas->addTrackingLine(pIt.key(), pIt.value(), false);
-                    }
-                }
-                updatePositionLabel();
+                seek(curr);
                 if (curr == mTimeEnd && ui->playButton->isChecked())
                     ui->playButton->click(); //pause
             });
@@ -129,8 +146,8 @@ QDialog(parent), ui(new Ui::GisTrackingReplay), mCanvas(canvas)
             [this]
             {
                 stop(false);
-                mTrackpoints.clear();
-                mIssis.clear();
+                mTracks.clear();
+                mTimes.clear();
             });
     mTimer = new QTimer(this);
     connect(mTimer, &QTimer::timeout, this,
@@ -156,12 +173,12 @@ void GisTrackingReplay::setTheme()
 
 void GisTrackingReplay::resetData()
 {
-    if (!mIssis.empty())
+    if (!mTracks.empty())
     {
         stop(false);
-        mIssis.clear();
+        mTracks.clear();
     }
-    mTrackpoints.clear();
+    mTimes.clear();
     //set start time beyond now
     mTimeStart = QDateTime::currentDateTime().toTime_t() + 600;
     mTimeEnd = 0;
@@ -169,21 +186,30 @@ void GisTrackingReplay::resetData()
 
 void GisTrackingReplay::start()
 {
-    if (mIssis.empty())
+    if (mTracks.empty())
     {
         close();
         return;
     }
+    //build time index
+    mTimes.clear();
     QStringList l;
-    for (auto i : qAsConst(mIssis))
+    for (auto it=mTracks.constBegin(); it!=mTracks.constEnd(); ++it)
     {
-        l << QString::number(i);
+        l << QString::number(it.key());
+        for (auto t : it.value().timeOffsets)
+        {
+            mTimes.push_back(it.value().timeBase + t);
+        }
     }
+    sort(mTimes.begin(), mTimes.end());
+    mTimes.erase(unique(mTimes.begin(), mTimes.end()), mTimes.end());
+    mTimes.squeeze();
     setWindowTitle(tr("Tracking Replay: %1").arg(l.join(',')));
-    ui->pointsLbl->setText("(" + QString::number(mTrackpoints.size()) + " " +
+    ui->pointsLbl->setText("(" + QString::number(mTimes.size()) + " " +
                            tr("points") + ")");
-    reset(true);
     ui->replaySlider->setMaximum(mTimeEnd - mTimeStart);
+    reset(true);
     show();
     ui->playButton->setChecked(true);
     ui->playButton->click();
@@ -196,63 +222,139 @@ void GisTrackingReplay::addData(int issi, DbInt::QResult *res)
         assert("Bad param in GisTrackingReplay::addData" == 0);
         return;
     }
-    mIssis.insert(issi);
+    int n = res->getNumRows();
+    if (n <= 0)
+        return;
+    //collect points as (time_t, row) for sorting, with existing points of
+    //this ISSI as negative rows
+    TrackT &track(mTracks[issi]);
+    QVector<QPair<uint, int> > pts;
+    pts.reserve(track.timeOffsets.size() + n);
+    int i = 0;
+    for (; i<track.timeOffsets.size(); ++i)
+    {
+        pts.push_back(qMakePair(track.timeBase + track.timeOffsets[i], -i - 1));
+    }
+    QVector<qint32> lats;
+    QVector<qint32> lons;
+    lats.reserve(n);
+    lons.reserve(n);
+    bool   isSorted = pts.empty();
+    uint   dayStart = 0;
+    string day;
     string val;
-    //get first gps time
-    res->getFieldValue(DbInt::FIELD_LOC_TIME, val);
-    uint t = QDateTime::fromString(QString::fromStdString(val), FMT).toTime_t();
-    if (t < mTimeStart)
+    size_t pos;
+    for (i=0; i<n; ++i)
     {
-        mTimeStart = t;
-        ui->startLbl->setText(tr("Start: ") + QString::fromStdString(val));
+        res->getFieldValue(DbInt::FIELD_LOC_TIME, val, i);
+        pts.push_back(qMakePair(toTime(val, day, dayStart), i));
+        if (isSorted && i > 0 && pts[i].first < pts[i - 1].first)
+            isSorted = false;
+        res->getFieldValue(DbInt::FIELD_LOC_LATLONG, val, i);
+        pos = val.find(',');
+        lats.push_back(toMicroDeg(val.c_str()));
+        lons.push_back((pos == string::npos)?
+                       0: toMicroDeg(val.c_str() + pos + 1));
     }
-    //start adding new points
-    string coord;
-    res->getFieldValue(DbInt::FIELD_LOC_LATLONG, coord);
-    mTrackpoints[t][issi] = coord;
-    //get last gps time
-    int i = res->getNumRows() - 1;
-    res->getFieldValue(DbInt::FIELD_LOC_TIME, val, i);
-    t = QDateTime::fromString(QString::fromStdString(val), FMT).toTime_t();
-    if (t > mTimeEnd)
+    if (!isSorted)
+        stable_sort(pts.begin(), pts.end(),
+                    [](const QPair<uint, int> &a, const QPair<uint, int> &b)
+                    {
+                        return (a.first < b.first);
+                    });
+    //rebuild columns, keeping the later of points with the same time
+    TrackT t;
+    t.timeBase = pts.front().first;
+    t.timeOffsets.reserve(pts.size());
+    t.lats.reserve(pts.size());
+    t.lons.reserve(pts.size());
+    int row;
+    for (i=0; i<pts.size(); ++i)
     {
-        mTimeEnd = t;
-        ui->endLbl->setText(tr("End: ") + QString::fromStdString(val));
+        if (i + 1 < pts.size() && pts[i + 1].first == pts[i].first)
+            continue;
+        row = pts[i].second;
+        t.timeOffsets.push_back(pts[i].first - t.timeBase);
+        if (row >= 0)
+        {
+            t.lats.push_back(lats[row]);
+            t.lons.push_back(lons[row]);
+        }
+        else
+        {
+            t.lats.push_back(track.lats[-row - 1]);
+            t.lons.push_back(track.lons[-row - 1]);
+        }
     }
-    res->getFieldValue(DbInt::FIELD_LOC_LATLONG, coord, i);
-    mTrackpoints[t][issi] = coord;
-    //fill up track with the intermediate data points
-    for (--i; i>0; --i)
+    track = t;
+    if (t.timeBase < mTimeStart)
     {
-        res->getFieldValue(DbInt::FIELD_LOC_TIME, val, i);
-        res->getFieldValue(DbInt::FIELD_LOC_LATLONG, coord, i);
-        mTrackpoints[QDateTime::fromString(QString::fromStdString(val), FMT)
-                .toTime_t()][issi] = coord;
+        mTimeStart = t.timeBase;
+        ui->startLbl->setText(tr("Start: ") +
+                     QDateTime::fromTime_t(mTimeStart).toString(FMT));
+    }
+    if (pts.back().first > mTimeEnd)
+    {
+        mTimeEnd = pts.back().first;
+        ui->endLbl->setText(tr("End: ") +
+                     QDateTime::fromTime_t(mTimeEnd).toString(FMT));
     }
 }
 
+void GisTrackingReplay::seek(uint t)
+{
+    QVariantList coords;
+    int n;
+    int i;
+    for (auto it=mTracks.begin(); it!=mTracks.end(); ++it)
+    {
+        TrackT &track(it.value());
+        //number of points up to t
+        n = (t < track.timeBase)?
+            0: upper_bound(track.timeOffsets.constBegin(),
+                           track.timeOffsets.constEnd(),
+                           t - track.timeBase) -
+               track.timeOffsets.constBegin();
+        if (n > track.plotted)
+        {
+            coords.clear();
+            coords.reserve(2 * (n - track.plotted));
+            for (i=track.plotted; i<n; ++i)
+            {
+                coords << track.lats[i] / 1000000.0
+                       << track.lons[i] / 1000000.0;
+            }
+            mCanvas->addTrackingLines(it.key(), coords,
+                                      (mDoZoom && track.plotted == 0));
+            mDoZoom = false;
+        }
+        else if (n < track.plotted)
+        {
+            mCanvas->deleteTrackingLineSegments(it.key(), track.plotted - n);
+        }
+        track.plotted = n;
+    }
+    mPointNum = upper_bound(mTimes.constBegin(), mTimes.constEnd(), t) -
+                mTimes.constBegin();
+    updatePositionLabel();
+}
+
 void GisTrackingReplay::reset(bool isFirstTime)
 {
-    mIt = mTrackpoints.begin();
-    mPointNum = 1;
+    mDoZoom = isFirstTime;
     ui->currTimeLbl->setText(QDateTime::fromTime_t(mTimeStart).toString(FMT));
-    updatePositionLabel();
     ui->playButton->setChecked(false);
     ui->replaySlider->setValue(0);
-    auto it = mIt.value().begin();
-    mCanvas->addTrackingLine(it.key(), it.value(), isFirstTime);
-    for (++it; it!=mIt.value().end(); ++it)
-    {
-        mCanvas->addTrackingLine(it.key(), it.value(), false);
-    }
+    seek(mTimeStart); //in case value was already 0
 }
 
 void GisTrackingReplay::stop(bool doReset)
 {
     mTimer->stop();
-    for (auto i : qAsConst(mIssis))
+    for (auto it=mTracks.begin(); it!=mTracks.end(); ++it)
     {
-        mCanvas->deleteTrackingLineSegments(i);
+        mCanvas->deleteTrackingLineSegments(it.key());
+        it.value().plotted = 0;
     }
     if (doReset)
         reset(false);
@@ -260,17 +362,21 @@ void GisTrackingReplay::stop(bool doReset)
 
 void GisTrackingReplay::updatePositionLabel()
 {
-    auto it = mIt.value().begin();
-    QString txt(QString::fromStdString(it.value()));
-    txt.append(" [").append(QString::number(mPointNum)).append("]");
-    if (mIssis.size() > 1)
+    QString txt;
+    int i;
+    for (auto it=mTracks.constBegin(); it!=mTracks.constEnd(); ++it)
     {
-        txt.prepend(": ").prepend(QString::number(it.key()));
-        for (++it; it!=mIt.value().end(); ++it)
-        {
-            txt.append("\n").append(QString::number(it.key()))
-               .append(": ").append(QString::fromStdString(it.value()));
-        }
+        i = it.value().plotted - 1;
+        if (i < 0)
+            continue;
+        if (!txt.isEmpty())
+            txt.append("\n");
+        if (mTracks.size() > 1)
+            txt.append(QString::number(it.key())).append(": ");
+        txt.append(toDegStr(it.value().lats[i])).append(",")
+           .append(toDegStr(it.value().lons[i]));
+        if (!txt.contains('\n'))
+            txt.append(" [").append(QString::number(mPointNum)).append("]");
     }
     ui->currPosLbl->setText(txt);
 }
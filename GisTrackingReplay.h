@@ -11,8 +11,9 @@
 #define GISTRACKINGREPLAY_H
 
 #include <QDialog>
-#include <QSet>
+#include <QMap>
 #include <QTimer>
+#include <QVector>
 
 #include "DbInt.h"
 #include "GisCanvas.h"
@@ -54,6 +55,7 @@ public:
     /**
      * Adds replay data.
      * resetData() must have been called before the first call to this.
+     * Data for an ISSI already added is merged.
      *
      * @param[in] issi The ISSI.
      * @param[in] res  The tracking data.
@@ -61,20 +63,37 @@ public:
     void addData(int issi, DbInt::QResult *res);
 
 private:
-    //key is ISSI, value is coordinates
-    typedef QMap<int, std::string>  IssiPointsT;
-    typedef QMap<uint, IssiPointsT> TrackPointsT; //key is time_t
+    //track of one ISSI in columns, in ascending time order
+    struct TrackT
+    {
+        TrackT() : timeBase(0), plotted(0) {}
+
+        uint             timeBase;    //time_t of first point
+        QVector<quint32> timeOffsets; //seconds from timeBase
+        QVector<qint32>  lats;        //microdegrees
+        QVector<qint32>  lons;        //microdegrees
+        int              plotted;     //number of points on canvas
+    };
+    typedef QMap<int, TrackT> TracksT; //key is ISSI
 
     Ui::GisTrackingReplay  *ui;
     QTimer                 *mTimer;
     GisCanvas              *mCanvas;
+    bool                    mDoZoom;     //auto-zoom on next first point
     int                     mSpeed;
     int                     mPointNum;
     uint                    mTimeStart;
     uint                    mTimeEnd;
-    QSet<int>               mIssis;
-    TrackPointsT            mTrackpoints;
-    TrackPointsT::iterator  mIt;
+    TracksT                 mTracks;
+    QVector<uint>           mTimes;      //distinct times of all points
+
+    /**
+     * Plots tracks up to a time, by adding or deleting tracking lines from
+     * the currently plotted points.
+     *
+     * @param[in] t The time_t.
+     */
+    void seek(uint t);
 
     /**
      * Resets the replay to the beginning, and adds the first point.
@@ -0,0 +1,194 @@
+/**
+ * Terminal point history implementation.
+ *
+ * Copyright (C) Sapura Secured Technologies, 2026. All Rights Reserved.
+ *
+ * @file
+ * @version $Id$
+ * @author agent <agent@local>
+ */
+#include <math.h>
+#include <utility>
+
+#include "GisTrail.h"
+
+using namespace std;
+
+static const double PI = 3.14159265358979;
+//mean earth radius in meters per degree
+static const double METERS_PER_DEG = 6371008.8 * PI / 180;
+//web mercator resolution at the equator at zoom level 0, in meters per pixel
+static const double METERS_PER_PX_Z0 = 156543.03392;
+
+const double GisTrail::TOLERANCE_PX = 2.0;
+
+GisTrail::GisTrail(int maxPoints, int maxAge) :
+mMaxPoints(maxPoints), mMaxAge(maxAge), mZoom(-1), mTolerance(0),
+mFirstSeq(0)
+{
+}
+
+void GisTrail::add(double lat, double lon, time_t t)
+{
+    PointT p = { lat, lon, t };
+    mPoints.push_back(p);
+    unsigned long seq = mFirstSeq + mPoints.size() - 1;
+    if (mKept.size() < 2)
+    {
+        mKept.push_back(seq);
+    }
+    else
+    {
+        //the new point may make the last kept point redundant, so redo
+        //from the one before it, unless that covers too many points
+        unsigned long start = mKept[mKept.size() - 2];
+        if (seq - start > MAX_WINDOW)
+            start = mKept.back();
+        else
+            mKept.pop_back();
+        simplify(start, seq);
+    }
+    while (mMaxPoints > 0 && (int) mPoints.size() > mMaxPoints)
+    {
+        removeFirst();
+    }
+    expire(t);
+}
+
+
+void GisTrail::removeLast(int num)
+{
+    for (; num>0 && !mPoints.empty(); --num)
+    {
+        mPoints.pop_back();
+    }
+    rebuild();
+}
+
+bool GisTrail::setZoom(double zoom)
+{
+    int z = (int) floor(zoom + 0.5);
+    if (z == mZoom)
+        return false;
+    mZoom = z;
+    rebuild();
+    return true;
+}
+
+void GisTrail::getPath(vector<double> &coords) const
+{
+    coords.clear();
+    coords.reserve(mKept.size() * 2);
+    for (auto seq : mKept)
+    {
+        const PointT &p(mPoints[seq - mFirstSeq]);
+        coords.push_back(p.lat);
+        coords.push_back(p.lon);
+    }
+}
+
+void GisTrail::expire(time_t now)
+{
+    if (mMaxAge <= 0)
+        return;
+    //always keep the last point, which is the current position
+    while (mPoints.size() > 1 && now - mPoints.front().t > mMaxAge)
+    {
+        removeFirst();
+    }
+}
+
+void GisTrail::removeFirst()
+{
+    mPoints.pop_front();
+    ++mFirstSeq;
+    while (!mKept.empty() && mKept.front() < mFirstSeq)
+    {
+        mKept.pop_front();
+    }
+    if (!mPoints.empty() && (mKept.empty() || mKept.front() != mFirstSeq))
+        mKept.push_front(mFirstSeq);
+}
+
+void GisTrail::rebuild()
+{
+    mKept.clear();
+    if (mZoom >= 0)
+        mTolerance = TOLERANCE_PX * METERS_PER_PX_Z0 / pow(2.0, mZoom) *
+                     ((mPoints.empty())?
+                      1: cos(mPoints.front().lat * PI / 180));
+    if (mPoints.empty())
+        return;
+    mKept.push_back(mFirstSeq);
+    if (mPoints.size() > 1)
+        simplify(mFirstSeq, mFirstSeq + mPoints.size() - 1);
+}
+
+void GisTrail::simplify(unsigned long start, unsigned long end)
+{
+    size_t first = start - mFirstSeq;
+    size_t last = end - mFirstSeq;
+    vector<bool> keep(last - first + 1, false);
+    keep.back() = true;
+    //iterative, to avoid deep recursion on long histories
+    vector<pair<size_t, size_t>> stack;
+    stack.push_back(make_pair(first, last));
+    size_t a;
+    size_t b;
+    size_t i;
+    size_t iMax;
+    double d;
+    double dMax;
+    while (!stack.empty())
+    {
+        a = stack.back().first;
+        b = stack.back().second;
+        stack.pop_back();
+        if (b - a < 2)
+            continue;
+        iMax = 0;
+        dMax = -1;
+        for (i=a+1; i<b; ++i)
+        {
+            d = getDistance(mPoints[i], mPoints[a], mPoints[b]);
+            if (d > dMax)
+            {
+                dMax = d;
+                iMax = i;
+            }
+        }
+        if (dMax > mTolerance)
+        {
+            keep[iMax - first] = true;
+            stack.push_back(make_pair(a, iMax));
+            stack.push_back(make_pair(iMax, b));
+        }
+    }
+    for (i=first+1; i<=last; ++i)
+    {
+        if (keep[i - first])
+            mKept.push_back(mFirstSeq + i);
+    }
+}
+
+double GisTrail::getDistance(const PointT &p, const PointT &a, const PointT &b)
+{
+    //project onto a plane with the segment start at the origin
+    double k = cos(a.lat * PI / 180);
+    double bx = (b.lon - a.lon) * k;
+    double by = b.lat - a.lat;
+    double px = (p.lon - a.lon) * k;
+    double py = p.lat - a.lat;
+    double len2 = bx * bx + by * by;
+    if (len2 > 0)
+    {
+        double u = (px * bx + py * by) / len2;
+        if (u > 1)
+            u = 1;
+        else if (u < 0)
+            u = 0;
+        px -= u * bx;
+        py -= u * by;
+    }
+    return sqrt(px * px + py * py) * METERS_PER_DEG;
+}
@@ -0,0 +1,137 @@
+/**
+ * Platform-independent point history of a moving terminal, for drawing as a
+ * single polyline.
+ * The points are kept in a ring limited by count and age, and the path for
+ * display is simplified with the Douglas-Peucker algorithm, using a tolerance
+ * of a fixed number of pixels at the current zoom level. The simplification
+ * is maintained on-line as points are added, so that a location update only
+ * reprocesses the end of the path, while a zoom level change reprocesses all
+ * points.
+ * Not thread-safe.
+ *
+ * Copyright (C) Sapura Secured Technologies, 2026. All Rights Reserved.
+ *
+ * @file
+ * @version $Id$
+ * @author agent <agent@local>
+ */
+#ifndef GISTRAIL_H
+#define GISTRAIL_H
+
+#include <deque>
+#include <time.h>
+#include <vector>
+
+class GisTrail
+{
+public:
+    //defaults for trailing configuration
+    static const int DEF_MAX_POINTS  = 2000;
+    static const int DEF_MAX_AGE_MIN = 480;
+
+    /**
+     * Constructor.
+     *
+     * @param[in] maxPoints The maximum number of points. 0 for no limit.
+     * @param[in] maxAge    The maximum point age in seconds. 0 for no limit.
+     */
+    explicit GisTrail(int maxPoints = 0, int maxAge = 0);
+
+    /**
+     * Adds a point at the end. Points beyond the limits are removed from the
+     * start.
+     *
+     * @param[in] lat The latitude.
+     * @param[in] lon The longitude.
+     * @param[in] t   The time. Ignored if there is no age limit.
+     */
+    void add(double lat, double lon, time_t t = 0);
+
+    /**
+     * Removes points from the end.
+     *
+     * @param[in] num The number of points.
+     */
+    void removeLast(int num);
+
+    /**
+     * Sets the map zoom level, and simplifies the path again if the
+     * tolerance changes.
+     *
+     * @param[in] zoom The zoom level. Rounded to the nearest integer.
+     * @return true if the path has changed.
+     */
+    bool setZoom(double zoom);
+
+    /**
+     * Gets the simplified path.
+     *
+     * @param[out] coords The coordinates as [lat1, lon1, lat2, lon2, ...].
+     */
+    void getPath(std::vector<double> &coords) const;
+
+    bool isEmpty() const { return mPoints.empty(); }
+
+private:
+    struct PointT
+    {
+        double lat;
+        double lon;
+        time_t t;
+    };
+
+    //the simplification tolerance in pixels
+    static const double TOLERANCE_PX;
+    //maximum number of points reprocessed on add(), beyond which the path
+    //before the new point is left as is
+    static const int    MAX_WINDOW = 256;
+
+    int                       mMaxPoints;
+    int                       mMaxAge;
+    int                       mZoom;       //-1 if not set
+    double                    mTolerance;  //in meters
+    unsigned long             mFirstSeq;   //sequence number of mPoints[0]
+    std::deque<PointT>        mPoints;
+    std::deque<unsigned long> mKept;       //sequence numbers in the path
+
+    /**
+     * Removes points older than the age limit.
+     *
+     * @param[in] now The current time.
+     */
+    void expire(time_t now);
+
+    /**
+     * Removes the first point, and makes the new first point the start of
+     * the path.
+     */
+    void removeFirst();
+
+    /**
+     * Simplifies the whole path.
+     */
+    void rebuild();
+
+    /**
+     * Simplifies the points between two sequence numbers and appends the
+     * kept ones after the start to the path.
+     *
+     * @param[in] start The start sequence number, already in the path.
+     * @param[in] end   The end sequence number.
+     */
+    void simplify(unsigned long start, unsigned long end);
+
+    /**
+     * Gets the distance of a point from a line segment, using an
+     * equirectangular projection around the segment start.
+     *
+     * @param[in] p The point.
+     * @param[in] a The segment start.
+     * @param[in] b The segment end.
+     * @return The distance in meters.
+     */
+    static double getDistance(const PointT &p,
+                              const PointT &a,
+                              const PointT &b);
+};
+#endif //GISTRAIL_H
@@ -611,6 +611,28 @@ void GisWindow::incidentUpdate(IncidentData *data, bool fromReport)
         mMapCanvas->incidentUpdate(data, GisQmlInt::TYPEID_INCIDENT);
 }
 
+void GisWindow::incidentLoad(const QList<IncidentData *> &data,
+                             bool                         fromReport)
+{
+    if (fromReport)
+    {
+        mMapCanvas->incidentLoad(data, GisQmlInt::TYPEID_INCIDENT_REPORT);
+        return;
+    }
+    QList<IncidentData *> l;
+    l.reserve(data.size());
+    for (auto d : data)
+    {
+        if (d == 0)
+            continue;
+        if (d->isClosed())
+            mMapCanvas->incidentClose(d->getId());
+        else
+            l.append(d);
+    }
+    mMapCanvas->incidentLoad(l, GisQmlInt::TYPEID_INCIDENT);
+}
+
 void GisWindow::incidentClose(int id)
 {
     mMapCanvas->incidentClose((id == 0)? GisQmlInt::TYPEID_INCIDENT: id);
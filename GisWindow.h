@@ -123,6 +123,15 @@ public:
      */
     void incidentUpdate(IncidentData *data, bool fromReport = false);
 
+    /**
+     * Adds/updates incident points in bulk.
+     *
+     * @param[in] data       The incidents.
+     * @param[in] fromReport true for Report incidents.
+     */
+    void incidentLoad(const QList<IncidentData *> &data,
+                      bool                         fromReport = false);
+
     /**
      * Deletes an incident point.
      *
@@ -207,11 +207,11 @@ void GpsMonitor::init(Logger        *logger,
     {
         if (sIssis.size() > 1)
             sMonGrps = true; //for mon grps, also start with none
-        session->gpsMonitorStop(SsisT()); //no monitoring
+        session->gpsMonitorStop(IdRangeSet()); //no monitoring
     }
     else
     {
-        session->gpsMonitorStart(sIssis); //all or saved selection
+        session->gpsMonitorStart(IdRangeSet(sIssis)); //all or saved selection
     }
 }
 
@@ -320,7 +320,7 @@ QString GpsMonitor::monGrpsStart(const SsisT &gssis)
         else
             it = issis.erase(it);
     }
-    if (!issis.empty() && !sSession->gpsMonitorStart(issis))
+    if (!issis.empty() && !sSession->gpsMonitorStart(IdRangeSet(issis)))
     {
         string s(Utils::toStringWithRange(issis));
         LOGGER_ERROR(sLogger, "GpsMonitor::monGrpsStart: Failed to send "
@@ -351,7 +351,7 @@ QString GpsMonitor::monGrpsStop(const SsisT &gssis, SsisT &affSsis)
         else
             ++it;
     }
-    if (!issis.empty() && !sSession->gpsMonitorStop(issis))
+    if (!issis.empty() && !sSession->gpsMonitorStop(IdRangeSet(issis)))
     {
         string s(Utils::toStringWithRange(issis));
         LOGGER_ERROR(sLogger, "GpsMonitor::monGrpsStop: Failed to send "
@@ -371,11 +371,13 @@ QString GpsMonitor::monGrpsAttDet(int issi, const SsisT &gssis)
 {
     string log;
     QString err;
+    IdRangeSet ids;
+    ids.add(issi);
     if (sIssis.count(issi) == 0)
     {
         //not monitored - add if attached to monitored grps
         if (SubsData::isGrpAttachedMember(issi, gssis) &&
-            !sSession->gpsMonitorStart(SsisT({issi})))
+            !sSession->gpsMonitorStart(ids))
         {
             log.append("add ");
             err.append(tr("add "));
@@ -383,7 +385,7 @@ QString GpsMonitor::monGrpsAttDet(int issi, const SsisT &gssis)
     }
     //monitored - remove if not attached to monitored grps
     else if (!SubsData::isGrpAttachedMember(issi, gssis) &&
-             !sSession->gpsMonitorStop(SsisT({issi})))
+             !sSession->gpsMonitorStop(ids))
     {
         log.append("remove ");
         err.append(tr("remove "));
@@ -514,7 +516,8 @@ void GpsMonitor::onOk()
                     if (newList.count(i) == 0)
                         updList.insert(i);
                 }
-                if (!updList.empty() && !sSession->gpsMonitorStop(updList))
+                if (!updList.empty() &&
+                    !sSession->gpsMonitorStop(IdRangeSet(updList)))
                 {
                     log.assign(Utils::toStringWithRange(updList));
                     err.append(tr("remove "))
@@ -529,7 +532,8 @@ void GpsMonitor::onOk()
                 if (sIssis.count(i) == 0)
                     updList.insert(i);
             }
-            if (!updList.empty() && !sSession->gpsMonitorStart(updList))
+            if (!updList.empty() &&
+                !sSession->gpsMonitorStart(IdRangeSet(updList)))
             {
                 if (!err.isEmpty())
                 {
@@ -542,7 +546,7 @@ void GpsMonitor::onOk()
             }
         }
         //none selected - stop all if was monitoring before
-        else if (mOpt != OPT_NONE && !sSession->gpsMonitorStop(newList))
+        else if (mOpt != OPT_NONE && !sSession->gpsMonitorStop(IdRangeSet()))
         {
             log = "stop monitoring";
             err = tr("stop monitoring");
@@ -550,7 +554,7 @@ void GpsMonitor::onOk()
     }
     else if (ui->optAll->isChecked())
     {
-        if (mOpt != OPT_ALL && !sSession->gpsMonitorStart(newList))
+        if (mOpt != OPT_ALL && !sSession->gpsMonitorStart(IdRangeSet()))
         {
             log = "monitor all";
             err = tr("monitor all");
@@ -565,7 +569,7 @@ void GpsMonitor::onOk()
             emit listChanged(getList()); //because not sending svr msg
         }
         //stop all first - grp members to be selected upon svr response
-        else if (!sSession->gpsMonitorStop(newList))
+        else if (!sSession->gpsMonitorStop(IdRangeSet()))
         {
             log = "stop monitoring";
             err = tr("stop monitoring");
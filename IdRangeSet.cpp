@@ -0,0 +1,268 @@
+/**
+ * ID range set implementation.
+ *
+ * Copyright (C) Sapura Secured Technologies, 2026. All Rights Reserved.
+ *
+ * @file
+ * @version $Id$
+ * @author agent <agent@local>
+ */
+#include <limits.h>
+#include <stdlib.h>
+
+#include "IdRangeSet.h"
+
+using namespace std;
+
+IdRangeSet::IdRangeSet(const set<int> &ids) : mCount(0)
+{
+    auto it = ids.begin();
+    if (it == ids.end())
+        return;
+    int min = *it;
+    int max = min;
+    for (++it; it!=ids.end(); ++it)
+    {
+        if (*it != max + 1)
+        {
+            mRanges.emplace_hint(mRanges.end(), min, max);
+            min = *it;
+        }
+        max = *it;
+    }
+    mRanges.emplace_hint(mRanges.end(), min, max);
+    mCount = ids.size();
+}
+
+IdRangeSet::IdRangeSet(const string &str, char delimiter) : mCount(0)
+{
+    parse(str, delimiter);
+}
+
+long long IdRangeSet::parse(const string &str, char delimiter)
+{
+    long long n = 0;
+    long min;
+    long max;
+    char *end;
+    const char *p = str.c_str();
+    while (*p != '\0')
+    {
+        min = strtol(p, &end, 10);
+        if (end != p && min > 0 && min <= INT_MAX)
+        {
+            p = end;
+            while (*p == ' ' && delimiter != ' ')
+                ++p;
+            max = min;
+            if (*p == '-')
+            {
+                max = strtol(p + 1, &end, 10);
+                if (end == p + 1 || max < min || max > INT_MAX)
+                    max = min;
+                else
+                    p = end;
+            }
+            n += add(min, max);
+        }
+        //skip the rest of the word
+        while (*p != '\0' && *p != delimiter)
+            ++p;
+        if (*p != '\0')
+            ++p;
+    }
+    return n;
+}
+
+string IdRangeSet::toString(const string &delimiter) const
+{
+    string str;
+    for (const auto &it : mRanges)
+    {
+        if (!str.empty())
+            str.append(delimiter);
+        appendRange(it.first, it.second, delimiter, str);
+    }
+    return str;
+}
+
+void IdRangeSet::toStrings(size_t          maxLen,
+                           vector<string> &strs,
+                           const string   &delimiter) const
+{
+    strs.clear();
+    string cur;
+    string rng;
+    for (const auto &it : mRanges)
+    {
+        rng.clear();
+        appendRange(it.first, it.second, delimiter, rng);
+        if (!cur.empty() && cur.size() + delimiter.size() + rng.size() > maxLen)
+        {
+            strs.push_back(cur);
+            cur.clear();
+        }
+        if (!cur.empty())
+            cur.append(delimiter);
+        cur.append(rng);
+    }
+    if (!cur.empty())
+        strs.push_back(cur);
+}
+
+void IdRangeSet::getIds(set<int> &ids) const
+{
+    int i;
+    for (const auto &it : mRanges)
+    {
+        for (i=it.first; ; ++i)
+        {
+            ids.insert(ids.end(), i);
+            if (i == it.second)
+                break;
+        }
+    }
+}
+
+bool IdRangeSet::contains(int id) const
+{
+    auto it = mRanges.upper_bound(id);
+    return (it != mRanges.begin() && id <= (--it)->second);
+}
+
+long long IdRangeSet::add(int min, int max)
+{
+    if (max < min)
+        return 0;
+    long long removed = 0;
+    //start with the last range starting at or below min, if it reaches min
+    auto it = mRanges.upper_bound(min);
+    if (it != mRanges.begin())
+    {
+        --it;
+        if ((long long) it->second + 1 < min)
+            ++it;
+        else if (it->second >= max)
+            return 0; //already covered
+    }
+    //merge all overlapping or adjacent ranges
+    while (it != mRanges.end() && (long long) it->first <= (long long) max + 1)
+    {
+        if (it->first < min)
+            min = it->first;
+        if (it->second > max)
+            max = it->second;
+        removed += (long long) it->second - it->first + 1;
+        it = mRanges.erase(it);
+    }
+    mRanges.emplace_hint(it, min, max);
+    removed = (long long) max - min + 1 - removed;
+    mCount += removed;
+    return removed;
+}
+
+long long IdRangeSet::remove(int min, int max)
+{
+    if (max < min)
+        return 0;
+    long long removed = 0;
+    int first;
+    int last;
+    auto it = mRanges.upper_bound(min);
+    if (it != mRanges.begin())
+    {
+        --it;
+        if (it->second < min)
+            ++it;
+    }
+    while (it != mRanges.end() && it->first <= max)
+    {
+        first = it->first;
+        last = it->second;
+        removed += (long long) ((last < max)? last: max) -
+                   ((first > min)? first: min) + 1;
+        it = mRanges.erase(it);
+        if (first < min)
+            mRanges.emplace_hint(it, first, min - 1);
+        if (last > max)
+        {
+            mRanges.emplace_hint(it, max + 1, last);
+            break;
+        }
+    }
+    mCount -= removed;
+    return removed;
+}
+
+long long IdRangeSet::unite(const IdRangeSet &other)
+{
+    if (&other == this)
+        return 0;
+    long long n = 0;
+    for (const auto &it : other.mRanges)
+    {
+        n += add(it.first, it.second);
+    }
+    return n;
+}
+
+long long IdRangeSet::subtract(const IdRangeSet &other)
+{
+    if (&other == this)
+    {
+        long long n = mCount;
+        clear();
+        return n;
+    }
+    long long n = 0;
+    for (const auto &it : other.mRanges)
+    {
+        n += remove(it.first, it.second);
+        if (mRanges.empty())
+            break;
+    }
+    return n;
+}
+
+long long IdRangeSet::intersect(const IdRangeSet &other)
+{
+    if (&other == this)
+        return 0;
+    RangeMapT res;
+    long long count = 0;
+    int min;
+    int max;
+    auto it = mRanges.begin();
+    auto oit = other.mRanges.begin();
+    while (it != mRanges.end() && oit != other.mRanges.end())
+    {
+        min = (it->first > oit->first)? it->first: oit->first;
+        max = (it->second < oit->second)? it->second: oit->second;
+        if (min <= max)
+        {
+            res.emplace_hint(res.end(), min, max);
+            count += (long long) max - min + 1;
+        }
+        //advance the one that ends first
+        if (it->second < oit->second)
+            ++it;
+        else
+            ++oit;
+    }
+    mRanges.swap(res);
+    count = mCount - count;
+    mCount -= count;
+    return count;
+}
+
+void IdRangeSet::appendRange(int           min,
+                             int           max,
+                             const string &delimiter,
+                             string       &str)
+{
+    str.append(to_string(min));
+    if ((long long) max == (long long) min + 1)
+        str.append(delimiter).append(to_string(max));
+    else if (max > min)
+        str.append(1, '-').append(to_string(max));
+}
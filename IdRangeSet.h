@@ -0,0 +1,174 @@
+/**
+ * Platform-independent set of integer IDs stored as disjoint ranges.
+ * Adjacent and overlapping ranges are merged, so a range of any length
+ * takes one map node. Membership lookup is logarithmic in the number of
+ * ranges, and a change affects only the ranges it touches.
+ * The string format is the one in Utils::fromStringWithRange() and
+ * Utils::toStringWithRange(), e.g. "1,5,7-20".
+ * Not thread-safe.
+ *
+ * Copyright (C) Sapura Secured Technologies, 2026. All Rights Reserved.
+ *
+ * @file
+ * @version $Id$
+ * @author agent <agent@local>
+ */
+#ifndef IDRANGESET_H
+#define IDRANGESET_H
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+class IdRangeSet
+{
+public:
+    //key is range start, value is range end (inclusive)
+    typedef std::map<int, int> RangeMapT;
+
+    IdRangeSet() : mCount(0) {}
+
+    /**
+     * Constructor from individual IDs.
+     *
+     * @param[in] ids The IDs.
+     */
+    explicit IdRangeSet(const std::set<int> &ids);
+
+    /**
+     * Constructor from a string. See parse().
+     *
+     * @param[in] str       The string.
+     * @param[in] delimiter The range delimiter.
+     */
+    explicit IdRangeSet(const std::string &str, char delimiter = ',');
+
+    bool operator==(const IdRangeSet &other) const
+    {
+        return (mRanges == other.mRanges);
+    }
+
+    bool operator!=(const IdRangeSet &other) const
+    {
+        return (mRanges != other.mRanges);
+    }
+
+    /**
+     * Adds IDs from a string of delimited single values and ranges
+     * "min-max", without expanding the ranges. A range end below its start
+     * is ignored, and so are words that do not start with a positive number.
+     *
+     * @param[in] str       The string.
+     * @param[in] delimiter The range delimiter.
+     * @return The number of IDs added.
+     */
+    long long parse(const std::string &str, char delimiter = ',');
+
+    /**
+     * Formats the IDs into a string, with a range for 3 or more consecutive
+     * values, as in Utils::toStringWithRange().
+     *
+     * @param[in] delimiter The value delimiter.
+     * @return The string.
+     */
+    std::string toString(const std::string &delimiter = ",") const;
+
+    /**
+     * Formats the IDs into strings of limited length, each in the format of
+     * toString().
+     *
+     * @param[in]  maxLen    The maximum string length. A single range is
+     *                       never split, even if longer.
+     * @param[out] strs      The strings.
+     * @param[in]  delimiter The value delimiter.
+     */
+    void toStrings(size_t                    maxLen,
+                   std::vector<std::string> &strs,
+                   const std::string        &delimiter = ",") const;
+
+    /**
+     * Expands the IDs into a set. Meant for small sets only.
+     *
+     * @param[in,out] ids The IDs are added here.
+     */
+    void getIds(std::set<int> &ids) const;
+
+    bool contains(int id) const;
+
+    /**
+     * Adds a range of IDs.
+     *
+     * @param[in] min The range start.
+     * @param[in] max The range end. Nothing is done if less than min.
+     * @return The number of IDs actually added.
+     */
+    long long add(int min, int max);
+
+    long long add(int id) { return add(id, id); }
+
+    /**
+     * Removes a range of IDs.
+     *
+     * @param[in] min The range start.
+     * @param[in] max The range end. Nothing is done if less than min.
+     * @return The number of IDs actually removed.
+     */
+    long long remove(int min, int max);
+
+    long long remove(int id) { return remove(id, id); }
+
+    /**
+     * Adds all IDs of another set.
+     *
+     * @param[in] other The other set.
+     * @return The number of IDs actually added.
+     */
+    long long unite(const IdRangeSet &other);
+
+    /**
+     * Removes all IDs of another set.
+     *
+     * @param[in] other The other set.
+     * @return The number of IDs actually removed.
+     */
+    long long subtract(const IdRangeSet &other);
+
+    /**
+     * Keeps only the IDs that are also in another set.
+     *
+     * @param[in] other The other set.
+     * @return The number of IDs removed.
+     */
+    long long intersect(const IdRangeSet &other);
+
+    void clear()
+    {
+        mRanges.clear();
+        mCount = 0;
+    }
+
+    bool empty() const { return mRanges.empty(); }
+
+    long long size() const { return mCount; }
+
+    const RangeMapT &getRanges() const { return mRanges; }
+
+private:
+    RangeMapT mRanges;
+    long long mCount;   //number of IDs
+
+    /**
+     * Appends a range to a string in the format of toString().
+     *
+     * @param[in]     min       The range start.
+     * @param[in]     max       The range end.
+     * @param[in]     delimiter The value delimiter.
+     * @param[in,out] str       The string.
+     */
+    static void appendRange(int                min,
+                            int                max,
+                            const std::string &delimiter,
+                            std::string       &str);
+};
+#endif //IDRANGESET_H
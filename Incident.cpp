@@ -15,12 +15,14 @@
 #include <QList>
 #include <QMenu>
 #include <QMessageBox>
+#include <QPointer>
 #include <QRegExp>
 #include <QSet>
 #include <QSpinBox>
 #include <QTimer>
 #include <QToolTip>
 #include <QWidgetAction>
+#include <QtConcurrent/QtConcurrent>
 
 #include "CmnTypes.h"
 #include "Contact.h"
@@ -64,7 +66,8 @@ Incident::Incident(AudioPlayer     *audioPlayer,
                    QWidget         *parent) :
 QWidget(parent), ui(new Ui::Incident), mActiveInc(activeInc),
 mAudioPlayer(audioPlayer), mLogger(logger), mSession(0), mGis(0), mTrmMdl(0),
-mMobMdl(0), mTrmList(0), mMobList(0), mData(0), mRscSelEnabled(false)
+mMobMdl(0), mTrmList(0), mMobList(0), mData(0), mRscSelEnabled(false),
+mRetrieveSeq(0)
 {
     IncidentData::init();
     ui->setupUi(this);
@@ -982,10 +985,7 @@ void Incident::setGis(GisWindow *gis)
     connect(mGis, &GisWindow::mainMapLoaded, this,
             [this]
             {
-                for (auto &p : mActiveInc->getAllData())
-                {
-                    mGis->incidentUpdate(p);
-                }
+                mGis->incidentLoad(mActiveInc->getAllData());
                 mGis->incidentLock(getEditId());
                 enableResourceSelect();
             });
@@ -1088,11 +1088,64 @@ void Incident::retrieveData(const QString &username)
         //add all
         IncidentButton::addFilter(IncidentButton::FIELD_STATE, stateList);
     }
+#ifdef NO_DB
+    RetrievedT rd;
+    onRetrieved(rd);
+#else
+    //continued in onRetrieved() - a newer call discards the older results
+    quint64 seq = ++mRetrieveSeq;
+    QPointer<Incident> self(this);
+    Logger *logger = mLogger;
+    string uname(username.toStdString());
+    QtConcurrent::run([self, seq, logger, uname]
+    {
+        DbInt &db(DbInt::instance());
+        auto *rd = new RetrievedT;
+        rd->ok = (db.getIncidentCategories(rd->categories) &&
+                  db.getCountryStates(rd->states));
+        if (rd->ok)
+        {
+            rd->loaded = fetchData(0, rd->incidents, logger);
+            rd->lockedId = db.getLockedIncident(uname);
+        }
+        QMetaObject::invokeMethod(qApp,
+                                  [self, seq, rd]
+                                  {
+                                      if (!self.isNull() &&
+                                          seq == self->mRetrieveSeq)
+                                          self->onRetrieved(*rd);
+                                      qDeleteAll(rd->incidents);
+                                      delete rd;
+                                  },
+                                  Qt::QueuedConnection);
+    });
+#endif //NO_DB
+}
+
+void Incident::loadData(int id)
+{
+    QPointer<Incident> self(this);
+    Logger *logger = mLogger;
+    QtConcurrent::run([self, id, logger]
+    {
+        auto *data = new DataListT;
+        bool ok = fetchData(id, *data, logger);
+        QMetaObject::invokeMethod(qApp,
+                                  [self, id, data, ok]
+                                  {
+                                      if (ok && !self.isNull())
+                                          self->applyData(id, *data);
+                                      qDeleteAll(*data);
+                                      delete data;
+                                  },
+                                  Qt::QueuedConnection);
+    });
+}
+
+void Incident::onRetrieved(RetrievedT &rd)
+{
 #ifndef NO_DB
-    DbInt &db(DbInt::instance());
-    DbInt::DataMapT categories;
-    DbInt::DataMapT states;
-    if (!db.getIncidentCategories(categories) || !db.getCountryStates(states))
+    if (!rd.ok)
     {
         QMessageBox::critical(this, tr("Incident: Data Error"),
                               tr("Database connection failed. Incident "
@@ -1103,15 +1156,15 @@ void Incident::retrieveData(const QString &username)
                                      "create incident."));
         return;
     }
-    IncidentData::setCategories(categories);
-    IncidentData::setAddrStates(states);
+    IncidentData::setCategories(rd.categories);
+    IncidentData::setAddrStates(rd.states);
     ui->newButton->setToolTip("");
     ui->stateCombo->clear();
     mStates.clear();
     QString state;
     //add all states to filter - only if none configured
     bool noFilter = !IncidentButton::hasFilter(IncidentButton::FIELD_ADDRSTATE);
-    for (const auto &it : states)
+    for (const auto &it : rd.states)
     {
         state = QString::fromStdString(it.first);
         mStates[state] = it.second;
@@ -1121,18 +1174,18 @@ void Incident::retrieveData(const QString &username)
                                          state);
     }
     IncidentButton::setFilterMaxSize(IncidentButton::FIELD_ADDRSTATE,
-                                     states.size());
+                                     rd.states.size());
     ui->stateCombo->model()->sort(0, Qt::AscendingOrder);
     ui->stateCombo->setCurrentIndex(0);
     ui->categoryCombo->clear();
-    for (const auto &it : categories)
+    for (const auto &it : rd.categories)
     {
         ui->categoryCombo->addItem(QString::fromStdString(it.first));
     }
 #endif //!NO_DB
     ui->categoryCombo->model()->sort(0, Qt::AscendingOrder);
     ui->categoryCombo->setCurrentIndex(0);
-    mdl = ui->categoryCombo->model();
+    QAbstractItemModel *mdl = ui->categoryCombo->model();
     IncidentButton::setFilterMaxSize(IncidentButton::FIELD_CATEGORY,
                                      mdl->rowCount());
     //add all categories to filter - only if none configured
@@ -1145,15 +1198,16 @@ void Incident::retrieveData(const QString &username)
                                          mdl->index(i, 0).data().toString());
         }
     }
-    //add filter menu - must be done before loadData()
+    //add filter menu - must be done before applyData()
     mActiveInc->setFilterMenu();
 #ifndef NO_DB
     //load open incidents
-    loadData();
+    if (rd.loaded)
+        applyData(0, rd.incidents);
     int id = getEditId();
     //check for unreleased lock from previous session, and release it if the
     //incident is not being edited now
-    int idDb = db.getLockedIncident(username.toStdString());
+    int idDb = rd.lockedId;
     if (idDb > 0 && idDb != id && mSession->incidentLock(idDb, false) <= 0)
         LOGGER_ERROR(mLogger, LOGPREFIX << "retrieveData: "
                      << "Failed to send unlock request to server for "
@@ -1174,7 +1228,7 @@ void Incident::retrieveData(const QString &username)
     }
 }
 
-void Incident::loadData(int id)
+bool Incident::fetchData(int id, DataListT &data, Logger *logger)
 {
     auto *res = (id > 0)?
                 DbInt::instance().getIncidentHistory(id):
@@ -1182,13 +1236,13 @@ void Incident::loadData(int id)
                                                     IncidentData::STATE_CLOSED);
     if (res == 0 || res->getNumRows() == 0)
     {
-        LOGGER_WARNING(mLogger, LOGPREFIX << "loadData: No result for ID "
+        LOGGER_WARNING(logger, LOGPREFIX << "loadData: No result for ID "
                        << id);
+        bool ok = (res != 0);
         delete res;
-        return;
+        return ok;
     }
-    IncidentData *data = 0;
-    int dispId = ui->idEdit->text().toInt();
+    IncidentData *d;
     int numRows = res->getNumRows();
     int i = 0;
     int creator;
@@ -1208,22 +1262,71 @@ void Incident::loadData(int id)
         {
             continue; //data not applicable
         }
-        data = new IncidentData(res, i);
-        if (!data->isValid())
+        d = new IncidentData(res, i);
+        if (!d->isValid())
         {
-            LOGGER_WARNING(mLogger, LOGPREFIX
+            LOGGER_WARNING(logger, LOGPREFIX
                            << "loadData: Invalid data for Incident ID "
                            << res->getFieldStr(DbInt::FIELD_ID, i));
-            delete data;
+            delete d;
             continue;
         }
-        if (data->getId() == dispId)
-            mData = data;
-        updateCase(data);
+        data.push_back(d);
     }
     delete res;
-    if (data != 0 && id > 0 && id == dispId)
-        showData(data); //updated incident is on display
+    return true;
+}
+
+void Incident::applyData(int id, DataListT &data)
+{
+    int dispId = ui->idEdit->text().toInt();
+    IncidentData *disp = 0;
+    IncidentData *cur;
+    set<int> ids;
+    //defer repainting until all changes are done
+    mActiveInc->setUpdatesEnabled(false);
+    for (auto *d : data)
+    {
+        ids.insert(d->getId());
+        cur = mActiveInc->getData(d->getId());
+        if (cur != 0 && (*cur == *d || cur->getLastUpdateDateTime() >
+                                       d->getLastUpdateDateTime()))
+        {
+            delete d; //unchanged or older
+            continue;
+        }
+        if (d->getId() == dispId)
+        {
+            mData = d;
+            disp = d;
+        }
+        updateCase(d);
+        //a closed incident is not kept by mActiveInc
+        if (d->isClosed() && d != mData)
+            delete d;
+    }
+    data.clear();
+    if (id == 0)
+    {
+        //close incidents no longer open
+        vector<int> closed;
+        for (auto *d : mActiveInc->getAllData())
+        {
+            if (ids.count(d->getId()) == 0)
+                closed.push_back(d->getId());
+        }
+        for (auto i : closed)
+        {
+            if (mData != 0 && mData->getId() == i)
+                mData = 0; //deleted below
+            mActiveInc->closeCase(i);
+            if (mGis != 0)
+                mGis->incidentClose(i);
+        }
+    }
+    mActiveInc->setUpdatesEnabled(true);
+    if (disp != 0 && id > 0)
+        showData(disp); //updated incident is on display
 }
 
 void Incident::showData(IncidentButton *btn)
@@ -1362,6 +1465,8 @@ bool Incident::showData(IncidentData *data)
               ->setVisible(QtTableUtils::getMsgData(rscs, start, end, gssis,
                                                     ui->msgTable));
         }
+        if (!ui->callFrame->isHidden())
+            mAudioPlayer->watch(ui->callTable);
         QApplication::restoreOverrideCursor();
     }
     ui->printButton->setEnabled(true);
@@ -1498,13 +1603,14 @@ void Incident::onPlotData(const set<IncidentData *> &data, const set<int> &ids)
                                  "yet loaded."));
         return;
     }
-    QStringList errIds;
+    QStringList           errIds;
+    QList<IncidentData *> l;
     if (!data.empty())
     {
         for (auto &d: data)
         {
             if (d->hasLocation())
-                mGis->incidentUpdate(d, true);
+                l.append(d);
             else
                 errIds << QString::number(d->getId());
         }
@@ -1516,11 +1622,12 @@ void Incident::onPlotData(const set<IncidentData *> &data, const set<int> &ids)
         {
             d = mActiveInc->getData(id);
             if (d != 0 && d->hasLocation())
-                mGis->incidentUpdate(d, true);
+                l.append(d);
             else
                 errIds << QString::number(id);
         }
     }
+    mGis->incidentLoad(l, true);
     mGis->show();
     if (!errIds.isEmpty())
         QMessageBox::information(this, tr("Plot Incidents"),
@@ -12,6 +12,7 @@
 
 #include <map>
 #include <set>
+#include <vector>
 #include <QModelIndex>
 #include <QPointF>
 #include <QSortFilterProxyModel>
@@ -102,14 +103,16 @@ public:
     int getEditId();
 
     /**
-     * Retrieves data from database.
+     * Retrieves data from database in a worker thread, and continues in
+     * onRetrieved().
      *
      * @param[in] username The username.
      */
     void retrieveData(const QString &username);
 
     /**
-     * Loads incident data from database.
+     * Loads incident data from database in a worker thread, and applies only
+     * the changes to the active incidents.
      *
      * @param[in] id The incident ID. Omit to load all open incidents.
      */
@@ -243,6 +246,21 @@ protected:
     bool eventFilter(QObject *obj, QEvent *event);
 
 private:
+    typedef std::vector<IncidentData *> DataListT;
+
+    //data retrieved by retrieveData() in a worker thread
+    struct RetrievedT
+    {
+        RetrievedT() : ok(false), loaded(false), lockedId(0) {}
+
+        bool            ok;         //categories and states retrieved
+        bool            loaded;     //incidents retrieved
+        int             lockedId;   //unreleased lock from previous session
+        DbInt::DataMapT categories;
+        DbInt::DataMapT states;
+        DataListT       incidents;
+    };
+
     Ui::Incident                   *ui;
     ActiveIncidents                *mActiveInc;
     AudioPlayer                    *mAudioPlayer;
@@ -257,11 +275,42 @@ private:
     IncidentData                   *mData;
     int                             mServerIssi;
     bool                            mRscSelEnabled;
+    quint64                         mRetrieveSeq; //to discard stale results
     QString                         mUserName;
     std::set<int>                   mUpdatedFields;
     //key: state name, value: state code
     std::map<QString, std::string>  mStates;
 
+    /**
+     * Sets up the UI and filters with the data retrieved by retrieveData(),
+     * and applies the loaded incidents.
+     *
+     * @param[in,out] rd The data. The incidents are taken over.
+     */
+    void onRetrieved(RetrievedT &rd);
+
+    /**
+     * Queries incident data from database. Thread-safe.
+     *
+     * @param[in]  id     The incident ID, or 0 for all open incidents.
+     * @param[out] data   The valid incidents applicable to this client, in
+     *                    result order. Caller takes ownership.
+     * @param[in]  logger The logger.
+     * @return false if the query failed.
+     */
+    static bool fetchData(int id, DataListT &data, Logger *logger);
+
+    /**
+     * Applies loaded incident data. Incidents that are unchanged, or older
+     * than the current data, are discarded without touching the UI.
+     *
+     * @param[in]     id   The incident ID, or 0 if data contains all open
+     *                     incidents, in which case incidents missing from it
+     *                     are closed.
+     * @param[in,out] data The data. Taken over, and cleared on return.
+     */
+    void applyData(int id, DataListT &data);
+
     /**
      * Clears some fields to allow creation of a new incident.
      *
@@ -122,6 +122,29 @@ mLongitude(INVALID_LATLON)
     res->getFieldValue(DbInt::FIELD_LOCK_HOLDER, mLockHolder, row);
 }
 
+bool IncidentData::operator==(const IncidentData &other) const
+{
+    return (mId == other.mId && mPriority == other.mPriority &&
+            mState == other.mState && mLockHolder == other.mLockHolder &&
+            mLatitude == other.mLatitude && mLongitude == other.mLongitude &&
+            mCallRecvDate == other.mCallRecvDate &&
+            mCloseDate == other.mCloseDate &&
+            mDispatchDate == other.mDispatchDate &&
+            mOnSceneDate == other.mOnSceneDate &&
+            mCallRecvTime == other.mCallRecvTime &&
+            mCloseTime == other.mCloseTime &&
+            mDispatchTime == other.mDispatchTime &&
+            mOnSceneTime == other.mOnSceneTime &&
+            mCallCardNum == other.mCallCardNum &&
+            mAddress1 == other.mAddress1 && mAddress2 == other.mAddress2 &&
+            mAddrState == other.mAddrState && mCategory == other.mCategory &&
+            mCreatedBy == other.mCreatedBy &&
+            mDescription == other.mDescription &&
+            mUpdatedBy == other.mUpdatedBy &&
+            mUpdateDateTime == other.mUpdateDateTime &&
+            mResources == other.mResources);
+}
+
 void IncidentData::setAddress(const QString &addr1,
                               const QString &addr2,
                               const QString &state)
@@ -55,6 +55,19 @@ public:
      */
     IncidentData(DbInt::QResult *res, int row);
 
+    /**
+     * Compares all fields, to detect changes in reloaded data.
+     *
+     * @param[in] other The other data.
+     * @return true if equal.
+     */
+    bool operator==(const IncidentData &other) const;
+
+    bool operator!=(const IncidentData &other) const
+    {
+        return !(*this == other);
+    }
+
     bool isValid() const { return (mId > 0); }
 
     /**
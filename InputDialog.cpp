@@ -120,7 +120,15 @@ QDialog(parent), mType(TYPE_SEARCH_RESULTS), mLayer(layer), mItemMdl(itemMdl)
         setWindowTitle(tr("Resources near %1").arg(loc));
         layout->addWidget(new QLabel(QtUtils::getTimestamp(), this));
         tv->setMinimumSize(400, 100);
-        tv->sortByColumn(COL_TERM_DISTANCE, Qt::AscendingOrder);
+        if (itemMdl->horizontalHeaderItem(COL_TERM_ETA) == 0)
+        {
+            tv->hideColumn(COL_TERM_ETA);
+            tv->sortByColumn(COL_TERM_DISTANCE, Qt::AscendingOrder);
+        }
+        else
+        {
+            tv->sortByColumn(COL_TERM_ETA, Qt::AscendingOrder);
+        }
         tv->setSortingEnabled(true);
     }
     else
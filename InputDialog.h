@@ -55,6 +55,7 @@ public:
         COL_TERM_ID = 0,
         COL_TERM_DISTANCE,
         COL_TERM_DATETIME,
+        COL_TERM_ETA,      //only with road network travel times
         COL_TERM_ITEM,
         COL_TERM_NUM
     };
@@ -252,6 +252,14 @@ size_t Logger::getMaxFileCount()
     return mMaxFileCount;
 }
 
+size_t Logger::getQueueSize()
+{
+    PalLock::take(&mDataQueueLock);
+    size_t sz = mDataQueue.size();
+    PalLock::release(&mDataQueueLock);
+    return sz;
+}
+
 void Logger::setLevel(LogLevel level)
 {
     mLevel = level;
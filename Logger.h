@@ -244,6 +244,13 @@ public:
      */
     size_t getMaxFileCount();
 
+    /**
+     * Gets the number of messages waiting to be written.
+     *
+     * @return The number.
+     */
+    size_t getQueueSize();
+
     /**
      * Sets the log level by value.
      *
@@ -29,14 +29,19 @@
 #include "CmnTypes.h"
 #include "CommsRegister.h"
 #include "DbInt.h"
+#include "GisTileCache.h"
 #include "GpsMonitor.h"
 #include "MessageDialog.h"
+#include "Metrics.h"
+#include "MsgJournal.h"
 #include "Props.h"
 #include "QtUtils.h"
 #include "ResourceData.h"
 #include "Settings.h"
+#include "SocketLoop.h"
 #include "Style.h"
 #include "SubsData.h"
+#include "ThumbnailCache.h"
 #include "Updater.h"
 #include "Version.h"
 #include "VideoDevice.h"
@@ -47,6 +52,7 @@ using namespace std;
 
 static const int MAX_LOGIN_FAILS = 3;
 static const int BROADCAST_SSI   = ServerSession::BROADCAST_SSI;
+static const int STALL_TIMER_MS  = 100;
 
 static const string LOGPREFIX("MainWindow:: ");
 
@@ -54,6 +60,17 @@ static const QString ICON_ONLINE  (":/Images/images/icon_stat_online.png");
 static const QString ICON_OFFLINE (":/Images/images/icon_stat_offline.png");
 static const QString ICON_VOIP_OFF(":/Images/images/icon_stat_voip_off.png");
 
+/**
+ * Metrics sampler for the logger queue size.
+ *
+ * @param[in] obj The Logger.
+ */
+static void sampleLogger(void *obj)
+{
+    Metrics::gauge("scad_logger_queue_size")
+        .set(static_cast<Logger *>(obj)->getQueueSize());
+}
+
 //keys for mMdiSubs
 enum eSubWindow
 {
@@ -67,7 +84,8 @@ enum eSubWindow
 
 MainWindow::MainWindow(QWidget *parent) :
 QMainWindow(parent), ui(new Ui::MainWindow), mLoginFailCount(0), mSession(0),
-mGisWindow(0), mLogin(0), mProc(0), mPoi(0)
+mGisWindow(0), mLogin(0), mProc(0), mPoi(0), mMsgDispatcher(0),
+mMsgDispatchPending(false), mStallTickUs(0)
 {
     Style::init();
     mSettingsUi = new SettingsUi();
@@ -91,9 +109,32 @@ mGisWindow(0), mLogin(0), mProc(0), mPoi(0)
     mLogger = new Logger(cfg.get<string>(Props::FLD_CFG_LOGFILE));
     LOGGER_RAW(mLogger, Version::logHeader());
     Updater::setLogger(mLogger);
+    SocketLoop::setLogger(mLogger);
     ResourceData::init(mLogger);
     ServerSession::setVersion(Version::APP_VERSION.toStdString());
+    ThumbnailCache::instance().setQuota(
+                                cfg.get<int>(Props::FLD_CFG_MMS_THUMBCACHE));
     mSettingsUi->setLogger(mLogger);
+    Metrics::addSampler(sampleLogger, mLogger);
+    string metricsFile(cfg.get<string>(Props::FLD_CFG_METRICS_FILE));
+    if (!metricsFile.empty())
+    {
+        Metrics::startExport(mLogger, metricsFile,
+                             cfg.get<int>(Props::FLD_CFG_METRICS_INTERVAL));
+        //a late tick means the GUI thread was busy for that long
+        mStallTimer.setInterval(STALL_TIMER_MS);
+        connect(&mStallTimer, &QTimer::timeout, this,
+                [this]
+                {
+                    long long now = Metrics::nowUs();
+                    static Metrics::Histogram &h(Metrics::histogram(
+                                                     "scad_gui_stall_us"));
+                    h.record(now - mStallTickUs - STALL_TIMER_MS * 1000);
+                    mStallTickUs = now;
+                });
+        mStallTickUs = Metrics::nowUs();
+        mStallTimer.start();
+    }
     string macs;
     foreach (QNetworkInterface ni, QNetworkInterface::allInterfaces())
     {
@@ -192,30 +233,24 @@ mGisWindow(0), mLogin(0), mProc(0), mPoi(0)
     connect(ui->monIndList, SIGNAL(customContextMenuRequested(QPoint)),
             SLOT(showMonContextMenu(QPoint)));
     int val = cfg.get<int>(Props::FLD_CFG_MSG_TMR_INTERVAL);
-    if (val < 0)
+    if (val <= 0)
     {
         //msg timer disabled - use signal/slot
         connect(this, SIGNAL(serverMsg(MsgSp*)), SLOT(onServerMsg(MsgSp*)));
     }
     else
     {
-        PalLock::init(&mMsgQueueLock);
+        mMsgDispatcher = new MsgDispatcher(mLogger,
+                                 [](void *obj, MsgSp *msg)
+                                 {
+                                     static_cast<MainWindow *>(obj)
+                                         ->onServerMsg(msg);
+                                 },
+                                 this);
+        //leave at least half of each interval for other events
+        mMsgDispatcher->setBudget((val > 10)? val/2: 5);
         mMsgTimer.setInterval(val);
-        connect(&mMsgTimer, &QTimer::timeout, this,
-                [this]
-                {
-                    MsgSp *m;
-                    PalLock::take(&mMsgQueueLock);
-                    while (!mMsgQueue.empty())
-                    {
-                        //must pop msg first because onServerMsg() may lead to
-                        //deleteSession() which does queue clearing
-                        m = mMsgQueue.front();
-                        mMsgQueue.pop();
-                        onServerMsg(m);
-                    }
-                    PalLock::release(&mMsgQueueLock);
-                });
+        connect(&mMsgTimer, &QTimer::timeout, this, [this] { dispatchMsgs(); });
         //start mMsgTimer just before creating ServerSession
     }
     mResources = new Resources(mLogger);
@@ -530,13 +565,19 @@ MainWindow::~MainWindow()
     delete ui;
     delete mLogin;
     CallWindow::finalize();
+    GisTileCache::destroy();
+    ThumbnailCache::destroy();
+    MsgJournal::destroy();
     Settings::destroy();
     Updater::destroy();
     VideoDevice::destroy();
+    mStallTimer.stop();
+    Metrics::stopExport();
+    Metrics::removeSampler(sampleLogger, mLogger);
+    SocketLoop::stop();
     delete mLogger;
     PalSocket::finalize();
-    if (mMsgTimer.interval() > 0)
-        PalLock::destroy(&mMsgQueueLock);
+    delete mMsgDispatcher;
 }
 
 void MainWindow::serverCallback(void *obj, MsgSp *msg)
@@ -547,20 +588,10 @@ void MainWindow::serverCallback(void *obj, MsgSp *msg)
         return;
     }
     auto *w = static_cast<MainWindow *>(obj);
-    if (w->mMsgTimer.isActive())
-    {
-        PalLock::take(&w->mMsgQueueLock);
-        w->mMsgQueue.push(msg);
-        PalLock::release(&w->mMsgQueueLock);
-    }
-    else if (w->mMsgTimer.interval() <= 0)
-    {
+    if (w->mMsgDispatcher == 0)
         emit w->serverMsg(msg);
-    }
-    else
-    {
+    else if (!w->mMsgDispatcher->post(msg))
         delete msg; //discard because will not be processed
-    }
 }
 
 void MainWindow::onNewCall(int calledType, int ssi, bool doStart)
@@ -1618,6 +1649,7 @@ void MainWindow::onServerMsg(MsgSp *msg)
         }
         case MsgSp::Type::MON_GRP_ATTACH_DETACH:
         {
+            mResources->updateGrpAtt();
             //msg has list of groups affected by the change
             set<int> gssis;
             if (Utils::fromStringWithRange(
@@ -1631,7 +1663,6 @@ void MainWindow::onServerMsg(MsgSp *msg)
                     mGisWindow->terminalsFilterUpdate(gssis);
                 Contact::setGrpActive(gssis);
                 callerId = msg->getFieldInt(MsgSp::Field::ISSI);
-                mResources->addGrpAttachData(false, callerId, gssis);
                 if (GpsMonitor::isMonGrps())
                 {
                     gssis.clear(); //get monitored grps
@@ -2051,14 +2082,9 @@ void MainWindow::onServerMsg(MsgSp *msg)
                 if (val != ResourceData::TYPE_MOBILE)
                     Contact::activate(callerId, false);
             }
+            //GRP_LIST added by SubsData to show grp detachments
             if (msg->hasField(MsgSp::Field::GRP_LIST))
-            {
-                //GRP_LIST added by SubsData to show grp detachments
-                set<int> gssis;
-                if (Utils::fromStringWithRange(
-                        msg->getFieldString(MsgSp::Field::GRP_LIST), gssis) > 0)
-                    mResources->addGrpAttachData(true, callerId, gssis);
-            }
+                mResources->updateGrpAtt();
             break;
         }
         case MsgSp::Type::MON_TX_CEASED:
@@ -2570,6 +2596,7 @@ void MainWindow::onLoginSuccess(bool          stmNwk,
     ui->helpDeskLabel->setStyleSheet(Style::getStyle(Style::OBJ_LABEL_WHITE));
     GpsMonitor::init(mLogger, mSession,
                      cfg.get<string>(Props::FLD_CFG_GPS_MON));
+    MsgJournal::instance().open(mLogger, mUserName.toInt());
     QString str(ResourceData::getClientDspTxt(mUserName.toInt()));
     mCall->getCommsRegister()->setUser(str);
     mCall->setBroadcastPermission(SubsData::getFleet() == SubsData::FLEET_NONE);
@@ -2654,8 +2681,7 @@ void MainWindow::onLoginFailure(MsgSp *msg)
                              msg->getFieldValueString(MsgSp::Field::RESULT));
             break;
     } //switch
-    //active timer indicates from onServerMsg() - lock acquired
-    deleteSession(mSession, mMsgTimer.isActive());
+    deleteSession(mSession);
     QMessageBox::critical(this, tr("Login Failure"), errMsg);
     if (mLoginFailCount >= MAX_LOGIN_FAILS)
     {
@@ -2975,11 +3001,10 @@ void MainWindow::grpUncAttach(int issi, int gssi)
 {
     if (SubsData::grpUncAttach(issi, gssi))
     {
-        set<int> gssis({gssi});
-        mResources->addGrpAttachData(false, issi, gssis);
+        mResources->updateGrpAtt();
         if (GpsMonitor::isMonGrps())
         {
-            gssis.clear(); //now get monitored grps
+            set<int> gssis; //monitored grps
             ResourceData::model(ui->monGrpList)->getIds(gssis);
             GpsMonitor::monGrpsAttDet(issi, gssis);
         }
@@ -3122,6 +3147,7 @@ void MainWindow::logout(bool doExit)
     mDgna->hide();
     mSds->setSession(0);
     mCall->getCommsRegister()->setUser("");
+    MsgJournal::instance().close();
 #ifdef INCIDENT
     mIncident->reset();
 #endif
@@ -3141,8 +3167,11 @@ void MainWindow::logout(bool doExit)
                     ui->idLabel->setText(tr("User ID: ") + nm);
                     ui->idLabel
                       ->setStyleSheet(Style::getStyle(Style::OBJ_LABEL_TITLE));
-                    if (mMsgTimer.interval() > 0)
+                    if (mMsgDispatcher != 0)
+                    {
+                        mMsgDispatcher->setEnabled(true);
                         mMsgTimer.start();
+                    }
                     mSession = new ServerSession(nm.toStdString(),
                                              pswd.toStdString(),
                                              Settings::instance().get<string>(
@@ -3183,8 +3212,7 @@ void MainWindow::doUpdate(MsgSp *msg)
         }
         else
         {
-            //active timer indicates from onServerMsg() - lock acquired
-            deleteSession(mSession, mMsgTimer.isActive());
+            deleteSession(mSession);
         }
         mLogin->hide();
         if (QMessageBox::Yes !=
@@ -3208,21 +3236,30 @@ void MainWindow::doUpdate(MsgSp *msg)
     up.updateApp(forced, msg);
 }
 
-void MainWindow::deleteSession(ServerSession *session, bool haveLock)
+void MainWindow::dispatchMsgs()
+{
+    if (mMsgDispatcher->dispatch() && !mMsgDispatchPending)
+    {
+        //backlog - continue as soon as pending GUI events are processed
+        mMsgDispatchPending = true;
+        QTimer::singleShot(0, this,
+                           [this]
+                           {
+                               mMsgDispatchPending = false;
+                               if (mMsgTimer.isActive())
+                                   dispatchMsgs();
+                           });
+    }
+}
+
+void MainWindow::deleteSession(ServerSession *session)
 {
     QTimer::singleShot(0, this, [=] { delete session; });
     mSession = 0;
     if (mMsgTimer.isActive())
     {
         mMsgTimer.stop();
-        if (!haveLock)
-            PalLock::take(&mMsgQueueLock);
-        while (!mMsgQueue.empty())
-        {
-            delete mMsgQueue.front();
-            mMsgQueue.pop();
-        }
-        if (!haveLock)
-            PalLock::release(&mMsgQueueLock);
+        //safe even if called from onServerMsg() during dispatch
+        mMsgDispatcher->setEnabled(false);
     }
 }
@@ -12,7 +12,6 @@
 #define MAINWINDOW_H
 
 #include <map>
-#include <queue>
 #include <set>
 #include <QCloseEvent>
 #include <QMainWindow>
@@ -33,8 +32,8 @@
 #endif
 #include "Login.h"
 #include "Logger.h"
+#include "MsgDispatcher.h"
 #include "MsgSp.h"
-#include "PalLock.h"
 #include "Poi.h"
 #include "Report.h"
 #include "Resources.h"
@@ -229,8 +228,10 @@ private:
     CallMapT            mCallMap;       //indexed by call ID
     CallWindowMapT      mCallWindowMap; //indexed by called/calling SSI
     QTimer              mMsgTimer;
-    std::queue<MsgSp *> mMsgQueue;
-    PalLock::LockT      mMsgQueueLock;  //guards mMsgQueue access
+    MsgDispatcher      *mMsgDispatcher; //0 if msg timer disabled
+    bool                mMsgDispatchPending;
+    QTimer              mStallTimer;    //for GUI stall measurement
+    long long           mStallTickUs;   //last mStallTimer tick
     std::map<int, QMdiSubWindow *> mMdiSubs;
 
     /**
@@ -525,14 +526,20 @@ private:
      */
     void doUpdate(MsgSp *msg);
 
+    /**
+     * Dispatches queued server messages within the time budget, and
+     * schedules an immediate continuation if more are pending, after other
+     * events have been processed.
+     */
+    void dispatchMsgs();
+
     /**
      * Deletes the server session asynchronously, resets mSession to 0 and
      * clears message queue if necessary.
      *
-     * @param[in] session  Server session.
-     * @param[in] haveLock true if caller is holding mMsgQueueLock.
+     * @param[in] session Server session.
      */
-    void deleteSession(ServerSession *session, bool haveLock = false);
+    void deleteSession(ServerSession *session);
 };
 //use std::string as a signal parameter
 Q_DECLARE_METATYPE(std::string)
@@ -8,13 +8,15 @@
  * @author Mohd Rashid
  * @author Zahari Hadzir
  */
-#include <fstream>
-#include <stdio.h> //sprintf
+#include <stdio.h> //sprintf, fopen
 
 #include "Md5Digest.h"
 
 using namespace std;
 
+//file read size - large reads are much faster than small ones
+static const size_t BLOCKSIZE = 1048576;
+
 static string finalize(MD5_CTX *ctx, bool lowerCase)
 {
     static const int  MD5SIZE = 16;
@@ -62,21 +64,59 @@ string md5Digest(const string &str)
 
 string md5DigestFile(const string &filename)
 {
-    ifstream ifs(filename.c_str(), ios::binary);
-    if (!ifs.is_open())
+    FILE *fp = fopen(filename.c_str(), "rb");
+    if (fp == 0)
         return "";
-    static const int BLOCKSIZE = 1024;
-    char             data[BLOCKSIZE];
-    MD5_CTX          ctx;
-    unsigned int     i;
+    vector<unsigned char> data(BLOCKSIZE);
+    MD5_CTX ctx;
+    size_t  i;
     MD5Init(&ctx);
-    while (!ifs.eof())
+    while ((i = fread(data.data(), 1, BLOCKSIZE, fp)) > 0)
     {
-        ifs.read(data, BLOCKSIZE);
-        i = ifs.gcount();
-        if (i > 0)
-            MD5Update(&ctx, (unsigned char *) data, i);
+        MD5Update(&ctx, data.data(), i);
     }
-    ifs.close();
+    fclose(fp);
     return finalize(&ctx, false);
 }
+
+long long md5DigestChunks(const string   &filename,
+                          long long       chunkSize,
+                          vector<string> &digests)
+{
+    digests.clear();
+    if (chunkSize <= 0)
+        return -1;
+    FILE *fp = fopen(filename.c_str(), "rb");
+    if (fp == 0)
+        return -1;
+    vector<unsigned char> data(BLOCKSIZE);
+    MD5_CTX   ctx;
+    long long total = 0;
+    long long rem = chunkSize;  //remaining bytes in current chunk
+    size_t    i;
+    size_t    n;
+    while ((i = fread(data.data(), 1, BLOCKSIZE, fp)) > 0)
+    {
+        for (n=0; n<i; )
+        {
+            if (rem == chunkSize)
+                MD5Init(&ctx);
+            size_t len = i - n;
+            if (static_cast<long long>(len) > rem)
+                len = static_cast<size_t>(rem);
+            MD5Update(&ctx, data.data() + n, len);
+            n += len;
+            rem -= len;
+            if (rem == 0)
+            {
+                digests.push_back(finalize(&ctx, true));
+                rem = chunkSize;
+            }
+        }
+        total += i;
+    }
+    fclose(fp);
+    if (rem != chunkSize)
+        digests.push_back(finalize(&ctx, true)); //last partial chunk
+    return total;
+}
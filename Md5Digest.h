@@ -12,6 +12,7 @@
 #define MD5DIGEST_H
 
 #include <string>
+#include <vector>
 
 #include "MD5.h"
 
@@ -43,4 +44,16 @@ std::string md5Digest(const std::string &str);
  */
 std::string md5DigestFile(const std::string &filename);
 
+/**
+ * Calculates MD5 digests of consecutive fixed-size chunks of a file.
+ *
+ * @param[in]  filename  The filename.
+ * @param[in]  chunkSize The chunk size. The last chunk may be smaller.
+ * @param[out] digests   Lowercase hexadecimal digest strings.
+ * @return The file size, or -1 on failure.
+ */
+long long md5DigestChunks(const std::string        &filename,
+                          long long                 chunkSize,
+                          std::vector<std::string> &digests);
+
 #endif //MD5DIGEST_H
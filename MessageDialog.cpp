@@ -35,7 +35,8 @@ MessageDialog::MessageDialog(const QString &title,
                              const QIcon   &icon,
                              bool           deleteOnClose,
                              QWidget       *parent) :
-QDialog(parent), ui(new Ui::MessageDialog), mLcdNum(0), mTime(0), mTimer(0)
+QDialog(parent), ui(new Ui::MessageDialog), mLcdNum(0), mTextEdit(0),
+mTime(0), mTimer(0)
 {
     init(title, header, icon, deleteOnClose);
 }
@@ -44,7 +45,8 @@ MessageDialog::MessageDialog(const QString &title,
                              const QIcon   &icon,
                              bool           deleteOnClose,
                              QWidget       *parent) :
-QDialog(parent), ui(new Ui::MessageDialog), mLcdNum(0), mTime(0), mTimer(0)
+QDialog(parent), ui(new Ui::MessageDialog), mLcdNum(0), mTextEdit(0),
+mTime(0), mTimer(0)
 {
     init(title, "", icon, deleteOnClose);
     ui->textLabel->hide();
@@ -56,16 +58,11 @@ MessageDialog::MessageDialog(const QString &title,
                              const QIcon   &icon,
                              bool           deleteOnClose,
                              QWidget       *parent) :
-QDialog(parent), ui(new Ui::MessageDialog), mLcdNum(0), mTime(0), mTimer(0)
+QDialog(parent), ui(new Ui::MessageDialog), mLcdNum(0), mTextEdit(0),
+mTime(0), mTimer(0)
 {
     init(title, header, icon, deleteOnClose);
-    if (!text.isEmpty())
-    {
-        auto *te = new QTextEdit();
-        te->setReadOnly(true);
-        te->setText(text);
-        ui->splitter->addWidget(te);
-    }
+    setText(header, text);
     adjustSize();
 }
 
@@ -151,6 +148,20 @@ void MessageDialog::setData(int timerMinutes, const QString &okBtnText)
     mTimer->start(1000);
 }
 
+void MessageDialog::setText(const QString &header, const QString &text)
+{
+    ui->textLabel->setText(header);
+    if (mTextEdit == 0)
+    {
+        if (text.isEmpty())
+            return;
+        mTextEdit = new QTextEdit();
+        mTextEdit->setReadOnly(true);
+        ui->splitter->addWidget(mTextEdit);
+    }
+    mTextEdit->setText(text);
+}
+
 void MessageDialog::showNoOk(QWidget *widget)
 {
     if (widget != 0)
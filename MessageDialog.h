@@ -15,6 +15,7 @@
 #include <QLCDNumber>
 #include <QMessageBox>
 #include <QStringList>
+#include <QTextEdit>
 #include <QTime>
 #include <QTimer>
 
@@ -98,6 +99,15 @@ public:
      */
     void setData(int timerMinutes, const QString &okBtnText);
 
+    /**
+     * Replaces the message header and text, e.g. to update a dialog that is
+     * kept open.
+     *
+     * @param[in] header The message header.
+     * @param[in] text   The message text.
+     */
+    void setText(const QString &header, const QString &text);
+
     /**
      * Shows this instance without OK button, which means it cannot be dismissed
      * by user, and must be deleted by caller.
@@ -194,6 +204,7 @@ public:
 private:
     Ui::MessageDialog *ui;
     QLCDNumber        *mLcdNum;
+    QTextEdit         *mTextEdit;
     QTime             *mTime;
     QTimer            *mTimer;
 
@@ -0,0 +1,428 @@
+/**
+ * Runtime metrics registry implementation.
+ *
+ * Copyright (C) Sapura Secured Technologies, 2026. All Rights Reserved.
+ *
+ * @file
+ * @version $Id$
+ * @author agent <agent@local>
+ */
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <stdio.h>      //rename, remove
+#include <time.h>
+#include <assert.h>
+
+#include "Metrics.h"
+
+using namespace std;
+
+static const string LOGPREFIX("Metrics:: ");
+
+const double Metrics::Histogram::QUANTILES[] = { 0.5, 0.9, 0.99 };
+
+Metrics::RegistryT  Metrics::sRegistry;
+Metrics::SamplersT  Metrics::sSamplers;
+Logger             *Metrics::sLogger(0);
+string              Metrics::sFilename;
+int                 Metrics::sInterval(DEF_INTERVAL);
+atomic<bool>        Metrics::sExporting(false);
+PalThread::ThreadT  Metrics::sThread;
+
+#ifdef QT_CORE_LIB
+PalLock::LockT Metrics::sLock;
+PalLock::LockT Metrics::sExportLock;
+#else
+PalLock::LockT Metrics::sLock = PTHREAD_MUTEX_INITIALIZER;
+PalLock::LockT Metrics::sExportLock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+/**
+ * Escapes a string for a Prometheus label value or JSON string.
+ *
+ * @param[in] str The string.
+ * @return The escaped string.
+ */
+static string escape(const string &str)
+{
+    string s;
+    for (auto c : str)
+    {
+        if (c == '"' || c == '\\')
+            s.push_back('\\');
+        if (c == '\n')
+            s.append("\\n");
+        else
+            s.push_back(c);
+    }
+    return s;
+}
+
+Metrics::Histogram::Histogram() : mCount(0), mSum(0), mMax(0)
+{
+    for (auto &b : mBuckets)
+    {
+        b.store(0, memory_order_relaxed);
+    }
+}
+
+void Metrics::Histogram::record(long long val)
+{
+    if (val < 0)
+        val = 0;
+    mBuckets[getBucket(val)].fetch_add(1, memory_order_relaxed);
+    mCount.fetch_add(1, memory_order_relaxed);
+    mSum.fetch_add(val, memory_order_relaxed);
+    long long m = mMax.load(memory_order_relaxed);
+    while (val > m &&
+           !mMax.compare_exchange_weak(m, val, memory_order_relaxed))
+        ;
+}
+
+void Metrics::Histogram::getStats(unsigned long long &count,
+                                  long long          &sum,
+                                  long long          &max,
+                                  long long           q[QUANTILE_COUNT]) const
+{
+    unsigned long long counts[BUCKET_COUNT];
+    count = 0;
+    int i = 0;
+    for (; i<BUCKET_COUNT; ++i)
+    {
+        counts[i] = mBuckets[i].load(memory_order_relaxed);
+        count += counts[i];
+    }
+    sum = mSum.load(memory_order_relaxed);
+    max = mMax.load(memory_order_relaxed);
+    unsigned long long n = 0;
+    int j = 0;
+    for (i=0; i<QUANTILE_COUNT; ++i)
+    {
+        if (count == 0)
+        {
+            q[i] = 0;
+            continue;
+        }
+        //rank of the quantile, 1-based
+        unsigned long long rank =
+                        static_cast<unsigned long long>(QUANTILES[i] * count);
+        if (rank == 0)
+            rank = 1;
+        for (; j<BUCKET_COUNT; ++j)
+        {
+            if (n + counts[j] >= rank)
+                break;
+            n += counts[j];
+        }
+        q[i] = (j < BUCKET_COUNT)? getBucketMax(j): max;
+        if (q[i] > max)
+            q[i] = max;
+    }
+}
+
+int Metrics::Histogram::getBucket(unsigned long long val)
+{
+    if (val < SUB_COUNT)
+        return static_cast<int>(val);
+    //position of highest bit
+    int e = 0;
+    unsigned long long v = val;
+    if (v >> 32) { v >>= 32; e += 32; }
+    if (v >> 16) { v >>= 16; e += 16; }
+    if (v >> 8)  { v >>= 8;  e += 8; }
+    if (v >> 4)  { v >>= 4;  e += 4; }
+    if (v >> 2)  { v >>= 2;  e += 2; }
+    if (v >> 1)  { e += 1; }
+    return (e - SUB_BITS + 1) * SUB_COUNT +
+           static_cast<int>((val >> (e - SUB_BITS)) & (SUB_COUNT - 1));
+}
+
+long long Metrics::Histogram::getBucketMax(int idx)
+{
+    if (idx < SUB_COUNT)
+        return idx;
+    int e = idx / SUB_COUNT + SUB_BITS - 1;
+    long long lo = static_cast<long long>(SUB_COUNT + idx % SUB_COUNT) <<
+                   (e - SUB_BITS);
+    return lo + (1LL << (e - SUB_BITS)) - 1;
+}
+
+Metrics::Counter &Metrics::counter(const string &name,
+                                   const string &label,
+                                   const string &value)
+{
+    return *static_cast<Counter *>(get(TYPE_COUNTER, name, label, value));
+}
+
+Metrics::Gauge &Metrics::gauge(const string &name,
+                               const string &label,
+                               const string &value)
+{
+    return *static_cast<Gauge *>(get(TYPE_GAUGE, name, label, value));
+}
+
+Metrics::Histogram &Metrics::histogram(const string &name,
+                                       const string &label,
+                                       const string &value)
+{
+    return *static_cast<Histogram *>(get(TYPE_HISTOGRAM, name, label, value));
+}
+
+void Metrics::addSampler(SamplerFn fn, void *obj)
+{
+    assert(fn != 0);
+    PalLock::take(&sLock);
+    sSamplers.push_back(make_pair(fn, obj));
+    PalLock::release(&sLock);
+}
+
+void Metrics::removeSampler(SamplerFn fn, void *obj)
+{
+    PalLock::take(&sLock);
+    auto it = sSamplers.begin();
+    while (it != sSamplers.end())
+    {
+        if (it->first == fn && it->second == obj)
+            it = sSamplers.erase(it);
+        else
+            ++it;
+    }
+    PalLock::release(&sLock);
+}
+
+bool Metrics::startExport(Logger       *logger,
+                          const string &filename,
+                          int           intervalSec)
+{
+    if (logger == 0 || filename.empty())
+    {
+        assert("Bad param in Metrics::startExport" == 0);
+        return false;
+    }
+    stopExport();
+    PalLock::take(&sExportLock);
+    sLogger = logger;
+    sFilename = filename;
+    sInterval = (intervalSec > 0)? intervalSec: DEF_INTERVAL;
+    sExporting = true;
+    bool ok = (PalThread::start(&sThread, startExportThread, 0) == 0);
+    if (!ok)
+        sExporting = false;
+    PalLock::release(&sExportLock);
+    if (ok)
+        LOGGER_INFO(logger, LOGPREFIX << "Exporting to " << filename
+                    << " every " << sInterval << "s");
+    else
+        LOGGER_ERROR(logger, LOGPREFIX << "Failed to start export thread");
+    return ok;
+}
+
+void Metrics::stopExport()
+{
+    PalLock::take(&sExportLock);
+    if (sExporting)
+    {
+        sExporting = false;
+        PalThread::stop(sThread);
+        exportFile();
+    }
+    PalLock::release(&sExportLock);
+}
+
+string Metrics::toPrometheus()
+{
+    ostringstream os;
+    unsigned long long count;
+    long long          sum;
+    long long          max;
+    long long          q[Histogram::QUANTILE_COUNT];
+    string             lbl;
+    string             prevName;
+    int                i;
+    PalLock::take(&sLock);
+    for (const auto &it : sRegistry)
+    {
+        const EntryT &e(it.second);
+        lbl.clear();
+        if (!e.label.empty())
+            lbl.append(e.label).append("=\"").append(escape(e.value))
+               .append("\"");
+        if (e.name != prevName)
+        {
+            prevName = e.name;
+            os << "# TYPE " << e.name << ' '
+               << ((e.type == TYPE_COUNTER)?
+                   "counter": (e.type == TYPE_GAUGE)? "gauge": "summary")
+               << '\n';
+        }
+        switch (e.type)
+        {
+            case TYPE_COUNTER:
+                os << e.name;
+                if (!lbl.empty())
+                    os << '{' << lbl << '}';
+                os << ' ' << static_cast<Counter *>(e.metric)->get() << '\n';
+                break;
+            case TYPE_GAUGE:
+                os << e.name;
+                if (!lbl.empty())
+                    os << '{' << lbl << '}';
+                os << ' ' << static_cast<Gauge *>(e.metric)->get() << '\n';
+                break;
+            default:
+                static_cast<Histogram *>(e.metric)->getStats(count, sum, max,
+                                                             q);
+                for (i=0; i<Histogram::QUANTILE_COUNT; ++i)
+                {
+                    os << e.name << '{' << lbl << ((lbl.empty())? "": ",")
+                       << "quantile=\"" << Histogram::QUANTILES[i] << "\"} "
+                       << q[i] << '\n';
+                }
+                if (!lbl.empty())
+                    lbl = '{' + lbl + '}';
+                os << e.name << "_sum" << lbl << ' ' << sum << '\n'
+                   << e.name << "_count" << lbl << ' ' << count << '\n';
+                break;
+        }
+    }
+    PalLock::release(&sLock);
+    return os.str();
+}
+
+string Metrics::toJson()
+{
+    ostringstream os;
+    unsigned long long count;
+    long long          sum;
+    long long          max;
+    long long          q[Histogram::QUANTILE_COUNT];
+    int                i;
+    os << "{\"time\":" << time(0) << ",\"metrics\":[";
+    PalLock::take(&sLock);
+    for (auto it=sRegistry.begin(); it!=sRegistry.end(); ++it)
+    {
+        const EntryT &e(it->second);
+        if (it != sRegistry.begin())
+            os << ',';
+        os << "\n{\"name\":\"" << e.name << '"';
+        if (!e.label.empty())
+            os << ",\"labels\":{\"" << e.label << "\":\"" << escape(e.value)
+               << "\"}";
+        switch (e.type)
+        {
+            case TYPE_COUNTER:
+                os << ",\"type\":\"counter\",\"value\":"
+                   << static_cast<Counter *>(e.metric)->get();
+                break;
+            case TYPE_GAUGE:
+                os << ",\"type\":\"gauge\",\"value\":"
+                   << static_cast<Gauge *>(e.metric)->get();
+                break;
+            default:
+                static_cast<Histogram *>(e.metric)->getStats(count, sum, max,
+                                                             q);
+                os << ",\"type\":\"histogram\",\"count\":" << count
+                   << ",\"sum\":" << sum << ",\"max\":" << max;
+                for (i=0; i<Histogram::QUANTILE_COUNT; ++i)
+                {
+                    os << ",\"p" << Histogram::QUANTILES[i] * 100 << "\":"
+                       << q[i];
+                }
+                break;
+        }
+        os << '}';
+    }
+    PalLock::release(&sLock);
+    os << "\n]}\n";
+    return os.str();
+}
+
+long long Metrics::nowUs()
+{
+    return chrono::duration_cast<chrono::microseconds>(
+                      chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void *Metrics::get(int           type,
+                   const string &name,
+                   const string &label,
+                   const string &value)
+{
+    string key(name);
+    if (!label.empty())
+        key.append("{").append(label).append("=").append(value).append("}");
+    PalLock::take(&sLock);
+    auto it = sRegistry.find(key);
+    if (it == sRegistry.end())
+    {
+        EntryT e;
+        e.type = type;
+        e.name = name;
+        e.label = label;
+        e.value = value;
+        switch (type)
+        {
+            case TYPE_COUNTER:
+                e.metric = new Counter();
+                break;
+            case TYPE_GAUGE:
+                e.metric = new Gauge();
+                break;
+            default:
+                e.metric = new Histogram();
+                break;
+        }
+        it = sRegistry.insert(make_pair(key, e)).first;
+    }
+    //a name must not be reused for a different type
+    assert(it->second.type == type);
+    void *m = it->second.metric;
+    PalLock::release(&sLock);
+    return m;
+}
+
+void *Metrics::startExportThread(void *)
+{
+    int n = 0;
+    while (sExporting)
+    {
+        PalThread::msleep(1000);
+        if (++n >= sInterval && sExporting)
+        {
+            n = 0;
+            exportFile();
+        }
+    }
+    return 0;
+}
+
+void Metrics::exportFile()
+{
+    PalLock::take(&sLock);
+    SamplersT samplers(sSamplers);
+    PalLock::release(&sLock);
+    for (auto &s : samplers)
+    {
+        s.first(s.second);
+    }
+    bool isJson = (sFilename.size() > 5 &&
+                   sFilename.compare(sFilename.size() - 5, 5, ".json") == 0);
+    string data((isJson)? toJson(): toPrometheus());
+    string tmp(sFilename + ".tmp");
+    ofstream ofs(tmp.c_str(), ios::binary | ios::trunc);
+    if (ofs)
+        ofs << data;
+    ofs.close();
+    if (!ofs)
+    {
+        LOGGER_ERROR(sLogger, LOGPREFIX << "Failed to write " << tmp);
+        return;
+    }
+#ifdef _WIN32
+    //rename() does not replace on Windows
+    remove(sFilename.c_str());
+#endif
+    if (rename(tmp.c_str(), sFilename.c_str()) != 0)
+        LOGGER_ERROR(sLogger, LOGPREFIX << "Failed to rename " << tmp);
+}
@@ -0,0 +1,273 @@
+/**
+ * Registry of runtime metrics - counters, gauges and latency histograms,
+ * with periodic export to a file.
+ * Metrics are created on first lookup and live until the process ends, so
+ * callers may keep the returned references. Updates are lock-free, and
+ * only lookups take a lock.
+ * Histograms are log-linear with 8 sub-buckets per power of 2, giving
+ * quantiles within 12.5% of the recorded values.
+ * The export file is in Prometheus text format, or JSON if the filename
+ * ends with ".json". It is replaced atomically, so a collector may read it
+ * at any time.
+ *
+ * Copyright (C) Sapura Secured Technologies, 2026. All Rights Reserved.
+ *
+ * @file
+ * @version $Id$
+ * @author agent <agent@local>
+ */
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Logger.h"
+#include "PalLock.h"
+#include "PalThread.h"
+
+class Metrics
+{
+public:
+    class Counter
+    {
+    public:
+        Counter() : mVal(0) {}
+
+        void add(unsigned long long n = 1)
+        {
+            mVal.fetch_add(n, std::memory_order_relaxed);
+        }
+
+        unsigned long long get() const
+        {
+            return mVal.load(std::memory_order_relaxed);
+        }
+
+    private:
+        std::atomic<unsigned long long> mVal;
+    };
+
+    class Gauge
+    {
+    public:
+        Gauge() : mVal(0) {}
+
+        void set(long long val) { mVal.store(val, std::memory_order_relaxed); }
+
+        void add(long long n) { mVal.fetch_add(n, std::memory_order_relaxed); }
+
+        long long get() const { return mVal.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<long long> mVal;
+    };
+
+    class Histogram
+    {
+    public:
+        //exported quantiles
+        static const int QUANTILE_COUNT = 3;
+        static const double QUANTILES[QUANTILE_COUNT];
+
+        Histogram();
+
+        /**
+         * Records a value.
+         *
+         * @param[in] val The value. Negative is taken as 0.
+         */
+        void record(long long val);
+
+        /**
+         * Gets a snapshot of the statistics. Concurrent records may be
+         * partially included.
+         *
+         * @param[out] count The number of values.
+         * @param[out] sum   The sum of values.
+         * @param[out] max   The maximum value.
+         * @param[out] q     The QUANTILES values, as the upper bounds of
+         *                   their buckets but not exceeding max.
+         */
+        void getStats(unsigned long long &count,
+                      long long          &sum,
+                      long long          &max,
+                      long long           q[QUANTILE_COUNT]) const;
+
+    private:
+        static const int SUB_BITS = 3;
+        static const int SUB_COUNT = 1 << SUB_BITS;
+        static const int BUCKET_COUNT = (64 - SUB_BITS) * SUB_COUNT;
+
+        std::atomic<unsigned long long> mBuckets[BUCKET_COUNT];
+        std::atomic<unsigned long long> mCount;
+        std::atomic<long long>          mSum;
+        std::atomic<long long>          mMax;
+
+        /**
+         * Gets the bucket index of a value.
+         *
+         * @param[in] val The value, non-negative.
+         * @return The index.
+         */
+        static int getBucket(unsigned long long val);
+
+        /**
+         * Gets the highest value in a bucket.
+         *
+         * @param[in] idx The bucket index.
+         * @return The value.
+         */
+        static long long getBucketMax(int idx);
+    };
+
+    //function to update gauges just before each export
+    typedef void (*SamplerFn)(void *obj);
+
+    /**
+     * Gets a counter, creating it if necessary.
+     *
+     * @param[in] name  The metric name.
+     * @param[in] label The label name, if any.
+     * @param[in] value The label value.
+     * @return The counter.
+     */
+    static Counter &counter(const std::string &name,
+                            const std::string &label = "",
+                            const std::string &value = "");
+
+    /**
+     * Gets a gauge, creating it if necessary.
+     *
+     * @param[in] name  The metric name.
+     * @param[in] label The label name, if any.
+     * @param[in] value The label value.
+     * @return The gauge.
+     */
+    static Gauge &gauge(const std::string &name,
+                        const std::string &label = "",
+                        const std::string &value = "");
+
+    /**
+     * Gets a histogram, creating it if necessary.
+     *
+     * @param[in] name  The metric name.
+     * @param[in] label The label name, if any.
+     * @param[in] value The label value.
+     * @return The histogram.
+     */
+    static Histogram &histogram(const std::string &name,
+                                const std::string &label = "",
+                                const std::string &value = "");
+
+    /**
+     * Adds a sampler function, called in the export thread.
+     *
+     * @param[in] fn  The function.
+     * @param[in] obj The object to pass to the function.
+     */
+    static void addSampler(SamplerFn fn, void *obj);
+
+    /**
+     * Removes a sampler function.
+     *
+     * @param[in] fn  The function.
+     * @param[in] obj The object.
+     */
+    static void removeSampler(SamplerFn fn, void *obj);
+
+    /**
+     * Starts the periodic export, stopping any running one first.
+     *
+     * @param[in] logger      Logger object.
+     * @param[in] filename    The export file path.
+     * @param[in] intervalSec The export interval in seconds. 0 for default.
+     * @return true if successful.
+     */
+    static bool startExport(Logger            *logger,
+                            const std::string &filename,
+                            int                intervalSec = 0);
+
+    /**
+     * Stops the periodic export, after a final export.
+     */
+    static void stopExport();
+
+    /**
+     * Gets all metrics in Prometheus text format.
+     *
+     * @return The text.
+     */
+    static std::string toPrometheus();
+
+    /**
+     * Gets all metrics in JSON format.
+     *
+     * @return The JSON string.
+     */
+    static std::string toJson();
+
+    /**
+     * Gets the current monotonic time for latency measurement.
+     *
+     * @return The time in microseconds.
+     */
+    static long long nowUs();
+
+private:
+    enum eType
+    {
+        TYPE_COUNTER,
+        TYPE_GAUGE,
+        TYPE_HISTOGRAM
+    };
+
+    struct EntryT
+    {
+        int          type;
+        std::string  name;
+        std::string  label;
+        std::string  value;
+        void        *metric;
+    };
+
+    //key is name with label
+    typedef std::map<std::string, EntryT>            RegistryT;
+    typedef std::vector<std::pair<SamplerFn, void *> > SamplersT;
+
+    static const int DEF_INTERVAL = 60; //seconds
+
+    static RegistryT          sRegistry;
+    static SamplersT          sSamplers;
+    static PalLock::LockT     sLock;       //guards all above
+    static PalLock::LockT     sExportLock; //guards all below
+    static Logger            *sLogger;
+    static std::string        sFilename;
+    static int                sInterval;
+    static std::atomic<bool>  sExporting;
+    static PalThread::ThreadT sThread;
+
+    /**
+     * Gets a registry entry, creating it if necessary.
+     *
+     * @param[in] type  The metric type - eType.
+     * @param[in] name  The metric name.
+     * @param[in] label The label name, if any.
+     * @param[in] value The label value.
+     * @return The metric object.
+     */
+    static void *get(int                type,
+                     const std::string &name,
+                     const std::string &label,
+                     const std::string &value);
+
+    static void *startExportThread(void *arg);
+
+    /**
+     * Calls the samplers and writes the export file.
+     */
+    static void exportFile();
+};
+#endif //METRICS_H
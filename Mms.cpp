@@ -200,7 +200,7 @@ QString Mms::rcv(MsgSp *msg)
             string path; //local path
             if (ok)
             {
-                //see MmsClient::dlThread()
+                //see MmsClient::dlEnd()
                 path = msg->getFieldString(MsgSp::Field::USER_DEFINED_DATA_1);
                 msg->removeField(MsgSp::Field::USER_DEFINED_DATA_1);
             }
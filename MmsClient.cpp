@@ -14,6 +14,7 @@
 #include <time.h>   //time_t, time()
 
 #include "PalThread.h"
+#include "SocketLoop.h"
 #include "Utils.h"
 #include "MmsClient.h"
 
@@ -21,26 +22,12 @@
 
 using namespace std;
 
-struct DlThreadParam
-{
-    DlThreadParam(MmsClient *o, int c) : obj(o), ctx(c) {}
-
-    MmsClient *obj; //this object
-    int        ctx; //download context ID
-};
-
-static void *startDlThread(void *arg)
-{
-    auto *p = static_cast<DlThreadParam *>(arg);
-    MmsClient *obj = p->obj;
-    int ctx = p->ctx;
-    delete p;
-    obj->dlThread(ctx);
-    return 0;
-}
-
 static const string LOGPREFIX("MmsClient::");
 
+static const int DL_RETRY_MS    = 100;  //delay before reconnecting
+static const int DL_TIMEOUT_MS  = 5000; //receive timeout
+static const int DL_MAX_TIMEOUT = 5;    //successive timeouts to declare failure
+
 #ifdef MOBILE
 #define MSGCB(arg) mCbFn(arg)
 static ostringstream sOss;
@@ -57,6 +44,7 @@ static ostringstream sOss;
 MmsClient::MmsClient(Logger *logger, CallbackFn cbFn, StrCallbackFn strCbFn) :
 mStopped(false), mSvrPort(0), mLogger(logger), mCbFn(cbFn), mStrCbFn(strCbFn)
 {
+    PalLock::init(&mRxLock);
 }
 
 #else //MOBILE
@@ -72,6 +60,7 @@ mCbFn(cbFn)
         assert("Bad param in MmsClient::MmsClient" == NULL);
         return;
     }
+    PalLock::init(&mRxLock);
 }
 #endif //MOBILE
 
@@ -84,16 +73,16 @@ MmsClient::~MmsClient()
         delete it.second.sock;
     }
     //stop ongoing download
-    for (auto &it : mRxCtxMap)
+    map<int, RxCtx> rxMap;
+    PalLock::take(&mRxLock);
+    rxMap.swap(mRxCtxMap);
+    PalLock::release(&mRxLock);
+    for (auto &it : rxMap)
     {
         delete it.second.msg;
-        it.second.msg = 0;
-        PalThread::stop(it.second.tId);
-        fclose(it.second.fp);
-#ifndef MOBILE
-        remove(it.second.fPath.c_str()); //delete local file
-#endif
+        rxStop(it.second);
     }
+    PalLock::destroy(&mRxLock);
     LOGGER_DEBUG(mLogger, LOGPREFIX << " Destroyed");
 }
 
@@ -102,10 +91,12 @@ int MmsClient::rxStart(MsgSp *msg, FILE *fp, const std::string &path)
 {
     int ctx = getNewContext();
     LOGX(DEBUG, LOGPREFIX << "rxStart [" << ctx << "]");
-    PalThread::ThreadT tid;
-    PalThread::start(&tid, startDlThread, new DlThreadParam(this, ctx));
-    mRxCtxMap[ctx] = RxCtx(path, tid, msg, fp);
     msg->addField(MsgSp::Field::ID, ctx); //internal use
+    PalLock::take(&mRxLock);
+    MsgSp *m = dlStart(ctx, mRxCtxMap[ctx] = RxCtx(path, msg, fp));
+    PalLock::release(&mRxLock);
+    if (m != 0)
+        MSGCB(m);
     return ctx;
 }
 
@@ -178,10 +169,12 @@ MsgSp *MmsClient::rxMsg(const MsgSp *msg, string &path, MsgSp *resp)
     {
         int ctx = getNewContext();
         LOGGER_DEBUG(mLogger, LOGPREFIX << "rxMsg: Download [" << ctx << "]");
-        PalThread::ThreadT tid;
-        PalThread::start(&tid, startDlThread, new DlThreadParam(this, ctx));
-        mRxCtxMap[ctx] = RxCtx(path, tid, resp, fp);
         resp->addField(MsgSp::Field::ID, ctx); //internal use
+        PalLock::take(&mRxLock);
+        MsgSp *m = dlStart(ctx, mRxCtxMap[ctx] = RxCtx(path, resp, fp));
+        PalLock::release(&mRxLock);
+        if (m != 0)
+            MSGCB(m);
     }
     return resp;
 }
@@ -189,199 +182,19 @@ MsgSp *MmsClient::rxMsg(const MsgSp *msg, string &path, MsgSp *resp)
 
 void MmsClient::rxEnd(int ctx)
 {
-    if (mRxCtxMap.count(ctx) == 0)
+    PalLock::take(&mRxLock);
+    auto it = mRxCtxMap.find(ctx);
+    if (it == mRxCtxMap.end())
     {
+        PalLock::release(&mRxLock);
         LOGX(ERROR, LOGPREFIX << "rxEnd: Invalid ctx " << ctx);
+        return;
     }
-    else
-    {
-        LOGX(DEBUG, LOGPREFIX << "rxEnd [" << ctx << "]");
-        PalThread::stop(mRxCtxMap[ctx].tId);
-        mRxCtxMap.erase(ctx);
-    }
-}
-
-void MmsClient::dlThread(int ctx)
-{
-    ostringstream oss;
-#ifndef MOBILE
-    oss << LOGPREFIX;
-#endif
-    oss << "dlThread[" << ctx << "] ";
-    string logPref(oss.str());
-    oss.clear();
-    oss.str("");
-    //ensure context data ready from rxStart()/rxMsg()
-    int retry = 10; //maximum tries
-    while (mRxCtxMap.count(ctx) == 0 || mRxCtxMap[ctx].msg == 0)
-    {
-        if (--retry == 0)
-        {
-            LOGX(ERROR, logPref << "Missing context data in map, aborting");
-            return;
-        }
-        PalThread::msleep(5);
-    }
-    auto &d(mRxCtxMap[ctx]);
-    string url(d.msg->getFieldString(MsgSp::Field::FILE_PATH));
-    string ip(url);
-    ip.erase(0, ip.find("//") + 2);  //delete "http://" or "https://"
-    auto pos = ip.find('/');
-    string path(ip.substr(pos));     //must start with /
-    ip.erase(pos);                   //ip:port
-    pos = ip.find(':');
-    string port(ip.substr(pos + 1)); //port
-    ip.erase(pos);                   //ip
-    auto *sock = new TcpSocket(ip, Utils::fromString<int>(port),
-                               (url.compare(0, 5, "https") == 0));
-    Utils::TimepointT startTp = Utils::getTimepoint();
-
-    const int  MAX_TIMEOUT = 5; //successive timeouts to declare failure
-    int        res = -1;        //result
-    int        timeoutCount;
-    int        bytesRcvd;
-    int        fSize = d.msg->getFieldInt(MsgSp::Field::FILE_SIZE);
-    string     str;
-    string     hdr;
-    char       buf[65535];
-    retry = 5;
-    while (retry-- > 0)
-    {
-        if (sock->connect() != 0)
-        {
-            if (retry == 0)
-            {
-                LOGX(ERROR, logPref << url
-                     << " server connection failed, aborting");
-                res = MsgSp::Value::RESULT_MMSERR_DOWNLOAD;
-                break;
-            }
-            LOGX(ERROR, logPref << url
-                 << " server connection failed, retrying...");
-            PalThread::msleep(100);
-            continue;
-        }
-        res = -1; //any negative
-        //send request
-        oss << "GET " << path << " HTTP/1.1\r\nHost: " << ip
-            << "\r\nConnection: close\r\n\r\n";
-        sock->send(oss.str());
-        LOGX(DEBUG, logPref << oss.str());
-        oss.clear();
-        oss.str("");
-
-        timeoutCount = MAX_TIMEOUT;
-        fSize = d.msg->getFieldInt(MsgSp::Field::FILE_SIZE); //down counter
-        str.clear();
-        hdr.clear();
-        rewind(d.fp);
-        while (res < 0)
-        {
-            //use short timeout to allow quick interrupt for thread termination
-            bytesRcvd = sock->recv(buf, sizeof(buf), 5);
-            if (bytesRcvd == TcpSocket::ERR_TIMEOUT)
-            {
-                if (--timeoutCount == 0)
-                {
-                    LOGX(ERROR, logPref << "Receive timeout");
-                    res = MsgSp::Value::RESULT_MMSERR_DOWNLOAD;
-                }
-                continue;
-            }
-            timeoutCount = MAX_TIMEOUT; //reset
-            if (bytesRcvd <= 0)
-            {
-                if (Socket::isDisconnectedError(-bytesRcvd))
-                {
-                    LOGX(ERROR, logPref << "Error " << bytesRcvd
-                         << Socket::getErrorStr(-bytesRcvd)
-                         << "- server disconnected");
-                    res = MsgSp::Value::RESULT_MMSERR_DOWNLOAD;
-                }
-                else
-                {
-                    LOGX(DEBUG, logPref << "Error " << bytesRcvd
-                         << Socket::getErrorStr(-bytesRcvd));
-                }
-                continue;
-            }
-            str.append(buf, bytesRcvd);
-            if (hdr.empty())
-            {
-                pos = str.find("\r\n\r\n");
-                if (pos == string::npos)
-                {
-                    LOGX(ERROR, logPref << "Bad HTTP header");
-                    res = MsgSp::Value::RESULT_MMSERR_DOWNLOAD;
-                    continue;
-                }
-                hdr = str.substr(0, pos);
-                str.erase(0, pos + 4);
-                LOGGER_DEBUG(mLogger, logPref << "HTTP header ("
-                             << (hdr.size() + 4) << ")\n" << hdr);
-                //hdr start when file not available: HTTP/1.1 404 Not Found
-                if (hdr.find("404 Not Found") != string::npos)
-                {
-                    res = MsgSp::Value::RESULT_MMSERR_DOWNLOAD_PERM;
-                    retry = 0;
-                    break;
-                }
-                cipherStart(d.msg, ctx);
-                if (str.empty())
-                    continue;
-                bytesRcvd = str.size();
-            }
-            pos = str.size(); //reuse pos
-            if (cipherRun(false, ctx, str))
-            {
-                pos = str.size();
-                if (fwrite(str.data(), 1, pos, d.fp) == pos)
-                {
-                    fSize -= pos;
-                    if (fSize <= 0)
-                    {
-                        res = 0;
-                        retry = 0;
-                        break;
-                    }
-                    str.clear();
-                }
-                else
-                {
-                    LOGX(ERROR, logPref << "Failed to write to file "
-                         << d.fPath);
-                    res = MsgSp::Value::RESULT_MMSERR_DOWNLOAD;
-                    break;
-                }
-            }
-        } //while (res < 0)
-    } //while (retry-- > 0)
-    cipherEnd(ctx);
-    delete sock;
-    if (d.msg != 0) //not stopped by destructor
-    {
-        fclose(d.fp);
-        if (res == 0)
-        {
-            LOGX(VERBOSE, logPref << "Received from "
-                 << d.msg->getFieldInt(MsgSp::Field::CALLED_PARTY)
-                 << " " << url << " to " << d.fPath << " ("
-                 << Utils::getTransferStats(startTp,
-                                    d.msg->getFieldInt(MsgSp::Field::FILE_SIZE))
-                 << ")");
-            //add local path
-            d.msg->addField(MsgSp::Field::USER_DEFINED_DATA_1, d.fPath);
-        }
-        else
-        {
-#ifndef MOBILE
-            remove(d.fPath.c_str()); //delete local file
-#endif
-            d.msg->addField(MsgSp::Field::RESULT, res);
-        }
-        MSGCB(d.msg);
-    }
-    LOGGER_DEBUG(mLogger, logPref << "finished");
+    RxCtx rx(it->second);
+    mRxCtxMap.erase(it);
+    PalLock::release(&mRxLock);
+    LOGX(DEBUG, LOGPREFIX << "rxEnd [" << ctx << "]");
+    rxStop(rx);
 }
 
 int MmsClient::txStart(const MsgSp *msg, const string &path)
@@ -580,6 +393,264 @@ void MmsClient::cipherEnd(int ctx)
     mCipherMap.erase(ctx);
 }
 
+MsgSp *MmsClient::dlStart(int ctx, RxCtx &rx)
+{
+    auto *dl = new DlCtx(this, ctx);
+    ostringstream oss;
+#ifndef MOBILE
+    oss << LOGPREFIX;
+#endif
+    oss << "dl[" << ctx << "] ";
+    dl->logPref = oss.str();
+    dl->url = rx.msg->getFieldString(MsgSp::Field::FILE_PATH);
+    string &ip(dl->ip);
+    ip = dl->url;
+    ip.erase(0, ip.find("//") + 2);  //delete "http://" or "https://"
+    auto pos = ip.find('/');
+    dl->path = ip.substr(pos);       //must start with /
+    ip.erase(pos);                   //ip:port
+    pos = ip.find(':');
+    string port(ip.substr(pos + 1)); //port
+    ip.erase(pos);                   //ip
+    dl->sock = new TcpSocket(ip, Utils::fromString<int>(port),
+                             (dl->url.compare(0, 5, "https") == 0));
+    rx.dl = dl;
+    return dlConnect(dl);
+}
+
+void MmsClient::onDlEvent(void *obj, int events)
+{
+    auto *dl = static_cast<DlCtx *>(obj);
+    dl->obj->dlEvent(dl, events);
+}
+
+void MmsClient::dlEvent(DlCtx *dl, int events)
+{
+    //dl stays valid even if detached by rxEnd(), until its
+    //SocketLoop::remove() returns, which waits for this callback
+    MsgSp *msg = 0;
+    PalLock::take(&mRxLock);
+    auto it = mRxCtxMap.find(dl->ctx);
+    if (it != mRxCtxMap.end() && it->second.dl == dl)
+        msg = dlStep(dl, events);
+    PalLock::release(&mRxLock);
+    if (msg != 0)
+        MSGCB(msg);
+}
+
+MsgSp *MmsClient::dlStep(DlCtx *dl, int events)
+{
+    switch (dl->phase)
+    {
+        case DlCtx::PHASE_DELAY:
+            SocketLoop::remove(dl->handle);
+            dl->handle = 0;
+            return dlConnect(dl);
+        case DlCtx::PHASE_CONNECT:
+            break;
+        default:
+            return dlRecv(dl, events);
+    }
+    int res = ((events & SocketLoop::EVENT_TIMEOUT) != 0)?
+              Socket::ERR_TIMEOUT: dl->sock->connectFinish();
+    if (res == Socket::ERR_WANT_READ || res == Socket::ERR_WANT_WRITE)
+    {
+        //SSL handshake in progress
+        SocketLoop::modify(dl->handle,
+                           (res == Socket::ERR_WANT_READ)?
+                               SocketLoop::EVENT_READ: SocketLoop::EVENT_WRITE,
+                           DL_TIMEOUT_MS * DL_MAX_TIMEOUT);
+        return 0;
+    }
+    if (res != 0)
+    {
+        LOGX(ERROR, dl->logPref << dl->url << " server connection failed, "
+             << res << Socket::getErrorStr(-res)
+             << ((dl->retry > 0)? ", retrying...": ", aborting"));
+        return dlRetry(dl, MsgSp::Value::RESULT_MMSERR_DOWNLOAD);
+    }
+    //send request
+    ostringstream oss;
+    oss << "GET " << dl->path << " HTTP/1.1\r\nHost: " << dl->ip
+        << "\r\nConnection: close\r\n\r\n";
+    res = dl->sock->send(oss.str());
+    LOGX(DEBUG, dl->logPref << oss.str());
+    if (res <= 0)
+    {
+        LOGX(ERROR, dl->logPref << "Send error " << res
+             << Socket::getErrorStr(-res));
+        return dlRetry(dl, MsgSp::Value::RESULT_MMSERR_DOWNLOAD);
+    }
+    auto &rx(mRxCtxMap[dl->ctx]);
+    dl->phase = DlCtx::PHASE_RECV;
+    dl->timeoutCount = DL_MAX_TIMEOUT;
+    dl->fSize = rx.msg->getFieldInt(MsgSp::Field::FILE_SIZE); //down counter
+    dl->str.clear();
+    dl->hdr.clear();
+    rewind(rx.fp);
+    SocketLoop::modify(dl->handle, SocketLoop::EVENT_READ, DL_TIMEOUT_MS);
+    return 0;
+}
+
+MsgSp *MmsClient::dlConnect(DlCtx *dl)
+{
+    --dl->retry;
+    int res = dl->sock->connectStart();
+    if (res == 0 || res == Socket::ERR_IN_PROGRESS)
+    {
+        dl->phase = DlCtx::PHASE_CONNECT;
+        dl->handle = SocketLoop::add(dl->sock->getSock(),
+                                     SocketLoop::EVENT_WRITE,
+                                     DL_TIMEOUT_MS * DL_MAX_TIMEOUT,
+                                     onDlEvent, dl);
+        if (dl->handle != 0)
+            return 0;
+        dl->retry = 0; //event loop not available
+    }
+    LOGX(ERROR, dl->logPref << dl->url << " server connection failed, "
+         << res << Socket::getErrorStr(-res)
+         << ((dl->retry > 0)? ", retrying...": ", aborting"));
+    return dlRetry(dl, MsgSp::Value::RESULT_MMSERR_DOWNLOAD);
+}
+
+MsgSp *MmsClient::dlRecv(DlCtx *dl, int events)
+{
+    if (events == SocketLoop::EVENT_TIMEOUT)
+    {
+        if (--dl->timeoutCount > 0)
+            return 0;
+        LOGX(ERROR, dl->logPref << "Receive timeout");
+        return dlRetry(dl, MsgSp::Value::RESULT_MMSERR_DOWNLOAD);
+    }
+    dl->timeoutCount = DL_MAX_TIMEOUT; //reset
+    auto &rx(mRxCtxMap[dl->ctx]);
+    string &str(dl->str);
+    char   buf[65535];
+    int    bytesRcvd;
+    size_t pos;
+    //read until no more data, because SSL may have buffered some
+    while (true)
+    {
+        bytesRcvd = dl->sock->recv(buf, sizeof(buf));
+        if (bytesRcvd <= 0)
+        {
+            if (bytesRcvd < 0 && Socket::isWouldBlockError(-bytesRcvd))
+                return 0; //wait for more
+            LOGX(ERROR, dl->logPref << "Error " << bytesRcvd
+                 << Socket::getErrorStr(-bytesRcvd)
+                 << (Socket::isDisconnectedError(-bytesRcvd)?
+                     "- server disconnected": ""));
+            return dlRetry(dl, MsgSp::Value::RESULT_MMSERR_DOWNLOAD);
+        }
+        str.append(buf, bytesRcvd);
+        if (dl->hdr.empty())
+        {
+            pos = str.find("\r\n\r\n");
+            if (pos == string::npos)
+            {
+                if (str.size() < sizeof(buf))
+                    continue; //header may be incomplete
+                LOGX(ERROR, dl->logPref << "Bad HTTP header");
+                return dlRetry(dl, MsgSp::Value::RESULT_MMSERR_DOWNLOAD);
+            }
+            dl->hdr = str.substr(0, pos);
+            str.erase(0, pos + 4);
+            LOGGER_DEBUG(mLogger, dl->logPref << "HTTP header ("
+                         << (dl->hdr.size() + 4) << ")\n" << dl->hdr);
+            //hdr start when file not available: HTTP/1.1 404 Not Found
+            if (dl->hdr.find("404 Not Found") != string::npos)
+                return dlEnd(dl, MsgSp::Value::RESULT_MMSERR_DOWNLOAD_PERM);
+            cipherStart(rx.msg, dl->ctx);
+            if (str.empty())
+                continue;
+        }
+        //cipherRun() keeps any incomplete block, so str is always consumed
+        if (cipherRun(false, dl->ctx, str))
+        {
+            pos = str.size();
+            if (fwrite(str.data(), 1, pos, rx.fp) != pos)
+            {
+                LOGX(ERROR, dl->logPref << "Failed to write to file "
+                     << rx.fPath);
+                return dlRetry(dl, MsgSp::Value::RESULT_MMSERR_DOWNLOAD);
+            }
+            dl->fSize -= pos;
+            if (dl->fSize <= 0)
+                return dlEnd(dl, 0);
+        }
+        str.clear();
+    }
+}
+
+MsgSp *MmsClient::dlRetry(DlCtx *dl, int res)
+{
+    SocketLoop::remove(dl->handle);
+    dl->handle = 0;
+    dl->sock->close();
+    if (dl->retry > 0)
+    {
+        dl->phase = DlCtx::PHASE_DELAY;
+        dl->handle = SocketLoop::add(INVALID_SOCKET, 0, DL_RETRY_MS,
+                                     onDlEvent, dl);
+        if (dl->handle != 0)
+            return 0;
+    }
+    return dlEnd(dl, res);
+}
+
+MsgSp *MmsClient::dlEnd(DlCtx *dl, int res)
+{
+    SocketLoop::remove(dl->handle);
+    cipherEnd(dl->ctx);
+    delete dl->sock;
+    auto &rx(mRxCtxMap[dl->ctx]);
+    rx.dl = 0;
+    fclose(rx.fp);
+    rx.fp = 0;
+    if (res == 0)
+    {
+        LOGX(VERBOSE, dl->logPref << "Received from "
+             << rx.msg->getFieldInt(MsgSp::Field::CALLED_PARTY)
+             << " " << dl->url << " to " << rx.fPath << " ("
+             << Utils::getTransferStats(dl->startTp,
+                                   rx.msg->getFieldInt(MsgSp::Field::FILE_SIZE))
+             << ")");
+        //add local path
+        rx.msg->addField(MsgSp::Field::USER_DEFINED_DATA_1, rx.fPath);
+    }
+    else
+    {
+#ifndef MOBILE
+        remove(rx.fPath.c_str()); //delete local file
+#endif
+        rx.msg->addField(MsgSp::Field::RESULT, res);
+    }
+    LOGGER_DEBUG(mLogger, dl->logPref << "finished");
+    delete dl;
+    return rx.msg;
+}
+
+void MmsClient::rxStop(RxCtx &rx)
+{
+    if (rx.dl != 0)
+    {
+        //waits for any running callback, which then finds dl detached
+        SocketLoop::remove(rx.dl->handle);
+        cipherEnd(rx.dl->ctx);
+        delete rx.dl->sock;
+        delete rx.dl;
+        rx.dl = 0;
+    }
+    if (rx.fp != 0)
+    {
+        fclose(rx.fp);
+        rx.fp = 0;
+#ifndef MOBILE
+        remove(rx.fPath.c_str()); //delete local file
+#endif
+    }
+}
+
 int MmsClient::getNewContext()
 {
     static int ctx = 0; //running context id
@@ -20,7 +20,7 @@
 #endif
 #include "Logger.h"
 #include "MsgSp.h"
-#include "PalThread.h"
+#include "PalLock.h"
 #include "TcpSocket.h"
 
 class MmsClient
@@ -110,7 +110,7 @@ public:
     /**
      * Handles a received MMS_TRANSFER message by creating MMS_RPT response.
      * If message has file attachment, creates it with a unique path in the
-     * download directory, and starts a new download thread.
+     * download directory, and starts the download on the SocketLoop.
      *
      * @param[in]  msg  The message.
      * @param[out] path The created download file path if applicable,
@@ -122,20 +122,13 @@ public:
 #endif //MOBILE
 
     /**
-     * Ends a file download process by stopping the thread and erasing the
-     * context.
+     * Ends a file download process by stopping it if still running, and
+     * erasing the context.
      *
      * @param[in] ctx The download context ID.
      */
     void rxEnd(int ctx);
 
-    /**
-     * Performs file download in a separate thread.
-     *
-     * @param[in] ctx The download context ID.
-     */
-    void dlThread(int ctx);
-
     /**
      * Starts file upload by calling txConnect().
      * Must be followed by txSend() and txEnd() calls.
@@ -217,19 +210,49 @@ private:
     CallbackFn     mCbFn;     //callback function
 #endif //MOBILE
 
+    //download state, driven by SocketLoop callbacks
+    struct DlCtx
+    {
+        enum ePhase
+        {
+            PHASE_DELAY,   //waiting to reconnect
+            PHASE_CONNECT, //TCP connection and SSL handshake
+            PHASE_RECV
+        };
+
+        DlCtx(MmsClient *o, int c) : obj(o), ctx(c) {}
+
+        MmsClient         *obj;
+        int                ctx;                //download context ID
+        int                handle  = 0;        //SocketLoop handle
+        int                phase   = PHASE_CONNECT;
+        int                retry   = 5;        //remaining tries
+        int                timeoutCount = 0;   //remaining receive timeouts
+        int                fSize   = 0;        //remaining bytes
+        TcpSocket         *sock    = 0;
+        Utils::TimepointT  startTp = Utils::getTimepoint();
+        std::string        logPref;
+        std::string        url;
+        std::string        ip;
+        std::string        path;               //URL path
+        std::string        str;                //received data to process
+        std::string        hdr;                //HTTP response header
+    };
+
     //context data for file receiving
     struct RxCtx
     {
-        RxCtx(const std::string &p, PalThread::ThreadT t, MsgSp *m, FILE *f) :
-            fPath(p), tId(t), msg(m), fp(f) {}
+        RxCtx(const std::string &p, MsgSp *m, FILE *f) :
+            fPath(p), msg(m), fp(f) {}
         RxCtx() {}
 
-        std::string         fPath;   //local path
-        PalThread::ThreadT  tId = 0;
-        MsgSp              *msg = 0; //MMS_RPT
-        FILE               *fp  = 0;
+        std::string  fPath;   //local path
+        DlCtx       *dl  = 0; //0 when finished
+        MsgSp       *msg = 0; //MMS_RPT
+        FILE        *fp  = 0; //0 when finished
     };
     std::map<int, RxCtx> mRxCtxMap; //key is context ID
+    PalLock::LockT       mRxLock;   //guards mRxCtxMap and its DlCtx
 
     //context data for file sending
     struct TxCtx
@@ -314,6 +337,92 @@ private:
      */
     int getNewContext();
 
+    /**
+     * Creates the download state of a new receive context and starts the
+     * connection. Caller must hold mRxLock.
+     *
+     * @param[in]     ctx The download context ID.
+     * @param[in,out] rx  The receive context.
+     * @return See dlStep().
+     */
+    MsgSp *dlStart(int ctx, RxCtx &rx);
+
+    /**
+     * SocketLoop callback for a download.
+     *
+     * @param[in] obj    The DlCtx.
+     * @param[in] events SocketLoop::eEvent flags.
+     */
+    static void onDlEvent(void *obj, int events);
+
+    /**
+     * Handles a socket event of a download, and invokes the MMS message
+     * callback if it has ended.
+     *
+     * @param[in] dl     The download.
+     * @param[in] events SocketLoop::eEvent flags.
+     */
+    void dlEvent(DlCtx *dl, int events);
+
+    /**
+     * Advances a download state on a socket event.
+     * Caller must hold mRxLock.
+     *
+     * @param[in] dl     The download.
+     * @param[in] events SocketLoop::eEvent flags.
+     * @return The MMS_RPT message to pass to the callback if the download
+     *         has ended, otherwise 0.
+     */
+    MsgSp *dlStep(DlCtx *dl, int events);
+
+    /**
+     * Starts a connection attempt for a download.
+     * Caller must hold mRxLock.
+     *
+     * @param[in] dl The download.
+     * @return See dlStep().
+     */
+    MsgSp *dlConnect(DlCtx *dl);
+
+    /**
+     * Receives and stores available download data.
+     * Caller must hold mRxLock.
+     *
+     * @param[in] dl     The download.
+     * @param[in] events SocketLoop::eEvent flags.
+     * @return See dlStep().
+     */
+    MsgSp *dlRecv(DlCtx *dl, int events);
+
+    /**
+     * Closes the connection of a failed download attempt, and schedules a
+     * retry, or ends the download if there are no more tries.
+     * Caller must hold mRxLock.
+     *
+     * @param[in] dl  The download.
+     * @param[in] res The result to use if ending.
+     * @return See dlStep().
+     */
+    MsgSp *dlRetry(DlCtx *dl, int res);
+
+    /**
+     * Ends a download, deleting its state, and sets the result in the
+     * MMS_RPT message. Caller must hold mRxLock.
+     *
+     * @param[in] dl  The download.
+     * @param[in] res 0 if successful, otherwise the MsgSp::Value result.
+     * @return The MMS_RPT message.
+     */
+    MsgSp *dlEnd(DlCtx *dl, int res);
+
+    /**
+     * Stops a download if running, and closes and deletes its file if not
+     * completed. The context must have been removed from mRxCtxMap.
+     *
+     * @param[in] rx The receive context.
+     */
+    void rxStop(RxCtx &rx);
+
     /**
      * Connects to server and sends header data for file upload.
      *
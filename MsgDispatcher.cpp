@@ -0,0 +1,302 @@
+/**
+ * Server message dispatcher implementation.
+ *
+ * Copyright (C) Sapura Secured Technologies, 2026. All Rights Reserved.
+ *
+ * @file
+ * @version $Id$
+ * @author agent <agent@local>
+ */
+#include <chrono>
+#include <assert.h>
+
+#include "MsgDispatcher.h"
+
+using namespace std;
+
+static const string LOGPREFIX("MsgDispatcher:: ");
+
+//coalescing key types, in the upper 32 bits of the key
+static const long long KEY_LOCATION = 1LL << 32;
+static const long long KEY_CALL_TX  = 2LL << 32;
+
+MsgDispatcher::MsgDispatcher(Logger *logger, HandlerFn handler, void *obj) :
+mLogger(logger), mHandler(handler), mObj(obj), mEnabled(false), mHead(0),
+mBudgetUs(10000),
+mCoalescedCount(Metrics::counter("scad_msg_coalesced_total")),
+mDroppedCount(Metrics::counter("scad_msg_dropped_total")),
+mQueueSize(Metrics::gauge("scad_msg_queue_size")), mStatsUs(nowUs()),
+mAgeMaxUs(0), mAgeTotalUs(0), mDispatched(0), mCoalesced(0), mDropped(0),
+mQueueMax(0)
+{
+    assert(logger != 0 && handler != 0);
+}
+
+MsgDispatcher::~MsgDispatcher()
+{
+    mEnabled = false;
+    clear();
+}
+
+void MsgDispatcher::setEnabled(bool enable)
+{
+    mEnabled = enable;
+    if (!enable)
+        clear();
+}
+
+bool MsgDispatcher::post(MsgSp *msg)
+{
+    if (msg == 0 || !mEnabled)
+        return false;
+    auto *n = new NodeT;
+    n->msg = msg;
+    n->enqUs = nowUs();
+    n->next = mHead.load(memory_order_relaxed);
+    while (!mHead.compare_exchange_weak(n->next, n, memory_order_release,
+                                        memory_order_relaxed))
+        ;
+    return true;
+}
+
+bool MsgDispatcher::dispatch()
+{
+    collect();
+    long long start = nowUs();
+    long long now = start;
+    MsgSp *msg;
+    int n = 0;
+    int i = 0;
+    while (i < LANE_MAX)
+    {
+        LaneT &lane(mLanes[i]);
+        if (lane.empty())
+        {
+            ++i;
+            continue;
+        }
+        if (n != 0 && now - start >= mBudgetUs)
+            break;
+        //must pop first because the handler may lead to clear()
+        msg = lane.front().msg;
+        if (msg != 0)
+        {
+            long long age = now - lane.front().enqUs;
+            if (age > mAgeMaxUs)
+                mAgeMaxUs = age;
+            mAgeTotalUs += age;
+            getLatency(msg->getType()).record(age);
+            ++mDispatched;
+            ++n;
+        }
+        popFront(lane);
+        if (msg != 0)
+        {
+            mHandler(mObj, msg);
+            now = nowUs();
+            //a higher priority lane may have been refilled by a nested
+            //dispatch() through the handler - restart from the top
+            i = 0;
+        }
+    }
+    mQueueSize.set(getQueueSize());
+    logStats(now);
+    return (getQueueSize() != 0 || mHead.load(memory_order_relaxed) != 0);
+}
+
+void MsgDispatcher::clear()
+{
+    NodeT *n = mHead.exchange(0, memory_order_acquire);
+    NodeT *next;
+    for (; n!=0; n=next)
+    {
+        next = n->next;
+        delete n->msg;
+        delete n;
+    }
+    for (auto &lane : mLanes)
+    {
+        for (auto &e : lane)
+        {
+            delete e.msg;
+        }
+        lane.clear();
+    }
+    mCoalesceMap.clear();
+}
+
+long long MsgDispatcher::nowUs()
+{
+    return chrono::duration_cast<chrono::microseconds>(
+                      chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void MsgDispatcher::collect()
+{
+    NodeT *n = mHead.exchange(0, memory_order_acquire);
+    if (n == 0)
+        return;
+    //reverse into posting order
+    NodeT *prev = 0;
+    NodeT *next;
+    for (; n!=0; n=next)
+    {
+        next = n->next;
+        n->next = prev;
+        prev = n;
+    }
+    for (n=prev; n!=0; n=next)
+    {
+        next = n->next;
+        add(n->msg, n->enqUs);
+        delete n;
+    }
+    size_t sz = getQueueSize();
+    if (sz > mQueueMax)
+        mQueueMax = sz;
+}
+
+void MsgDispatcher::add(MsgSp *msg, long long enqUs)
+{
+    int lane;
+    long long key = 0;
+    int id;
+    switch (msg->getType())
+    {
+        case MsgSp::Type::GPS_LOC:
+        case MsgSp::Type::MON_LOC:
+            lane = LANE_LOCATION;
+            id = msg->getFieldInt(MsgSp::Field::CALLING_PARTY);
+            if (id > 0)
+                key = KEY_LOCATION | id;
+            break;
+        case MsgSp::Type::MON_TX_CEASED:
+        case MsgSp::Type::MON_TX_GRANTED:
+            lane = LANE_DEFAULT;
+            id = msg->getFieldInt(MsgSp::Field::CALL_ID);
+            if (id > 0)
+                key = KEY_CALL_TX | id;
+            break;
+        case MsgSp::Type::CALL_ALERT:
+        case MsgSp::Type::CALL_CONNECT:
+        case MsgSp::Type::CALL_CONNECT_ACK:
+        case MsgSp::Type::CALL_DISCONNECT:
+        case MsgSp::Type::CALL_FINISH:
+        case MsgSp::Type::CALL_INFO:
+        case MsgSp::Type::CALL_PROCEEDING:
+        case MsgSp::Type::CALL_RELEASE:
+        case MsgSp::Type::CALL_SETUP:
+        case MsgSp::Type::CALL_SSCF_FWD:
+        case MsgSp::Type::CALL_TX_CEASED:
+        case MsgSp::Type::CALL_TX_DEMAND:
+        case MsgSp::Type::CALL_TX_GRANTED:
+        case MsgSp::Type::CALL_TX_INTERRUPT:
+        case MsgSp::Type::LISTEN_CONNECT:
+        case MsgSp::Type::LISTEN_DISCONNECT:
+        case MsgSp::Type::LISTEN_RELEASE:
+        case MsgSp::Type::SSIC_CANCEL:
+        case MsgSp::Type::SSIC_DISCONNECT:
+        case MsgSp::Type::SSIC_INCL:
+        case MsgSp::Type::SSIC_INVOCATION_FAILURE:
+        case MsgSp::Type::SSIC_INVOKE:
+        case MsgSp::Type::SSIC_RELEASE:
+            //emergency calls stay here to keep order with their call
+            //control messages
+            lane = LANE_CALL;
+            break;
+        default:
+            lane = (msg->getPriority() >=
+                    MsgSp::Value::CALL_PRIORITY_PREEMPTIVE_4_EMERGENCY)?
+                   LANE_URGENT: LANE_DEFAULT;
+            break;
+    }
+    LaneT &l(mLanes[lane]);
+    if (key != 0)
+    {
+        auto it = mCoalesceMap.find(key);
+        if (it != mCoalesceMap.end())
+        {
+            //supersede the queued one, but queue the new one at the end to
+            //keep order with messages received in between
+            delete it->second->msg;
+            it->second->msg = 0;
+            ++mCoalesced;
+            mCoalescedCount.add();
+        }
+        l.push_back(EntryT(msg, enqUs, key));
+        mCoalesceMap[key] = &l.back();
+    }
+    else
+    {
+        l.push_back(EntryT(msg, enqUs, 0));
+    }
+    if (lane == LANE_LOCATION)
+    {
+        while (l.size() > MAX_LOCATION)
+        {
+            if (l.front().msg != 0)
+            {
+                delete l.front().msg;
+                l.front().msg = 0;
+                ++mDropped;
+                mDroppedCount.add();
+            }
+            popFront(l);
+        }
+    }
+}
+
+void MsgDispatcher::popFront(LaneT &lane)
+{
+    EntryT &e(lane.front());
+    if (e.key != 0)
+    {
+        auto it = mCoalesceMap.find(e.key);
+        if (it != mCoalesceMap.end() && it->second == &e)
+            mCoalesceMap.erase(it);
+    }
+    lane.pop_front();
+}
+
+size_t MsgDispatcher::getQueueSize() const
+{
+    size_t sz = 0;
+    for (const auto &lane : mLanes)
+    {
+        sz += lane.size();
+    }
+    return sz;
+}
+
+void MsgDispatcher::logStats(long long now)
+{
+    if (now - mStatsUs < STATS_INTERVAL_US)
+        return;
+    if (mDispatched != 0 || mCoalesced != 0 || mDropped != 0)
+        LOGGER_INFO(mLogger, LOGPREFIX << "Dispatched " << mDispatched
+                    << ", coalesced " << mCoalesced << ", dropped "
+                    << mDropped << ", queue max " << mQueueMax
+                    << ", age avg/max(ms) "
+                    << ((mDispatched == 0)?
+                        0: mAgeTotalUs/mDispatched/1000)
+                    << '/' << mAgeMaxUs/1000);
+    mStatsUs = now;
+    mAgeMaxUs = 0;
+    mAgeTotalUs = 0;
+    mDispatched = 0;
+    mCoalesced = 0;
+    mDropped = 0;
+    mQueueMax = 0;
+}
+
+Metrics::Histogram &MsgDispatcher::getLatency(int type)
+{
+    auto it = mLatency.find(type);
+    if (it != mLatency.end())
+        return *it->second;
+    Metrics::Histogram &h(Metrics::histogram("scad_msg_dispatch_latency_us",
+                                             "type",
+                                             MsgSp::getTypeName(type)));
+    mLatency[type] = &h;
+    return h;
+}
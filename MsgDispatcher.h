@@ -0,0 +1,198 @@
+/**
+ * Dispatcher of server messages to the GUI thread.
+ * Producer threads post messages through a lock-free handoff, so they never
+ * block on the GUI. The GUI thread collects the posted messages into
+ * priority lanes and dispatches them within a time budget per call, leaving
+ * the rest for the next call.
+ * Lanes in dispatch order:
+ *   -urgent: emergency status,
+ *   -call control: CALL_*, SSIC_* and LISTEN_*,
+ *   -default: everything else,
+ *   -location: GPS_LOC and MON_LOC.
+ * A queued message superseded by a newer one is dropped - location per ISSI,
+ * and monitored transmission state per call ID.
+ * The queueing latency of each message type is recorded in Metrics.
+ *
+ * Copyright (C) Sapura Secured Technologies, 2026. All Rights Reserved.
+ *
+ * @file
+ * @version $Id$
+ * @author agent <agent@local>
+ */
+#ifndef MSGDISPATCHER_H
+#define MSGDISPATCHER_H
+
+#include <atomic>
+#include <deque>
+#include <map>
+
+#include "Logger.h"
+#include "Metrics.h"
+#include "MsgSp.h"
+
+class MsgDispatcher
+{
+public:
+    //handler function, which takes ownership of the message
+    typedef void (*HandlerFn)(void *obj, MsgSp *msg);
+
+    /**
+     * Constructor.
+     *
+     * @param[in] logger  Logger object.
+     * @param[in] handler Message handler.
+     * @param[in] obj     Object to pass to the handler.
+     */
+    MsgDispatcher(Logger *logger, HandlerFn handler, void *obj);
+
+    ~MsgDispatcher();
+
+    /**
+     * Enables or disables post(). Disabling also clears all queued
+     * messages.
+     *
+     * @param[in] enable true to enable.
+     */
+    void setEnabled(bool enable);
+
+    /**
+     * Sets the time budget for each dispatch() call.
+     *
+     * @param[in] ms The budget in milliseconds.
+     */
+    void setBudget(int ms) { mBudgetUs = ((ms > 0)? ms: 1) * 1000LL; }
+
+    /**
+     * Posts a message for dispatching. Thread-safe and non-blocking.
+     *
+     * @param[in] msg The message. Ownership is taken only if successful.
+     * @return true if successful, false if disabled.
+     */
+    bool post(MsgSp *msg);
+
+    /**
+     * Dispatches queued messages in lane order until all are done or the
+     * time budget is used up. At least one message is dispatched if any.
+     * The handler may call clear() or setEnabled().
+     * Must be called in the consumer thread only.
+     *
+     * @return true if there are still messages pending.
+     */
+    bool dispatch();
+
+    /**
+     * Deletes all queued messages.
+     * Must be called in the consumer thread only.
+     */
+    void clear();
+
+private:
+    enum eLane
+    {
+        LANE_URGENT,
+        LANE_CALL,
+        LANE_DEFAULT,
+        LANE_LOCATION,
+        LANE_MAX
+    };
+
+    //node in the lock-free handoff stack
+    struct NodeT
+    {
+        MsgSp    *msg;
+        long long enqUs;  //enqueue time
+        NodeT    *next;
+    };
+
+    struct EntryT
+    {
+        EntryT(MsgSp *m, long long t, long long k) :
+            msg(m), enqUs(t), key(k) {}
+
+        MsgSp    *msg;    //0 if superseded
+        long long enqUs;
+        long long key;    //coalescing key, or 0 for none
+    };
+
+    typedef std::deque<EntryT>                  LaneT;
+    typedef std::map<long long, EntryT *>        CoalesceMapT;
+    typedef std::map<int, Metrics::Histogram *>  LatencyMapT;
+
+    //interval between statistics logs in microseconds
+    static const long long STATS_INTERVAL_US = 60000000LL;
+    //maximum queued location messages - oldest ones are dropped
+    static const size_t    MAX_LOCATION      = 20000;
+
+    Logger              *mLogger;
+    HandlerFn            mHandler;
+    void                *mObj;
+    std::atomic<bool>    mEnabled;
+    std::atomic<NodeT *> mHead;       //handoff stack, newest first
+    long long            mBudgetUs;
+    LaneT                mLanes[LANE_MAX];
+    CoalesceMapT         mCoalesceMap;
+    LatencyMapT          mLatency;    //key is message type
+    Metrics::Counter    &mCoalescedCount;
+    Metrics::Counter    &mDroppedCount;
+    Metrics::Gauge      &mQueueSize;
+    //statistics since last log
+    long long            mStatsUs;    //last log time
+    long long            mAgeMaxUs;
+    long long            mAgeTotalUs;
+    unsigned int         mDispatched;
+    unsigned int         mCoalesced;
+    unsigned int         mDropped;
+    size_t               mQueueMax;
+
+    /**
+     * Gets the current monotonic time.
+     *
+     * @return The time in microseconds.
+     */
+    static long long nowUs();
+
+    /**
+     * Takes all posted messages and adds them to the lanes in posting
+     * order.
+     */
+    void collect();
+
+    /**
+     * Adds a message to its lane, dropping any queued message superseded by
+     * it.
+     *
+     * @param[in] msg   The message.
+     * @param[in] enqUs The enqueue time.
+     */
+    void add(MsgSp *msg, long long enqUs);
+
+    /**
+     * Removes the first entry of a lane.
+     *
+     * @param[in] lane The lane.
+     */
+    void popFront(LaneT &lane);
+
+    /**
+     * Gets the total number of queued entries.
+     *
+     * @return The number.
+     */
+    size_t getQueueSize() const;
+
+    /**
+     * Logs the statistics if due, and resets them.
+     *
+     * @param[in] now The current time in microseconds.
+     */
+    void logStats(long long now);
+
+    /**
+     * Gets the latency histogram of a message type.
+     *
+     * @param[in] type The message type.
+     * @return The histogram.
+     */
+    Metrics::Histogram &getLatency(int type);
+};
+#endif //MSGDISPATCHER_H
@@ -0,0 +1,467 @@
+/**
+ * Local message archive implementation.
+ *
+ * Copyright (C) Sapura Secured Technologies, 2026. All Rights Reserved.
+ *
+ * @file
+ * @version $Id$
+ * @author agent <agent@local>
+ */
+#include <algorithm>
+#include <string.h>
+#include <QDateTime>
+#include <QDir>
+#include <QRegularExpression>
+#include <QStandardPaths>
+
+#include "MsgJournal.h"
+
+using namespace std;
+
+static const string  LOGPREFIX("MsgJournal:: ");
+static const quint32 FILE_MAGIC   = 0x4C4E4A4D; //"MJNL"
+static const quint32 FILE_VERSION = 1;
+static const quint32 REC_MAGIC    = 0x5243454D; //"MECR"
+
+MsgJournal *MsgJournal::sInstance = 0;
+
+MsgJournal &MsgJournal::instance()
+{
+    if (sInstance == 0)
+        sInstance = new MsgJournal();
+    return *sInstance;
+}
+
+void MsgJournal::destroy()
+{
+    delete sInstance;
+    sInstance = 0;
+}
+
+bool MsgJournal::open(Logger *logger, int userId)
+{
+    QString dir(QStandardPaths::writableLocation(
+                                       QStandardPaths::AppLocalDataLocation) +
+                "/journal/");
+    QString fn(dir + QString::number(userId) + ".jnl");
+    if (isOpen() && mFile.fileName() == fn)
+        return true;
+    close();
+    mLogger = logger;
+    QDir().mkpath(dir);
+    mFile.setFileName(fn);
+    if (!mFile.open(QIODevice::ReadWrite))
+    {
+        LOGGER_ERROR(mLogger, LOGPREFIX << "open: Failed to open "
+                     << fn.toStdString() << ", "
+                     << mFile.errorString().toStdString());
+        return false;
+    }
+    qint64 sz = mFile.size();
+    if (!remap((sz < INIT_BYTES)? qint64(INIT_BYTES): sz))
+        return false;
+    if (hdr()->magic != FILE_MAGIC || hdr()->version != FILE_VERSION ||
+        hdr()->end < sizeof(FileHdrT) || hdr()->end > quint64(mSize))
+    {
+        if (sz != 0)
+            LOGGER_WARNING(mLogger, LOGPREFIX << "open: Discarding invalid "
+                           "journal " << fn.toStdString());
+        hdr()->magic = FILE_MAGIC;
+        hdr()->version = FILE_VERSION;
+        hdr()->end = sizeof(FileHdrT);
+    }
+    buildIndexes();
+    mOpenTime = QDateTime::currentSecsSinceEpoch();
+    LOGGER_DEBUG(mLogger, LOGPREFIX << "open: " << fn.toStdString() << ", "
+                 << mOffsets.size() << " entries");
+    return true;
+}
+
+void MsgJournal::close()
+{
+    if (mData != 0)
+    {
+        mFile.unmap(mData);
+        mData = 0;
+    }
+    mFile.close();
+    mSize = 0;
+    mOffsets.clear();
+    mIdIndex.clear();
+    mWordIndex.clear();
+}
+
+void MsgJournal::add(const EntryT &entry)
+{
+    if (!isOpen())
+        return;
+    QByteArray txt(entry.text.toUtf8());
+    quint64 size = (sizeof(RecHdrT) + txt.size() + 7) & ~quint64(7);
+    if (hdr()->end + size > quint64(mSize))
+    {
+        qint64 sz = mSize;
+        while (sz < MAX_BYTES && hdr()->end + size > quint64(sz))
+        {
+            sz *= 2;
+        }
+        if (sz > MAX_BYTES)
+            sz = MAX_BYTES;
+        if (sz > mSize && !remap(sz))
+            return;
+        if (hdr()->end + size > quint64(mSize))
+            compact();
+        if (hdr()->end + size > quint64(mSize))
+            return; //should not occur with any sensible message length
+    }
+    auto *r = reinterpret_cast<RecHdrT *>(mData + hdr()->end);
+    r->magic = REC_MAGIC;
+    r->size = size;
+    //keep the records in time order for search()
+    r->time = entry.time;
+    if (!mOffsets.empty() && r->time < rec(mOffsets.size() - 1)->time)
+        r->time = rec(mOffsets.size() - 1)->time;
+    r->type = entry.type;
+    r->from = entry.from;
+    r->fromType = entry.fromType;
+    r->to = entry.to;
+    r->toType = entry.toType;
+    r->code = entry.code;
+    r->textLen = txt.size();
+    r->reserved = 0;
+    memcpy(r + 1, txt.constData(), txt.size());
+    //commit only after the record is complete
+    mOffsets.push_back(hdr()->end);
+    hdr()->end += size;
+    addToIndexes(mOffsets.size() - 1);
+}
+
+qint64 MsgJournal::getStartTime() const
+{
+    if (!isOpen())
+        return -1;
+    if (!mOffsets.empty() && rec(0)->time > mOpenTime)
+        return rec(0)->time;
+    return mOpenTime;
+}
+
+int MsgJournal::getLast(int       type,
+                        int       from,
+                        int       to,
+                        bool      doAnd,
+                        int       count,
+                        EntriesT &entries)
+{
+    entries.clear();
+    if (!isOpen() || count <= 0)
+        return 0;
+    EntryT e;
+    if (from == 0 && to == 0)
+    {
+        for (auto i=mOffsets.size(); i>0 && int(entries.size())<count; --i)
+        {
+            if (matches(rec(i - 1), type, 0, 0, doAnd))
+            {
+                toEntry(rec(i - 1), e);
+                entries.push_back(e);
+            }
+        }
+    }
+    else
+    {
+        PostingsT recs;
+        getIdPostings(from, to, doAnd, recs);
+        for (auto it=recs.rbegin();
+             it!=recs.rend() && int(entries.size())<count;
+             ++it)
+        {
+            if (matches(rec(*it), type, from, to, doAnd))
+            {
+                toEntry(rec(*it), e);
+                entries.push_back(e);
+            }
+        }
+    }
+    return entries.size();
+}
+
+int MsgJournal::search(qint64          startTime,
+                       qint64          endTime,
+                       const QString  &text,
+                       int             type,
+                       int             from,
+                       int             to,
+                       bool            doAnd,
+                       EntriesT       &entries)
+{
+    entries.clear();
+    if (!isOpen())
+        return 0;
+    //get the record number range in the period, records being in time order
+    quint32 lo = 0;
+    quint32 hi = mOffsets.size();
+    quint32 n;
+    while (lo < hi)
+    {
+        n = lo + (hi - lo)/2;
+        if (rec(n)->time < startTime)
+            lo = n + 1;
+        else
+            hi = n;
+    }
+    hi = mOffsets.size();
+    quint32 first = lo;
+    while (lo < hi)
+    {
+        n = lo + (hi - lo)/2;
+        if (rec(n)->time <= endTime)
+            lo = n + 1;
+        else
+            hi = n;
+    }
+    if (first >= lo)
+        return 0;
+    QStringList terms;
+    QString s(text.trimmed());
+    if (s.size() > 1 && s.startsWith('"') && s.endsWith('"'))
+        terms << s.mid(1, s.size() - 2).toLower();
+    else
+        terms = s.toLower().split(' ', QString::SkipEmptyParts);
+    bool useAll = false;
+    PostingsT recs;
+    if (!terms.isEmpty())
+    {
+        for (const auto &t : terms)
+        {
+            //look up the longest word in the term, and verify the term later
+            QString w;
+            for (const auto &tw : t.split(QRegularExpression("\\W+"),
+                                          QString::SkipEmptyParts))
+            {
+                if (tw.size() > w.size())
+                    w = tw;
+            }
+            if (w.isEmpty())
+            {
+                useAll = true; //no word to look up, so check all
+                break;
+            }
+            getWordPostings(w, recs);
+        }
+        if (!useAll)
+        {
+            sort(recs.begin(), recs.end());
+            recs.erase(unique(recs.begin(), recs.end()), recs.end());
+        }
+    }
+    else if (from != 0 || to != 0)
+    {
+        getIdPostings(from, to, doAnd, recs);
+    }
+    else
+    {
+        useAll = true;
+    }
+    if (useAll)
+    {
+        recs.clear();
+        for (n=first; n<lo; ++n)
+        {
+            recs.push_back(n);
+        }
+    }
+    EntryT e;
+    const RecHdrT *r;
+    for (auto it=recs.rbegin();
+         it!=recs.rend() && int(entries.size())<MAX_RESULTS;
+         ++it)
+    {
+        if (*it >= lo)
+            continue;
+        if (*it < first)
+            break;
+        r = rec(*it);
+        if (!matches(r, type, from, to, doAnd))
+            continue;
+        if (!terms.isEmpty())
+        {
+            s = getText(r);
+            if (r->code >= 0)
+                s.append(' ').append(QString::number(r->code));
+            for (n=0; int(n)<terms.size(); ++n)
+            {
+                if (s.contains(terms[n], Qt::CaseInsensitive))
+                    break;
+            }
+            if (int(n) == terms.size())
+                continue;
+        }
+        toEntry(r, e);
+        entries.push_back(e);
+    }
+    return entries.size();
+}
+
+bool MsgJournal::remap(qint64 size)
+{
+    if (mData != 0)
+    {
+        mFile.unmap(mData);
+        mData = 0;
+    }
+    if (mFile.size() < size && !mFile.resize(size))
+    {
+        LOGGER_ERROR(mLogger, LOGPREFIX << "remap: Failed to resize "
+                     << mFile.fileName().toStdString() << " to " << size
+                     << ", " << mFile.errorString().toStdString());
+    }
+    else
+    {
+        mData = mFile.map(0, size);
+        if (mData != 0)
+        {
+            mSize = size;
+            return true;
+        }
+        LOGGER_ERROR(mLogger, LOGPREFIX << "remap: Failed to map "
+                     << mFile.fileName().toStdString() << ", "
+                     << mFile.errorString().toStdString());
+    }
+    close();
+    return false;
+}
+
+void MsgJournal::compact()
+{
+    quint64 start = sizeof(FileHdrT);
+    quint64 end = hdr()->end;
+    auto it = lower_bound(mOffsets.begin(), mOffsets.end(),
+                          start + (end - start)/2);
+    quint64 keep = (it == mOffsets.end())? end: *it;
+    LOGGER_DEBUG(mLogger, LOGPREFIX << "compact: Discarding "
+                 << (it - mOffsets.begin()) << " entries");
+    memmove(mData + start, mData + keep, end - keep);
+    hdr()->end = start + end - keep;
+    buildIndexes();
+}
+
+void MsgJournal::buildIndexes()
+{
+    mOffsets.clear();
+    mIdIndex.clear();
+    mWordIndex.clear();
+    quint64 end = hdr()->end;
+    quint64 off = sizeof(FileHdrT);
+    const RecHdrT *r;
+    while (off + sizeof(RecHdrT) <= end)
+    {
+        r = reinterpret_cast<const RecHdrT *>(mData + off);
+        if (r->magic != REC_MAGIC || r->size < sizeof(RecHdrT) ||
+            sizeof(RecHdrT) + r->textLen > r->size || off + r->size > end)
+            break;
+        mOffsets.push_back(off);
+        addToIndexes(mOffsets.size() - 1);
+        off += r->size;
+    }
+    if (off != end)
+    {
+        LOGGER_WARNING(mLogger, LOGPREFIX << "buildIndexes: Dropping "
+                       << (end - off) << " bytes of invalid data");
+        hdr()->end = off;
+    }
+}
+
+void MsgJournal::addToIndexes(quint32 recNum)
+{
+    const RecHdrT *r = rec(recNum);
+    if (r->from != 0)
+        mIdIndex[r->from].push_back(recNum);
+    if (r->to != 0 && r->to != r->from)
+        mIdIndex[r->to].push_back(recNum);
+    for (const auto &w : getWords(r))
+    {
+        PostingsT &p(mWordIndex[w]);
+        //a word may occur more than once in a record
+        if (p.empty() || p.back() != recNum)
+            p.push_back(recNum);
+    }
+}
+
+void MsgJournal::getIdPostings(int from, int to, bool doAnd, PostingsT &recs)
+{
+    recs.clear();
+    auto itFrom = mIdIndex.constFind(from);
+    auto itTo = mIdIndex.constFind(to);
+    const PostingsT *pFrom = (from == 0 || itFrom == mIdIndex.constEnd())?
+                             0: &*itFrom;
+    const PostingsT *pTo = (to == 0 || itTo == mIdIndex.constEnd())?
+                           0: &*itTo;
+    if (from != 0 && to != 0 && doAnd)
+    {
+        //both required - the shorter list suffices for matches()
+        if (pFrom != 0 && pTo != 0)
+            recs = (pFrom->size() < pTo->size())? *pFrom: *pTo;
+    }
+    else if (pFrom != 0 && pTo != 0)
+    {
+        set_union(pFrom->begin(), pFrom->end(), pTo->begin(), pTo->end(),
+                  back_inserter(recs));
+    }
+    else if (pFrom != 0)
+    {
+        recs = *pFrom;
+    }
+    else if (pTo != 0)
+    {
+        recs = *pTo;
+    }
+}
+
+void MsgJournal::getWordPostings(const QString &term, PostingsT &recs)
+{
+    //the vocabulary is much smaller than the records, so a substring scan
+    //of it is cheap
+    for (auto it=mWordIndex.constBegin(); it!=mWordIndex.constEnd(); ++it)
+    {
+        if (it.key().contains(term))
+            recs.insert(recs.end(), it->begin(), it->end());
+    }
+}
+
+bool MsgJournal::matches(const RecHdrT *r, int type, int from, int to,
+                         bool doAnd)
+{
+    if (type >= 0 && r->type != type)
+        return false;
+    bool f = (from == 0 || r->from == from);
+    bool t = (to == 0 || r->to == to);
+    if (from != 0 && to != 0 && !doAnd)
+        return (f || t);
+    return (f && t);
+}
+
+QString MsgJournal::getText(const RecHdrT *r)
+{
+    return QString::fromUtf8(reinterpret_cast<const char *>(r + 1),
+                             r->textLen);
+}
+
+QStringList MsgJournal::getWords(const RecHdrT *r)
+{
+    QStringList l(getText(r).toLower().split(QRegularExpression("\\W+"),
+                                             QString::SkipEmptyParts));
+    if (r->code >= 0)
+        l << QString::number(r->code);
+    return l;
+}
+
+void MsgJournal::toEntry(const RecHdrT *r, EntryT &entry)
+{
+    entry.time = r->time;
+    entry.type = r->type;
+    entry.from = r->from;
+    entry.fromType = r->fromType;
+    entry.to = r->to;
+    entry.toType = r->toType;
+    entry.code = r->code;
+    entry.text = getText(r);
+}
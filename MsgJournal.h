@@ -0,0 +1,275 @@
+/**
+ * Local archive of SDS and Status Messages seen by this client.
+ * Messages are appended to a memory-mapped journal file per user, with
+ * in-memory indexes by sender/recipient ID and by text word, so that recent
+ * and keyword lookups need no database query, and still work when the
+ * database is not available.
+ * The indexes are rebuilt from the journal on open. When the journal reaches
+ * its size limit, the older half is discarded.
+ * Must be used in the GUI thread only.
+ *
+ * Copyright (C) Sapura Secured Technologies, 2026. All Rights Reserved.
+ *
+ * @file
+ * @version $Id$
+ * @author agent <agent@local>
+ */
+#ifndef MSGJOURNAL_H
+#define MSGJOURNAL_H
+
+#include <vector>
+#include <QFile>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+
+#include "Logger.h"
+
+class MsgJournal
+{
+public:
+    struct EntryT
+    {
+        EntryT() : time(0), type(0), from(0), fromType(0), to(0), toType(0),
+                   code(-1) {}
+
+        qint64  time;     //secs since epoch
+        int     type;     //CmnTypes::COMMS_MSG_SDS/COMMS_MSG_STATUS
+        int     from;
+        int     fromType; //CmnTypes::eIdType
+        int     to;
+        int     toType;
+        int     code;     //Status code, or -1 for SDS
+        QString text;     //SDS text or Status text
+    };
+    typedef std::vector<EntryT> EntriesT;
+
+    //maximum number of search results
+    static const int MAX_RESULTS = 5000;
+
+    /**
+     * Instantiates the singleton if it has not been created.
+     *
+     * @return The instance.
+     */
+    static MsgJournal &instance();
+
+    /**
+     * Deletes the single instance.
+     */
+    static void destroy();
+
+    /**
+     * Opens the journal of a user, creating it if necessary, and closes the
+     * currently open one if different.
+     *
+     * @param[in] logger App logger.
+     * @param[in] userId The user ID.
+     * @return true if successful.
+     */
+    bool open(Logger *logger, int userId);
+
+    /**
+     * Closes the journal.
+     */
+    void close();
+
+    bool isOpen() const { return (mData != 0); }
+
+    /**
+     * Gets the start of the period in which the journal has all messages
+     * seen by this client - since it was opened, or since the oldest record
+     * if older ones have been discarded.
+     *
+     * @return The time in secs since epoch, or -1 if not open.
+     */
+    qint64 getStartTime() const;
+
+    /**
+     * Appends an entry. Does nothing if the journal is not open.
+     *
+     * @param[in] entry The entry. Its time must not be earlier than the
+     *                  previous entry.
+     */
+    void add(const EntryT &entry);
+
+    /**
+     * Gets the latest entries involving specific resources.
+     *
+     * @param[in]  type    The message type - CmnTypes::COMMS_MSG_SDS/
+     *                     COMMS_MSG_STATUS, or -1 for both.
+     * @param[in]  from    The sender. 0 for any.
+     * @param[in]  to      The recipient. 0 for any.
+     * @param[in]  doAnd   true to AND 'from' and 'to', false to OR.
+     * @param[in]  count   The maximum number of entries.
+     * @param[out] entries The entries, newest first.
+     * @return The number of entries.
+     */
+    int getLast(int       type,
+                int       from,
+                int       to,
+                bool      doAnd,
+                int       count,
+                EntriesT &entries);
+
+    /**
+     * Searches for entries in a period.
+     *
+     * @param[in]  startTime The start time in secs since epoch.
+     * @param[in]  endTime   The end time in secs since epoch.
+     * @param[in]  text      The text keywords in one of the following
+     *                       formats, as in DbInt::getSdsHistory():
+     *                       -Space separated words for any occurence of
+     *                        either word (case-insensitive).
+     *                       -Quoted string for any occurence of a phrase
+     *                        (case-insensitive).
+     *                       -Empty if not applicable.
+     *                       A Status code matches its number.
+     * @param[in]  type      See getLast().
+     * @param[in]  from      See getLast().
+     * @param[in]  to        See getLast().
+     * @param[in]  doAnd     See getLast().
+     * @param[out] entries   The latest MAX_RESULTS entries, newest first.
+     * @return The number of entries.
+     */
+    int search(qint64          startTime,
+               qint64          endTime,
+               const QString  &text,
+               int             type,
+               int             from,
+               int             to,
+               bool            doAnd,
+               EntriesT       &entries);
+
+private:
+    struct FileHdrT
+    {
+        quint32 magic;
+        quint32 version;
+        quint64 end;      //end of last complete record
+    };
+
+    struct RecHdrT
+    {
+        quint32 magic;    //to detect a partially written record
+        quint32 size;     //including header and padding
+        qint64  time;
+        qint32  type;
+        qint32  from;
+        qint32  fromType;
+        qint32  to;
+        qint32  toType;
+        qint32  code;
+        quint32 textLen;  //UTF-8 bytes following the header
+        quint32 reserved;
+    };
+
+    typedef std::vector<quint32> PostingsT;   //record numbers, ascending
+
+    static const qint64 INIT_BYTES = 1LL << 20;
+    static const qint64 MAX_BYTES  = 64LL << 20;
+
+    static MsgJournal *sInstance;
+
+    Logger              *mLogger;
+    QFile                mFile;
+    uchar               *mData;     //mapped file
+    qint64               mSize;     //mapped size
+    qint64               mOpenTime; //secs since epoch
+    std::vector<quint32> mOffsets;  //indexed by record number, oldest first
+    QHash<int, PostingsT>     mIdIndex;   //key is sender/recipient ID
+    QHash<QString, PostingsT> mWordIndex; //key is lowercase word
+
+    MsgJournal() : mLogger(0), mData(0), mSize(0), mOpenTime(0) {}
+
+    ~MsgJournal() { close(); }
+
+    FileHdrT *hdr() { return reinterpret_cast<FileHdrT *>(mData); }
+
+    const RecHdrT *rec(quint32 recNum) const
+    {
+        return reinterpret_cast<const RecHdrT *>(mData + mOffsets[recNum]);
+    }
+
+    /**
+     * Maps the file with a new size.
+     *
+     * @param[in] size The size.
+     * @return true if successful.
+     */
+    bool remap(qint64 size);
+
+    /**
+     * Discards the older half of the records.
+     */
+    void compact();
+
+    /**
+     * Rebuilds the indexes from the records, and drops any partially written
+     * record at the end.
+     */
+    void buildIndexes();
+
+    /**
+     * Adds a record to the indexes.
+     *
+     * @param[in] recNum The record number.
+     */
+    void addToIndexes(quint32 recNum);
+
+    /**
+     * Gets the candidate records matching one ID filter.
+     *
+     * @param[in]  from  See getLast().
+     * @param[in]  to    See getLast().
+     * @param[in]  doAnd See getLast().
+     * @param[out] recs  The record numbers.
+     */
+    void getIdPostings(int from, int to, bool doAnd, PostingsT &recs);
+
+    /**
+     * Gets the candidate records containing any word that contains a term.
+     *
+     * @param[in]  term The lowercase term.
+     * @param[out] recs The record numbers, merged into existing ones.
+     */
+    void getWordPostings(const QString &term, PostingsT &recs);
+
+    /**
+     * Checks whether a record matches the non-text filters.
+     *
+     * @param[in] r     The record.
+     * @param[in] type  See getLast().
+     * @param[in] from  See getLast().
+     * @param[in] to    See getLast().
+     * @param[in] doAnd See getLast().
+     * @return true if matching.
+     */
+    static bool matches(const RecHdrT *r, int type, int from, int to,
+                        bool doAnd);
+
+    /**
+     * Gets the text of a record.
+     *
+     * @param[in] r The record.
+     * @return The text.
+     */
+    static QString getText(const RecHdrT *r);
+
+    /**
+     * Gets the index words of a record.
+     *
+     * @param[in] r The record.
+     * @return The lowercase words.
+     */
+    static QStringList getWords(const RecHdrT *r);
+
+    /**
+     * Converts a record to an entry.
+     *
+     * @param[in]  r     The record.
+     * @param[out] entry The entry.
+     */
+    static void toEntry(const RecHdrT *r, EntryT &entry);
+};
+#endif //MSGJOURNAL_H
@@ -7,8 +7,9 @@
  * @version $Id: MsgSip.cpp 1704 2023-05-31 02:24:24Z rosnin $
  * @author Ahmad Syukri
  */
-#include <sstream>
 #include <assert.h>
+#include <ctype.h>  //isspace
+#include <string.h> //memchr
 
 #include "Utils.h"
 #include "MsgSip.h"
@@ -17,6 +18,73 @@ using namespace std;
 
 static const string SIP_PREFIX("SIP/");
 
+/**
+ * Checks whether a character is a space or tab.
+ *
+ * @param[in] c The character.
+ * @return true if space or tab.
+ */
+static inline bool isSpace(char c)
+{
+    return (c == ' ' || c == '\t');
+}
+
+/**
+ * Shrinks a character range to exclude leading and trailing whitespace.
+ *
+ * @param[in,out] begin The range start.
+ * @param[in,out] end   The range end.
+ */
+static inline void trimRange(const char *&begin, const char *&end)
+{
+    while (begin != end && isspace(static_cast<unsigned char>(*begin)))
+    {
+        ++begin;
+    }
+    while (end != begin && isspace(static_cast<unsigned char>(end[-1])))
+    {
+        --end;
+    }
+}
+
+/**
+ * Finds the start of the line after the given one.
+ *
+ * @param[in] line The line start.
+ * @param[in] end  The data end.
+ * @return The next line start, or end if this is the last line.
+ */
+static inline const char *nextLine(const char *line, const char *end)
+{
+    const char *p = static_cast<const char *>(memchr(line, '\n', end - line));
+    return (p == 0)? end: p + 1;
+}
+
+/**
+ * Converts a decimal number in a character range, ignoring surrounding
+ * whitespace and any trailing non-digits.
+ *
+ * @param[in] data The data.
+ * @param[in] len  The data length.
+ * @return The value, or MsgSip::Value::UNDEFINED if there are no digits.
+ */
+static int toInt(const char *data, size_t len)
+{
+    const char *end = data + len;
+    trimRange(data, end);
+    bool neg = false;
+    if (data != end && (*data == '-' || *data == '+'))
+        neg = (*data++ == '-');
+    if (data == end || *data < '0' || *data > '9')
+        return MsgSip::Value::UNDEFINED;
+    int val = 0;
+    for (; data != end && *data >= '0' && *data <= '9'; ++data)
+    {
+        val = val * 10 + (*data - '0');
+    }
+    return (neg)? -val: val;
+}
+
 //static initializers
 const string     MsgSip::Value::ENDL("\r\n");
 const string     MsgSip::Value::SIP_VERSION("SIP/2.0");
@@ -69,9 +137,7 @@ MsgSip &MsgSip::addField(int key, const string &value)
 
 MsgSip &MsgSip::addField(int key, int value)
 {
-    ostringstream os;
-    os << value;
-    mFields[key] = os.str();
+    mFields[key] = Utils::toString(value);
     return *this;
 }
 
@@ -123,14 +189,10 @@ string MsgSip::getFieldString(int key) const
 
 int MsgSip::getFieldInt(int key) const
 {
-    int retVal = Value::UNDEFINED;
     auto it = mFields.find(key);
     if (it != mFields.end())
-    {
-        istringstream is(it->second);
-        is >> retVal;
-    }
-    return retVal;
+        return toInt(it->second.c_str(), it->second.size());
+    return Value::UNDEFINED;
 }
 
 string MsgSip::getSubfieldString(int key, int subkey) const
@@ -147,7 +209,8 @@ string MsgSip::getSubfieldString(int key, int subkey) const
 
 char *MsgSip::getBytes(int &len) const
 {
-    string msg(toString());
+    string msg;
+    serialize(msg);
     len = msg.length();
     if (len == 0)
         return 0;
@@ -156,20 +219,29 @@ char *MsgSip::getBytes(int &len) const
     return bytes;
 }
 
-string MsgSip::toString(const string &endln) const
+string &MsgSip::serialize(string &out, const string &endln) const
 {
-    ostringstream os;
-    os << mStartLine << endln;
-
+    out.clear();
+    if (out.capacity() < 512)
+        out.reserve(512 + mContentBody.size());
+    out.append(mStartLine).append(endln);
+    NameMapT::const_iterator nameIt;
     for (const auto &it : mFields)
     {
-        os << sFieldNameMap[it.first] << Value::FIELD_DELIMITER << ' '
-           << it.second << endln;
+        nameIt = sFieldNameMap.find(it.first);
+        out.append((nameIt == sFieldNameMap.end())?
+                   sFieldNameMap[Field::UNDEFINED]: nameIt->second)
+           .append(1, Value::FIELD_DELIMITER).append(1, ' ')
+           .append(it.second).append(endln);
     }
-    os << endln;
-    if (mContentBody.size() > 0)
-        os << mContentBody;
-    return os.str();
+    out.append(endln).append(mContentBody);
+    return out;
+}
+
+string MsgSip::toString(const string &endln) const
+{
+    string s;
+    return serialize(s, endln);
 }
 
 const string &MsgSip::getName() const
@@ -182,9 +254,8 @@ const string &MsgSip::getName() const
 MsgSip &MsgSip::setSeqId(int seqId)
 {
     mSeqId = seqId;
-    ostringstream os;
-    os << mSeqId << ' ' << getName();
-    addField(MsgSip::Field::CSEQ, os.str());
+    mFields[Field::CSEQ].assign(Utils::toString(mSeqId)).append(1, ' ')
+                        .append(getName());
     return *this;
 }
 
@@ -195,26 +266,24 @@ int MsgSip::getReasonCause() const
 
 int MsgSip::getParamInt(int key, const string &param) const
 {
-    int    val = Value::UNDEFINED;
-    string s(getFieldString(key));
-    if (!s.empty())
+    auto it = mFields.find(key);
+    if (it == mFields.end() || param.empty())
+        return Value::UNDEFINED;
+    const string &s(it->second);
+    size_t pos = s.find(param);
+    if (pos == string::npos)
+        return Value::UNDEFINED;
+    pos += param.length();
+    if (param.back() != Value::PAIR_DELIMITER)
     {
-        string p(param);
-        if (p.back() != Value::PAIR_DELIMITER)
-            p.append(1, Value::PAIR_DELIMITER);
-        size_t pos = s.find(p);
-        if (pos != string::npos)
-        {
-            s.erase(0, pos + p.length());
-            istringstream is(s);
-            if (getline(is, p, Value::PARAM_DELIMITER))
-            {
-                is.str(p);
-                is >> val;
-            }
-        }
+        if (pos >= s.size() || s[pos] != Value::PAIR_DELIMITER)
+            return Value::UNDEFINED;
+        ++pos;
     }
-    return val;
+    size_t end = s.find(Value::PARAM_DELIMITER, pos);
+    if (end == string::npos)
+        end = s.size();
+    return toInt(s.data() + pos, end - pos);
 }
 
 bool MsgSip::hasSubfieldHeader(int key) const
@@ -224,9 +293,8 @@ bool MsgSip::hasSubfieldHeader(int key) const
 
 int MsgSip::getTypeId(const string &key)
 {
-    if (sTypeIdMap.count(key) == 0)
-        return Type::UNDEFINED;
-    return sTypeIdMap[key];
+    auto it = sTypeIdMap.find(key);
+    return (it == sTypeIdMap.end())? Type::UNDEFINED: it->second;
 }
 
 const string &MsgSip::getFieldName(int id)
@@ -238,102 +306,165 @@ const string &MsgSip::getFieldName(int id)
 
 int MsgSip::getFieldId(const string &key)
 {
-    if (sFieldIdMap.count(key) == 0)
-        return Field::UNDEFINED;
-    return sFieldIdMap[key];
+    auto it = sFieldIdMap.find(key);
+    return (it == sFieldIdMap.end())? Field::UNDEFINED: it->second;
 }
 
 int MsgSip::getSubfieldId(const string &key)
 {
-    if (sSubfieldIdMap.count(key) == 0)
-        return Subfield::UNDEFINED;
-    return sSubfieldIdMap[key];
+    auto it = sSubfieldIdMap.find(key);
+    return (it == sSubfieldIdMap.end())? Subfield::UNDEFINED: it->second;
 }
 
 #ifdef SIPTCP
 MsgSip *MsgSip::parse(const string &str, int &contentLen)
+{
+    //header only - content body is framed separately in TCP
+    size_t pos = str.find(Value::TERMINATOR);
+    return parse(str.data(),
+                 (pos == string::npos)? str.size():
+                                        pos + Value::TERMINATOR.size(),
+                 contentLen);
+}
 #else
 MsgSip *MsgSip::parse(const string &str)
+{
+    return parse(str.data(), str.size());
+}
+#endif
+
+#ifdef SIPTCP
+MsgSip *MsgSip::parse(const char *data, size_t len, int &contentLen)
+#else
+MsgSip *MsgSip::parse(const char *data, size_t len)
 #endif
 {
 #ifdef SIPTCP
     contentLen = 0;
 #endif
-    MsgSip *msg = new MsgSip();
-    istringstream is(str);
-    string val1;
-    getline(is, val1);
-    msg->mStartLine = val1;
+    const char *end = data + len;
+    const char *line = data;
+    const char *eol = nextLine(line, end);
     //difference between request and response message is the start line
     //  request:  <Method> <Request URI> <SIP Version>
     //            e.g. REGISTER sip:10.12.49.86 SIP/2.0
     //  response: <SIP Version> <Response Code> <Reason Phrase>
     //            e.g. SIP/2.0 401 Unauthorized
-    istringstream iss(val1);
-    string value;
-    iss >> value;
-    int id;
+    const char *p1 = line;
+    const char *p2 = eol;
+    trimRange(p1, p2);
+    if (p1 == p2)
+        return 0;
+    MsgSip *msg = new MsgSip();
+    msg->mStartLine.assign(p1, p2 - p1);
+    const char *tok = p1;
+    while (p1 != p2 && !isSpace(*p1))
+    {
+        ++p1;
+    }
+    const char *tokEnd = p1;
+    while (p1 != p2 && isSpace(*p1))
+    {
+        ++p1;
+    }
+    const char *tok2 = p1;
+    while (p1 != p2 && !isSpace(*p1))
+    {
+        ++p1;
+    }
     //match the SIP_PREFIX part only, to handle different versions
-    if (value.find(SIP_PREFIX) == 0)
+    if (size_t(tokEnd - tok) >= SIP_PREFIX.size() &&
+        SIP_PREFIX.compare(0, string::npos, tok, SIP_PREFIX.size()) == 0)
     {
-        if (!(iss >> id))
+        int code = toInt(tok2, p1 - tok2);
+        if (code == Value::UNDEFINED)
         {
             delete msg;
             return 0;
         }
-        msg->setRespCode(id);
+        msg->setRespCode(code);
     }
     else
     {
-        iss >> msg->mReqUri;
+        msg->mReqUri.assign(tok2, p1 - tok2);
     }
-    //each message has a header part and optionally a content body, separated by
-    //a TERMINATOR - in UDP, the content body is included in str here, but in
-    //TCP, it is not
-    size_t pos = str.find(MsgSip::Value::TERMINATOR);
-#ifndef SIPTCP
-    if (pos != string::npos)
+    int id = Field::UNDEFINED;
+    string key;
+    for (line = eol; line < end; line = eol)
     {
-        pos += Value::TERMINATOR.size();
-        if (pos < str.size())
-            msg->setContentBody(str.substr(pos));
-    }
+        eol = nextLine(line, end);
+        p2 = eol;
+        //strip the line terminator
+        while (p2 != line && (p2[-1] == '\n' || p2[-1] == '\r'))
+        {
+            --p2;
+        }
+        //a blank line ends the header
+        if (p2 == line)
+        {
+#ifndef SIPTCP
+            //in UDP, the content body follows in the same datagram
+            if (eol < end)
+                msg->mContentBody.assign(eol, end - eol);
 #endif
-    id = Field::UNDEFINED;
-    int n;
-    string val2;
-    while (getline(is, val1))
-    {
-        //the last line may be a blank line, i.e. with CRLF only,
-        //on Linux this means a line with 1 character CR
-        if (val1.size() <= 1)
             break;
-        pos = val1.find(MsgSip::Value::FIELD_DELIMITER);
-        if (pos == string::npos)
+        }
+        p1 = static_cast<const char *>(memchr(line, Value::FIELD_DELIMITER,
+                                              p2 - line));
+        if (p1 == 0)
         {
             //continuation of previous field value, only if this starts with a
             //space or tab
-            if (id != Field::UNDEFINED && (val1[0] == ' ' || val1[0] == '\t') &&
-                Utils::trim(val1) != 0)
-                msg->mFields[id].append(" ").append(val1);
+            if (id != Field::UNDEFINED && (*line == ' ' || *line == '\t'))
+            {
+                p1 = line;
+                trimRange(p1, p2);
+                if (p1 != p2)
+                {
+                    string &value(msg->mFields[id]);
+                    value.append(" ").append(p1, p2 - p1);
+                    if (id == Field::PROXY_AUTHENTICATE ||
+                        id == Field::WWW_AUTHENTICATE)
+                        parseSubfields(value, msg->mSubfields[id]);
+                }
+            }
             continue;
         }
-        val1.replace(pos, 1, " ");
-        istringstream isLine(val1);
-        isLine >> val2;
-        id = getFieldId(val2);
-        getline(isLine, value);
-        if (Utils::trim(value) == 0)
+        tok = line;
+        tokEnd = p1;
+        trimRange(tok, tokEnd);
+        key.assign(tok, tokEnd - tok);
+        id = getFieldId(key);
+        ++p1;
+        trimRange(p1, p2);
+        if (p1 == p2)
             continue;
-        msg->mFields[id] = value;
+        string &value(msg->mFields[id]);
+        value.assign(p1, p2 - p1);
         switch (id)
         {
             case Field::CSEQ:
             {
-                isLine.clear();
-                isLine.str(value);
-                isLine >> msg->mSeqId >> value;
-                msg->setType(getTypeId(value));
+                //e.g. CSeq: 4 INVITE
+                tok = p1;
+                while (p1 != p2 && !isSpace(*p1))
+                {
+                    ++p1;
+                }
+                msg->mSeqId = toInt(tok, p1 - tok);
+                if (msg->mSeqId == Value::UNDEFINED)
+                    msg->mSeqId = 0;
+                while (p1 != p2 && isSpace(*p1))
+                {
+                    ++p1;
+                }
+                tok = p1;
+                while (p1 != p2 && !isSpace(*p1))
+                {
+                    ++p1;
+                }
+                key.assign(tok, p1 - tok);
+                msg->setType(getTypeId(key));
                 break;
             }
             case Field::PROXY_AUTHENTICATE:
@@ -343,33 +474,15 @@ MsgSip *MsgSip::parse(const string &str)
                 //e.g. Digest realm="10.12.49.86",
                 //nonce="7d686854-f293-4708-b34b-ab6492a7265f",
                 //algorithm=MD5, qop="auth"
-                val1.assign(sSubfieldNameMap[Subfield::DIGEST]).append(" ");
-                pos = value.find(val1);
-                if (pos != string::npos)
-                    value.erase(0, pos + val1.length());
-                isLine.clear();
-                isLine.str(value);
-                while (getline(isLine, value, Value::LIST_DELIMITER))
-                {
-                    pos = value.find(Value::PAIR_DELIMITER);
-                    if (pos != string::npos)
-                    {
-                        val1 = value.substr(0, pos);
-                        Utils::trim(val1);
-                        val2 = value.substr(pos + 1);
-                        n = Utils::trim(val2) - 1;
-                        //remove double quotes at beginning and end of value
-                        if (n > 0 && val2[0] == '\"' && val2[n] == '\"')
-                            val2.erase(n, 1).erase(0, 1);
-                        msg->mSubfields[id][getSubfieldId(val1)] = val2;
-                    }
-                }
+                parseSubfields(value, msg->mSubfields[id]);
                 break;
             }
 #ifdef SIPTCP
             case Field::CONTENT_LENGTH:
             {
-                contentLen = Utils::fromString<int>(value);
+                contentLen = toInt(p1, p2 - p1);
+                if (contentLen < 0)
+                    contentLen = 0;
                 break;
             }
 #endif
@@ -382,6 +495,127 @@ MsgSip *MsgSip::parse(const string &str)
     return msg;
 }
 
+void MsgSip::parseSubfields(const string &value, FieldsMapT &subfields)
+{
+    const string &digest(sSubfieldNameMap[Subfield::DIGEST]);
+    size_t pos = value.find(digest + " ");
+    const char *p = value.data();
+    const char *end = p + value.size();
+    if (pos != string::npos)
+        p += pos + digest.size() + 1;
+    const char *item;
+    const char *itemEnd;
+    const char *eq;
+    const char *tagEnd;
+    string tag;
+    while (p < end)
+    {
+        item = p;
+        itemEnd = static_cast<const char *>(memchr(p, Value::LIST_DELIMITER,
+                                                   end - p));
+        if (itemEnd == 0)
+            itemEnd = end;
+        p = itemEnd + 1;
+        eq = static_cast<const char *>(memchr(item, Value::PAIR_DELIMITER,
+                                              itemEnd - item));
+        if (eq == 0)
+            continue;
+        tagEnd = eq;
+        trimRange(item, tagEnd);
+        tag.assign(item, tagEnd - item);
+        ++eq;
+        trimRange(eq, itemEnd);
+        //remove double quotes at beginning and end of value
+        if (itemEnd - eq >= 2 && *eq == '\"' && itemEnd[-1] == '\"')
+        {
+            ++eq;
+            --itemEnd;
+        }
+        subfields[getSubfieldId(tag)].assign(eq, itemEnd - eq);
+    }
+}
+
+#ifdef SIPTCP
+void MsgSip::Framer::append(const char *data, int len)
+{
+    if (len > 0)
+        mBuf.append(data, len);
+}
+
+bool MsgSip::Framer::next(MsgSip *&msg)
+{
+    msg = 0;
+    if (mMsg != 0)
+    {
+        //waiting for content body
+        if (mBuf.size() - mStart < size_t(mContentLen))
+            return false;
+        mMsg->mContentBody.assign(mBuf, mStart, mContentLen);
+        consume(mContentLen);
+        msg = mMsg;
+        mMsg = 0;
+        mContentLen = 0;
+        return true;
+    }
+    size_t termLen = Value::TERMINATOR.size();
+    //resume search with an overlap in case the TERMINATOR straddles the
+    //previous data end
+    size_t from = (mScan > mStart + termLen)? mScan - termLen + 1: mStart;
+    size_t pos = mBuf.find(Value::TERMINATOR, from);
+    if (pos == string::npos)
+    {
+        mScan = mBuf.size();
+        return false;
+    }
+    size_t hdrLen = pos + termLen - mStart;
+    int contentLen;
+    msg = parse(mBuf.data() + mStart, hdrLen, contentLen);
+    if (msg == 0)
+    {
+        mRejected.assign(mBuf, mStart, hdrLen);
+        consume(hdrLen);
+        return true;
+    }
+    consume(hdrLen);
+    if (contentLen > 0)
+    {
+        //body may already be fully buffered
+        mMsg = msg;
+        mContentLen = contentLen;
+        return next(msg);
+    }
+    return true;
+}
+
+void MsgSip::Framer::clear()
+{
+    delete mMsg;
+    mMsg = 0;
+    mContentLen = 0;
+    mStart = 0;
+    mScan = 0;
+    mBuf.clear();
+}
+
+void MsgSip::Framer::consume(size_t n)
+{
+    mStart += n;
+    if (mStart >= mBuf.size())
+    {
+        //fully consumed - keep capacity for the next message
+        mBuf.clear();
+        mStart = 0;
+    }
+    else if (mStart > mBuf.size() / 2)
+    {
+        //remaining data is small - move it to the front
+        mBuf.erase(0, mStart);
+        mStart = 0;
+    }
+    mScan = mStart;
+}
+#endif //SIPTCP
+
 inline void MsgSip::setQuotes(int subfieldId, string &quotes) const
 {
     switch (subfieldId)
@@ -337,6 +337,18 @@ public:
      */
     std::string getSubfieldString(int key, int subkey) const;
 
+    /**
+     * Does message serialization into a caller-owned buffer. The buffer is
+     * cleared first, but its capacity is kept, so a buffer reused across
+     * messages does not reallocate once it has grown to the typical size.
+     *
+     * @param[out] out   The output buffer.
+     * @param[in]  endln The line terminator string.
+     * @return out.
+     */
+    std::string &serialize(std::string       &out,
+                           const std::string &endln = Value::ENDL) const;
+
     /**
      * Does message serialization and gets the actual data bytes.
      *
@@ -472,6 +484,93 @@ public:
     static MsgSip *parse(const std::string &str);
 #endif
 
+    /**
+     * Parses message data directly from a receive buffer, without copying
+     * the whole message first. Lines are tokenized in place, and only the
+     * final field values are copied into the message object.
+     *
+     * @param[in]  data       The message data. Need not be null-terminated.
+     * @param[in]  len        The data length. With SIPTCP, this is the header
+     *                        length including the TERMINATOR.
+     * @param[out] contentLen The content body length.
+     * @return The message object, or 0 on failure. Caller takes ownership
+     *         of the created object, and is responsible for deleting it.
+     */
+#ifdef SIPTCP
+    static MsgSip *parse(const char *data, size_t len, int &contentLen);
+#else
+    static MsgSip *parse(const char *data, size_t len);
+#endif
+
+#ifdef SIPTCP
+    /**
+     * Incremental message framer for SIP over TCP.
+     * Received bytes are appended as they arrive, and complete messages are
+     * extracted in order. The framer alternates between 2 states:
+     *   -waiting for a header TERMINATOR, scanning only the newly received
+     *    bytes (plus a small overlap) instead of the whole buffer,
+     *   -waiting for the Content-Length bytes of the current message.
+     * Consumed data is not erased from the front of the buffer after each
+     * message. The read offset just advances, and the buffer is compacted
+     * only when it is fully consumed or the consumed part dominates.
+     */
+    class Framer
+    {
+    public:
+        Framer() : mMsg(0) { clear(); }
+
+        ~Framer() { delete mMsg; }
+
+        /**
+         * Appends received data.
+         *
+         * @param[in] data The data.
+         * @param[in] len  The data length.
+         */
+        void append(const char *data, int len);
+
+        /**
+         * Extracts the next complete message, if any.
+         *
+         * @param[out] msg The message, or 0 if its header failed to parse.
+         *                 Caller takes ownership.
+         * @return true if a message was consumed from the buffer, false if
+         *         more data is needed.
+         */
+        bool next(MsgSip *&msg);
+
+        /**
+         * Discards all buffered data and any partially received message.
+         */
+        void clear();
+
+        /**
+         * Gets the header data of the last message that failed to parse.
+         *
+         * @return The data.
+         */
+        const std::string &getRejected() const { return mRejected; }
+
+    private:
+        MsgSip     *mMsg;        //message waiting for its content body
+        int         mContentLen; //pending content body length
+        size_t      mStart;      //read offset in mBuf
+        size_t      mScan;       //offset to resume TERMINATOR search
+        std::string mBuf;        //received data
+        std::string mRejected;   //header that failed to parse
+
+        /**
+         * Advances the read offset, and compacts the buffer if worthwhile.
+         *
+         * @param[in] n The number of bytes consumed.
+         */
+        void consume(size_t n);
+
+        Framer(const Framer &);
+        Framer &operator=(const Framer &);
+    }; //class Framer
+#endif //SIPTCP
+
 private:
     typedef std::map<int, std::string> FieldsMapT;
     typedef std::map<int, FieldsMapT>  SubfieldsMapT;
@@ -503,6 +602,16 @@ private:
      */
     void setQuotes(int subfieldId, std::string &quotes) const;
 
+    /**
+     * Parses a field value into subfields.
+     * E.g. Digest realm="10.12.49.86",nonce="7d686854",algorithm=MD5
+     *
+     * @param[in]  value     The field value.
+     * @param[out] subfields The subfield values, without double quotes.
+     */
+    static void parseSubfields(const std::string &value,
+                               FieldsMapT        &subfields);
+
     /**
      * Creates a mapping of type ID to string.
      *
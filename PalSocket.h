@@ -67,6 +67,12 @@ namespace PalSocket
         return ioctlsocket(sock, FIONBIO, &mode);
     }
 
+    inline int setBlocking(SocketT sock)
+    {
+        unsigned long mode = 0;
+        return ioctlsocket(sock, FIONBIO, &mode);
+    }
+
     inline std::string getIp(const SockAddrT &addr)
     {
 #ifdef IPV6
@@ -145,6 +151,20 @@ namespace PalSocket
         return (code == WSAEWOULDBLOCK);
     }
 
+    inline bool isInProgressError(int code)
+    {
+        return (code == WSAEWOULDBLOCK); //non-blocking connect()
+    }
+
+    inline int getSockError(SocketT sock)
+    {
+        int err = 0;
+        int len = sizeof(err);
+        if (getsockopt(sock, SOL_SOCKET, SO_ERROR, (char *) &err, &len) != 0)
+            return WSAGetLastError();
+        return err;
+    }
+
     inline int pollFd(const SocketT &fd, int &timeout)
     {
         int ret = 0;
@@ -211,6 +231,11 @@ namespace PalSocket
         return fcntl(sock, F_SETFL, O_NONBLOCK);
     }
 
+    inline int setBlocking(SocketT sock)
+    {
+        return fcntl(sock, F_SETFL, fcntl(sock, F_GETFL) & ~O_NONBLOCK);
+    }
+
     inline std::string getIp(const SockAddrT &addr)
     {
 #ifdef IPV6
@@ -283,6 +308,20 @@ namespace PalSocket
         return (code == EWOULDBLOCK);
     }
 
+    inline bool isInProgressError(int code)
+    {
+        return (code == EINPROGRESS); //non-blocking connect()
+    }
+
+    inline int getSockError(SocketT sock)
+    {
+        int err = 0;
+        socklen_t len = sizeof(err);
+        if (getsockopt(sock, SOL_SOCKET, SO_ERROR, &err, &len) != 0)
+            return errno;
+        return err;
+    }
+
     inline int pollFd(const SocketT &fd, int &timeout)
     {
         int ret = 0;
@@ -63,12 +63,16 @@ TEMPLATE = app
 #modules arranged in 4 blocks: non-Qt, Qt, GIS-non-Qt and GIS-Qt
 #in alphabetical order within each block
 SOURCES += \
+    AudioMixer.cpp \
     CmnTypes.cpp \
     DbInt.cpp \
+    IdRangeSet.cpp \
     Logger.cpp \
     MD5.c \
     Md5Digest.cpp \
+    Metrics.cpp \
     MmsClient.cpp \
+    MsgDispatcher.cpp \
     MsgSip.cpp \
     MsgSp.cpp \
     Props.cpp \
@@ -76,6 +80,7 @@ SOURCES += \
     RtspStreamer.cpp \
     ServerSession.cpp \
     Socket.cpp \
+    SocketLoop.cpp \
     StatusCodes.cpp \
     SubsData.cpp \
     TcpSocket.cpp \
@@ -106,11 +111,14 @@ SOURCES += \
     MainWindow.cpp \
     MessageDialog.cpp \
     Mms.cpp \
+    MsgJournal.cpp \
     Poi.cpp \
     QtTableUtils.cpp \
     QtUtils.cpp \
+    RecordingCache.cpp \
     Report.cpp \
     ResourceButton.cpp \
+    ResourceDelegate.cpp \
     Resources.cpp \
     ResourceSelector.cpp \
     RscCollector.cpp \
@@ -118,10 +126,15 @@ SOURCES += \
     Settings.cpp \
     SettingsUi.cpp \
     Style.cpp \
+    TableWriter.cpp \
+    ThumbnailCache.cpp \
     Updater.cpp \
     Version.cpp \
     VideoDevice.cpp \
+    GisCluster.cpp \
     GisLocation.cpp \
+    GisRoadNet.cpp \
+    GisTrail.cpp \
     GisBookmarks.cpp \
     GisCanvas.cpp \
     GisDgnaList.cpp \
@@ -133,6 +146,7 @@ SOURCES += \
     GisMenuUserPoi.cpp \
     GisPoint.cpp \
     GisQmlInt.cpp \
+    GisTileCache.cpp \
     GisRouting.cpp \
     GisTracking.cpp \
     GisTrackingReplay.cpp \
@@ -144,13 +158,17 @@ SOURCES += \
 }
 
 HEADERS += \
+    AudioMixer.h \
     CmnTypes.h \
     DbInt.h \
+    IdRangeSet.h \
     Locker.h \
     Logger.h \
     MD5.h \
     Md5Digest.h \
+    Metrics.h \
     MmsClient.h \
+    MsgDispatcher.h \
     MsgSip.h \
     MsgSp.h \
     MsgValueBase.h \
@@ -166,6 +184,7 @@ HEADERS += \
     RtspStreamer.h \
     ServerSession.h \
     Socket.h \
+    SocketLoop.h \
     StatusCodes.h \
     SubsData.h \
     TcpSocket.h \
@@ -195,12 +214,15 @@ HEADERS += \
     MainWindow.h \
     MessageDialog.h \
     Mms.h \
+    MsgJournal.h \
     Poi.h \
     QThreadWorker.h \
     QtTableUtils.h \
     QtUtils.h \
+    RecordingCache.h \
     Report.h \
     ResourceButton.h \
+    ResourceDelegate.h \
     Resources.h \
     ResourceSelector.h \
     RscCollector.h \
@@ -208,10 +230,15 @@ HEADERS += \
     Settings.h \
     SettingsUi.h \
     Style.h \
+    TableWriter.h \
+    ThumbnailCache.h \
     Updater.h \
     Version.h \
     VideoDevice.h \
+    GisCluster.h \
     GisLocation.h \
+    GisRoadNet.h \
+    GisTrail.h \
     GisBookmarks.h \
     GisCanvas.h \
     GisDgnaList.h \
@@ -223,6 +250,7 @@ HEADERS += \
     GisMenuUserPoi.h \
     GisPoint.h \
     GisQmlInt.h \
+    GisTileCache.h \
     GisRouting.h \
     GisTracking.h \
     GisTrackingReplay.h \
@@ -146,6 +146,7 @@ Props::ValueMapT Props::createFieldNames()
 
     v[FLD_CFG_AUDIO_IN]            = "AudioIn";
     v[FLD_CFG_AUDIO_OUT]           = "AudioOut";
+    v[FLD_CFG_AUDIO_VAD]           = "AudioVad";
     v[FLD_CFG_BRANCH]              = "Branch";
     v[FLD_CFG_BRANCH_ALLOWED]      = "BranchAllowed";
     v[FLD_CFG_CAMERA]              = "Camera";
@@ -164,11 +165,19 @@ Props::ValueMapT Props::createFieldNames()
     v[FLD_CFG_LOGLEVEL]            = "LogLevel";
     v[FLD_CFG_MAP_CTR_RSC_CALL]    = "MapCtrRscInCall";
     v[FLD_CFG_MAP_MAXSCALE]        = "MapMaxScale";
+    v[FLD_CFG_MAP_ROADNET]         = "MapRoadNet";
     v[FLD_CFG_MAP_SEA]             = "MapSea";
+    v[FLD_CFG_MAP_SEA_SVR]         = "MapSeaSvr";
     v[FLD_CFG_MAP_TERM_LBL]        = "MapTermLbl";
     v[FLD_CFG_MAP_TERM_STALE1]     = "MapTermStale1";
     v[FLD_CFG_MAP_TERM_STALELAST]  = "MapTermStaleLast";
+    v[FLD_CFG_MAP_TILECACHE]       = "MapTileCache";
+    v[FLD_CFG_MAP_TRAIL_MAXAGE]    = "MapTrailMaxAge";
+    v[FLD_CFG_MAP_TRAIL_MAXPTS]    = "MapTrailMaxPts";
+    v[FLD_CFG_METRICS_FILE]        = "MetricsFile";
+    v[FLD_CFG_METRICS_INTERVAL]    = "MetricsInterval";
     v[FLD_CFG_MMS_DOWNLOADDIR]     = "MMSDownloadDir";
+    v[FLD_CFG_MMS_THUMBCACHE]      = "MMSThumbCache";
     v[FLD_CFG_MONITOR_RETAIN]      = "MonRetain";
     v[FLD_CFG_MSG_TMR_INTERVAL]    = "MsgTimerInterval";
     v[FLD_CFG_PTT_ALT]             = "PttAlt";
@@ -179,6 +188,7 @@ Props::ValueMapT Props::createFieldNames()
     v[FLD_CFG_SDSTEMPLATE]         = "SDSTemplate";
     v[FLD_CFG_SERVERIP]            = "ServerIP";
     v[FLD_CFG_SERVERPORT]          = "ServerPort";
+    v[FLD_CFG_UPD_MAXDOWNLOADS]    = "UpdMaxDownloads";
 
     v[FLD_COORDINATES]             = "Coordinates";
     v[FLD_COORDINATES_MULTILINE]   = "CoordsMultiLine";
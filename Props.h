@@ -31,6 +31,7 @@ public:
         //Settings
         FLD_CFG_AUDIO_IN,
         FLD_CFG_AUDIO_OUT,
+        FLD_CFG_AUDIO_VAD,
         FLD_CFG_BRANCH,
         FLD_CFG_BRANCH_ALLOWED,
         FLD_CFG_CAMERA,
@@ -49,11 +50,19 @@ public:
         FLD_CFG_LOGLEVEL,
         FLD_CFG_MAP_CTR_RSC_CALL,
         FLD_CFG_MAP_MAXSCALE,
+        FLD_CFG_MAP_ROADNET,
         FLD_CFG_MAP_SEA,
+        FLD_CFG_MAP_SEA_SVR,
         FLD_CFG_MAP_TERM_LBL,
         FLD_CFG_MAP_TERM_STALE1,
         FLD_CFG_MAP_TERM_STALELAST,
+        FLD_CFG_MAP_TILECACHE,
+        FLD_CFG_MAP_TRAIL_MAXAGE,
+        FLD_CFG_MAP_TRAIL_MAXPTS,
+        FLD_CFG_METRICS_FILE,
+        FLD_CFG_METRICS_INTERVAL,
         FLD_CFG_MMS_DOWNLOADDIR,
+        FLD_CFG_MMS_THUMBCACHE,
         FLD_CFG_MONITOR_RETAIN,
         FLD_CFG_MSG_TMR_INTERVAL,
         FLD_CFG_PTT_ALT,
@@ -64,6 +73,7 @@ public:
         FLD_CFG_SDSTEMPLATE,
         FLD_CFG_SERVERIP,
         FLD_CFG_SERVERPORT,
+        FLD_CFG_UPD_MAXDOWNLOADS,
 
         //GIS
         FLD_COORDINATES,
@@ -31,6 +31,39 @@
 
 using namespace std;
 
+/**
+ * Converts a date-time string to secs since epoch.
+ *
+ * @param[in] dt    The date-time as "d/M/yyyy hh:mm", as in the Report date
+ *                  and time edit formats, or with seconds.
+ * @param[in] isEnd true for a period end, which includes the whole minute
+ *                  if without seconds.
+ * @return The time, or -1 if invalid.
+ */
+static qint64 toSecs(const string &dt, bool isEnd)
+{
+    QString s(QString::fromStdString(dt));
+    QDateTime t(QDateTime::fromString(s, "d/M/yyyy hh:mm:ss"));
+    if (t.isValid())
+        return t.toSecsSinceEpoch();
+    t = QDateTime::fromString(s, "d/M/yyyy hh:mm");
+    if (!t.isValid())
+        return -1;
+    return t.toSecsSinceEpoch() + ((isEnd)? 59: 0);
+}
+
+/**
+ * Converts secs since epoch to a date-time string for a database query.
+ *
+ * @param[in] secs The time.
+ * @return The date-time as "d/M/yyyy hh:mm:ss".
+ */
+static string toDateTime(qint64 secs)
+{
+    return QDateTime::fromSecsSinceEpoch(secs).toString("d/M/yyyy hh:mm:ss")
+                                              .toStdString();
+}
+
 //not to be translated because these are in database, set by server
 const string QtTableUtils::CALLTYPE_AMBIENCE ("Ambience");
 const string QtTableUtils::CALLTYPE_BROADCAST("Broadcast");
@@ -514,37 +547,72 @@ bool QtTableUtils::getMsgData(int           from,
         assert("Bad param in QtTableUtils::getMsgData(Report)" == 0);
         return false;
     }
-    DbInt::QResult *res;
     int tblType;
     switch (msgType)
     {
         case CmnTypes::COMMS_MSG_MMS:
             tblType = TBLTYPE_MMS;
-            res = DbInt::instance().getMmsHistory(startTime, endTime, input,
-                                                  from, to, doAnd);
             break;
         case CmnTypes::COMMS_MSG_SDS:
             tblType = TBLTYPE_SDS;
-            res = DbInt::instance().getSdsHistory(startTime, endTime, input,
-                                                  from, to, doAnd);
             break;
         case CmnTypes::COMMS_MSG_STATUS:
             tblType = TBLTYPE_STS;
-            res = DbInt::instance().getStsMsgHistory(startTime, endTime, input,
-                                                     from, to, doAnd);
             break;
         default:
             tblType = TBLTYPE_MSG;
-            res = DbInt::instance().getMsgHistory(startTime, endTime, from, to,
-                                                  doAnd);
             break;
     }
-    if (res == 0)
-        return false;
-    tv->setSortingEnabled(false);
+    //the local archive is used for the period it covers, and the database
+    //only for the older part
+    MsgJournal &mj(MsgJournal::instance());
+    qint64 t1 = toSecs(startTime, false);
+    qint64 t2 = toSecs(endTime, true);
+    qint64 jt = -1; //archive start time
+    if (tblType != TBLTYPE_MMS && mj.isOpen() && t1 >= 0 && t2 >= 0)
+        jt = mj.getStartTime();
+    DbInt::QResult *res = 0;
+    if (jt < 0 || t1 < jt)
+    {
+        string end((jt < 0 || t2 < jt)? endTime: toDateTime(jt - 1));
+        switch (tblType)
+        {
+            case TBLTYPE_MMS:
+                res = DbInt::instance().getMmsHistory(startTime, end, input,
+                                                      from, to, doAnd);
+                break;
+            case TBLTYPE_SDS:
+                res = DbInt::instance().getSdsHistory(startTime, end, input,
+                                                      from, to, doAnd);
+                break;
+            case TBLTYPE_STS:
+                res = DbInt::instance().getStsMsgHistory(startTime, end,
+                                                         input, from, to,
+                                                         doAnd);
+                break;
+            default:
+                res = DbInt::instance().getMsgHistory(startTime, end, from,
+                                                      to, doAnd);
+                break;
+        }
+        if (res == 0 && jt < 0)
+            return false;
+    }
     auto *mdl = new QStandardItemModel();
-    fillMsgData(res, msgType, SubsData::isMultiCluster(), mdl,
-                (tblType == TBLTYPE_MSG));
+    if (res != 0)
+        fillMsgData(res, msgType, SubsData::isMultiCluster(), mdl,
+                    (tblType == TBLTYPE_MSG));
+    //if the database is not available, the archive for the whole period
+    if (jt >= 0 && (res == 0 || t2 >= jt))
+    {
+        MsgJournal::EntriesT entries;
+        mj.search((res == 0)? t1: jt, t2,
+                  (tblType == TBLTYPE_MSG)? "": QString::fromStdString(input),
+                  (tblType == TBLTYPE_MSG)? -1: msgType, from, to, doAnd,
+                  entries);
+        fillJournalData(entries, mdl, (tblType == TBLTYPE_MSG));
+    }
+    tv->setSortingEnabled(false);
     if (mdl->rowCount() == 0)
         delete mdl;
     else
@@ -667,6 +735,52 @@ void QtTableUtils::fillLocData(DbInt::QResult     *res,
     mdl->sort(COL_LOC_TIME);
 }
 
+void QtTableUtils::fillJournalData(const MsgJournal::EntriesT &entries,
+                                   QStandardItemModel         *mdl,
+                                   bool                        showType)
+{
+    assert(mdl != 0);
+    QStandardItem *item;
+    QString s;
+    for (const auto &e : entries)
+    {
+        mdl->insertRow(0);
+        item = new QStandardItem();
+        item->setData(QDateTime::fromSecsSinceEpoch(e.time), Qt::DisplayRole);
+        mdl->setItem(0, COL_TIME, item);
+        item = new QStandardItem(ResourceData::getDspTxt(e.from, e.fromType));
+        item->setData(e.from);
+        mdl->setItem(0, COL_FROM, item);
+        item = new QStandardItem(ResourceData::getDspTxt(e.to, e.toType));
+        item->setData(e.to);
+        mdl->setItem(0, COL_TO, item);
+        s = e.text;
+        if (e.type == CmnTypes::COMMS_MSG_SDS)
+        {
+            if (showType)
+                mdl->setItem(0, COL_TYPE,
+                             new QStandardItem(QtUtils::getCommsIcon(e.type),
+                                               QObject::tr("SDS")));
+        }
+        else
+        {
+            if (showType)
+                mdl->setItem(0, COL_TYPE,
+                             new QStandardItem(QtUtils::getCommsIcon(e.type),
+                                               QObject::tr("Status")));
+            //show message as "text [code]"
+            if (e.code >= 0)
+            {
+                if (!s.isEmpty())
+                    s.append(" ");
+                s.append("[").append(QString::number(e.code)).append("]");
+            }
+        }
+        mdl->setItem(0, COL_MSG, new QStandardItem(s));
+    }
+    mdl->sort(COL_TIME);
+}
+
 #define SETITEM(field, dbRow, col) \
     do \
     { \
@@ -1136,6 +1250,7 @@ bool QtTableUtils::getLastData(int         tblType,
     bool doCheckBranch = SubsData::isMultiCluster();
     int rows = mdl->rowCount();
     DbInt::QResult *res = 0;
+    MsgJournal::EntriesT entries;
     switch (tblType)
     {
         case TBLTYPE_CALL:
@@ -1149,6 +1264,24 @@ bool QtTableUtils::getLastData(int         tblType,
                 fillMsgData(res, CmnTypes::COMMS_MSG_MMS, doCheckBranch, mdl);
             break;
         case TBLTYPE_MSG:
+        case TBLTYPE_SDS:
+        case TBLTYPE_STS:
+        {
+            if (tblType == TBLTYPE_SDS)
+                msgType = CmnTypes::COMMS_MSG_SDS;
+            else if (tblType == TBLTYPE_STS)
+                msgType = CmnTypes::COMMS_MSG_STATUS;
+            bool showType = (tblType == TBLTYPE_MSG);
+            //the local archive first, if the message is in the period it
+            //covers
+            MsgJournal &mj(MsgJournal::instance());
+            if (msgType != CmnTypes::COMMS_MSG_MMS &&
+                mj.getLast(msgType, from, to, true, 1, entries) != 0 &&
+                entries.front().time >= mj.getStartTime())
+            {
+                fillJournalData(entries, mdl, showType);
+                break;
+            }
             if (msgType == CmnTypes::COMMS_MSG_SDS)
                 res = DbInt::instance().getLastSds(from, to);
             else if (msgType == CmnTypes::COMMS_MSG_STATUS)
@@ -1156,18 +1289,12 @@ bool QtTableUtils::getLastData(int         tblType,
             else
                 res = DbInt::instance().getLastMms(from, to);
             if (res != 0)
-                fillMsgData(res, msgType, doCheckBranch, mdl, true);
-            break;
-        case TBLTYPE_SDS:
-            res = DbInt::instance().getLastSds(from, to);
-            if (res != 0)
-                fillMsgData(res, CmnTypes::COMMS_MSG_SDS, doCheckBranch, mdl);
-            break;
-        case TBLTYPE_STS:
-            res = DbInt::instance().getLastSts(from, to);
-            if (res != 0)
-                fillMsgData(res, CmnTypes::COMMS_MSG_STATUS, doCheckBranch, mdl);
+                fillMsgData(res, msgType, doCheckBranch, mdl, showType);
+            //database not available - older message from the archive
+            else if (!entries.empty())
+                fillJournalData(entries, mdl, showType);
             break;
+        }
         default:
             assert("Bad type in QtTableUtils::getLastData()" == 0);
             break;
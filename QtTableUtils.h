@@ -23,6 +23,7 @@
 #include <QTableWidget>
 
 #include "DbInt.h"
+#include "MsgJournal.h"
 
 namespace QtTableUtils
 {
@@ -326,7 +327,9 @@ namespace QtTableUtils
 
     /**
      * Gets SDS or Status Message data involving specific resources in a
-     * specific period from database into a Report table.
+     * specific period into a Report table. SDS and Status Message are taken
+     * from MsgJournal for the period it covers, and from database only for
+     * the older part.
      *
      * @param[in]  from      The sender. 0 for any.
      * @param[in]  to        The recipient. 0 for any.
@@ -339,7 +342,8 @@ namespace QtTableUtils
      *                       Status Message code.
      * @param[out] tv        The table.
      * @return true if successful (but tv may be empty). false indicates DB
-     *         query failure.
+     *         query failure, except for SDS and Status Message which are
+     *         then taken from MsgJournal for the whole period if available.
      */
     bool getMsgData(int                from,
                     int                to,
@@ -431,6 +435,18 @@ namespace QtTableUtils
                      bool                doCheckBranch,
                      QStandardItemModel *mdl);
 
+    /**
+     * Fills up a table with messaging data from MsgJournal - SDS or Status
+     * Message.
+     *
+     * @param[in]  entries  The entries.
+     * @param[out] mdl      The table data model.
+     * @param[in]  showType true to show the message type in a column.
+     */
+    void fillJournalData(const MsgJournal::EntriesT &entries,
+                         QStandardItemModel         *mdl,
+                         bool                        showType = false);
+
     //the following fill* functions are grouped here because they share a set
     //of macros
     /**
@@ -564,6 +580,8 @@ namespace QtTableUtils
 
     /**
      * Adds new call, SDS or Status Message data into an Incident table.
+     * SDS and Status Message are taken from MsgJournal if the last one is in
+     * the period it covers, or if the database is not available.
      *
      * @param[in]  tblType The table type - eTblType.
      * @param[in]  msgType The message type - CmnType::eCommsType.
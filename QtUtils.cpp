@@ -237,6 +237,7 @@ const QString QtUtils::getActionIconSrc(int type)
             return ":/Images/images/icon_play.png";
         case CmnTypes::ACTIONTYPE_PLAY_VID:
             return ":/Images/images/icon_video.png";
+        case CmnTypes::ACTIONTYPE_PRINT_CSV:
         case CmnTypes::ACTIONTYPE_PRINT_EXCEL:
             return ":/Images/images/icon_excel.png";
         case CmnTypes::ACTIONTYPE_PRINT_PDF:
@@ -394,6 +395,9 @@ QAction *QtUtils::addMenuAction(QMenu &menu, int type, const QString &txt)
             case CmnTypes::ACTIONTYPE_PB_DEL:
                 s = QObject::tr("Delete from Phonebook");
                 break;
+            case CmnTypes::ACTIONTYPE_PRINT_CSV:
+                s = QObject::tr("CSV");
+                break;
             case CmnTypes::ACTIONTYPE_PRINT_EXCEL:
                 s = QObject::tr("Excel");
                 break;
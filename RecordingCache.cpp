@@ -0,0 +1,311 @@
+/**
+ * Call recording playback cache implementation.
+ *
+ * Copyright (C) Sapura Secured Technologies, 2026. All Rights Reserved.
+ *
+ * @file
+ * @version $Id$
+ * @author agent <agent@local>
+ */
+#include <assert.h>
+#include <QApplication>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QNetworkRequest>
+#include <QPointer>
+#include <QStandardPaths>
+#include <QTimer>
+#include <QtConcurrent/QtConcurrent>
+
+#include "DbInt.h"
+#include "RecordingCache.h"
+
+using namespace std;
+
+static const string LOGPREFIX("RecordingCache:: ");
+
+RecordingCache::RecordingCache(Logger *logger, QObject *parent) :
+QObject(parent), mLogger(logger), mNwkManager(new QNetworkAccessManager(this)),
+mReply(0), mFile(0), mTotalSize(0), mSeq(0),
+mDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) +
+     "/recordings/"),
+mPtt(MAX_PTT)
+{
+    assert(logger != 0);
+    //recordings are not kept across sessions
+    QDir(mDir).removeRecursively();
+}
+
+RecordingCache::~RecordingCache()
+{
+    abortFetch();
+    QDir(mDir).removeRecursively();
+}
+
+QString RecordingCache::getHostKey(const QUrl &url)
+{
+    return url.host() + ":" +
+           QString::number(url.port((url.scheme().toLower() == "https")?
+                                    443: 80));
+}
+
+int RecordingCache::getHostState(const QUrl &url)
+{
+    QString key(getHostKey(url));
+    HostT &h(mHosts[key]);
+    if (h.probe != 0)
+        return h.state;
+    qint64 age = QDateTime::currentMSecsSinceEpoch() - h.checkTime;
+    if (h.state == HOST_UP && age <= HOST_UP_VALID_MS)
+        return HOST_UP;
+    if (h.state == HOST_DOWN && age <= HOST_DOWN_VALID_MS)
+        return HOST_DOWN;
+    auto *s = new QTcpSocket(this);
+    h.probe = s;
+    connect(s, &QTcpSocket::connected, this,
+            [this, key] { onHostChecked(key, true); });
+    connect(s, qOverload<QAbstractSocket::SocketError>(&QAbstractSocket::error),
+            this, [this, key] { onHostChecked(key, false); });
+    QTimer::singleShot(HOST_TIMEOUT_MS, s,
+                       [this, key] { onHostChecked(key, false); });
+    s->connectToHost(url.host(), url.port((url.scheme().toLower() == "https")?
+                                          443: 80));
+    //a host that was down may be up by now, so do not report it as down
+    if (h.state == HOST_DOWN)
+        h.state = HOST_UNKNOWN;
+    return h.state;
+}
+
+QString RecordingCache::getFile(const QString &path)
+{
+    auto it = mEntries.find(path);
+    if (it == mEntries.end())
+        return "";
+    if (!QFile::exists(it->file))
+    {
+        remove(path);
+        return "";
+    }
+    mLru.erase(it->seq);
+    it->seq = ++mSeq;
+    mLru[it->seq] = path;
+    return it->file;
+}
+
+void RecordingCache::remove(const QString &path)
+{
+    auto it = mEntries.find(path);
+    if (it == mEntries.end())
+        return;
+    mTotalSize -= it->size;
+    mLru.erase(it->seq);
+    QFile::remove(it->file);
+    mEntries.erase(it);
+}
+
+bool RecordingCache::getPtt(const QString &callKey, PttHistoryT &hist)
+{
+    auto *h = mPtt.object(callKey);
+    if (h != 0)
+    {
+        hist = *h;
+    }
+    else
+    {
+        hist.clear();
+        if (loadPtt(callKey, hist))
+            mPtt.insert(callKey, new PttHistoryT(hist));
+    }
+    return !hist.isEmpty();
+}
+
+void RecordingCache::prefetch(const QString &path, const QString &callKey)
+{
+    if (!callKey.isEmpty() && !mPtt.contains(callKey) &&
+        !mPttPending.contains(callKey))
+    {
+        mPttPending.insert(callKey);
+        QPointer<RecordingCache> self(this);
+        QtConcurrent::run([self, callKey]
+        {
+            auto *hist = new PttHistoryT;
+            bool ok = loadPtt(callKey, *hist);
+            QMetaObject::invokeMethod(qApp,
+                                      [self, callKey, hist, ok]
+                                      {
+                                          if (self.isNull())
+                                          {
+                                              delete hist;
+                                              return;
+                                          }
+                                          self->mPttPending.remove(callKey);
+                                          if (ok)
+                                              self->mPtt.insert(callKey, hist);
+                                          else
+                                              delete hist;
+                                      },
+                                      Qt::QueuedConnection);
+        });
+    }
+    if (path.isEmpty() || path == mPath || mEntries.contains(path))
+        return;
+    QUrl url(path);
+    QString scheme(url.scheme().toLower());
+    if (scheme != "http" && scheme != "https")
+        return; //local file, or not supported by QNetworkAccessManager
+    mPendingPath.clear();
+    switch (getHostState(url))
+    {
+        case HOST_UP:
+            startFetch(path);
+            break;
+        case HOST_UNKNOWN:
+            //continue in onHostChecked()
+            abortFetch();
+            mPendingPath = path;
+            break;
+        default:
+            break; //do nothing
+    }
+}
+
+bool RecordingCache::loadPtt(const QString &callKey, PttHistoryT &hist)
+{
+    auto *res = DbInt::instance().getPttHistory(callKey.toStdString());
+    if (res == 0)
+        return false;
+    string txParty;
+    int start;
+    int dur;
+    int i = res->getNumRows() - 1;
+    for (; i>=0; --i)
+    {
+        if (res->getFieldValue(DbInt::FIELD_TX_PARTY, txParty, i) &&
+            res->getFieldValue(DbInt::FIELD_START, start, i) &&
+            res->getFieldValue(DbInt::FIELD_CALL_DURATION, dur, i))
+            hist.append(PttData(QString::fromStdString(txParty), start,
+                                start + dur));
+    }
+    delete res;
+    return true;
+}
+
+void RecordingCache::onHostChecked(const QString &hostKey, bool up)
+{
+    auto it = mHosts.find(hostKey);
+    if (it == mHosts.end() || it->probe == 0)
+        return; //already done
+    it->probe->disconnect(this);
+    it->probe->abort();
+    it->probe->deleteLater();
+    it->probe = 0;
+    int state = (up)? HOST_UP: HOST_DOWN;
+    if (state != it->state && !up)
+        LOGGER_WARNING(mLogger, LOGPREFIX << "Recording server "
+                       << hostKey.toStdString() << " not available");
+    it->state = state;
+    it->checkTime = QDateTime::currentMSecsSinceEpoch();
+    if (!mPendingPath.isEmpty() && getHostKey(QUrl(mPendingPath)) == hostKey)
+    {
+        QString path;
+        path.swap(mPendingPath);
+        if (up)
+            startFetch(path);
+    }
+    emit hostChecked(hostKey, up);
+}
+
+void RecordingCache::startFetch(const QString &path)
+{
+    abortFetch();
+    QUrl url(path);
+    QString suffix(QFileInfo(url.path()).suffix());
+    //keep the suffix for media format detection
+    QDir().mkpath(mDir);
+    mFile = new QFile(mDir +
+                      QCryptographicHash::hash(path.toUtf8(),
+                                               QCryptographicHash::Md5)
+                          .toHex() +
+                      ((suffix.isEmpty())? "": "." + suffix));
+    if (!mFile->open(QIODevice::WriteOnly))
+    {
+        LOGGER_ERROR(mLogger, LOGPREFIX << "startFetch: Failed to create "
+                     << mFile->fileName().toStdString() << ", "
+                     << mFile->errorString().toStdString());
+        delete mFile;
+        mFile = 0;
+        return;
+    }
+    mPath = path;
+    QNetworkRequest req(url);
+    req.setAttribute(QNetworkRequest::FollowRedirectsAttribute, true);
+    mReply = mNwkManager->get(req);
+    mReply->ignoreSslErrors();
+    connect(mReply, &QNetworkReply::readyRead, this,
+            [this]
+            {
+                if (mFile->write(mReply->readAll()) < 0 ||
+                    mFile->size() > MAX_FILE_BYTES)
+                    abortFetch();
+            });
+    connect(mReply, &QNetworkReply::finished, this,
+            [this] { onFetchFinished(); });
+}
+
+void RecordingCache::abortFetch()
+{
+    if (mReply == 0)
+        return;
+    mReply->disconnect(this);
+    mReply->abort();
+    mReply->deleteLater();
+    mReply = 0;
+    mFile->remove();
+    delete mFile;
+    mFile = 0;
+    mPath.clear();
+}
+
+void RecordingCache::onFetchFinished()
+{
+    QNetworkReply *reply = mReply;
+    mReply = 0;
+    reply->deleteLater();
+    if (reply->error() == QNetworkReply::NoError)
+        mFile->write(reply->readAll());
+    if (reply->error() != QNetworkReply::NoError ||
+        mFile->error() != QFileDevice::NoError)
+    {
+        LOGGER_ERROR(mLogger, LOGPREFIX << "Failed to fetch "
+                     << mPath.toStdString() << ", "
+                     << ((reply->error() != QNetworkReply::NoError)?
+                         reply->errorString(): mFile->errorString())
+                            .toStdString());
+        mFile->remove();
+    }
+    else
+    {
+        mFile->close();
+        EntryT &e(mEntries[mPath]);
+        e.file = mFile->fileName();
+        e.size = mFile->size();
+        e.seq = ++mSeq;
+        mLru[e.seq] = mPath;
+        mTotalSize += e.size;
+        evict();
+    }
+    delete mFile;
+    mFile = 0;
+    mPath.clear();
+}
+
+void RecordingCache::evict()
+{
+    //keep the most recent recording even if it alone exceeds the quota
+    while (mTotalSize > MAX_BYTES && mLru.size() > 1)
+    {
+        remove(mLru.begin()->second);
+    }
+}
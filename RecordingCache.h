@@ -0,0 +1,213 @@
+/**
+ * Cache for call recording playback.
+ * Keeps the reachability state of each recording server, checked
+ * asynchronously so that the GUI thread never waits on a connection.
+ * Prefetches recordings into a local directory with a size quota, evicting
+ * the least recently used ones, and PTT histories from the database in a
+ * background thread.
+ * Must be used in the GUI thread only.
+ *
+ * Copyright (C) Sapura Secured Technologies, 2026. All Rights Reserved.
+ *
+ * @file
+ * @version $Id$
+ * @author agent <agent@local>
+ */
+#ifndef RECORDINGCACHE_H
+#define RECORDINGCACHE_H
+
+#include <map>
+#include <QCache>
+#include <QFile>
+#include <QHash>
+#include <QList>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QTcpSocket>
+#include <QUrl>
+
+#include "Logger.h"
+
+class RecordingCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum eHostState
+    {
+        HOST_UNKNOWN,   //check in progress
+        HOST_UP,
+        HOST_DOWN
+    };
+
+    struct PttData
+    {
+        PttData(const QString &p, int s, int e) :
+            txParty(p), start(s), end(e) {}
+
+        QString txParty;
+        int     start;    //seconds from call start
+        int     end;
+    };
+    typedef QList<PttData> PttHistoryT;
+
+    /**
+     * Constructor. Clears the recording directory.
+     *
+     * @param[in] logger App logger.
+     * @param[in] parent Parent object, if any.
+     */
+    explicit RecordingCache(Logger *logger, QObject *parent = 0);
+
+    /**
+     * Destructor. Deletes all cached recordings.
+     */
+    ~RecordingCache();
+
+    /**
+     * Gets the host key of a URL, for hostChecked().
+     *
+     * @param[in] url The URL.
+     * @return "<host>:<port>".
+     */
+    static QString getHostKey(const QUrl &url);
+
+    /**
+     * Gets the cached reachability state of the host of a URL, and starts an
+     * asynchronous check if the state is unknown or expired.
+     * Emits hostChecked() when a started check is done.
+     *
+     * @param[in] url The URL.
+     * @return eHostState. An expired state is returned as it is, while being
+     *         checked again.
+     */
+    int getHostState(const QUrl &url);
+
+    /**
+     * Gets the local file of a cached recording, and marks it as recently
+     * used.
+     *
+     * @param[in] path The recording path.
+     * @return The local filepath, or empty string if not cached.
+     */
+    QString getFile(const QString &path);
+
+    /**
+     * Removes a recording from the cache, e.g. after a playback error.
+     *
+     * @param[in] path The recording path.
+     */
+    void remove(const QString &path);
+
+    /**
+     * Gets the PTT history of a call, from the cache if available, otherwise
+     * from the database.
+     *
+     * @param[in]  callKey The call key.
+     * @param[out] hist    The history, oldest first.
+     * @return true if successful and not empty.
+     */
+    bool getPtt(const QString &callKey, PttHistoryT &hist);
+
+    /**
+     * Starts prefetching a recording and its PTT history in the background.
+     * A remote recording is fetched only if its host is reachable. Aborts the
+     * previous recording prefetch if still in progress.
+     *
+     * @param[in] path    The recording path.
+     * @param[in] callKey The call key for PTT history, or empty string if
+     *                    not needed.
+     */
+    void prefetch(const QString &path, const QString &callKey);
+
+signals:
+    void hostChecked(const QString &hostKey, bool up);
+
+private:
+    struct HostT
+    {
+        HostT() : state(HOST_UNKNOWN), checkTime(0), probe(0) {}
+
+        int         state;
+        qint64      checkTime;  //msecs since epoch
+        QTcpSocket *probe;      //check in progress
+    };
+
+    struct EntryT
+    {
+        QString file;
+        qint64  size;
+        quint64 seq;   //last use sequence number
+    };
+
+    //connection timeout for host check
+    static const int    HOST_TIMEOUT_MS     = 3000;
+    //validity of host states
+    static const int    HOST_UP_VALID_MS    = 60000;
+    static const int    HOST_DOWN_VALID_MS  = 5000;
+    //recordings quota
+    static const qint64 MAX_BYTES           = 200LL << 20;
+    //larger recordings, e.g. long videos, are not prefetched
+    static const qint64 MAX_FILE_BYTES      = 50LL << 20;
+    //number of cached PTT histories
+    static const int    MAX_PTT             = 100;
+
+    Logger                     *mLogger;
+    QNetworkAccessManager      *mNwkManager;
+    QNetworkReply              *mReply;       //prefetch in progress
+    QFile                      *mFile;        //for mReply
+    qint64                      mTotalSize;
+    quint64                     mSeq;
+    QString                     mPath;        //recording path being fetched
+    QString                     mPendingPath; //waiting for host check
+    QString                     mDir;         //with trailing separator
+    QHash<QString, HostT>       mHosts;       //key is host key
+    QHash<QString, EntryT>      mEntries;     //key is recording path
+    std::map<quint64, QString>  mLru;         //oldest first, value is path
+    QCache<QString, PttHistoryT> mPtt;        //key is call key
+    QSet<QString>               mPttPending;  //call keys being fetched
+
+    /**
+     * Gets the PTT history of a call from the database.
+     * Thread-safe.
+     *
+     * @param[in]  callKey The call key.
+     * @param[out] hist    The history, oldest first.
+     * @return true if successful.
+     */
+    static bool loadPtt(const QString &callKey, PttHistoryT &hist);
+
+    /**
+     * Handles the result of a host check.
+     *
+     * @param[in] hostKey The host key.
+     * @param[in] up      true if reachable.
+     */
+    void onHostChecked(const QString &hostKey, bool up);
+
+    /**
+     * Starts downloading a recording, aborting any download in progress.
+     *
+     * @param[in] path The recording path.
+     */
+    void startFetch(const QString &path);
+
+    /**
+     * Stops the download in progress, and deletes its partial file.
+     */
+    void abortFetch();
+
+    /**
+     * Handles the end of the download in progress.
+     */
+    void onFetchFinished();
+
+    /**
+     * Removes least recently used recordings until within the quota.
+     */
+    void evict();
+};
+#endif //RECORDINGCACHE_H
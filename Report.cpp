@@ -229,6 +229,9 @@ mLogger(logger), mDateTimeDelegate(0), mFilterType(FILTERTYPE_CALL)
     connect(QtUtils::addMenuAction(*menu, CmnTypes::ACTIONTYPE_PRINT_EXCEL),
             &QAction::triggered, this,
             [this] { doPrint(Document::PRINTTYPE_EXCEL); });
+    connect(QtUtils::addMenuAction(*menu, CmnTypes::ACTIONTYPE_PRINT_CSV),
+            &QAction::triggered, this,
+            [this] { doPrint(Document::PRINTTYPE_CSV); });
     ui->printButton->setMenu(menu);
     mDateTimeDelegate = new DateTimeDelegate(this);
     //invoke displayButton click when Enter pressed in certain comboboxes
@@ -485,6 +488,8 @@ void Report::onDisplay()
                                      ui->typeCombo->currentData().toString()
                                                                  .toStdString(),
                                      tv);
+            if (success)
+                mAudioPlayer->watch(tv);
             break;
         }
 #ifdef INCIDENT
@@ -36,29 +36,17 @@ mName(ResourceData::getName(id, type))
     mSsBase.append("QToolButton {color:black;")
            .append(Style::getStyle(Style::OBJ_FONT3))
            .append("border-radius:8px;background-color:rgb(");
+    QColor c(getBgColor(mType));
+    mSsNormalBgColor = QString("%1,%2,%3").arg(c.red()).arg(c.green())
+                                          .arg(c.blue());
     switch (mType)
     {
-        case ResourceData::TYPE_SUBSCRIBER:
-            mSsNormalBgColor = "135,200,217";
-            break;
         case ResourceData::TYPE_GROUP:
-            mSsNormalBgColor = "105,191,116";
-            enableNotes = false; //still enabled but not by clicking
-            break;
         case ResourceData::TYPE_DGNA_IND:
-            mSsNormalBgColor = "139,128,0";
-            enableNotes = false;
-            break;
         case ResourceData::TYPE_DGNA_GRP:
-            mSsNormalBgColor = "230,172,0";
-            enableNotes = false;
-            break;
-        case ResourceData::TYPE_MOBILE:
-            mSsNormalBgColor = "135,159,217";
+            enableNotes = false; //still enabled but not by clicking
             break;
-        case ResourceData::TYPE_DISPATCHER:
         default:
-            mSsNormalBgColor = "147,112,219";
             break;
     }
     setOnline(true, true, true); //init
@@ -134,19 +122,11 @@ void ResourceButton::phonebookDelete()
 
 void ResourceButton::setActive()
 {
-    switch (SubsData::grpActive(mId))
+    int stat = SubsData::grpActive(mId);
+    setIcon(getIcon(mType, stat));
+    switch (stat)
     {
-        case SubsData::GRP_STAT_ASSIGN:
-            setIcon(QIcon(QPixmap(":/Images/images/icon_dgna_ind_assign.png")));
-            mGrpMembers.clear();
-            setToolTip(mNotes);
-            break;
         case SubsData::GRP_STAT_ATTACH:
-            if (mType == ResourceData::TYPE_GROUP)
-                setIcon(QIcon(QPixmap(":/Images/images/icon_group_attach.png")));
-            else //ResourceData::TYPE_DGNA_IND
-                setIcon(QIcon(
-                          QPixmap(":/Images/images/icon_dgna_ind_attach.png")));
             mGrpMembers = QString::fromStdString(
                                    SubsData::getGrpAttachedMembers(mId, false));
             if (mGrpMembers.isEmpty())
@@ -157,7 +137,6 @@ void ResourceButton::setActive()
                 setToolTip(mNotes + "\n" + mGrpMembers);
             break;
         default:
-            setIcon(QtUtils::getRscIcon(mType));
             mGrpMembers.clear();
             setToolTip(mNotes);
             break;
@@ -248,6 +227,45 @@ void ResourceButton::showNotes()
     }
 }
 
+QColor ResourceButton::getBgColor(int type)
+{
+    switch (type)
+    {
+        case ResourceData::TYPE_SUBSCRIBER:
+            return QColor(135, 200, 217);
+        case ResourceData::TYPE_GROUP:
+            return QColor(105, 191, 116);
+        case ResourceData::TYPE_DGNA_IND:
+            return QColor(139, 128, 0);
+        case ResourceData::TYPE_DGNA_GRP:
+            return QColor(230, 172, 0);
+        case ResourceData::TYPE_MOBILE:
+            return QColor(135, 159, 217);
+        case ResourceData::TYPE_DISPATCHER:
+        default:
+            return QColor(147, 112, 219);
+    }
+}
+
+QIcon ResourceButton::getIcon(int type, int grpStat)
+{
+    static const QIcon assignIcon(
+                      QPixmap(":/Images/images/icon_dgna_ind_assign.png"));
+    static const QIcon grpAttIcon(
+                      QPixmap(":/Images/images/icon_group_attach.png"));
+    static const QIcon dgnaAttIcon(
+                      QPixmap(":/Images/images/icon_dgna_ind_attach.png"));
+    switch (grpStat)
+    {
+        case SubsData::GRP_STAT_ASSIGN:
+            return assignIcon;
+        case SubsData::GRP_STAT_ATTACH:
+            return (type == ResourceData::TYPE_GROUP)? grpAttIcon: dgnaAttIcon;
+        default:
+            return QtUtils::getRscIcon(type);
+    }
+}
+
 void ResourceButton::mousePressEvent(QMouseEvent *event)
 {
     handleMousePress(event);
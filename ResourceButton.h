@@ -12,6 +12,7 @@
 #define RESOURCEBUTTON_H
 
 #include <map>
+#include <QColor>
 #include <QIcon>
 #include <QMouseEvent>
 #include <QToolButton>
@@ -101,6 +102,23 @@ public:
 
     static QSize getIconSize() { return sIconSize; }
 
+    /**
+     * Gets the normal background color for a resource type.
+     *
+     * @param[in] type The resource type - ResourceData::eType.
+     * @return The color.
+     */
+    static QColor getBgColor(int type);
+
+    /**
+     * Gets the icon for a resource type with a group state.
+     *
+     * @param[in] type    The resource type - ResourceData::eType.
+     * @param[in] grpStat The group state - SubsData::eGrpStat.
+     * @return The icon.
+     */
+    static QIcon getIcon(int type, int grpStat);
+
     static void setUsername(const std::string &username)
     {
         sUsername = username;
@@ -23,12 +23,14 @@ int                     ResourceData::sGrpDspOpt     = DSP_OPT_NAME_SSI;
 int                     ResourceData::sSubsDspOpt    = DSP_OPT_SSI_NAME;
 int                     ResourceData::sMapSubsDspOpt = DSP_OPT_SSI_NAME;
 ResourceData::TypeMapT  ResourceData::sDataMap;
+ResourceData::DspCacheT ResourceData::sDspCache;
 set<ResourceData::ListModel *> ResourceData::sModels;
 
 static const string  LOGPREFIX("ResourceData:: ");
 static const QString PREFIX_DISPATCHER("D:");
 static const QString SEP_GRP(": ");  //separator between group name and GSSI
 static const QString SEP_ISSI(" :"); //separator between ISSI and name
+static const int     KEY_MAP_LBL = 0xFFFF; //display text cache key type
 
 void ResourceData::init(Logger *logger)
 {
@@ -65,6 +67,7 @@ void ResourceData::setMobileStat(bool enable)
     {
         delete sDataMap[TYPE_MOBILE_ONLINE].mdl;
         sDataMap.erase(TYPE_MOBILE_ONLINE);
+        invalidate();
     }
 }
 
@@ -111,6 +114,7 @@ void ResourceData::cleanup(bool doDelete)
         else
             it.second.reset();
     }
+    invalidate();
 }
 
 QStringList ResourceData::dspOptLabels(int type)
@@ -195,9 +199,29 @@ bool ResourceData::addRemoveId(bool doAdd, int type, int id)
         LOGGER_ERROR(sLogger, LOGPREFIX << "addRemoveId: Invalid type " << type);
         return false;
     }
+    auto &data(sDataMap[type]);
     if (!doAdd)
     {
-        sDataMap[type].idNames.erase(id);
+        auto it = data.idNames.find(id);
+        if (it != data.idNames.end())
+        {
+            QString key(it->second.toCaseFolded());
+            data.idNames.erase(it);
+            if (data.nameIds.value(key) == id)
+            {
+                //find any other ID with the same name
+                data.nameIds.remove(key);
+                for (const auto &it2 : data.idNames)
+                {
+                    if (it2.second.toCaseFolded() == key)
+                    {
+                        data.nameIds.insert(key, it2.first);
+                        break;
+                    }
+                }
+            }
+        }
+        invalidate();
         return mdl->removeId(id);
     }
     if (mdl->hasId(id))
@@ -219,7 +243,9 @@ bool ResourceData::addRemoveId(bool doAdd, int type, int id)
             break; //do nothing
     }
     QString name((nm.empty())? "": QtUtils::fromHexUnicode(nm).trimmed());
-    sDataMap[type].idNames[id] = name;
+    data.idNames[id] = name;
+    addName(data, id, name);
+    invalidate();
     mdl->addIdWithName(id, name, true);
     return true;
 }
@@ -280,7 +306,7 @@ int ResourceData::getType(int id)
 {
     for (const auto &it : sDataMap)
     {
-        if (it.second.mdl->hasId(id))
+        if (it.second.idNames.count(id) != 0)
             return it.first;
     }
     return TYPE_UNKNOWN;
@@ -358,18 +384,20 @@ int ResourceData::matchName(bool update, QString &str, int &type)
     else
     {
         //match name
+        QString key(str.toCaseFolded());
         for (auto t : qAsConst(types))
         {
-            for (const auto &it : sDataMap[t].idNames)
+            auto it = sDataMap.find(t);
+            if (it == sDataMap.end())
+                continue;
+            auto it2 = it->second.nameIds.constFind(key);
+            if (it2 != it->second.nameIds.constEnd())
             {
-                if (it.second.compare(str, Qt::CaseInsensitive) == 0)
-                {
-                    if (type >= TYPE_UNKNOWN)
-                        type = t;
-                    if (update)
-                        str = getDspTxt(it.first, t);
-                    return it.first;
-                }
+                if (type >= TYPE_UNKNOWN)
+                    type = t;
+                if (update)
+                    str = getDspTxt(it2.value(), t);
+                return it2.value();
             }
         }
     }
@@ -530,8 +558,12 @@ int ResourceData::getItemId(const QListView *list, int row)
     return 0;
 }
 
-string ResourceData::getMapSubsLbl(int issi)
+QString ResourceData::getMapSubsLblTxt(int issi)
 {
+    quint64 key = getDspKey(issi, KEY_MAP_LBL, sMapSubsDspOpt);
+    auto it = sDspCache.constFind(key);
+    if (it != sDspCache.constEnd())
+        return it->txt;
     QString s;
     if (sMapSubsDspOpt != DSP_OPT_SSI)
     {
@@ -540,19 +572,25 @@ string ResourceData::getMapSubsLbl(int issi)
             s = getName(issi, TYPE_MOBILE);
     }
     if (s.isEmpty())
-        return Utils::toString(issi);
-    switch (sMapSubsDspOpt)
     {
-        case DSP_OPT_NAME_SSI:
-            s.append(SEP_ISSI).append(QString::number(issi));
-            break;
-        case DSP_OPT_SSI_NAME:
-            s.prepend(SEP_ISSI).prepend(QString::number(issi));
-            break;
-        default:
-            break; //do nothing
+        s = QString::number(issi);
+    }
+    else
+    {
+        switch (sMapSubsDspOpt)
+        {
+            case DSP_OPT_NAME_SSI:
+                s.append(SEP_ISSI).append(QString::number(issi));
+                break;
+            case DSP_OPT_SSI_NAME:
+                s.prepend(SEP_ISSI).prepend(QString::number(issi));
+                break;
+            default:
+                break; //do nothing
+        }
     }
-    return s.toStdString();
+    sDspCache.insert(key, {s, TYPE_SUBSCRIBER});
+    return s;
 }
 
 string ResourceData::toString(const IdsT &ids)
@@ -560,6 +598,18 @@ string ResourceData::toString(const IdsT &ids)
     return Utils::toString(ids, ",");
 }
 
+void ResourceData::addName(TypeData &data, int id, const QString &name)
+{
+    if (name.isEmpty())
+        return;
+    QString key(name.toCaseFolded());
+    auto it = data.nameIds.find(key);
+    if (it == data.nameIds.end())
+        data.nameIds.insert(key, id);
+    else if (id < it.value())
+        it.value() = id;
+}
+
 int ResourceData::setDspOpt(int val, int type)
 {
     if (val < 0 || val > DSP_OPT_MAX)
@@ -577,6 +627,7 @@ int ResourceData::setDspOpt(int val, int type)
         case TYPE_SUBSCRIBER:
             sSubsDspOpt = val;
             refreshModel(type, true);
+            refreshModel(TYPE_MOBILE, true);
             break;
         case TYPE_UNKNOWN:
             sMapSubsDspOpt = val;
@@ -687,29 +738,49 @@ QString ResourceData::getDspTxtAndType(int id, int &type)
 {
     if (type == TYPE_DISPATCHER)
         return getClientDspTxt(id);
-    //get from master model
-    QStandardItem *itm;
+    //the options of all types since the resolved type may differ
+    quint64 key = getDspKey(id, type,
+                            sSubsDspOpt * (DSP_OPT_MAX + 1) + sGrpDspOpt);
+    auto it = sDspCache.constFind(key);
+    if (it != sDspCache.constEnd())
+    {
+        type = it->type;
+        return it->txt;
+    }
+    //same as the master model item text
+    DspTxtT dt;
+    dt.type = TYPE_UNKNOWN;
     if (type < TYPE_UNKNOWN)
     {
-        auto *mdl = getModel(type);
-        if (mdl != 0)
+        auto it2 = sDataMap.find(type);
+        if (it2 != sDataMap.end())
         {
-            itm = mdl->getItem(id);
-            if (itm != 0)
-                return itm->text();
+            auto it3 = it2->second.idNames.find(id);
+            if (it3 != it2->second.idNames.end())
+            {
+                dt.type = type;
+                dt.txt = getDspTxt(type, id, it3->second);
+            }
         }
     }
-    for (const auto &it : sDataMap)
+    if (dt.type == TYPE_UNKNOWN)
     {
-        itm = it.second.mdl->getItem(id);
-        if (itm != 0)
+        for (const auto &it2 : sDataMap)
         {
-            type = it.first;
-            return itm->text();
+            auto it3 = it2.second.idNames.find(id);
+            if (it3 != it2.second.idNames.end())
+            {
+                dt.type = it2.first;
+                dt.txt = getDspTxt(it2.first, id, it3->second);
+                break;
+            }
         }
+        if (dt.type == TYPE_UNKNOWN)
+            dt.txt = QString::number(id);
     }
-    type = TYPE_UNKNOWN;
-    return QString::number(id);
+    sDspCache.insert(key, dt);
+    type = dt.type;
+    return dt.txt;
 }
 
 void ResourceData::loadModel(int type, const SubsData::Ssi2DescMapT &data)
@@ -723,8 +794,10 @@ void ResourceData::loadModel(int type, const SubsData::Ssi2DescMapT &data)
             idNames[it.first] = "";
         else
             idNames[it.first] = QtUtils::fromHexUnicode(it.second).trimmed();
+        addName(sDataMap[type], it.first, idNames[it.first]);
         mdl->addIdWithName(it.first, idNames[it.first]);
     }
+    invalidate();
     mdl->sort(0);
     refreshModel(type, false);
 }
@@ -748,9 +821,14 @@ void ResourceData::loadModel(int type, const QString &data)
         {
             name = SubsData::getIssiName(id);
             if (name.empty())
+            {
                 idNames[id] = "";
+            }
             else
+            {
                 idNames[id] = QtUtils::fromHexUnicode(name).trimmed();
+                addName(sDataMap[type], id, idNames[id]);
+            }
         }
         else
         {
@@ -758,6 +836,7 @@ void ResourceData::loadModel(int type, const QString &data)
         }
         mdl->addIdWithName(id, idNames[id]);
     }
+    invalidate();
     mdl->sort(0);
     refreshModel(type, false);
 }
@@ -17,6 +17,8 @@
  *    its user data.
  * The resource ID is set and read through accessors.
  * Utility functions defined here for data handling convenience.
+ * Display texts and map labels are cached by ID, type and display text
+ * option, and the cache is invalidated whenever resource data changes.
  *
  * Copyright (C) Sapura Secured Technologies, 2020-2024. All Rights Reserved.
  *
@@ -31,6 +33,7 @@
 #include <map>
 #include <set>
 #include <assert.h>
+#include <QHash>
 #include <QListView>
 #include <QStandardItem>
 #include <QStandardItemModel>
@@ -747,7 +750,7 @@ public:
      * @param[in] issi The ISSI.
      * @return The label text.
      */
-    static std::string getMapSubsLbl(int issi);
+    static QString getMapSubsLblTxt(int issi);
 
     /**
      * Converts an ID list to string.
@@ -761,19 +764,29 @@ private:
     typedef std::map<int, QString> IdNameMapT;
     struct TypeData
     {
-        ListModel  *mdl = 0; //master model
-        IdNameMapT  idNames; //name of each ID
+        ListModel          *mdl = 0; //master model
+        IdNameMapT          idNames; //name of each ID
+        QHash<QString, int> nameIds; //lowest ID of each case-folded name
 
         //clear data and return the model
         ListModel *reset()
         {
             idNames.clear();
+            nameIds.clear();
             mdl->clear();
             return mdl;
         }
     };
     typedef std::map<int, TypeData> TypeMapT;
 
+    struct DspTxtT
+    {
+        QString txt;
+        int     type; //resolved type
+    };
+    //key from getDspKey()
+    typedef QHash<quint64, DspTxtT> DspCacheT;
+
     static Logger   *sLogger;
     //true normally, false in STM-nwk mode (fewer resource types)
     static bool      sFull;
@@ -782,9 +795,39 @@ private:
     static int       sSubsDspOpt;    //eDspOpt
     static int       sMapSubsDspOpt; //eDspOpt
     static TypeMapT  sDataMap;       //data for each eType
+    static DspCacheT sDspCache;      //display texts and map labels
     //models to refresh upon display text option change - owned by others
     static std::set<ListModel *> sModels;
 
+    /**
+     * Clears the display text cache. Must be called whenever an ID or name
+     * is added, removed or changed.
+     */
+    static void invalidate() { sDspCache.clear(); }
+
+    /**
+     * Gets a display text cache key.
+     *
+     * @param[in] id   The ID.
+     * @param[in] type The requested type.
+     * @param[in] opt  The applicable display text options.
+     * @return The key.
+     */
+    static quint64 getDspKey(int id, int type, int opt)
+    {
+        return ((quint64(quint32(id)) << 32) | ((type & 0xFFFF) << 8) |
+                (opt & 0xFF));
+    }
+
+    /**
+     * Adds a name to the name index of a type.
+     *
+     * @param[in] data The type data.
+     * @param[in] id   The ID.
+     * @param[in] name The name. Ignored if empty.
+     */
+    static void addName(TypeData &data, int id, const QString &name);
+
     /**
      * Sets the resource display text option.
      *
@@ -823,7 +866,7 @@ private:
 
     /**
      * Gets a resource display text and possibly its correct type, from the
-     * master model.
+     * cache or the master data.
      * If the resource has no name, the display text is the ID itself.
      *
      * @param[in]     id   The ID.
@@ -0,0 +1,81 @@
+/**
+ * Resource item delegate implementation.
+ *
+ * Copyright (C) Sapura Secured Technologies, 2026. All Rights Reserved.
+ *
+ * @file
+ * @version $Id$
+ * @author agent <agent@local>
+ */
+#include <QPainter>
+
+#include "QtUtils.h"
+#include "ResourceButton.h"
+#include "ResourceData.h"
+#include "SubsData.h"
+#include "ResourceDelegate.h"
+
+static const int ITEM_WIDTH = 110;
+static const int MARGIN     = 4;
+static const int FONT_SIZE  = 10; //as in Style::OBJ_FONT3
+
+ResourceDelegate::ResourceDelegate(int type, QObject *parent) :
+QStyledItemDelegate(parent), mType(type),
+mHasActiveState(type == ResourceData::TYPE_DGNA_GRP ||
+                type == ResourceData::TYPE_DGNA_IND ||
+                type == ResourceData::TYPE_GROUP)
+{
+}
+
+void ResourceDelegate::paint(QPainter                   *painter,
+                             const QStyleOptionViewItem &option,
+                             const QModelIndex          &index) const
+{
+    auto *mdl = static_cast<const ResourceData::ListModel *>(index.model());
+    int id = ResourceData::getItemId(mdl, index.row());
+    //as in ResourceButton::setOnline()
+    bool online = (mType != ResourceData::TYPE_MOBILE ||
+                   ResourceData::hasId(ResourceData::onlineMobileType(), id));
+    QColor c((online)? ResourceButton::getBgColor(mType):
+                       QColor(150, 150, 150));
+    if ((option.state & QStyle::State_MouseOver) != 0)
+        c = c.lighter(115);
+    painter->save();
+    painter->setRenderHint(QPainter::Antialiasing);
+    QRect r(option.rect.adjusted(1, 1, -1, -1));
+    if ((option.state & QStyle::State_Selected) != 0)
+        painter->setPen(QPen(option.palette.highlight(), 2));
+    else
+        painter->setPen(Qt::NoPen);
+    painter->setBrush(c);
+    painter->drawRoundedRect(r, 8, 8);
+    QSize sz(ResourceButton::getIconSize());
+    QRect ir(r.x() + (r.width() - sz.width())/2, r.y() + MARGIN, sz.width(),
+             sz.height());
+    if (mHasActiveState)
+        ResourceButton::getIcon(mType, SubsData::grpActive(id)).paint(painter,
+                                                                      ir);
+    else
+        QtUtils::getRscIcon(mType).paint(painter, ir);
+    QFont f(option.font);
+    f.setPointSize(FONT_SIZE);
+    painter->setFont(f);
+    painter->setPen(Qt::black);
+    QRect tr(r.x() + MARGIN, ir.bottom() + MARGIN, r.width() - 2 * MARGIN,
+             r.bottom() - ir.bottom() - MARGIN);
+    QFontMetrics fm(f);
+    painter->drawText(tr, Qt::AlignHCenter | Qt::AlignTop,
+                      fm.elidedText(ResourceData::getName(id, mType),
+                                    Qt::ElideRight, tr.width())
+                          .append("\n").append(QString::number(id)));
+    painter->restore();
+}
+
+QSize ResourceDelegate::sizeHint(const QStyleOptionViewItem &option,
+                                 const QModelIndex          &) const
+{
+    QFont f(option.font);
+    f.setPointSize(FONT_SIZE);
+    return QSize(ITEM_WIDTH, ResourceButton::getIconSize().height() +
+                             2 * QFontMetrics(f).height() + 3 * MARGIN);
+}
@@ -0,0 +1,44 @@
+/**
+ * Item delegate that paints resource list items like ResourceButton, for a
+ * list view in icon mode. Only visible items are painted, so a large list
+ * does not need a widget per resource.
+ * The online and group state are retrieved at painting time, while the
+ * tooltip comes from the model.
+ *
+ * Copyright (C) Sapura Secured Technologies, 2026. All Rights Reserved.
+ *
+ * @file
+ * @version $Id$
+ * @author agent <agent@local>
+ */
+#ifndef RESOURCEDELEGATE_H
+#define RESOURCEDELEGATE_H
+
+#include <QStyledItemDelegate>
+
+class ResourceDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+
+public:
+    /**
+     * Constructor.
+     *
+     * @param[in] type   The resource type - ResourceData::eType.
+     * @param[in] parent Parent object.
+     */
+    ResourceDelegate(int type, QObject *parent = 0);
+
+    //overrides
+    void paint(QPainter                   *painter,
+               const QStyleOptionViewItem &option,
+               const QModelIndex          &index) const;
+
+    QSize sizeHint(const QStyleOptionViewItem &option,
+                   const QModelIndex          &index) const;
+
+private:
+    int  mType;
+    bool mHasActiveState;
+};
+#endif //RESOURCEDELEGATE_H
@@ -24,6 +24,7 @@
 #include "DbInt.h"
 #include "FlowLayout.h"
 #include "MessageDialog.h"
+#include "ResourceDelegate.h"
 #include "QtUtils.h"
 #include "Style.h"
 #include "SubsData.h"
@@ -65,7 +66,8 @@ static bool compare(const ResourceButton *b1, const ResourceButton *b2)
     while (0)
 
 Resources::Resources(Logger *logger, QWidget *parent) :
-QWidget(parent), ui(new Ui::Resources), mLogger(logger), mDgnaMembersModel(0)
+QWidget(parent), ui(new Ui::Resources), mLogger(logger), mGrpAttSeq(0),
+mDgnaMembersModel(0)
 {
     ui->setupUi(this);
     SETTABTXT(ui->subsTab, ResourceData::TYPE_SUBSCRIBER);
@@ -139,10 +141,7 @@ QWidget(parent), ui(new Ui::Resources), mLogger(logger), mDgnaMembersModel(0)
                     type = ResourceData::TYPE_DISPATCHER;
                 else
                     return; //cannot occur
-                if (ui->viewGroup->checkedId() == RB_LIST)
-                    showList(type, false);
-                else
-                    showButtons(type, false);
+                showList(type, false, ui->viewGroup->checkedId() != RB_LIST);
             });
     mGrpAttTbl = new QTableWidget(0, 4, this);
     mGrpAttTbl->hide(); //show only after put inside dialog
@@ -223,7 +222,8 @@ QWidget(parent), ui(new Ui::Resources), mLogger(logger), mDgnaMembersModel(0)
                         w = ui->mobileScroll->widget();
                     else
                         w = ui->dispScroll->widget();
-                    if (qobject_cast<DraggableListView *>(w) != 0)
+                    auto *list = qobject_cast<DraggableListView *>(w);
+                    if (list != 0 && list->viewMode() == QListView::ListMode)
                         ui->listView->setChecked(true);
                     else
                         ui->buttonsView->setChecked(true);
@@ -247,6 +247,11 @@ QWidget(parent), ui(new Ui::Resources), mLogger(logger), mDgnaMembersModel(0)
 
 Resources::~Resources()
 {
+    //dialogs may outlive the map
+    for (auto &it : mGrpAttDlgs)
+    {
+        it.second->disconnect(this);
+    }
     ResourceData::cleanup(true);
     delete mDgnaMembersModel;
     phonebookClear(false);
@@ -460,56 +465,29 @@ void Resources::addRemoveId(bool doAdd, int id, int type)
         default:
             break; //do nothing
     }
-    if (w == 0)
-        return;
     auto *list = qobject_cast<DraggableListView *>(w);
-    if (list != 0)
+    if (list == 0)
+        return;
+    //other than TYPE_MOBILE_ONLINE, do nothing if list is showing all
+    //items, because it is updated automatically through the model
+    if (type != ResourceData::TYPE_MOBILE_ONLINE &&
+        list->model() == ResourceData::getModel(type))
+        return;
+    //find item to remove or update
+    auto *itm = ResourceData::getItem(list, id);
+    if (itm != 0)
     {
-        //other than TYPE_MOBILE_ONLINE, do nothing if list is showing all
-        //items, because it is updated automatically through the model
-        if (type != ResourceData::TYPE_MOBILE_ONLINE &&
-            list->model() == ResourceData::getModel(type))
-            return;
-        //find item to remove or update
-        auto *itm = ResourceData::getItem(list, id);
-        if (itm != 0)
+        if (type == ResourceData::TYPE_MOBILE_ONLINE)
         {
-            if (type == ResourceData::TYPE_MOBILE_ONLINE)
-            {
-                setMobOnlineStatus(itm, (doAdd)? 1: 0);
-            }
-            else
-            {
-                //cannot use qobject_cast here
-                auto *m = dynamic_cast<ResourceData::ListModel *>(list->model());
-                if (m != 0)
-                    m->removeId(id);
-            }
+            //also repaints the item in button view
+            setMobOnlineStatus(itm, (doAdd)? 1: 0);
         }
-    }
-    else
-    {
-        //find button to remove or update
-        auto *layout(w->layout());
-        if (layout == 0)
-            return;
-        ResourceButton *rb = 0;
-        int i = layout->count() - 1;
-        for (; i>=0; --i)
+        else
         {
-            w = layout->itemAt(i)->widget();
-            if (w != 0)
-            {
-                rb = qobject_cast<ResourceButton *>(w);
-                if (rb != 0 && rb->getId() == id)
-                {
-                    if (type == ResourceData::TYPE_MOBILE_ONLINE)
-                        rb->setOnline(true, doAdd);
-                    else
-                        delete rb;
-                    break;
-                }
-            }
+            //cannot use qobject_cast here
+            auto *m = dynamic_cast<ResourceData::ListModel *>(list->model());
+            if (m != 0)
+                m->removeId(id);
         }
     }
 }
@@ -596,36 +574,14 @@ void Resources::setGrpActive(int gssi)
             return; //do nothing - should not occur
     }
     //it is possible that buttons/list not yet generated
-    if (w != 0)
+    auto *list = qobject_cast<DraggableListView *>(w);
+    if (list != 0)
     {
-        auto *list = qobject_cast<DraggableListView *>(w);
-        if (list != 0)
-        {
-            //find the list item to change appearance
-            auto *p = ResourceData::getItem(list, gssi);
-            if (p != 0)
-                setGrpStatus(p, gssi);
-        }
-        else
-        {
-            //find the button to change appearance
-            ResourceButton *rb;
-            QLayout *layout(w->layout());
-            int i = layout->count() - 1;
-            for (; i>=0; --i)
-            {
-                w = layout->itemAt(i)->widget();
-                if (w != 0)
-                {
-                    rb = qobject_cast<ResourceButton *>(w);
-                    if (rb != 0 && rb->getId() == gssi)
-                    {
-                        rb->setActive();
-                        break;
-                    }
-                }
-            }
-        }
+        //find the item to change appearance - the change also repaints it in
+        //button view
+        auto *p = ResourceData::getItem(list, gssi);
+        if (p != 0)
+            setGrpStatus(p, gssi);
     }
     auto *btn = phonebookGetItem(type, gssi);
     if (btn != 0)
@@ -634,66 +590,67 @@ void Resources::setGrpActive(int gssi)
 
 void Resources::showGrpAttachedMembers(int gssi, QWidget *parent)
 {
+    auto it = mGrpAttDlgs.find(gssi);
+    if (it != mGrpAttDlgs.end())
+    {
+        it->second->raise();
+        it->second->activateWindow();
+        return;
+    }
     int type = ResourceData::getType(gssi);
-    QString msg(ResourceData::getDspTxt(gssi, type));
-    msg.append("\n").append(QtUtils::getTimestamp());
-    QString s(QString::fromStdString(
-                           SubsData::getGrpAttachedMembers(gssi, false, true)));
-    if (s.isEmpty())
-        msg.append(tr("\nNo attached members."));
-    else
-        msg.append(tr("\nAttached members:"));
     if (type == ResourceData::TYPE_UNKNOWN)
         type = ResourceData::TYPE_GROUP; //for getRscIcon()
-    if (ResourceData::isFullMode())
-    {
-        string s2(SubsData::getGrpUncAttach(gssi));
-        if (!s2.empty())
-            s.append("\n\n").append(tr("Unconfirmed:")).append("\n")
-             .append(QString::fromStdString(s2));
-    }
-    MessageDialog::showMessage(tr("Group Attachments"), msg, s,
-                               QtUtils::getRscIcon(type),
-                               (parent == 0)? this: parent);
+    auto *md = new MessageDialog(tr("Group Attachments"), "",
+                                 QtUtils::getRscIcon(type), true,
+                                 (parent == 0)? this: parent);
+    setGrpAttText(gssi, md);
+    mGrpAttDlgs[gssi] = md;
+    connect(md, &QObject::destroyed, this,
+            [this, gssi] { mGrpAttDlgs.erase(gssi); });
+    md->adjustSize();
+    md->show();
 }
 
-void Resources::addGrpAttachData(bool detach, int issi, const set<int> &gssis)
+void Resources::updateGrpAtt()
 {
-    QString a((detach)? tr("Detach"): ""); //remains unchanged if detach=true
-    QString i(QString::number(issi));
+    if (!SubsData::isReady())
+        return; //refreshed after data reload
+    SubsData::GrpAttChangesT changes;
+    if (!SubsData::getGrpAttChanges(mGrpAttSeq, changes))
+    {
+        refreshGrpAtt();
+        return;
+    }
+    if (changes.empty())
+        return;
     QString t(QtUtils::getTimestamp());
+    set<int> gssis; //affected
     mGrpAttTbl->setSortingEnabled(false);
-    for (auto g : gssis)
+    for (const auto &c : changes)
     {
-        if (!detach && SubsData::isGrpAttachedMember(issi, g))
+        gssis.insert(c.gssi);
+        if (c.attached)
         {
-            if (mGrpAttMap.count(g) != 0 && mGrpAttMap[g].count(issi) != 0)
-            {
-                LOGGER_DEBUG(mLogger, LOGPREFIX << "addGrpAttachData: "
-                             "Skipping attach " << issi << "=>" << g);
-                continue; //issi already shown as attached to g
-            }
-            mGrpAttMap[g].insert(issi);
-            a = tr("Attach");
+            if (!mGrpAttMap[c.gssi].insert(c.issi).second)
+                continue; //already shown as attached
         }
         else
         {
-            if (mGrpAttMap.count(g) == 0 || mGrpAttMap[g].erase(issi) == 0)
-            {
-                LOGGER_DEBUG(mLogger, LOGPREFIX << "addGrpAttachData: "
-                             "Skipping detach " << issi << "<=" << g);
-                continue; //issi not shown as attached to g
-            }
-            if (!detach)
-                a = tr("Detach"); //else already correct string
+            auto it = mGrpAttMap.find(c.gssi);
+            if (it == mGrpAttMap.end() || it->second.erase(c.issi) == 0)
+                continue; //not shown as attached, e.g. after history clear
+            if (it->second.empty())
+                mGrpAttMap.erase(it);
         }
-        mGrpAttTbl->insertRow(0);
-        mGrpAttTbl->setItem(0, 0, new QTableWidgetItem(QString::number(g)));
-        mGrpAttTbl->setItem(0, 1, new QTableWidgetItem(i));
-        mGrpAttTbl->setItem(0, 2, new QTableWidgetItem(a));
-        mGrpAttTbl->setItem(0, 3, new QTableWidgetItem(t));
+        addGrpAttRow(QString::number(c.gssi), c.issi, c.attached, t);
     }
     mGrpAttTbl->setSortingEnabled(true);
+    for (auto g : gssis)
+    {
+        auto it = mGrpAttDlgs.find(g);
+        if (it != mGrpAttDlgs.end())
+            setGrpAttText(g, it->second);
+    }
 }
 
 void Resources::showEvent(QShowEvent *)
@@ -706,7 +663,7 @@ void Resources::refreshGrpAtt()
     QString g; //GSSI
     QString t(QtUtils::getTimestamp());
     auto tmpMap(mGrpAttMap); //init just to be able to use 'auto'
-    SubsData::getGrpAttachedMembers(tmpMap);
+    SubsData::getGrpAttachedMembers(tmpMap, &mGrpAttSeq);
     mGrpAttTbl->setSortingEnabled(false);
     if (!mGrpAttMap.empty())
     {
@@ -726,13 +683,7 @@ void Resources::refreshGrpAtt()
                     ++it;
                     continue;
                 }
-                mGrpAttMap[mit->first].insert(*it);
-                mGrpAttTbl->insertRow(0);
-                mGrpAttTbl->setItem(0, 0, new QTableWidgetItem(g));
-                mGrpAttTbl->setItem(0, 1,
-                                    new QTableWidgetItem(QString::number(*it)));
-                mGrpAttTbl->setItem(0, 2, new QTableWidgetItem(tr("Detach")));
-                mGrpAttTbl->setItem(0, 3, new QTableWidgetItem(t));
+                addGrpAttRow(g, *it, false, t);
                 it = mit->second.erase(it);
             }
             if (mit->second.empty())
@@ -754,16 +705,49 @@ void Resources::refreshGrpAtt()
                     mGrpAttMap[it.first].count(i) != 0)
                     continue; //already shown as attached - skip
                 mGrpAttMap[it.first].insert(i);
-                mGrpAttTbl->insertRow(0);
-                mGrpAttTbl->setItem(0, 0, new QTableWidgetItem(g));
-                mGrpAttTbl->setItem(0, 1,
-                                    new QTableWidgetItem(QString::number(i)));
-                mGrpAttTbl->setItem(0, 2, new QTableWidgetItem(tr("Attach")));
-                mGrpAttTbl->setItem(0, 3, new QTableWidgetItem(t));
+                addGrpAttRow(g, i, true, t);
             }
         }
     } //if (!tmpMap.empty())
     mGrpAttTbl->setSortingEnabled(true);
+    for (auto &it : mGrpAttDlgs)
+    {
+        setGrpAttText(it.first, it.second);
+    }
+}
+
+void Resources::addGrpAttRow(const QString &gssi,
+                             int            issi,
+                             bool           attach,
+                             const QString &time)
+{
+    mGrpAttTbl->insertRow(0);
+    mGrpAttTbl->setItem(0, 0, new QTableWidgetItem(gssi));
+    mGrpAttTbl->setItem(0, 1, new QTableWidgetItem(QString::number(issi)));
+    mGrpAttTbl->setItem(0, 2,
+                        new QTableWidgetItem((attach)? tr("Attach"):
+                                                       tr("Detach")));
+    mGrpAttTbl->setItem(0, 3, new QTableWidgetItem(time));
+}
+
+void Resources::setGrpAttText(int gssi, MessageDialog *md)
+{
+    QString hdr(ResourceData::getDspTxt(gssi, ResourceData::getType(gssi)));
+    hdr.append("\n").append(QtUtils::getTimestamp());
+    QString s(QString::fromStdString(
+                           SubsData::getGrpAttachedMembers(gssi, false, true)));
+    if (s.isEmpty())
+        hdr.append(tr("\nNo attached members."));
+    else
+        hdr.append(tr("\nAttached members:"));
+    if (ResourceData::isFullMode())
+    {
+        string s2(SubsData::getGrpUncAttach(gssi));
+        if (!s2.empty())
+            s.append("\n\n").append(tr("Unconfirmed:")).append("\n")
+             .append(QString::fromStdString(s2));
+    }
+    md->setText(hdr, s);
 }
 
 inline bool Resources::hasActiveState(int type) const
@@ -826,20 +810,34 @@ void Resources::search(int type, const QString &re)
 
 void Resources::showSearchResults(int type)
 {
-    if (type == ResourceData::TYPE_SUBSCRIBER || ui->listView->isChecked())
-        showList(type, true);
-    else
-        showButtons(type, true);
+    showList(type, true,
+             type != ResourceData::TYPE_SUBSCRIBER &&
+             !ui->listView->isChecked());
 }
 
-int Resources::showList(int type, bool filtered)
+int Resources::showList(int type, bool filtered, bool asButtons)
 {
     auto *mdl = (filtered)? mSearchResultMap[type]: ResourceData::getModel(type);
     if (mdl == 0)
         return 0;
     auto *list = new DraggableListView(type);
     list->setContextMenuPolicy(Qt::CustomContextMenu);
+    if (asButtons)
+    {
+        //only the visible items are painted, instead of having a
+        //ResourceButton for each item
+        list->setViewMode(QListView::IconMode);
+        list->setMovement(QListView::Static);
+        list->setResizeMode(QListView::Adjust);
+        list->setUniformItemSizes(true);
+        list->setSpacing(2);
+        list->setMouseTracking(true);
+        list->setItemDelegate(new ResourceDelegate(type, list));
+    }
     list->setModel(mdl);
+    //single click in button view, like ResourceButton
+    auto activated = (asButtons)? &DraggableListView::clicked:
+                                  &DraggableListView::doubleClicked;
     QScrollArea *sa = 0;
     switch (type)
     {
@@ -849,14 +847,16 @@ int Resources::showList(int type, bool filtered)
         case ResourceData::TYPE_DGNA_GRP:
             if (sa == 0)
                 sa = ui->dgnaGrpScroll;
-            connect(list, &DraggableListView::doubleClicked, this,
-                    [this](const QModelIndex &idx)
+            connect(list, activated, this,
+                    [this, asButtons](const QModelIndex &idx)
                     {
                         //emit selected DGNA grp data
                         auto *mdl = ResourceData::model(
                           qobject_cast<DraggableListView *>(QObject::sender()));
                         selectedDgna(mdl->type(),
                                      ResourceData::getItemId(mdl, idx.row()));
+                        if (asButtons)
+                            return;
                         auto *l = qobject_cast<DraggableListView *>
                                   (QObject::sender());
                         showGrpAttachedMembers(
@@ -868,7 +868,7 @@ int Resources::showList(int type, bool filtered)
             break;
         case ResourceData::TYPE_GROUP:
             sa = ui->talkgroupScroll;
-            connect(list, &DraggableListView::doubleClicked, this,
+            connect(list, activated, this,
                     [this](const QModelIndex &idx)
                     {
                         //show attached grp members
@@ -918,46 +918,6 @@ int Resources::showList(int type, bool filtered)
     return mdl->rowCount();
 }
 
-int Resources::showButtons(int type, bool filtered)
-{
-    auto *mdl = (filtered)? mSearchResultMap[type]: ResourceData::getModel(type);
-    if (mdl == 0)
-        return 0;
-    auto *widget = new QWidget();
-    widget->setLayout(new FlowLayout(5, 4, 4));
-    int n = mdl->rowCount();
-    for (auto i=0; i<n; ++i)
-    {
-        createButton(type, ResourceData::getItemId(mdl, i), false, widget);
-    }
-    QScrollArea *sa;
-    switch (type)
-    {
-        case ResourceData::TYPE_DGNA_GRP:
-            sa = ui->dgnaGrpScroll;
-            break;
-        case ResourceData::TYPE_DGNA_IND:
-            sa = ui->dgnaIndScroll;
-            break;
-        case ResourceData::TYPE_DISPATCHER:
-            sa = ui->dispScroll;
-            break;
-        case ResourceData::TYPE_GROUP:
-            sa = ui->talkgroupScroll;
-            break;
-        case ResourceData::TYPE_MOBILE:
-            sa = ui->mobileScroll;
-            break;
-        case ResourceData::TYPE_SUBSCRIBER:
-        default:
-            sa = ui->subsScroll;
-            break;
-    }
-    sa->setWidget(widget);
-    sa->setVerticalScrollBarPolicy(Qt::ScrollBarAsNeeded);
-    return n;
-}
-
 ResourceButton *Resources::createButton(int      type,
                                         int      id,
                                         bool     enableNotes,
@@ -22,6 +22,7 @@
 
 #include "DraggableListView.h"
 #include "Logger.h"
+#include "MessageDialog.h"
 #include "ResourceButton.h"
 #include "ResourceData.h"
 
@@ -111,7 +112,8 @@ public:
     void setGrpActive(int gssi);
 
     /**
-     * Displays attached members of a group.
+     * Displays attached members of a group. The dialog is kept updated
+     * until closed, and is only raised if already open.
      *
      * @param[in] gssi   The GSSI.
      * @param[in] parent The parent widget, if any.
@@ -119,15 +121,11 @@ public:
     void showGrpAttachedMembers(int gssi, QWidget *parent = 0);
 
     /**
-     * Adds to group attachments history.
-     *
-     * @param[in] detach true for detachment of all GSSIs, false if need to
-     *                   determine attachment/detachment of each GSSI from
-     *                   SubsData.
-     * @param[in] issi   The ISSI.
-     * @param[in] gssis  The affected GSSIs.
+     * Applies the group attachment changes in SubsData since the last call
+     * to the group attachments history and open attached members dialogs.
+     * Rebuilds the history if the changes are no longer available.
      */
-    void addGrpAttachData(bool detach, int issi, const std::set<int> &gssis);
+    void updateGrpAtt();
 
 signals:
     void dgnaSelected(int gssi, int type, ResourceData::ListModel *rscModel);
@@ -149,7 +147,10 @@ private:
     std::map<int, ResourceData::ListModel *> mSearchResultMap;
     //grp attachments as in mGrpAttTbl, GSSI=>ISSIs
     std::map<int, std::set<int>>             mGrpAttMap;
+    //open attached members dialogs, GSSI=>dialog
+    std::map<int, MessageDialog *>           mGrpAttDlgs;
 
+    long long                mGrpAttSeq;        //last SubsData change applied
     QString                  mUsername;
     QTableWidget            *mGrpAttTbl;        //grp attachments history
     ResourceData::ListModel *mDgnaMembersModel; //potential DGNA members
@@ -162,6 +163,27 @@ private:
      */
     void refreshGrpAtt();
 
+    /**
+     * Adds an entry at the top of the group attachments history.
+     *
+     * @param[in] gssi   The GSSI.
+     * @param[in] issi   The ISSI.
+     * @param[in] attach true for attachment.
+     * @param[in] time   The timestamp.
+     */
+    void addGrpAttRow(const QString &gssi,
+                      int            issi,
+                      bool           attach,
+                      const QString &time);
+
+    /**
+     * Sets the content of an attached members dialog.
+     *
+     * @param[in] gssi The GSSI.
+     * @param[in] md   The dialog.
+     */
+    void setGrpAttText(int gssi, MessageDialog *md);
+
     /**
      * Checks whether the given resource type has an Active state.
      * Currently this is true for a group type only.
@@ -187,22 +209,15 @@ private:
     void showSearchResults(int type);
 
     /**
-     * Displays resources in the resource type tab in list view.
+     * Displays resources in the resource type tab in list or button view.
+     * The button view is a list view in icon mode with a ResourceDelegate.
      *
-     * @param[in] type     The resource type - ResourceData::eType.
-     * @param[in] filtered true to show the filtered resources.
+     * @param[in] type      The resource type - ResourceData::eType.
+     * @param[in] filtered  true to show the filtered resources.
+     * @param[in] asButtons true for button view.
      * @return The list size.
      */
-    int showList(int type, bool filtered);
-
-    /**
-     * Displays resources in the resource type tab in button view.
-     *
-     * @param[in] type     The resource type - ResourceData::eType.
-     * @param[in] filtered true to show the filtered resources.
-     * @return The number of buttons.
-     */
-    int showButtons(int type, bool filtered);
+    int showList(int type, bool filtered, bool asButtons);
 
     /**
      * Creates a resource button.
@@ -10,7 +10,9 @@
  * @author Zulzaidi Atan
  */
 #include <assert.h>
+#include <math.h>       //fabs
 
+#include "Metrics.h"
 #include "VoipSessionBase.h"
 #include "RtpSession.h"
 
@@ -43,7 +45,8 @@ RtpSession::RtpSession(int             type,
                        void           *cbObj,
                        RecvCallbackFn  recvCbFn,
                        StatCallbackFn  statCbFn) :
-mTs(0), mTsInc(0), mRxSeq(0), mState(STATE_END), mBytesRcvd(0),
+mTs(0), mTsInc(0), mRxSeq(0), mLastRxTs(0), mState(STATE_END), mBytesRcvd(0),
+mLastRxUs(0), mJitterUs(0),
 mLocalPort(localPort), mRemotePort(remotePort), mRecvThread(0), mLogger(logger),
 mRtp(0), mCbObj(cbObj), mRxCbFn(recvCbFn), mStatCbFn(statCbFn)
 {
@@ -282,8 +285,34 @@ void RtpSession::rtpSessionCallback(struct rtp *s, rtp_event *e)
 void RtpSession::recv(rtp_packet *p)
 {
     assert(p != 0);
-    if (p->data == NULL || p->data_len <= 0 || (p->seq > 0 && p->seq < mRxSeq))
-        return; //discard invalid or old data
+    static Metrics::Counter &rcvdCount(
+                           Metrics::counter("scad_rtp_packets_received_total"));
+    static Metrics::Counter &lateCount(
+                               Metrics::counter("scad_rtp_packets_late_total"));
+    static Metrics::Counter &lostCount(
+                               Metrics::counter("scad_rtp_packets_lost_total"));
+    static Metrics::Histogram &jitter(Metrics::histogram("scad_rtp_jitter_us"));
+    if (p->data == NULL || p->data_len <= 0)
+        return; //discard invalid data
+    rcvdCount.add();
+    long long now = Metrics::nowUs();
+    if (mLastRxUs != 0 && mSample > 0)
+    {
+        //RFC 3550 interarrival jitter, in microseconds instead of RTP
+        //timestamp units
+        double d = (now - mLastRxUs) -
+                   static_cast<int32_t>(p->ts - mLastRxTs) * 1000000.0 /
+                       mSample;
+        mJitterUs += (fabs(d) - mJitterUs) / 16;
+        jitter.record(static_cast<long long>(mJitterUs));
+    }
+    mLastRxUs = now;
+    mLastRxTs = p->ts;
+    if (p->seq > 0 && p->seq < mRxSeq)
+    {
+        lateCount.add();
+        return; //discard old data
+    }
     mBytesRcvd += p->data_len;
     if (p->seq == 0 && !mRxData.empty())
     {
@@ -310,7 +339,11 @@ void RtpSession::recv(rtp_packet *p)
     {
         auto it = mRxData.begin();
         if (mRxData.size() >= mRxDataMax)
-            mRxSeq = it->first; //do not wait anymore, just skip missing data
+        {
+            //do not wait anymore, just skip missing data
+            lostCount.add(it->first - mRxSeq - 1);
+            mRxSeq = it->first;
+        }
         while (it != mRxData.end())
         {
             if (it->first > mRxSeq + 1)
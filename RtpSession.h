@@ -53,7 +53,9 @@ public:
 
     void stop() {}
 
-    int send(char *, int) { return 0; }
+    int send(char *, int, bool = false) { return 0; }
+
+    void skip() {}
 
     static void setRemoteIp(const std::string &) {}
 #else
@@ -109,6 +111,12 @@ public:
      */
     int send(char *data, int len, bool marker = false);
 
+    /**
+     * Advances the RTP timestamp for a frame that is not sent, e.g. during
+     * silence suppression.
+     */
+    void skip() { mTs += mTsInc; }
+
     /**
      * Gets the object identifier for logging.
      *
@@ -167,12 +175,15 @@ private:
     uint32_t            mTs;              //RTP timestamp
     uint32_t            mTsInc;           //RTP timestamp increment
     uint16_t            mRxSeq;           //current RTP packet sequence
+    uint32_t            mLastRxTs;        //RTP timestamp of last Rx packet
     int                 mPayload;         //payload type
     int                 mState;           //receive thread state
     int                 mSample;          //sample rate in Hz
     int                 mPacketTime;      //in milliseconds
     int                 mRxDataMax;       //Rx data buffer max size
     int                 mBytesRcvd;
+    long long           mLastRxUs;        //arrival time of last Rx packet
+    double              mJitterUs;        //RFC 3550 interarrival jitter
     uint16_t            mLocalPort;
     uint16_t            mRemotePort;
     std::string         mLogPrefix;       //object identifier for logging
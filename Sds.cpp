@@ -26,6 +26,7 @@
 #include "Settings.h"
 #include "StatusCodes.h"
 #include "Style.h"
+#include "ThumbnailCache.h"
 #include "Utils.h"
 #include "ui_Sds.h"
 #include "Sds.h"
@@ -187,6 +188,17 @@ mMsgState(MSG_EMPTY), mLogger(logger), mResourceSelector(rscSelector)
                 }
             });
     ui->mmsFiles->setAcceptDrops(true);
+    connect(&ThumbnailCache::instance(), &ThumbnailCache::ready, this,
+            [this](const QString &path, int size)
+            {
+                if (size != ThumbnailCache::ICON_SIZE)
+                    return;
+                for (auto *item :
+                     ui->mmsFiles->findItems(path, Qt::MatchExactly))
+                {
+                    item->setIcon(CommsRegister::getIcon(path));
+                }
+            });
     ui->mmsFiles->installEventFilter(this);
     ui->mmsFiles->setContextMenuPolicy(Qt::CustomContextMenu);
     connect(ui->mmsFiles, &QListWidget::customContextMenuRequested, this,
@@ -16,6 +16,8 @@
 #include "DbInt.h"
 #endif
 #include "Md5Digest.h"
+#include "Metrics.h"
+#include "SocketLoop.h"
 #include "StatusCodes.h"
 #include "SubsData.h"
 #include "Utils.h"
@@ -34,6 +36,17 @@ enum
 static const int BUFFER_SIZE_BYTES = 2048;
 //multiplication factor to get the watchdog period from the KeepAlive period
 static const int WATCHDOG_KEEPALIVE_PERIOD_FACTOR = 2;
+//maximum SSI list length in a monitoring message - a larger list is split
+//into multiple messages, each fitting in a single socket read on the server
+static const size_t MON_LIST_MAX_LEN = 1000;
+//standby session check period while disconnected or idle, which bounds the
+//delay in noticing a logout of the current session
+static const int STANDBY_POLL_SECS = 1;
+//standby session login response timeout
+static const int STANDBY_LOGIN_SECS = 10;
+//delay before standby session reconnection after failure to connect or login
+static const int STANDBY_RETRY_SECS = 2;
+static const int STANDBY_RETRY_LOGIN_SECS = 30;
 
 //common static initializers
 int             ServerSession::sServerIdx(SERVER_IDX_MAIN);
@@ -63,6 +76,11 @@ static void *startRecvThread(void *arg)
     return 0;
 }
 
+static void onStandbyEvent(void *obj, int events)
+{
+    static_cast<ServerSession *>(obj)->standbyEvent(events);
+}
+
 ServerSession::ServerSession(const string   &username,
                              const string   &password,
                              const string   &branches,
@@ -77,8 +95,11 @@ mState(STATE_INVALID), mMessageId(MsgSp::Value::MSG_ID_MIN - 1),
 mDoSubsData(doSubsData),
 #endif
 mRecvTime(0), mSentTime(0), mUsername(username), mPassword(password),
-mBranches(branches), mRecvThread(0), mVoipSession(0), mSocket(0),
-mCbObj(callbackObj), mCbFn(callbackFn)
+mBranches(branches), mRecvThread(0), mStandbyState(STATE_INVALID),
+mStandbyIdx(SERVER_IDX_NONE), mStandbyKeepAlive(0), mStandbyRecvTime(0),
+mStandbySentTime(0), mStandbyRetryTime(0), mFailTime(0), mStandbyLogin(0),
+mStandbyHandle(0), mGpsMonAll(false), mVoipSession(0), mSocket(0),
+mStandby(0), mCbObj(callbackObj), mCbFn(callbackFn)
 {
     start();
 }
@@ -93,10 +114,20 @@ ServerSession::~ServerSession()
     }
     mState = STATE_STOPPED;
     delete mVoipSession;
+    //waits for any running standby callback
+    SocketLoop::remove(mStandbyHandle);
+    if (mStandby != 0)
+        standbyDisconnect();
     delete mSocket;
     if (mRecvThread != 0)
         PalThread::stop(mRecvThread);
+    delete mStandby;
+    delete mStandbyLogin;
+    monBatchClear();
     PalLock::destroy(&mSendMsgLock);
+    PalLock::destroy(&mMonBatchLock);
+    PalLock::destroy(&mStandbyLock);
+    PalLock::destroy(&mMirrorLock);
 #ifndef NO_DB
     DbInt::destroy();
 #endif
@@ -123,7 +154,13 @@ void ServerSession::setBranches(const string *branches)
             m.addField(MsgSp::Field::GRP_LIST, mBranches);
         sendMsg(&m, false);
         if (branches != 0)
+        {
             requestSubsData();
+            PalLock::take(&mMirrorLock);
+            if (mStandbyState == STATE_LOGIN)
+                standbySend(m);
+            PalLock::release(&mMirrorLock);
+        }
     }
 }
 
@@ -137,21 +174,19 @@ bool ServerSession::monitorStart(int ssi, bool isGroup)
                      << ssi);
         return false;
     }
-    sendMon(MsgSp::Type::MON_START, isGroup, 0, ssi);
-    return true;
+    return sendMon(MsgSp::Type::MON_START, isGroup, 0, ssi);
 }
 
-bool ServerSession::monitorStart(const SsiSetT &ssiSet, bool isGroup)
+bool ServerSession::monitorStart(const IdRangeSet &ssis, bool isGroup)
 {
     if (!isLoggedIn())
         return false;
-    if (ssiSet.empty())
+    if (ssis.empty())
     {
         LOGGER_ERROR(sLogger, mLogPrefix << "monitorStart: Empty SSI list.");
         return false;
     }
-    sendMon(MsgSp::Type::MON_START, isGroup, &ssiSet);
-    return true;
+    return sendMon(MsgSp::Type::MON_START, isGroup, &ssis);
 }
 
 bool ServerSession::monitorStop(int ssi, bool isGroup)
@@ -164,21 +199,19 @@ bool ServerSession::monitorStop(int ssi, bool isGroup)
                      << ssi);
         return false;
     }
-    sendMon(MsgSp::Type::MON_STOP, isGroup, 0, ssi);
-    return true;
+    return sendMon(MsgSp::Type::MON_STOP, isGroup, 0, ssi);
 }
 
-bool ServerSession::monitorStop(const SsiSetT &ssiSet, bool isGroup)
+bool ServerSession::monitorStop(const IdRangeSet &ssis, bool isGroup)
 {
     if (!isLoggedIn())
         return false;
-    if (ssiSet.empty())
+    if (ssis.empty())
     {
         LOGGER_ERROR(sLogger, mLogPrefix << "monitorStop: Empty SSI list.");
         return false;
     }
-    sendMon(MsgSp::Type::MON_STOP, isGroup, &ssiSet);
-    return true;
+    return sendMon(MsgSp::Type::MON_STOP, isGroup, &ssis);
 }
 
 bool ServerSession::monitorStop()
@@ -186,23 +219,28 @@ bool ServerSession::monitorStop()
     if (!isLoggedIn())
         return false;
     sendMsg(new MsgSp(MsgSp::Type::MON_STOP));
+    mirrorMon(MsgSp::Type::MON_STOP, false, IdRangeSet());
     return true;
 }
 
-bool ServerSession::gpsMonitorStart(const SsiSetT &ssiSet)
+bool ServerSession::gpsMonitorStart(const IdRangeSet &ssis)
 {
     MsgSp m(MsgSp::Type::GPS_MON_START);
-    if (!ssiSet.empty())
-        m.addField(MsgSp::Field::ISSI_LIST, Utils::toStringWithRange(ssiSet));
-    return (sendMsg(&m, false) > 0);
+    if ((ssis.empty())? (sendMsg(&m, false) <= 0):
+                        !sendMonBulk(m, MsgSp::Field::ISSI_LIST, ssis))
+        return false;
+    mirrorMon(MsgSp::Type::GPS_MON_START, false, ssis);
+    return true;
 }
 
-bool ServerSession::gpsMonitorStop(const SsiSetT &ssiSet)
+bool ServerSession::gpsMonitorStop(const IdRangeSet &ssis)
 {
     MsgSp m(MsgSp::Type::GPS_MON_STOP);
-    if (!ssiSet.empty())
-        m.addField(MsgSp::Field::ISSI_LIST, Utils::toStringWithRange(ssiSet));
-    return (sendMsg(&m, false) > 0);
+    if ((ssis.empty())? (sendMsg(&m, false) <= 0):
+                        !sendMonBulk(m, MsgSp::Field::ISSI_LIST, ssis))
+        return false;
+    mirrorMon(MsgSp::Type::GPS_MON_STOP, false, ssis);
+    return true;
 }
 
 bool ServerSession::requestStatusData()
@@ -675,6 +713,11 @@ int ServerSession::poiUpdate(int id, bool doDelete)
 }
 
 int ServerSession::sendMsg(MsgSp *msg, bool deleteMsg)
+{
+    return sendMsg(msg, deleteMsg, 0);
+}
+
+int ServerSession::sendMsg(MsgSp *msg, bool deleteMsg, int msgId)
 {
     if (msg == 0)
     {
@@ -682,9 +725,12 @@ int ServerSession::sendMsg(MsgSp *msg, bool deleteMsg)
         return 0;
     }
     PalLock::take(&mSendMsgLock);
-    if (++mMessageId > MsgSp::Value::MSG_ID_MAX)
-        mMessageId = MsgSp::Value::MSG_ID_MIN;
-    int msgId = mMessageId;
+    if (msgId == 0)
+    {
+        if (++mMessageId > MsgSp::Value::MSG_ID_MAX)
+            mMessageId = MsgSp::Value::MSG_ID_MIN;
+        msgId = mMessageId;
+    }
     msg->addField(MsgSp::Field::MSG_ID, msgId);
     int res;
     if (msg->getType() == MsgSp::Type::LOGIN && !mMsgKey.empty())
@@ -702,6 +748,9 @@ int ServerSession::sendMsg(MsgSp *msg, bool deleteMsg)
         mSentTime = time(NULL);
         //need mutex only up to modifying mSentTime
         PalLock::release(&mSendMsgLock);
+        static Metrics::Counter &sentCount(
+                               Metrics::counter("scad_server_msgs_sent_total"));
+        sentCount.add();
         switch (msg->getType())
         {
 #ifndef DEBUG
@@ -774,6 +823,10 @@ void ServerSession::recvThread()
     MsgSp  *msg;
     MsgSp  *resp = 0;
     char    buf[BUFFER_SIZE_BYTES];
+    Metrics::Counter &recvCount(
+                           Metrics::counter("scad_server_msgs_received_total"));
+    Metrics::Counter &parseErrCount(
+                         Metrics::counter("scad_server_parse_errors_total"));
 
     while (mState != STATE_STOPPED)
     {
@@ -800,6 +853,12 @@ void ServerSession::recvThread()
                 //timeout - server still connected but not sending
                 LOGGER_ERROR(sLogger, mLogPrefix << "Server timeout "
                             << time(NULL) - mRecvTime << " seconds.");
+                if (failover(keepAlivePeriod, str))
+                {
+                    watchdogPeriod = keepAlivePeriod *
+                                     WATCHDOG_KEEPALIVE_PERIOD_FACTOR;
+                    continue;
+                }
                 mCbFn(mCbObj, new MsgSp(MsgSp::Type::REMOTE_SERVER_TIMEOUT));
                 if (isLoggedIn())
                 {
@@ -811,6 +870,7 @@ void ServerSession::recvThread()
                 StatusCodes::setStateDownloading(false);
                 setName();
                 str.clear();
+                monBatchClear();
                 if (!connectToServer())
                     return;
             }
@@ -824,6 +884,12 @@ void ServerSession::recvThread()
         {
             if (Socket::isDisconnectedError(-bytesRcvd))
             {
+                if (failover(keepAlivePeriod, str))
+                {
+                    watchdogPeriod = keepAlivePeriod *
+                                     WATCHDOG_KEEPALIVE_PERIOD_FACTOR;
+                    continue;
+                }
                 setState(STATE_DISCONNECTED);
                 LOGGER_ERROR(sLogger, mLogPrefix << "recvThread: Error "
                              << bytesRcvd << Socket::getErrorStr(-bytesRcvd)
@@ -833,6 +899,7 @@ void ServerSession::recvThread()
                 StatusCodes::setStateDownloading(false);
                 setName();
                 str.clear();
+                monBatchClear();
                 if (!connectToServer())
                     return;
             }
@@ -855,11 +922,13 @@ void ServerSession::recvThread()
             msg = MsgSp::parse(valStr, mMsgKey);
             if (msg == 0)
             {
+                parseErrCount.add();
                 LOGGER_ERROR(sLogger, mLogPrefix
                              << "Message parsing/decryption failed on\n"
                              << Utils::toHexString(valStr));
                 continue;
             }
+            recvCount.add();
             doCallback = true;
             switch (msg->getType())
             {
@@ -1015,7 +1084,15 @@ void ServerSession::recvThread()
                         msg->reset(MsgSp::Type::MON_GRP_ATTACH_DETACH)
                             .addField(MsgSp::Field::ISSI, s)
                             .addField(MsgSp::Field::GRP_LIST, valStr);
+                        break;
                     }
+                    //fallthrough
+                }
+                case MsgSp::Type::GPS_MON_START:
+                case MsgSp::Type::GPS_MON_STOP:
+                {
+                    monBatchResult(msg);
+                    doCallback = (msg != 0);
                     break;
                 }
 
@@ -1041,34 +1118,19 @@ void ServerSession::recvThread()
                         requestStatusData();
                         setBranches();
                         requestSubsData();
-                        mMobIp = msg->getFieldString(MsgSp::Field::VOIP_GW);
-                        //NETWORK_TYPE presence (value irrelevant) indicates
-                        //STM-nwk, and VOIP svr is on STM
-                        if (msg->hasField(MsgSp::Field::NETWORK_TYPE))
-                            mVoipSvrIp = mMobIp;
-                        else
-                            mVoipSvrIp = sServerIps[sServerIdx];
-                        mIpFromServer = msg->getFieldString(MsgSp::Field::DESC);
-                        if (mVoipSession != 0 && mVoipSession->isValid())
+                        if (mFailTime != 0)
                         {
-                            mVoipSession->reregister(mIpFromServer, mVoipSvrIp);
+                            Metrics::histogram("scad_server_failover_us",
+                                               "mode", "reconnect")
+                                .record(Metrics::nowUs() - mFailTime);
+                            mFailTime = 0;
                         }
-                        else if (checkVoipSession() != 0)
+                        if (!loginSetup(*msg, challenge))
                         {
                             //put any value in VOIP_SSRC to indicate failure
                             msg->addField(MsgSp::Field::VOIP_SSRC, "0");
                         }
 #ifndef NO_DB
-                        //connect to database
-                        valStr = msg->getFieldString(MsgSp::Field::DB_ADDRESS);
-                        DbInt::init(sLogger,
-                             msg->getFieldString(MsgSp::Field::DB_USERNAME),
-                             MsgSp::hexUnscramble(
-                                 msg->getFieldString(MsgSp::Field::DB_PASSWORD),
-                                 challenge),
-                             msg->getFieldString(MsgSp::Field::DB_NAME),
-                             msg->getFieldInt(MsgSp::Field::DB_PORT),
-                             (valStr.empty())? sServerIps[sServerIdx]: valStr);
                         //DbInt::init() could take a while if there is
                         //connection problem - user may have logged out by now
                         if (mState == STATE_STOPPED)
@@ -1217,6 +1279,111 @@ void ServerSession::recvThread()
     } //while (mState != STATE_STOPPED)
 }
 
+void ServerSession::standbyEvent(int events)
+{
+    if (mState == STATE_STOPPED)
+        return; //the handle is removed by the destructor
+    if (mState != STATE_LOGIN)
+    {
+        //nothing to stand by for - the current session may be connecting
+        //to the standby server
+        if (mStandbyState != STATE_DISCONNECTED)
+            standbyReset(0);
+        return;
+    }
+    switch (mStandbyState)
+    {
+        case STATE_DISCONNECTED:
+        {
+            //the handle may still be on a socket taken over by failover()
+            SocketLoop::modify(mStandbyHandle, INVALID_SOCKET, 0,
+                               STANDBY_POLL_SECS * 1000);
+            if (time(NULL) >= mStandbyRetryTime)
+                standbyConnect();
+            return;
+        }
+        case STATE_CONNECTING:
+        {
+            standbyConnectFinish(events);
+            return;
+        }
+        case STATE_CONNECTED:
+        {
+            if (time(NULL) - mStandbyRecvTime >= STANDBY_LOGIN_SECS)
+            {
+                LOGGER_ERROR(sLogger, mLogPrefix
+                             << "Standby server login timeout.");
+                standbyReset(STANDBY_RETRY_SECS);
+                return;
+            }
+            break;
+        }
+        default:
+        {
+            if (time(NULL) - mStandbyRecvTime >=
+                mStandbyKeepAlive * WATCHDOG_KEEPALIVE_PERIOD_FACTOR)
+            {
+                LOGGER_ERROR(sLogger, mLogPrefix << "Standby server timeout "
+                             << time(NULL) - mStandbyRecvTime << " seconds.");
+                standbyReset(STANDBY_RETRY_SECS);
+                return;
+            }
+            if (time(NULL) - mStandbySentTime >= mStandbyKeepAlive)
+            {
+                MsgSp m(MsgSp::Type::SYS_KEEPALIVE);
+                standbySend(m);
+            }
+            break;
+        }
+    }
+    if ((events & (SocketLoop::EVENT_READ | SocketLoop::EVENT_ERROR)) == 0)
+        return;
+    int            res;
+    int            len;
+    vector<string> msgs;
+    char           buf[BUFFER_SIZE_BYTES];
+    //the socket is read only under the lock, so that no data is taken from
+    //it once it has been swapped in by failover()
+    PalLock::take(&mStandbyLock);
+    if (mStandbyState == STATE_DISCONNECTED)
+    {
+        PalLock::release(&mStandbyLock);
+        return; //taken over
+    }
+    res = mStandby->recv(buf, sizeof(buf));
+    if (res > 0)
+    {
+        mStandbyRecvTime = time(NULL);
+        len = MsgSp::getMsgLen(mStandbyBuf.append(buf, res));
+        while ((int) mStandbyBuf.size() >= len + MsgSp::LEN_SIZE)
+        {
+            msgs.push_back(mStandbyBuf.substr(MsgSp::LEN_SIZE, len));
+            mStandbyBuf.erase(0, len + MsgSp::LEN_SIZE);
+            len = MsgSp::getMsgLen(mStandbyBuf);
+        }
+    }
+    PalLock::release(&mStandbyLock);
+    if (res <= 0)
+    {
+        LOGGER_ERROR(sLogger, mLogPrefix << "standbyEvent: Error " << res
+                     << Socket::getErrorStr(-res)
+                     << ". Standby server disconnected.");
+        standbyReset(STANDBY_RETRY_SECS);
+        return;
+    }
+    MsgSp *msg;
+    for (const auto &s : msgs)
+    {
+        msg = MsgSp::parse(s, mStandbyKey);
+        if (msg == 0)
+            LOGGER_ERROR(sLogger, mLogPrefix << "Standby message "
+                         "parsing/decryption failed on\n"
+                         << Utils::toHexString(s));
+        else
+            standbyProcess(msg);
+    }
+}
+
 bool ServerSession::init(Logger       *logger,
                          const string &serverIp,
                          int           serverPort,
@@ -1400,7 +1567,11 @@ void ServerSession::destroy()
 ServerSession::ServerSession() :
 mState(STATE_INVALID), mMessageId(MsgSp::Value::MSG_ID_MIN - 1),
 mRecvTime(0), mSentTime(0), mUsername(sUsername), mPassword(sPassword),
-mRecvThread(0), mVoipSession(0), mSocket(0), mCbObj(sCbObj), mCbFn(sCbFn)
+mRecvThread(0), mStandbyState(STATE_INVALID), mStandbyIdx(SERVER_IDX_NONE),
+mStandbyKeepAlive(0), mStandbyRecvTime(0), mStandbySentTime(0),
+mStandbyRetryTime(0), mFailTime(0), mStandbyLogin(0), mStandbyHandle(0),
+mGpsMonAll(false), mVoipSession(0), mSocket(0), mStandby(0), mCbObj(sCbObj),
+mCbFn(sCbFn)
 {
     start();
 }
@@ -1408,6 +1579,9 @@ mRecvThread(0), mVoipSession(0), mSocket(0), mCbObj(sCbObj), mCbFn(sCbFn)
 void ServerSession::start()
 {
     PalLock::init(&mSendMsgLock);
+    PalLock::init(&mMonBatchLock);
+    PalLock::init(&mStandbyLock);
+    PalLock::init(&mMirrorLock);
     assert(sLogger != 0);
     if (mCbObj == 0 || mCbFn == 0)
     {
@@ -1431,6 +1605,19 @@ void ServerSession::start()
     mState = STATE_DISCONNECTED;
     mSocket = new TcpSocket(sServerIps[sServerIdx], sServerPorts[sServerIdx]);
     PalThread::start(&mRecvThread, startRecvThread, this);
+    if (sServerPorts.size() > 1)
+    {
+        mStandbyState = STATE_DISCONNECTED;
+        mStandbyIdx = SERVER_IDX_REDUNDANT;
+        mStandby = new TcpSocket(sServerIps[mStandbyIdx],
+                                 sServerPorts[mStandbyIdx]);
+        mStandbyHandle = SocketLoop::add(INVALID_SOCKET, 0,
+                                         STANDBY_POLL_SECS * 1000,
+                                         onStandbyEvent, this);
+        if (mStandbyHandle == 0)
+            LOGGER_ERROR(sLogger, mLogPrefix
+                         << "Failed to start standby session.");
+    }
 }
 
 int ServerSession::checkVoipSession()
@@ -1545,23 +1732,538 @@ bool ServerSession::connectToServer()
     return true;
 }
 
-void ServerSession::sendMon(int            msgType,
-                            bool           isGroup,
-                            const SsiSetT *ssiSet,
-                            int            ssi)
+bool ServerSession::loginSetup(const MsgSp &msg, const string &challenge)
+{
+    bool ok = true;
+    mMobIp = msg.getFieldString(MsgSp::Field::VOIP_GW);
+    //NETWORK_TYPE presence (value irrelevant) indicates STM-nwk, and VOIP
+    //svr is on STM
+    if (msg.hasField(MsgSp::Field::NETWORK_TYPE))
+        mVoipSvrIp = mMobIp;
+    else
+        mVoipSvrIp = sServerIps[sServerIdx];
+    mIpFromServer = msg.getFieldString(MsgSp::Field::DESC);
+    if (mVoipSession != 0 && mVoipSession->isValid())
+        mVoipSession->reregister(mIpFromServer, mVoipSvrIp);
+    else
+        ok = (checkVoipSession() == 0);
+#ifndef NO_DB
+    //connect to database
+    string dbIp(msg.getFieldString(MsgSp::Field::DB_ADDRESS));
+    DbInt::init(sLogger, msg.getFieldString(MsgSp::Field::DB_USERNAME),
+                MsgSp::hexUnscramble(
+                              msg.getFieldString(MsgSp::Field::DB_PASSWORD),
+                              challenge),
+                msg.getFieldString(MsgSp::Field::DB_NAME),
+                msg.getFieldInt(MsgSp::Field::DB_PORT),
+                (dbIp.empty())? sServerIps[sServerIdx]: dbIp);
+#else
+    (void) challenge;
+#endif
+    return ok;
+}
+
+bool ServerSession::failover(int &keepAlivePeriod, string &buf)
+{
+    long long startTime = Metrics::nowUs();
+    //the send lock ensures that no message is being sent on the failed
+    //socket while it is swapped out
+    PalLock::take(&mSendMsgLock);
+    PalLock::take(&mStandbyLock);
+    if (mStandbyState != STATE_LOGIN || mState != STATE_LOGIN)
+    {
+        PalLock::release(&mStandbyLock);
+        PalLock::release(&mSendMsgLock);
+        if (isLoggedIn())
+        {
+            mFailTime = startTime;
+            //the monitoring is redone after login on reconnection
+            PalLock::take(&mMirrorLock);
+            mMonIssis.clear();
+            mMonGssis.clear();
+            mGpsMonIssis.clear();
+            mGpsMonAll = false;
+            PalLock::release(&mMirrorLock);
+        }
+        return false;
+    }
+    TcpSocket *sock = mSocket;
+    mSocket = mStandby;
+    mStandby = sock;
+    mStandby->close();
+    mMsgKey.swap(mStandbyKey);
+    int idx = sServerIdx;
+    sServerIdx = mStandbyIdx;
+    mStandbyIdx = idx;
+    buf.swap(mStandbyBuf);
+    mStandbyBuf.clear();
+    keepAlivePeriod = mStandbyKeepAlive;
+    mSentTime = mStandbySentTime;
+    mRecvTime = time(NULL);
+    MsgSp *login = mStandbyLogin;
+    mStandbyLogin = 0;
+    string challenge;
+    challenge.swap(mStandbyChallenge);
+    mStandbyState = STATE_DISCONNECTED;
+    mStandbyRetryTime = time(NULL) + STANDBY_RETRY_SECS;
+    PalLock::release(&mStandbyLock);
+    PalLock::release(&mSendMsgLock);
+    //stop watching the socket taken over
+    SocketLoop::modify(mStandbyHandle, INVALID_SOCKET, 0,
+                       STANDBY_POLL_SECS * 1000);
+
+    //setName() resets the message key, which is already set for the session
+    string key(mMsgKey);
+    setName();
+    mMsgKey = key;
+    monBatchClear();
+    long long t = Metrics::nowUs() - startTime;
+    Metrics::histogram("scad_server_failover_us", "mode", "standby").record(t);
+    LOGGER_WARNING(sLogger, mLogPrefix << "Server "
+                   << mStandby->getRemoteAddrStr()
+                   << " failed. Switched over to standby session on "
+                   << mSocket->getRemoteAddrStr() << " in " << t << " us");
+    loginSetup(*login, challenge);
+    delete login;
+    return true;
+}
+
+void ServerSession::standbyConnect()
+{
+    //no lock needed for the socket until logged in - failover() does not
+    //touch it before that
+    mStandbyIdx = (sServerIdx == SERVER_IDX_MAIN)? SERVER_IDX_REDUNDANT:
+                                                   SERVER_IDX_MAIN;
+    mStandby->setRemoteAddr(sServerIps[mStandbyIdx],
+                            sServerPorts[mStandbyIdx]);
+    int res = mStandby->connectStart();
+    if (res == 0 || res == Socket::ERR_IN_PROGRESS)
+    {
+        if (SocketLoop::modify(mStandbyHandle, mStandby->getSock(),
+                               SocketLoop::EVENT_WRITE,
+                               STANDBY_LOGIN_SECS * 1000))
+        {
+            mStandbyState = STATE_CONNECTING;
+            return;
+        }
+        mStandby->close();
+    }
+    LOGGER_DEBUG(sLogger, mLogPrefix << "Standby connection to "
+                 << mStandby->getRemoteAddrStr() << " failed, error "
+                 << -res << Socket::getErrorStr(-res));
+    mStandbyRetryTime = time(NULL) + STANDBY_RETRY_SECS;
+}
+
+void ServerSession::standbyConnectFinish(int events)
+{
+    int res = ((events & SocketLoop::EVENT_TIMEOUT) != 0)?
+              Socket::ERR_TIMEOUT: mStandby->connectFinish();
+    if (res == Socket::ERR_WANT_READ || res == Socket::ERR_WANT_WRITE)
+    {
+        //SSL handshake in progress
+        SocketLoop::modify(mStandbyHandle, mStandby->getSock(),
+                           (res == Socket::ERR_WANT_READ)?
+                               SocketLoop::EVENT_READ: SocketLoop::EVENT_WRITE,
+                           STANDBY_LOGIN_SECS * 1000);
+        return;
+    }
+    //the socket is blocking as the current one once taken over
+    if (res == 0)
+        res = mStandby->setBlocking();
+    if (res == 0 &&
+        !SocketLoop::modify(mStandbyHandle, mStandby->getSock(),
+                            SocketLoop::EVENT_READ, STANDBY_POLL_SECS * 1000))
+        res = Socket::ERR_INVALID_SOCKET;
+    if (res != 0)
+    {
+        LOGGER_DEBUG(sLogger, mLogPrefix << "Standby connection to "
+                     << mStandby->getRemoteAddrStr() << " failed, error "
+                     << -res << Socket::getErrorStr(-res));
+        standbyReset(STANDBY_RETRY_SECS);
+        return;
+    }
+    mStandbyBuf.clear();
+    mStandbyChallenge.clear();
+    mStandbyKeepAlive = 0;
+    mStandbyRecvTime = time(NULL);
+    if (mMsgKey.empty())
+        mStandbyKey.clear();
+    else
+        mStandbyKey = MsgSp::getKey(mStandby->getLocalAddrStr() + mUsername);
+    mStandbyState = STATE_CONNECTED;
+    LOGGER_INFO(sLogger, mLogPrefix << "Standby connected to "
+                << mStandby->getRemoteAddrStr());
+    MsgSp m(MsgSp::Type::LOGIN);
+    m.addField(MsgSp::Field::USERNAME, mUsername);
+    standbySend(m);
+}
+
+void ServerSession::standbyDisconnect()
+{
+    if (mStandbyState == STATE_LOGIN)
+    {
+        MsgSp m(MsgSp::Type::LOGOUT);
+        m.addField(MsgSp::Field::USERNAME, mUsername);
+        standbySend(m);
+    }
+    PalLock::take(&mStandbyLock);
+    mStandbyState = (mState == STATE_STOPPED)? STATE_STOPPED:
+                                               STATE_DISCONNECTED;
+    mStandby->close();
+    mStandbyBuf.clear();
+    delete mStandbyLogin;
+    mStandbyLogin = 0;
+    PalLock::release(&mStandbyLock);
+}
+
+void ServerSession::standbyReset(int retrySecs)
+{
+    //the socket must be unwatched before it is closed
+    SocketLoop::modify(mStandbyHandle, INVALID_SOCKET, 0,
+                       STANDBY_POLL_SECS * 1000);
+    standbyDisconnect();
+    mStandbyRetryTime = time(NULL) + retrySecs;
+}
+
+void ServerSession::standbyProcess(MsgSp *msg)
+{
+    switch (msg->getType())
+    {
+        case MsgSp::Type::LOGIN:
+        {
+            string passwd(mPassword);
+            mStandbyChallenge.assign(
+                                msg->getFieldString(MsgSp::Field::CHALLENGE));
+            md5Digest(passwd, mStandbyChallenge);
+            msg->reset(MsgSp::Type::PASSWORD);
+            msg->addField(MsgSp::Field::USERNAME, mUsername);
+            msg->addField(MsgSp::Field::PASSWORD, passwd);
+            msg->addField(MsgSp::Field::VOIP_GW, sServerIps[mStandbyIdx]);
+            msg->addField(MsgSp::Field::MAC_ADDRESSES, sMacAddresses);
+            msg->addField(MsgSp::Field::VERSION, sVersion);
+            //as in recvThread()
+            if (!mStandbyKey.empty())
+                mStandbyKey = MsgSp::getKey(
+                                     Utils::scramble(mStandby->getLocalPort(),
+                                                     mStandbyChallenge,
+                                                     mStandbyKey));
+            standbySend(*msg);
+            break;
+        }
+
+        case MsgSp::Type::PASSWORD:
+        {
+            if (!msg->isResultSuccessful())
+            {
+#ifdef DEBUG
+                LOGGER_ERROR(sLogger, mLogPrefix << "Standby login failure, "
+                             << msg->getFieldValueString(
+                                                      MsgSp::Field::RESULT));
+#else
+                LOGGER_ERROR(sLogger, mLogPrefix << "Standby login failure.");
+#endif
+                standbyReset(STANDBY_RETRY_LOGIN_SECS);
+                break;
+            }
+            mStandbyKeepAlive = msg->getFieldInt(
+                                                MsgSp::Field::KEEPALIVE_PERIOD);
+            //mirror the current session before allowing failover, with
+            //concurrent monitoring changes held until done
+            PalLock::take(&mMirrorLock);
+            if (!mBranches.empty())
+            {
+                MsgSp m(MsgSp::Type::BRANCH_DATA);
+                if (mBranches[0] != '-')
+                    m.addField(MsgSp::Field::GRP_LIST, mBranches);
+                standbySend(m);
+            }
+            if (!mMonIssis.empty())
+                standbyMon(MsgSp::Type::MON_START, false, mMonIssis);
+            if (!mMonGssis.empty())
+                standbyMon(MsgSp::Type::MON_START, true, mMonGssis);
+            if (mGpsMonAll)
+                standbyMon(MsgSp::Type::GPS_MON_START, false, IdRangeSet());
+            else if (!mGpsMonIssis.empty())
+                standbyMon(MsgSp::Type::GPS_MON_START, false, mGpsMonIssis);
+            PalLock::take(&mStandbyLock);
+            mStandbyLogin = msg;
+            msg = 0;
+            mStandbyState = STATE_LOGIN;
+            PalLock::release(&mStandbyLock);
+            PalLock::release(&mMirrorLock);
+            LOGGER_INFO(sLogger, mLogPrefix << "Standby logged in to "
+                        << mStandby->getRemoteAddrStr());
+            break;
+        }
+
+        default:
+        {
+            break; //discard
+        }
+    }
+    delete msg;
+}
+
+int ServerSession::nextMsgId()
+{
+    PalLock::take(&mSendMsgLock);
+    if (++mMessageId > MsgSp::Value::MSG_ID_MAX)
+        mMessageId = MsgSp::Value::MSG_ID_MIN;
+    int msgId = mMessageId;
+    PalLock::release(&mSendMsgLock);
+    return msgId;
+}
+
+int ServerSession::standbySend(MsgSp &msg)
+{
+    int msgId = nextMsgId();
+    msg.addField(MsgSp::Field::MSG_ID, msgId);
+    int res;
+    PalLock::take(&mStandbyLock);
+    if (msg.getType() == MsgSp::Type::LOGIN && !mStandbyKey.empty())
+    {
+        msg.addField(MsgSp::Field::DESC, mStandby->getLocalAddrStr());
+        res = mStandby->send(msg.serialize(
+                        MsgSp::getKey(MsgSp::getTypeName(MsgSp::Type::LOGIN))));
+    }
+    else
+    {
+        res = mStandby->send(msg.serialize(mStandbyKey));
+    }
+    if (res > 0)
+        mStandbySentTime = time(NULL);
+    PalLock::release(&mStandbyLock);
+    if (res > 0)
+    {
+        LOGGER_DEBUG2(sLogger, mLogPrefix << "Standby Tx " << msg.getName());
+        return msgId;
+    }
+    LOGGER_ERROR(sLogger, mLogPrefix << "Error " << res
+                 << Socket::getErrorStr(-res) << " sending message "
+                 << msg.getName() << " to standby server");
+    return res;
+}
+
+void ServerSession::mirrorMon(int               msgType,
+                              bool              isGroup,
+                              const IdRangeSet &inp)
+{
+    PalLock::take(&mMirrorLock);
+    IdRangeSet &ssis((msgType == MsgSp::Type::GPS_MON_START ||
+                      msgType == MsgSp::Type::GPS_MON_STOP)? mGpsMonIssis:
+                     (isGroup)? mMonGssis: mMonIssis);
+    switch (msgType)
+    {
+        case MsgSp::Type::GPS_MON_START:
+            if (inp.empty())
+                mGpsMonAll = true;
+            //fallthrough
+        case MsgSp::Type::MON_START:
+            ssis.unite(inp);
+            break;
+        case MsgSp::Type::GPS_MON_STOP:
+            if (inp.empty())
+                mGpsMonAll = false;
+            //fallthrough
+        default:
+            if (inp.empty())
+            {
+                ssis.clear();
+                if (msgType == MsgSp::Type::MON_STOP)
+                    mMonGssis.clear(); //mMonIssis cleared above
+            }
+            else
+            {
+                ssis.subtract(inp);
+            }
+            break;
+    }
+    if (mStandbyState == STATE_LOGIN)
+        standbyMon(msgType, isGroup, inp);
+    PalLock::release(&mMirrorLock);
+}
+
+void ServerSession::standbyMon(int               msgType,
+                               bool              isGroup,
+                               const IdRangeSet &ssis)
+{
+    MsgSp m(msgType);
+    int field = MsgSp::Field::ISSI_LIST;
+    if (msgType == MsgSp::Type::MON_START || msgType == MsgSp::Type::MON_STOP)
+    {
+        field = MsgSp::Field::SSI_LIST;
+        if (!ssis.empty())
+            m.addField(MsgSp::Field::AFFECTED_USER_TYPE,
+                       (isGroup)? MsgSp::Value::IDENTITY_TYPE_GSSI :
+                                  MsgSp::Value::IDENTITY_TYPE_ISSI);
+    }
+    if (ssis.empty())
+    {
+        standbySend(m);
+        return;
+    }
+    vector<string> lists;
+    ssis.toStrings(MON_LIST_MAX_LEN, lists);
+    for (const auto &l : lists)
+    {
+        m.addField(field, l);
+        if (standbySend(m) <= 0)
+            break;
+    }
+}
+
+bool ServerSession::sendMon(int               msgType,
+                            bool              isGroup,
+                            const IdRangeSet *ssis,
+                            int               ssi)
 {
     assert((msgType == MsgSp::Type::MON_START ||
             msgType == MsgSp::Type::MON_STOP) &&
-           (ssiSet != 0 || ssi != 0));
+           (ssis != 0 || ssi != 0));
     MsgSp m(msgType);
     m.addField(MsgSp::Field::AFFECTED_USER_TYPE,
                (isGroup)? MsgSp::Value::IDENTITY_TYPE_GSSI :
                           MsgSp::Value::IDENTITY_TYPE_ISSI);
-    if (ssiSet != 0)
-        m.addField(MsgSp::Field::SSI_LIST, Utils::toStringWithRange(*ssiSet));
-    else if (ssi > 0)
-        m.addField(MsgSp::Field::SSI_LIST, ssi);
+    if (ssis != 0)
+    {
+        if (!sendMonBulk(m, MsgSp::Field::SSI_LIST, *ssis))
+            return false;
+        mirrorMon(msgType, isGroup, *ssis);
+        return true;
+    }
+    if (ssi <= 0)
+        return false;
+    m.addField(MsgSp::Field::SSI_LIST, ssi);
+    if (sendMsg(&m, false) <= 0)
+        return false;
+    IdRangeSet single;
+    single.add(ssi);
+    mirrorMon(msgType, isGroup, single);
+    return true;
+}
+
+bool ServerSession::sendMonBulk(MsgSp &msg, int field, const IdRangeSet &ssis)
+{
+    vector<string> lists;
+    ssis.toStrings(MON_LIST_MAX_LEN, lists);
+    if (lists.size() == 1)
+    {
+        msg.addField(field, lists.front());
+        return (sendMsg(&msg, false) > 0);
+    }
+    LOGGER_DEBUG(sLogger, mLogPrefix << "sendMonBulk: " << msg.getName()
+                 << ' ' << ssis.size() << " SSIs in " << lists.size()
+                 << " chunks");
+    //register all chunks before sending, so that early responses find
+    //their batch
+    vector<int> msgIds;
+    for (size_t i=0; i<lists.size(); ++i)
+    {
+        msgIds.push_back(nextMsgId());
+    }
+    int batchId = msgIds.front();
+    PalLock::take(&mMonBatchLock);
+    for (auto id : msgIds)
+    {
+        mMonChunks[id] = batchId;
+    }
+    mMonBatches[batchId].pending = lists.size();
+    PalLock::release(&mMonBatchLock);
+    int msgId = 0;
+    size_t i = 0;
+    for (; i<lists.size(); ++i)
+    {
+        msg.addField(field, lists[i]);
+        msgId = sendMsg(&msg, false, msgIds[i]);
+        if (msgId <= 0)
+            break;
+    }
+    if (msgId <= 0)
+    {
+        //the server has only part of the set - abort the batch so that the
+        //caller can retry the whole set, and discard the responses to the
+        //chunks already sent
+        PalLock::take(&mMonBatchLock);
+        auto it = mMonBatches.find(batchId);
+        if (it != mMonBatches.end())
+        {
+            delete it->second.okMsg;
+            delete it->second.failMsg;
+            mMonBatches.erase(it);
+        }
+        for (; i<msgIds.size(); ++i)
+        {
+            mMonChunks.erase(msgIds[i]);
+        }
+        PalLock::release(&mMonBatchLock);
+        LOGGER_ERROR(sLogger, mLogPrefix << "sendMonBulk: " << msg.getName()
+                     << " batch " << batchId << " aborted on chunk failure");
+    }
+    return (msgId > 0);
+}
+
+void ServerSession::monBatchResult(MsgSp *&msg)
+{
+    PalLock::take(&mMonBatchLock);
+    auto chunkIt = mMonChunks.find(msg->getFieldInt(MsgSp::Field::MSG_ACK));
+    if (chunkIt == mMonChunks.end())
+    {
+        PalLock::release(&mMonBatchLock);
+        return; //not a chunk
+    }
+    auto it = mMonBatches.find(chunkIt->second);
+    mMonChunks.erase(chunkIt);
+    if (it == mMonBatches.end())
+    {
+        //aborted batch
+        PalLock::release(&mMonBatchLock);
+        delete msg;
+        msg = 0;
+        return;
+    }
+    int field = (msg->getType() == MsgSp::Type::GPS_MON_START ||
+                 msg->getType() == MsgSp::Type::GPS_MON_STOP)?
+                MsgSp::Field::ISSI_LIST: MsgSp::Field::SSI_LIST;
+    MonBatchT &b(it->second);
+    bool ok = msg->isResultSuccessful();
+    ((ok)? b.okSsis: b.failSsis).parse(msg->getFieldString(field));
+    MsgSp *&m((ok)? b.okMsg: b.failMsg);
+    if (m == 0)
+        m = msg;
     else
+        delete msg;
+    msg = 0;
+    if (--b.pending > 0)
+    {
+        PalLock::release(&mMonBatchLock);
         return;
-    sendMsg(&m, false);
+    }
+    MsgSp *okMsg = b.okMsg;
+    msg = b.failMsg;
+    if (okMsg != 0)
+        okMsg->addField(field, b.okSsis.toString());
+    if (msg != 0)
+        msg->addField(field, b.failSsis.toString());
+    LOGGER_DEBUG(sLogger, mLogPrefix << "monBatchResult: Batch "
+                 << it->first << " done, " << b.okSsis.size() << " OK, "
+                 << b.failSsis.size() << " failed");
+    mMonBatches.erase(it);
+    PalLock::release(&mMonBatchLock);
+    if (msg == 0)
+        msg = okMsg;
+    else if (okMsg != 0)
+        mCbFn(mCbObj, okMsg); //msg ownership transferred
+}
+
+void ServerSession::monBatchClear()
+{
+    PalLock::take(&mMonBatchLock);
+    for (auto &it : mMonBatches)
+    {
+        delete it.second.okMsg;
+        delete it.second.failMsg;
+    }
+    mMonBatches.clear();
+    mMonChunks.clear();
+    PalLock::release(&mMonBatchLock);
 }
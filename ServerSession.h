@@ -2,6 +2,10 @@
  * A class that provides communication session with the server.
  * Can be used as either singleton (mainly for test client) or normal instance.
  * Either usage must start with init().
+ * With a redundant server, a standby session is kept logged in to the
+ * server other than the current one, with the same monitoring, so that on
+ * failure of the current server the standby connection takes over at once,
+ * without login or subscriber/status data download.
  * For singleton:
  *   - must continue with setParams(),
  *   - get the object with instance(),
@@ -17,11 +21,13 @@
 #ifndef SERVERSESSION_H
 #define SERVERSESSION_H
 
+#include <map>
 #include <set>
 #include <string>
 #include <vector>
 #include <time.h>   //time_t, time()
 
+#include "IdRangeSet.h"
 #include "Logger.h"
 #include "MsgSp.h"
 #include "PalLock.h"
@@ -47,6 +53,7 @@ public:
     {
         STATE_INVALID,
         STATE_DISCONNECTED,
+        STATE_CONNECTING,   //standby session only
         STATE_CONNECTED,
         STATE_LOGIN,
         STATE_STOPPED
@@ -110,12 +117,16 @@ public:
 
     /**
      * Starts monitoring some SSIs.
+     * A large set is sent in chunks without waiting for each response, and
+     * the chunk responses are aggregated into one result message for the
+     * callback. See sendMonBulk().
      *
-     * @param[in] ssiSet  The SSIs (ISSIs or GSSIs) to monitor.
+     * @param[in] ssis    The SSIs (ISSIs or GSSIs) to monitor.
      * @param[in] isGroup true for GSSI.
-     * @return true if successful.
+     * @return true if successful. false if any chunk failed to be sent, in
+     *         which case the whole set should be retried.
      */
-    bool monitorStart(const SsiSetT &ssiSet, bool isGroup);
+    bool monitorStart(const IdRangeSet &ssis, bool isGroup);
 
     /**
      * Stops monitoring an SSI.
@@ -128,12 +139,13 @@ public:
 
     /**
      * Stops monitoring some SSIs.
+     * A large set is sent in chunks as in monitorStart().
      *
-     * @param[in] ssiSet  The SSIs to stop monitoring.
+     * @param[in] ssis    The SSIs to stop monitoring.
      * @param[in] isGroup true for GSSI.
      * @return true if successful.
      */
-    bool monitorStop(const SsiSetT &ssiSet, bool isGroup);
+    bool monitorStop(const IdRangeSet &ssis, bool isGroup);
 
     /**
      * Stops monitoring all SSIs.
@@ -144,19 +156,21 @@ public:
 
     /**
      * Starts GPS monitoring of some or all ISSIs.
+     * A large set is sent in chunks as in monitorStart().
      *
-     * @param[in] ssiSet The ISSIs, or empty set to monitor all.
+     * @param[in] ssis The ISSIs, or empty set to monitor all.
      * @return true if successful.
      */
-    bool gpsMonitorStart(const SsiSetT &ssiSet);
+    bool gpsMonitorStart(const IdRangeSet &ssis);
 
     /**
      * Stops GPS monitoring of some or all ISSIs.
+     * A large set is sent in chunks as in monitorStart().
      *
-     * @param[in] ssiSet The ISSIs, or empty set to stop all.
+     * @param[in] ssis The ISSIs, or empty set to stop all.
      * @return true if successful.
      */
-    bool gpsMonitorStop(const SsiSetT &ssiSet);
+    bool gpsMonitorStop(const IdRangeSet &ssis);
 
     /**
      * Requests Status data from Server.
@@ -537,6 +551,15 @@ public:
      */
     void recvThread();
 
+    /**
+     * Handles an event loop callback for the standby session. Keeps the
+     * session connected and logged in while the current session is logged
+     * in, and discards its messages other than those for login.
+     *
+     * @param[in] events SocketLoop::eEvent flags.
+     */
+    void standbyEvent(int events);
+
     /**
      * Sets the logger and server parameters. Must be done before
      * instantiating a class object.
@@ -611,6 +634,21 @@ public:
     static void destroy();
 
 private:
+    //bulk monitoring batch, sent as chunks with one message each
+    struct MonBatchT
+    {
+        MonBatchT() : pending(0), okMsg(0), failMsg(0) {}
+
+        int        pending;  //chunks without response
+        IdRangeSet okSsis;   //accumulated from successful chunks
+        IdRangeSet failSsis; //accumulated from failed chunks
+        MsgSp     *okMsg;    //first successful chunk response
+        MsgSp     *failMsg;  //first failed chunk response
+    };
+    typedef std::map<int, MonBatchT> MonBatchMapT; //key is batch ID
+    //chunk msg ID (MSG_ACK in response) to batch ID
+    typedef std::map<int, int>       MonChunkMapT;
+
     int                mState;
     int                mMessageId;    //incremented in every sent message
 #ifdef TESTCLIENT
@@ -641,9 +679,36 @@ private:
     std::string        mBranches;
     PalThread::ThreadT mRecvThread;       //receive thread ID
     PalLock::LockT     mSendMsgLock;      //guards sendMsg() call
+    PalLock::LockT     mMonBatchLock;     //guards mMonBatches and mMonChunks
+    MonBatchMapT       mMonBatches;
+    MonChunkMapT       mMonChunks;
+
+    //standby session - the socket and these are swapped in on failover
+    int                mStandbyState;
+    int                mStandbyIdx;       //standby server
+    int                mStandbyKeepAlive; //KeepAlive period from login
+    time_t             mStandbyRecvTime;
+    time_t             mStandbySentTime;
+    time_t             mStandbyRetryTime; //earliest next connection attempt
+    //start of current session failure in microseconds, for failover metric
+    long long          mFailTime;
+    std::string        mStandbyKey;       //for encryption
+    std::string        mStandbyBuf;       //received partial message
+    std::string        mStandbyChallenge; //login challenge
+    MsgSp             *mStandbyLogin;     //successful login response
+    int                mStandbyHandle;    //SocketLoop handle
+    //guards standby socket swap, state, buffer and login response
+    PalLock::LockT     mStandbyLock;
+    //guards monitored SSIs below and their sending to standby session
+    PalLock::LockT     mMirrorLock;
+    IdRangeSet         mMonIssis;         //monitored ISSIs
+    IdRangeSet         mMonGssis;         //monitored GSSIs
+    IdRangeSet         mGpsMonIssis;      //GPS monitored ISSIs
+    bool               mGpsMonAll;        //GPS monitoring all ISSIs
 
     VoipSessionClient *mVoipSession;
     TcpSocket         *mSocket;
+    TcpSocket         *mStandby;
     void              *mCbObj;        //callback function owner object
     RecvCallbackFn     mCbFn;         //callback function for received messages
 
@@ -703,19 +768,158 @@ private:
      */
     bool connectToServer();
 
+    /**
+     * Sets up VOIP and database connections after login.
+     *
+     * @param[in] msg       The successful login response.
+     * @param[in] challenge The login challenge.
+     * @return false if the VOIP session could not be created.
+     */
+    bool loginSetup(const MsgSp &msg, const std::string &challenge);
+
+    /**
+     * Switches over to the standby session if it is logged in, after failure
+     * of the current session. The standby socket and session data replace
+     * the current ones, and the failed server becomes the standby target.
+     *
+     * @param[out] keepAlivePeriod The KeepAlive period of the new session.
+     * @param[out] buf             Any partial message received on the new
+     *                             session.
+     * @return true if switched.
+     */
+    bool failover(int &keepAlivePeriod, std::string &buf);
+
+    /**
+     * Starts a non-blocking connection of the standby session to the server
+     * other than the current one.
+     */
+    void standbyConnect();
+
+    /**
+     * Completes the standby session connection, and sends a login message
+     * if successful.
+     *
+     * @param[in] events SocketLoop::eEvent flags.
+     */
+    void standbyConnectFinish(int events);
+
+    /**
+     * Closes the standby session connection, with logout if logged in.
+     */
+    void standbyDisconnect();
+
+    /**
+     * Closes the standby session connection and schedules the next
+     * connection attempt.
+     *
+     * @param[in] retrySecs The delay in seconds before the next attempt.
+     */
+    void standbyReset(int retrySecs);
+
+    /**
+     * Processes a message received on the standby session.
+     *
+     * @param[in] msg The message. Ownership is taken.
+     */
+    void standbyProcess(MsgSp *msg);
+
+    /**
+     * Adds a unique message ID to a message and sends it to the standby
+     * server.
+     *
+     * @param[in] msg The message object.
+     * @return The positive message ID if successful.
+     */
+    int standbySend(MsgSp &msg);
+
+    /**
+     * Allocates the next unique message ID.
+     *
+     * @return The message ID.
+     */
+    int nextMsgId();
+
+    /**
+     * Adds a message ID to a message and sends it to the server.
+     *
+     * @param[in] msg       The message object.
+     * @param[in] deleteMsg true to delete the message after sending it.
+     * @param[in] msgId     The message ID from nextMsgId(), or 0 to allocate
+     *                      one.
+     * @return The positive message ID if successful.
+     */
+    int sendMsg(MsgSp *msg, bool deleteMsg, int msgId);
+
+    /**
+     * Records a monitoring change for the standby session, and sends it
+     * there if logged in.
+     *
+     * @param[in] msgType MsgSp::Type::MON_START, MON_STOP, GPS_MON_START or
+     *                    GPS_MON_STOP.
+     * @param[in] isGroup true for GSSIs. Only for MON_START and MON_STOP.
+     * @param[in] ssis    The SSIs, or empty set for all, except for
+     *                    MON_START.
+     */
+    void mirrorMon(int msgType, bool isGroup, const IdRangeSet &ssis);
+
+    /**
+     * Sends a monitoring message to the standby session, split into chunks
+     * as in sendMonBulk(), without tracking the responses.
+     * Parameters are as in mirrorMon().
+     */
+    void standbyMon(int msgType, bool isGroup, const IdRangeSet &ssis);
+
     /**
      * Sends a monitoring start/stop message to the server, for either
      * multiple SSIs or a single SSI.
      *
      * @param[in] msgType MsgSp::Type::MON_START or MON_STOP.
      * @param[in] isGroup true for group targets.
-     * @param[in] ssiSet  The target SSIs if for multiple.
-     * @param[in] ssi     The target SSI if for single. Used only if ssiSet
-     *                    is 0.
-     */
-    void sendMon(int            msgType,
-                 bool           isGroup,
-                 const SsiSetT *ssiSet,
-                 int            ssi = 0);
+     * @param[in] ssis    The target SSIs if for multiple.
+     * @param[in] ssi     The target SSI if for single. Used only if ssis is
+     *                    0.
+     * @return true if successful. The monitoring is mirrored to the standby
+     *         session only then.
+     */
+    bool sendMon(int               msgType,
+                 bool              isGroup,
+                 const IdRangeSet *ssis,
+                 int               ssi = 0);
+
+    /**
+     * Sends a monitoring start/stop message for multiple SSIs, split into
+     * chunks of at most MON_LIST_MAX_LEN list characters if necessary.
+     * All chunks are sent back-to-back. If there is more than one, they are
+     * tracked as a batch until all responses are received. The batch is
+     * registered with preallocated message IDs before sending, so that the
+     * batch lock is not held while sending.
+     * If a chunk fails to be sent, the batch is aborted and the responses to
+     * the chunks already sent are discarded, so that the caller can retry
+     * the whole set.
+     *
+     * @param[in] msg    The message with all fields except the SSI list.
+     * @param[in] field  The SSI list field - MsgSp::Field::SSI_LIST or
+     *                   ISSI_LIST.
+     * @param[in] ssis   The SSIs.
+     * @return true if all chunks were sent.
+     */
+    bool sendMonBulk(MsgSp &msg, int field, const IdRangeSet &ssis);
+
+    /**
+     * Processes a monitoring response that may belong to a batch.
+     * A chunk response is absorbed into its batch. When the last chunk
+     * response arrives, the batch result is given in one message for the
+     * successful SSIs and one for the failed SSIs, if any. If there are both,
+     * the successful one is passed directly to the callback.
+     *
+     * @param[in,out] msg The response. Set to the aggregated result message,
+     *                    or 0 if absorbed. Ownership is taken if changed.
+     */
+    void monBatchResult(MsgSp *&msg);
+
+    /**
+     * Discards all pending batches, e.g. on disconnection.
+     */
+    void monBatchClear();
 };
 #endif //SERVERSESSION_H
@@ -64,6 +64,12 @@ Settings &Settings::set(int key, const string &value)
     return *this;
 }
 
+long long Settings::getList(int key, IdRangeSet &s, char delim) const
+{
+    s.parse(Props::get(mProperties, key), delim);
+    return s.size();
+}
+
 void Settings::remove(int key)
 {
     mProperties.erase(key);
@@ -89,6 +95,9 @@ bool Settings::validate(int key, const string &value, bool doSet)
         case Props::FLD_CFG_INCFILTER_PRIORITY:
         case Props::FLD_CFG_INCFILTER_STATE:
         case Props::FLD_CFG_LOGFILE:
+        case Props::FLD_CFG_MAP_ROADNET:
+        case Props::FLD_CFG_MAP_SEA_SVR:
+        case Props::FLD_CFG_METRICS_FILE:
         case Props::FLD_CFG_MMS_DOWNLOADDIR:
         case Props::FLD_CFG_PTT_CHAR:
         case Props::FLD_CFG_SDSTEMPLATE:
@@ -16,6 +16,7 @@
 #include <string>
 #include <vector>
 
+#include "IdRangeSet.h"
 #include "PalLock.h"
 #include "Props.h"
 #include "Utils.h"
@@ -115,11 +116,16 @@ public:
     size_t getList(int key, std::set<T> &s, char delim = ' ') const;
 
     /**
-     * Template specialization for a list of integers that may be stored as
-     * ranges.
+     * Gets a list of integers that may be stored as ranges, without
+     * expanding the ranges.
+     *
+     * @param[in]  key   The key.
+     * @param[out] s     The set to be populated. The caller is responsible
+     *                   for clearing it first if required.
+     * @param[in]  delim The value delimiter.
+     * @return The number of values in the set.
      */
-    template<>
-    size_t getList(int key, std::set<int> &s, char delim) const;
+    long long getList(int key, IdRangeSet &s, char delim = ' ') const;
 
     /**
      * Removes a configuration entry (but not from the permanent storage).
@@ -210,11 +216,4 @@ size_t Settings::getList(int key, std::set<T> &s, char delim) const
     Utils::fromString<T>(Props::get(mProperties, key), s, delim);
     return s.size();
 }
-
-template<>
-size_t Settings::getList(int key, std::set<int> &s, char delim) const
-{
-    Utils::fromStringWithRange(Props::get(mProperties, key), s, delim);
-    return s.size();
-}
 #endif //SETTINGS_H
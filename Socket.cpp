@@ -36,6 +36,13 @@ int Socket::setNonblocking()
     return 0;
 }
 
+int Socket::setBlocking()
+{
+    if (PalSocket::setBlocking(mSock) != 0)
+        return -PalSocket::getError();
+    return 0;
+}
+
 int Socket::connect()
 {
     if (!mHasRemoteAddress)
@@ -50,19 +57,13 @@ int Socket::connect()
     mIsConnected = true;
     if (mUseSsl)
     {
-        SSL_CTX *ctx = SSL_CTX_new(TLS_client_method());
-        if (ctx != 0)
-            mSsl = SSL_new(ctx);
         int ret;
-        if (mSsl == 0)
+        if (!createSsl())
         {
-            if (ctx != 0)
-                SSL_CTX_free(ctx);
             ret = ERR_INIT_SSL;
         }
         else
         {
-            SSL_set_fd(mSsl, mSock);
             ret = SSL_connect(mSsl);
             if (ret <= 0)
                 ret = -PalSocket::getError(mSsl, ret);
@@ -74,13 +75,7 @@ int Socket::connect()
         }
         sValidSsls.insert(mSsl);
     }
-    //get the local IP address and port
-    socklen_t len = sizeof(mLocalAddr);
-    if (getsockname(mSock, (sockaddr *)&mLocalAddr, &len) == 0)
-    {
-        mLocalPort = getPort(mLocalAddr);
-        mLocalIp = getIp(mLocalAddr);
-    }
+    getLocalAddr();
     return 0;
 }
 
@@ -91,6 +86,64 @@ int Socket::connect(const string &remoteIp, int remotePort)
     return connect();
 }
 
+int Socket::connectStart()
+{
+    if (!mHasRemoteAddress)
+        return ERR_MISSING_REMOTE_ADDR;
+    //a socket from a failed connection cannot be reused
+    close();
+    int ret = createSocket((mType == TYPE_UDP));
+    if (ret == 0)
+        ret = setNonblocking();
+    if (ret != 0)
+    {
+        close();
+        return ret;
+    }
+    if (::connect(mSock, (sockaddr *)&mRemoteAddr, sizeof(mRemoteAddr)) == 0)
+        return 0;
+    ret = PalSocket::getError();
+    if (PalSocket::isInProgressError(ret))
+        return ERR_IN_PROGRESS;
+    close();
+    return -ret;
+}
+
+int Socket::connectFinish()
+{
+    if (mSock == INVALID_SOCKET)
+        return ERR_INVALID_SOCKET;
+    int ret;
+    if (!mIsConnected)
+    {
+        ret = PalSocket::getSockError(mSock);
+        if (ret != 0)
+            return -ret;
+        mIsConnected = true;
+        if (mUseSsl && !createSsl())
+            return ERR_INIT_SSL;
+    }
+    if (mSsl != 0 && !SSL_is_init_finished(mSsl))
+    {
+        ret = SSL_connect(mSsl);
+        if (ret <= 0)
+        {
+            switch (SSL_get_error(mSsl, ret))
+            {
+                case SSL_ERROR_WANT_READ:
+                    return ERR_WANT_READ;
+                case SSL_ERROR_WANT_WRITE:
+                    return ERR_WANT_WRITE;
+                default:
+                    return -PalSocket::getError(mSsl, ret);
+            }
+        }
+        sValidSsls.insert(mSsl);
+    }
+    getLocalAddr();
+    return 0;
+}
+
 int Socket::send(const char *data, int len, const string *ip, int port)
 {
     if (mSock == INVALID_SOCKET)
@@ -363,3 +416,28 @@ inline int Socket::getPort(const SockAddrT &addr) const
 #endif
     return 0;
 }
+
+bool Socket::createSsl()
+{
+    SSL_CTX *ctx = SSL_CTX_new(TLS_client_method());
+    if (ctx != 0)
+        mSsl = SSL_new(ctx);
+    if (mSsl == 0)
+    {
+        if (ctx != 0)
+            SSL_CTX_free(ctx);
+        return false;
+    }
+    SSL_set_fd(mSsl, mSock);
+    return true;
+}
+
+void Socket::getLocalAddr()
+{
+    socklen_t len = sizeof(mLocalAddr);
+    if (getsockname(mSock, (sockaddr *)&mLocalAddr, &len) == 0)
+    {
+        mLocalPort = getPort(mLocalAddr);
+        mLocalIp = getIp(mLocalAddr);
+    }
+}
@@ -27,7 +27,10 @@ public:
         ERR_MISSING_REMOTE_ADDR     = -90002,
         ERR_INVALID_REMOTE_ADDR     = -90003,
         ERR_INVALID_REMOTE_IP       = -90004,
-        ERR_INIT_SSL                = -90005
+        ERR_INIT_SSL                = -90005,
+        ERR_IN_PROGRESS             = -90006,
+        ERR_WANT_READ               = -90007,
+        ERR_WANT_WRITE              = -90008
     };
 
     static const std::string LOCALHOST;
@@ -41,6 +44,13 @@ public:
      */
     int setNonblocking();
 
+    /**
+     * Sets this socket to be blocking, e.g. after connectFinish().
+     *
+     * @return 0 if successful, or a negative errno.
+     */
+    int setBlocking();
+
     /**
      * Connects to a host with the currently configured IP and port.
      * Closes any existing connection first.
@@ -62,6 +72,29 @@ public:
      */
     int connect(const std::string &remoteIp, int remotePort = 0);
 
+    /**
+     * Starts a non-blocking connection to a host with the currently
+     * configured IP and port, for use with an event loop. Closes any
+     * existing socket first, and leaves the new socket non-blocking.
+     * Must be followed by connectFinish() when the socket is writable.
+     *
+     * @return 0 if connected at once, ERR_IN_PROGRESS, or
+     *         ERR_MISSING_REMOTE_ADDR or a negative errno on failure.
+     */
+    int connectStart();
+
+    /**
+     * Completes a connection started by connectStart(), including the
+     * SSL/TLS handshake if enabled. On failure, the socket is left open, so
+     * that the caller may unregister it from the event loop before closing.
+     *
+     * @return 0 if connected, ERR_WANT_READ or ERR_WANT_WRITE to be called
+     *         again when the socket is readable or writable respectively,
+     *         or ERR_INVALID_SOCKET, ERR_INIT_SSL or a negative errno on
+     *         failure.
+     */
+    int connectFinish();
+
     /**
      * Sends data through the socket.
      *
@@ -279,5 +312,17 @@ protected:
      *         AF_INET/AF_INET6 family.
      */
     int getPort(const SockAddrT &addr) const;
+
+    /**
+     * Creates the SSL context on the connected socket.
+     *
+     * @return true if successful.
+     */
+    bool createSsl();
+
+    /**
+     * Gets the local IP address and port of the connected socket.
+     */
+    void getLocalAddr();
 };
 #endif //SOCKET_H
@@ -0,0 +1,537 @@
+/**
+ * Socket event loop implementation.
+ *
+ * Copyright (C) Sapura Secured Technologies, 2026. All Rights Reserved.
+ *
+ * @file
+ * @version $Id$
+ * @author agent <agent@local>
+ */
+#include <algorithm>    //std::find_if
+#include <chrono>
+#include <cstring>      //memset
+#include <assert.h>
+#if defined(_WIN32) || defined(WIN32)
+enum
+{
+    EPOLL_CTL_ADD = 1,
+    EPOLL_CTL_DEL,
+    EPOLL_CTL_MOD
+};
+#else
+#include <stdint.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#endif
+
+#include "PalSem.h"
+#include "PalThread.h"
+#include "Socket.h"
+#include "SocketLoop.h"
+
+using namespace std;
+
+typedef chrono::steady_clock ClockT;
+
+struct HandlerT
+{
+    SocketT                sock;
+    int                    events;
+    int                    timeoutMs;
+    ClockT::time_point     deadline;
+    SocketLoop::CallbackFn fn;
+    void                  *obj;
+};
+
+struct SocketLoop::LoopT
+{
+    PalLock::LockT          lock;     //guards handlers, current, waiters
+    std::map<int, HandlerT> handlers; //key is handle
+    int                     current;  //handle in callback, or 0
+    int                     waiters;  //remove() calls waiting on current
+    PalSem::SemT            doneSem;  //posted per waiter when current ends
+    PalThread::ThreadT      thread;
+    std::atomic<bool>       done;     //thread has exited
+#if defined(_WIN32) || defined(WIN32)
+    SocketT                 wakeSock; //loopback UDP socket connected to self
+#else
+    int                     pollFd;   //epoll instance
+    int                     wakeFd;   //eventfd
+#endif
+};
+
+static const string LOGPREFIX("SocketLoop:: ");
+
+Logger                        *SocketLoop::sLogger(0);
+vector<SocketLoop::LoopT *>    SocketLoop::sLoops;
+map<int, SocketLoop::LoopT *>  SocketLoop::sHandles;
+int                            SocketLoop::sLastHandle(0);
+unsigned int                   SocketLoop::sNextLoop(0);
+atomic<bool>                   SocketLoop::sRunning(false);
+thread_local SocketLoop::LoopT *SocketLoop::tLoop(0);
+
+#ifdef QT_CORE_LIB
+PalLock::LockT SocketLoop::sLock;
+#else
+PalLock::LockT SocketLoop::sLock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+int SocketLoop::add(SocketT    sock,
+                    int        events,
+                    int        timeoutMs,
+                    CallbackFn fn,
+                    void      *obj)
+{
+    if (fn == 0)
+    {
+        assert("Bad param in SocketLoop::add" == 0);
+        return 0;
+    }
+    PalLock::take(&sLock);
+    if (sLoops.empty() && !start())
+    {
+        PalLock::release(&sLock);
+        return 0;
+    }
+    LoopT *lp = sLoops[sNextLoop++ % sLoops.size()];
+    if (++sLastHandle <= 0)
+        sLastHandle = 1;
+    int handle = sLastHandle;
+    HandlerT h;
+    h.sock = sock;
+    h.events = events;
+    h.timeoutMs = timeoutMs;
+    h.deadline = ClockT::now() + chrono::milliseconds(timeoutMs);
+    h.fn = fn;
+    h.obj = obj;
+    PalLock::take(&lp->lock);
+    bool ok = (sock == INVALID_SOCKET ||
+               control(lp, EPOLL_CTL_ADD, handle, sock, events));
+    if (ok)
+    {
+        lp->handlers[handle] = h;
+        sHandles[handle] = lp;
+    }
+    PalLock::release(&lp->lock);
+    PalLock::release(&sLock);
+    if (!ok)
+        return 0;
+    wake(lp);
+    return handle;
+}
+
+bool SocketLoop::modify(int handle, int events, int timeoutMs)
+{
+    LoopT *lp = getLoop(handle);
+    if (lp == 0)
+        return false;
+    PalLock::take(&lp->lock);
+    auto hIt = lp->handlers.find(handle);
+    bool ok = (hIt != lp->handlers.end());
+    if (ok)
+    {
+        HandlerT &h(hIt->second);
+        if (h.sock != INVALID_SOCKET && events != h.events)
+            ok = control(lp, EPOLL_CTL_MOD, handle, h.sock, events);
+        if (ok)
+        {
+            h.events = events;
+            h.timeoutMs = timeoutMs;
+            h.deadline = ClockT::now() + chrono::milliseconds(timeoutMs);
+        }
+    }
+    PalLock::release(&lp->lock);
+    if (ok)
+        wake(lp);
+    return ok;
+}
+
+bool SocketLoop::modify(int handle, SocketT sock, int events, int timeoutMs)
+{
+    LoopT *lp = getLoop(handle);
+    if (lp == 0)
+        return false;
+    PalLock::take(&lp->lock);
+    auto hIt = lp->handlers.find(handle);
+    bool ok = (hIt != lp->handlers.end());
+    if (ok)
+    {
+        HandlerT &h(hIt->second);
+        if (sock == h.sock)
+        {
+            if (sock != INVALID_SOCKET && events != h.events)
+                ok = control(lp, EPOLL_CTL_MOD, handle, sock, events);
+        }
+        else
+        {
+            if (h.sock != INVALID_SOCKET)
+                control(lp, EPOLL_CTL_DEL, handle, h.sock, 0);
+            h.sock = INVALID_SOCKET;
+            h.events = 0;
+            if (sock != INVALID_SOCKET)
+                ok = control(lp, EPOLL_CTL_ADD, handle, sock, events);
+            if (ok)
+                h.sock = sock;
+        }
+        if (ok)
+        {
+            h.events = events;
+            h.timeoutMs = timeoutMs;
+            h.deadline = ClockT::now() + chrono::milliseconds(timeoutMs);
+        }
+    }
+    PalLock::release(&lp->lock);
+    if (ok)
+        wake(lp);
+    return ok;
+}
+
+void SocketLoop::remove(int handle)
+{
+    PalLock::take(&sLock);
+    auto it = sHandles.find(handle);
+    if (it == sHandles.end())
+    {
+        PalLock::release(&sLock);
+        return;
+    }
+    LoopT *lp = it->second;
+    sHandles.erase(it);
+    PalLock::release(&sLock);
+    PalLock::take(&lp->lock);
+    auto hIt = lp->handlers.find(handle);
+    if (hIt != lp->handlers.end())
+    {
+        if (hIt->second.sock != INVALID_SOCKET)
+            control(lp, EPOLL_CTL_DEL, handle, hIt->second.sock, 0);
+        lp->handlers.erase(hIt);
+    }
+    //a callback on this thread is the caller itself
+    while (lp->current == handle && tLoop != lp)
+    {
+        ++lp->waiters;
+        PalLock::release(&lp->lock);
+        PalSem::wait(&lp->doneSem);
+        PalLock::take(&lp->lock);
+    }
+    PalLock::release(&lp->lock);
+    wake(lp);
+}
+
+void SocketLoop::stop()
+{
+    PalLock::take(&sLock);
+    if (!sLoops.empty())
+    {
+        if (!sHandles.empty())
+            LOGGER_WARNING(sLogger, LOGPREFIX << "stop: " << sHandles.size()
+                           << " handles still registered");
+        sRunning = false;
+        for (auto lp : sLoops)
+        {
+            wake(lp);
+            //let the thread return by itself, which is the only way to stop
+            //it on some platforms
+            for (int i = MAX_WAIT_MS / 10; i > 0 && !lp->done; --i)
+            {
+                PalThread::msleep(10);
+            }
+            PalThread::stop(lp->thread);
+            closeLoop(lp);
+        }
+        sLoops.clear();
+        sHandles.clear();
+    }
+    PalLock::release(&sLock);
+}
+
+SocketLoop::LoopT *SocketLoop::getLoop(int handle)
+{
+    PalLock::take(&sLock);
+    auto it = sHandles.find(handle);
+    LoopT *lp = (it == sHandles.end())? 0: it->second;
+    PalLock::release(&sLock);
+    return lp;
+}
+
+bool SocketLoop::start()
+{
+    sRunning = true;
+    for (int i = 0; i < NUM_THREADS; ++i)
+    {
+        LoopT *lp = new LoopT;
+        lp->current = 0;
+        lp->waiters = 0;
+        lp->done = false;
+#if defined(_WIN32) || defined(WIN32)
+        lp->wakeSock = socket(AF_INET, SOCK_DGRAM, 0);
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        int len = sizeof(addr);
+        bool ok = (lp->wakeSock != INVALID_SOCKET &&
+                   bind(lp->wakeSock, (sockaddr *)&addr, len) == 0 &&
+                   getsockname(lp->wakeSock, (sockaddr *)&addr, &len) == 0 &&
+                   ::connect(lp->wakeSock, (sockaddr *)&addr, len) == 0 &&
+                   PalSocket::setNonblocking(lp->wakeSock) == 0);
+#else
+        lp->pollFd = epoll_create1(EPOLL_CLOEXEC);
+        lp->wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        bool ok = (lp->pollFd >= 0 && lp->wakeFd >= 0);
+        if (ok)
+        {
+            epoll_event ev;
+            ev.events = EPOLLIN;
+            ev.data.u64 = 0; //not a handle
+            ok = (epoll_ctl(lp->pollFd, EPOLL_CTL_ADD, lp->wakeFd, &ev) == 0);
+        }
+#endif
+        PalLock::init(&lp->lock);
+        PalSem::init(&lp->doneSem);
+        if (!ok)
+        {
+            int err = PalSocket::getError();
+            LOGGER_ERROR(sLogger, LOGPREFIX << "start: Failed to create "
+                         "poller, error " << err << Socket::getErrorStr(err));
+            closeLoop(lp);
+            break;
+        }
+        if (PalThread::start(&lp->thread, loopThread, lp) != 0)
+        {
+            LOGGER_ERROR(sLogger, LOGPREFIX << "start: Failed to start "
+                         "thread");
+            closeLoop(lp);
+            break;
+        }
+        sLoops.push_back(lp);
+    }
+    //run with fewer threads if some failed
+    if (sLoops.empty())
+        sRunning = false;
+    return sRunning;
+}
+
+void *SocketLoop::loopThread(void *arg)
+{
+    LoopT *lp = static_cast<LoopT *>(arg);
+    tLoop = lp;
+    vector<pair<int, int>> ready;
+    ClockT::time_point now;
+    int waitMs;
+    while (sRunning)
+    {
+        //wait until the earliest deadline
+        waitMs = MAX_WAIT_MS;
+        PalLock::take(&lp->lock);
+        now = ClockT::now();
+        for (auto &it : lp->handlers)
+        {
+            if (it.second.timeoutMs > 0)
+                waitMs = min(waitMs, static_cast<int>(
+                        chrono::duration_cast<chrono::milliseconds>(
+                                        it.second.deadline - now).count()));
+        }
+        PalLock::release(&lp->lock);
+        ready.clear();
+        waitEvents(lp, max(waitMs, 0), ready);
+        if (!sRunning)
+            break;
+        PalLock::take(&lp->lock);
+        now = ClockT::now();
+        for (auto &it : lp->handlers)
+        {
+            if (it.second.timeoutMs > 0 && it.second.deadline <= now &&
+                find_if(ready.begin(), ready.end(),
+                        [&it](const pair<int, int> &r)
+                        {
+                            return (r.first == it.first);
+                        }) == ready.end())
+                ready.push_back(make_pair(it.first, int(EVENT_TIMEOUT)));
+        }
+        PalLock::release(&lp->lock);
+        for (auto &r : ready)
+        {
+            dispatch(lp, r.first, r.second);
+        }
+    }
+    lp->done = true;
+    return 0;
+}
+
+void SocketLoop::waitEvents(LoopT                  *lp,
+                            int                     waitMs,
+                            vector<pair<int, int>> &ready)
+{
+    int events;
+#if defined(_WIN32) || defined(WIN32)
+    vector<WSAPOLLFD> fds;
+    vector<int>       handles;
+    WSAPOLLFD         pfd;
+    pfd.fd = lp->wakeSock;
+    pfd.events = POLLRDNORM;
+    pfd.revents = 0;
+    fds.push_back(pfd);
+    handles.push_back(0);
+    PalLock::take(&lp->lock);
+    for (auto &it : lp->handlers)
+    {
+        if (it.second.sock == INVALID_SOCKET || it.second.events == 0)
+            continue;
+        pfd.fd = it.second.sock;
+        pfd.events = 0;
+        if ((it.second.events & EVENT_READ) != 0)
+            pfd.events |= POLLRDNORM;
+        if ((it.second.events & EVENT_WRITE) != 0)
+            pfd.events |= POLLWRNORM;
+        fds.push_back(pfd);
+        handles.push_back(it.first);
+    }
+    PalLock::release(&lp->lock);
+    if (WSAPoll(fds.data(), static_cast<ULONG>(fds.size()), waitMs) <= 0)
+        return;
+    char buf[64];
+    for (size_t i = 0; i < fds.size(); ++i)
+    {
+        if (fds[i].revents == 0)
+            continue;
+        if (handles[i] == 0)
+        {
+            while (::recv(lp->wakeSock, buf, sizeof(buf), 0) > 0)
+            {
+                //drain
+            }
+            continue;
+        }
+        events = 0;
+        if ((fds[i].revents & POLLRDNORM) != 0)
+            events |= EVENT_READ;
+        if ((fds[i].revents & POLLWRNORM) != 0)
+            events |= EVENT_WRITE;
+        if ((fds[i].revents & (POLLERR | POLLHUP | POLLNVAL)) != 0)
+            events |= EVENT_ERROR;
+        ready.push_back(make_pair(handles[i], events));
+    }
+#else
+    epoll_event evs[MAX_EVENTS];
+    int n = epoll_wait(lp->pollFd, evs, MAX_EVENTS, waitMs);
+    uint64_t val;
+    for (int i = 0; i < n; ++i)
+    {
+        if (evs[i].data.u64 == 0)
+        {
+            if (read(lp->wakeFd, &val, sizeof(val)) < 0)
+                val = 0; //nothing to do
+            continue;
+        }
+        events = 0;
+        if ((evs[i].events & EPOLLIN) != 0)
+            events |= EVENT_READ;
+        if ((evs[i].events & EPOLLOUT) != 0)
+            events |= EVENT_WRITE;
+        if ((evs[i].events & (EPOLLERR | EPOLLHUP)) != 0)
+            events |= EVENT_ERROR;
+        ready.push_back(make_pair(static_cast<int>(evs[i].data.u64), events));
+    }
+#endif //WIN32
+}
+
+void SocketLoop::dispatch(LoopT *lp, int handle, int events)
+{
+    PalLock::take(&lp->lock);
+    auto it = lp->handlers.find(handle);
+    if (it == lp->handlers.end())
+    {
+        PalLock::release(&lp->lock); //removed by an earlier callback
+        return;
+    }
+    HandlerT &h(it->second);
+    ClockT::time_point now(ClockT::now());
+    if (events == EVENT_TIMEOUT)
+    {
+        //the timeout may have been restarted by an earlier callback
+        if (h.timeoutMs <= 0 || now < h.deadline)
+            events = 0;
+    }
+    else
+    {
+        //the interest may have been changed by an earlier callback
+        events &= (h.events | EVENT_ERROR);
+    }
+    if (events == 0)
+    {
+        PalLock::release(&lp->lock);
+        return;
+    }
+    h.deadline = now + chrono::milliseconds(h.timeoutMs);
+    CallbackFn fn = h.fn;
+    void *obj = h.obj;
+    lp->current = handle;
+    PalLock::release(&lp->lock);
+    fn(obj, events);
+    PalLock::take(&lp->lock);
+    lp->current = 0;
+    for (; lp->waiters > 0; --lp->waiters)
+    {
+        PalSem::post(&lp->doneSem);
+    }
+    PalLock::release(&lp->lock);
+}
+
+bool SocketLoop::control(LoopT *lp, int op, int handle, SocketT sock,
+                         int events)
+{
+#if defined(_WIN32) || defined(WIN32)
+    //the poll set is rebuilt on each wait
+    (void) lp;
+    (void) op;
+    (void) handle;
+    (void) sock;
+    (void) events;
+    return true;
+#else
+    epoll_event ev;
+    ev.events = 0;
+    if ((events & EVENT_READ) != 0)
+        ev.events |= EPOLLIN;
+    if ((events & EVENT_WRITE) != 0)
+        ev.events |= EPOLLOUT;
+    ev.data.u64 = handle;
+    if (epoll_ctl(lp->pollFd, op, sock, &ev) == 0)
+        return true;
+    int err = PalSocket::getError();
+    LOGGER_ERROR(sLogger, LOGPREFIX << "control: Failed operation " << op
+                 << " on socket " << sock << ", error " << err
+                 << Socket::getErrorStr(err));
+    return false;
+#endif //WIN32
+}
+
+void SocketLoop::closeLoop(LoopT *lp)
+{
+#if defined(_WIN32) || defined(WIN32)
+    if (lp->wakeSock != INVALID_SOCKET)
+        PalSocket::close(lp->wakeSock);
+#else
+    if (lp->pollFd >= 0)
+        close(lp->pollFd);
+    if (lp->wakeFd >= 0)
+        close(lp->wakeFd);
+#endif
+    PalSem::destroy(&lp->doneSem);
+    PalLock::destroy(&lp->lock);
+    delete lp;
+}
+
+void SocketLoop::wake(LoopT *lp)
+{
+    if (tLoop == lp)
+        return; //changes are picked up before the next wait
+#if defined(_WIN32) || defined(WIN32)
+    ::send(lp->wakeSock, "w", 1, 0);
+#else
+    uint64_t val = 1;
+    if (write(lp->wakeFd, &val, sizeof(val)) < 0)
+        val = 0; //counter full, so a wakeup is pending anyway
+#endif
+}
@@ -0,0 +1,205 @@
+/**
+ * Event loop for socket I/O on a small fixed pool of threads.
+ * A socket is registered with its read/write interest and an inactivity
+ * timeout, and the owner callback is invoked on a pool thread when the
+ * socket is ready or the timeout expires, so that many connections can be
+ * served without a blocking thread each. Uses epoll on Linux and WSAPoll on
+ * Windows. The threads are started on the first registration.
+ * Callbacks must not block, because that delays the other sockets on the
+ * same thread.
+ *
+ * Copyright (C) Sapura Secured Technologies, 2026. All Rights Reserved.
+ *
+ * @file
+ * @version $Id$
+ * @author agent <agent@local>
+ */
+#ifndef SOCKETLOOP_H
+#define SOCKETLOOP_H
+
+#include <atomic>
+#include <map>
+#include <vector>
+
+#include "Logger.h"
+#include "PalLock.h"
+#include "PalSocket.h"
+
+class SocketLoop
+{
+public:
+    //callback event flags
+    enum eEvent
+    {
+        EVENT_READ    = 0x01,
+        EVENT_WRITE   = 0x02,
+        EVENT_ERROR   = 0x04, //error or hangup, regardless of interest
+        EVENT_TIMEOUT = 0x08  //no event within the timeout
+    };
+
+    /**
+     * Callback for socket events. Invoked on a pool thread, never
+     * concurrently for the same handle.
+     *
+     * @param[in] obj    The object registered with the handle.
+     * @param[in] events eEvent flags.
+     */
+    typedef void (*CallbackFn)(void *obj, int events);
+
+    static const int NUM_THREADS = 2;
+
+    /**
+     * Sets the logger for errors.
+     *
+     * @param[in] logger App logger.
+     */
+    static void setLogger(Logger *logger) { sLogger = logger; }
+
+    /**
+     * Registers a socket. The socket must stay open until removed.
+     *
+     * @param[in] sock      The socket. INVALID_SOCKET for a timer without
+     *                      socket.
+     * @param[in] events    EVENT_READ and/or EVENT_WRITE interest, or 0.
+     * @param[in] timeoutMs The timeout in milliseconds, restarted on each
+     *                      callback. The callback is invoked with
+     *                      EVENT_TIMEOUT once per expiry. 0 for no timeout.
+     * @param[in] fn        The callback function.
+     * @param[in] obj       The object to pass to the callback.
+     * @return The positive handle, or 0 on failure.
+     */
+    static int add(SocketT    sock,
+                   int        events,
+                   int        timeoutMs,
+                   CallbackFn fn,
+                   void      *obj);
+
+    /**
+     * Changes the interest and timeout of a handle, and restarts the
+     * timeout.
+     *
+     * @param[in] handle    The handle from add().
+     * @param[in] events    See add().
+     * @param[in] timeoutMs See add().
+     * @return true if successful.
+     */
+    static bool modify(int handle, int events, int timeoutMs);
+
+    /**
+     * Changes the socket of a handle, e.g. to reconnect or to become a timer
+     * without socket, with its interest and timeout as in the other
+     * modify(). The old socket must still be open.
+     *
+     * @param[in] handle    The handle from add().
+     * @param[in] sock      See add().
+     * @param[in] events    See add().
+     * @param[in] timeoutMs See add().
+     * @return true if successful. On failure, the handle remains as a timer
+     *         without socket.
+     */
+    static bool modify(int handle, SocketT sock, int events, int timeoutMs);
+
+    /**
+     * Unregisters a handle. If its callback is running on another thread,
+     * waits for it to return. May be called from within the callback.
+     * Does nothing for an invalid handle.
+     *
+     * @param[in] handle The handle from add().
+     */
+    static void remove(int handle);
+
+    /**
+     * Stops the threads. All handles must have been removed. A later add()
+     * starts them again.
+     */
+    static void stop();
+
+private:
+    struct LoopT;
+
+    //maximum poll wait, in case a wakeup is missed
+    static const int MAX_WAIT_MS = 1000;
+    static const int MAX_EVENTS  = 64;
+
+    static Logger                 *sLogger;
+    static PalLock::LockT          sLock;       //guards all below
+    static std::vector<LoopT *>    sLoops;
+    static std::map<int, LoopT *>  sHandles;    //value is owner loop
+    static int                     sLastHandle;
+    static unsigned int            sNextLoop;   //for round-robin
+    static std::atomic<bool>       sRunning;
+
+    //loop of the current thread, if a pool thread
+    static thread_local LoopT     *tLoop;
+
+    /**
+     * Gets the loop of a handle.
+     *
+     * @param[in] handle The handle.
+     * @return The loop, or 0 if not found.
+     */
+    static LoopT *getLoop(int handle);
+
+    /**
+     * Creates the loops and starts their threads.
+     *
+     * @return true if successful.
+     */
+    static bool start();
+
+    /**
+     * Runs a loop until stopped.
+     *
+     * @param[in] arg The LoopT.
+     */
+    static void *loopThread(void *arg);
+
+    /**
+     * Waits for socket events.
+     *
+     * @param[in]  lp     The loop.
+     * @param[in]  waitMs The maximum wait in milliseconds.
+     * @param[out] ready  The handles with their eEvent flags.
+     */
+    static void waitEvents(LoopT                            *lp,
+                           int                               waitMs,
+                           std::vector<std::pair<int, int>> &ready);
+
+    /**
+     * Invokes the callback of a handle.
+     *
+     * @param[in] lp     The loop.
+     * @param[in] handle The handle.
+     * @param[in] events eEvent flags.
+     */
+    static void dispatch(LoopT *lp, int handle, int events);
+
+    /**
+     * Registers, modifies or unregisters a socket with the poller.
+     * Caller must hold the loop lock.
+     *
+     * @param[in] lp     The loop.
+     * @param[in] op     EPOLL_CTL_* on Linux, unused on Windows.
+     * @param[in] handle The handle.
+     * @param[in] sock   The socket.
+     * @param[in] events eEvent flags.
+     * @return true if successful.
+     */
+    static bool control(LoopT *lp, int op, int handle, SocketT sock,
+                        int events);
+
+    /**
+     * Closes the poller of a loop and deletes it.
+     *
+     * @param[in] lp The loop.
+     */
+    static void closeLoop(LoopT *lp);
+
+    /**
+     * Interrupts the poll wait of a loop, to apply handle changes.
+     *
+     * @param[in] lp The loop.
+     */
+    static void wake(LoopT *lp);
+};
+#endif //SOCKETLOOP_H
@@ -43,6 +43,8 @@ SubsData::Int2IntMapT       SubsData::sEmSsi;
 SubsData::Int2IntMapT       SubsData::sClusterCount;
 #else
 SubsData::RangeMapT         SubsData::sValidClients;
+long long                   SubsData::sGrpAttSeq(0);
+SubsData::GrpAttLogT        SubsData::sGrpAttLog;
 #endif
 SubsData::BranchMapT        SubsData::sBranchMap;
 
@@ -233,10 +235,9 @@ bool SubsData::processMsg(MsgSp *msg)
                 IdSetT issis;
                 Utils::fromStringWithRange(valStr, issis,
                                            MsgSp::Value::LIST_DELIMITER);
-                sData[SUBS_GSSI_ATTACH_LIST][val]
-                    .insert(issis.begin(), issis.end());
                 for (auto i : issis)
                 {
+                    grpAttUpdate(SUBS_GSSI_ATTACH_LIST, val, i, true);
                     grpUncDetach(i, 0, true);
                 }
 #endif
@@ -1095,44 +1096,31 @@ bool SubsData::addBranchIds(int           branch,
         }
         case BRID_MOB:
         {
-            Int2IntMapT inp;
-            if (!parseBranchRanges(idList, inp))
+            IdRangeSet inp(idList, ' ');
+            if (inp.empty())
                 return false; //invalid input
             affCids.clear();
             auto &brData(sBranchMap[branch]);
-            IdSetT ids;
-            branchRangeToIds(inp, ids);
             //affected IDs are those actually added
-            for (auto id : ids)
-            {
-                if (!brData.hasId(type, id))
-                    affCids.insert(id);
-            }
-            if (!affCids.empty())
+            IdRangeSet added(inp);
+            if (brData.idMap.count(type) != 0)
+                added.subtract(brData.idMap.at(type));
+            if (!added.empty())
             {
-                auto &ranges = brData.idMap[type];
-                for (auto &it : inp)
-                {
-                    addBranchRange(it.first, it.second, ranges);
-                }
+                added.getIds(affCids);
+                brData.idMap[type].unite(added);
                 setTimestamp();
             }
             break;
         }
         case BRID_SSI:
         {
-            Int2IntMapT inp;
-            if (!parseBranchRanges(idList, inp))
+            IdRangeSet inp(idList, ' ');
+            if (inp.empty())
                 return false; //invalid input
             affCids.clear();
             auto &brData(sBranchMap[branch]);
-            int n = brData.idCount(type); //initial size
-            auto &ranges = brData.idMap[type];
-            for (auto &it : inp)
-            {
-                addBranchRange(it.first, it.second, ranges);
-            }
-            if (brData.idCount(type) > n) //really added
+            if (brData.idMap[type].unite(inp) > 0) //really added
             {
                 brData.getClientIds(affCids); //all clients
                 setTimestamp();
@@ -1204,32 +1192,24 @@ void SubsData::removeBranchIds(int           branch,
         {
             if (brData.idMap.count(type) == 0)
                 break;
-            Int2IntMapT inp;
+            auto &ranges = brData.idMap[type];
             if (idList.empty())
             {
-                branchRangeToIds(brData.idMap[type], affCids);
+                ranges.getIds(affCids);
                 brData.idMap.erase(type); //remove all
                 setTimestamp();
             }
             else
             {
-                if (!parseBranchRanges(idList, inp))
+                IdRangeSet inp(idList, ' ');
+                if (inp.empty())
                     break;
-                IdSetT ids;
-                branchRangeToIds(inp, ids);
                 //affected IDs are those that actually exist
-                for (auto id : ids)
+                inp.intersect(ranges);
+                if (!inp.empty())
                 {
-                    if (brData.hasId(type, id))
-                        affCids.insert(id);
-                }
-                if (!affCids.empty())
-                {
-                    auto &ranges = brData.idMap[type];
-                    for (auto &it : inp)
-                    {
-                        removeBranchRange(it.first, it.second, ranges);
-                    }
+                    inp.getIds(affCids);
+                    ranges.subtract(inp);
                     if (ranges.empty())
                         brData.idMap.erase(type);
                     setTimestamp();
@@ -1249,18 +1229,14 @@ void SubsData::removeBranchIds(int           branch,
                 }
                 else
                 {
-                    Int2IntMapT inp;
-                    if (!parseBranchRanges(idList, inp))
+                    IdRangeSet inp(idList, ' ');
+                    if (inp.empty())
                         break;
-                    int n = brData.idCount(type); //initial size
                     auto &ranges = brData.idMap[type];
-                    for (auto &it : inp)
-                    {
-                        removeBranchRange(it.first, it.second, ranges);
-                    }
+                    long long n = ranges.subtract(inp);
                     if (ranges.empty())
                         brData.idMap.erase(type);
-                    if (brData.idCount(type) < n) //really removed
+                    if (n > 0) //really removed
                     {
                         brData.getClientIds(affCids);
                         setTimestamp();
@@ -1700,6 +1676,9 @@ void SubsData::clientInit(MsgSp *msg)
         case MsgSp::Type::SUBS_DATA:
         {
             sData.clear();
+            //force attachment views to rebuild
+            ++sGrpAttSeq;
+            sGrpAttLog.clear();
             sVpnGrps.clear();
             sFleetGrps.clear();
             sGssiDesc.clear();
@@ -1897,7 +1876,7 @@ bool SubsData::grpUncAttach(int issi, int gssi)
         return false;
     Locker lock(&sDataLock);
     grpUncDetach(issi, 0, true); //detach from all first
-    sData[SUBS_GSSI_ATTACH_LIST_UNC][gssi].insert(issi);
+    grpAttUpdate(SUBS_GSSI_ATTACH_LIST_UNC, gssi, issi, true);
     return true;
 }
 
@@ -1906,25 +1885,33 @@ void SubsData::grpUncDetach(int issi, int gssi, bool haveLock)
     if (!haveLock)
         PalLock::take(&sDataLock);
     auto &dm(sData[SUBS_GSSI_ATTACH_LIST_UNC]);
-    if (issi == 0)
+    if (gssi != 0 && issi != 0)
     {
-        dm.clear();
+        grpAttUpdate(SUBS_GSSI_ATTACH_LIST_UNC, gssi, issi, false);
     }
-    else if (gssi == 0)
+    else
     {
-        auto it = dm.begin();
-        while (it != dm.end())
+        //collect first because grpAttUpdate() may erase map entries
+        vector<pair<int, int>> atts;
+        for (const auto &it : dm)
         {
-            if (it->second.erase(issi) != 0 && it->second.empty())
-                it = dm.erase(it);
-            else
-                ++it;
+            if (issi == 0)
+            {
+                for (auto i : it.second)
+                {
+                    atts.push_back(make_pair(it.first, i));
+                }
+            }
+            else if (it.second.count(issi) != 0)
+            {
+                atts.push_back(make_pair(it.first, issi));
+            }
+        }
+        for (const auto &it : atts)
+        {
+            grpAttUpdate(SUBS_GSSI_ATTACH_LIST_UNC, it.first, it.second,
+                         false);
         }
-    }
-    else if (dm.count(gssi) != 0 && dm[gssi].erase(issi) != 0 &&
-             dm[gssi].empty())
-    {
-        dm.erase(gssi);
     }
     if (!haveLock)
         PalLock::release(&sDataLock);
@@ -1960,7 +1947,7 @@ void SubsData::setClientRanges(int type, const string &ranges)
     {
         Locker lock(&sDataLock);
         sValidClients[type].clear();
-        parseBranchRanges(ranges, sValidClients[type]);
+        sValidClients[type].parse(ranges, ' ');
     }
 }
 
@@ -1969,17 +1956,8 @@ bool SubsData::isValidClient(int type, int id)
     Locker lock(&sDataLock);
     if (sValidClients.empty())
         return true; //single cluster - no restriction
-    if (sValidClients.count(type) != 0)
-    {
-        for (const auto &it : sValidClients.at(type))
-        {
-            if (id < it.first)
-                break;
-            if (id <= it.second)
-                return true;
-        }
-    }
-    return false;
+    return (sValidClients.count(type) != 0 &&
+            sValidClients.at(type).contains(id));
 }
 #endif //SERVERAPP
 
@@ -2338,14 +2316,15 @@ void SubsData::removeResource(int id, bool disp, bool haveLock)
     {
         sMobileIds.erase(id);
         //remove from grp attachments
-        auto &dm(sData[SUBS_GSSI_ATTACH_LIST]);
-        auto it = dm.begin();
-        while (it != dm.end())
+        IdSetT gssis;
+        for (const auto &it : sData[SUBS_GSSI_ATTACH_LIST])
         {
-            if (it->second.erase(id) != 0 && it->second.empty())
-                it = dm.erase(it);
-            else
-                ++it;
+            if (it.second.count(id) != 0)
+                gssis.insert(it.first);
+        }
+        for (auto g : gssis)
+        {
+            grpAttUpdate(SUBS_GSSI_ATTACH_LIST, g, id, false);
         }
 #ifndef SERVERAPP
         grpUncDetach(id, 0, true);
@@ -2525,21 +2504,43 @@ string SubsData::getGrpMembers(int gssi)
     return oss.str();
 }
 
-bool SubsData::getGrpAttachedMembers(Int2IdsMapT &data)
+bool SubsData::getGrpAttachedMembers(Int2IdsMapT &data, long long *seq)
 {
     if (!isReady())
         return false;
     Locker lock(&sDataLock);
     data = sData[SUBS_GSSI_ATTACH_LIST];
-#ifndef SERVERAPP
+#ifdef SERVERAPP
+    (void) seq;
+#else
     for (const auto &it : sData[SUBS_GSSI_ATTACH_LIST_UNC])
     {
         data[it.first].insert(it.second.begin(), it.second.end());
     }
+    if (seq != 0)
+        *seq = sGrpAttSeq;
 #endif
     return !data.empty();
 }
 
+#ifndef SERVERAPP
+bool SubsData::getGrpAttChanges(long long &seq, GrpAttChangesT &changes)
+{
+    changes.clear();
+    Locker lock(&sDataLock);
+    //sequence number of the oldest logged change
+    long long first = sGrpAttSeq - sGrpAttLog.size() + 1;
+    if (seq < first - 1 || seq > sGrpAttSeq)
+    {
+        seq = sGrpAttSeq;
+        return false;
+    }
+    changes.assign(sGrpAttLog.begin() + (seq - first + 1), sGrpAttLog.end());
+    seq = sGrpAttSeq;
+    return true;
+}
+#endif
+
 bool SubsData::getGrpAttachedMembers(int gssi, IdSetT &issis, bool unc)
 {
     if (!isReady())
@@ -2731,7 +2732,7 @@ void SubsData::processMonMsg(MsgSp *msg)
                 {
                     for (auto i : gssis)
                     {
-                        dm[i].insert(content);
+                        grpAttUpdate(SUBS_GSSI_ATTACH_LIST, i, content, true);
                     }
 #ifndef SERVERAPP
                     grpUncDetach(content, 0, true); //confirmed attached
@@ -2739,25 +2740,22 @@ void SubsData::processMonMsg(MsgSp *msg)
                 }
                 break;
             }
-#ifndef SERVERAPP
-            //on client, add list of affected GSSIs into msg to enable group
+            //affected GSSIs - on client, added into msg to enable group
             //active state updates
             IdSetT gssis;
-#endif
             if (container == MsgSp::Value::GRP_ATT_DET_DETACH_ALL)
             {
                 //remove ISSI from all groups
-#ifdef SERVERAPP
-                for (auto &it : dm)
+                for (const auto &it : dm)
                 {
-                    it.second.erase(content);
+                    if (it.second.count(content) != 0)
+                        gssis.insert(it.first);
                 }
-#else
-                for (auto &it : dm)
+                for (auto g : gssis)
                 {
-                    if (it.second.erase(content) != 0)
-                        gssis.insert(it.first);
+                    grpAttUpdate(SUBS_GSSI_ATTACH_LIST, g, content, false);
                 }
+#ifndef SERVERAPP
                 grpUncDetach(content, 0, true); //all grps because detached all
 #endif
             }
@@ -2802,21 +2800,21 @@ void SubsData::processMonMsg(MsgSp *msg)
                         if (container < 0)
                         {
                             container = -container;
-                            dm[container].erase(content);
+                            grpAttUpdate(SUBS_GSSI_ATTACH_LIST, container,
+                                         content, false);
 #ifndef SERVERAPP
                             grpUncDetach(content, container, true); //this grp
 #endif
                         }
                         else
                         {
-                            dm[container].insert(content);
+                            grpAttUpdate(SUBS_GSSI_ATTACH_LIST, container,
+                                         content, true);
 #ifndef SERVERAPP
                             grpUncDetach(content, 0, true); //all grps
 #endif
                         }
-#ifndef SERVERAPP
                         gssis.insert(container);
-#endif
                     }
                 } //for (auto &v : nv)
             } //if (msg->getFieldVals(MsgSp::Field::GRP_ID, nv))
@@ -3343,6 +3341,38 @@ void SubsData::processMonMsg(MsgSp *msg)
     } //switch (msg->getType())
 }
 
+bool SubsData::grpAttUpdate(int type, int gssi, int issi, bool attach)
+{
+    auto &dm(sData[type]);
+    if (attach)
+    {
+        if (!dm[gssi].insert(issi).second)
+            return false;
+    }
+    else
+    {
+        auto it = dm.find(gssi);
+        if (it == dm.end() || it->second.erase(issi) == 0)
+            return false;
+        if (it->second.empty())
+            dm.erase(it);
+    }
+#ifndef SERVERAPP
+    //combined attachments change only if not in the other list
+    const auto &dm2(sData[(type == SUBS_GSSI_ATTACH_LIST)?
+                          SUBS_GSSI_ATTACH_LIST_UNC: SUBS_GSSI_ATTACH_LIST]);
+    auto it = dm2.find(gssi);
+    if (it == dm2.end() || it->second.count(issi) == 0)
+    {
+        sGrpAttLog.push_back(GrpAttChange(gssi, issi, attach));
+        ++sGrpAttSeq;
+        if (sGrpAttLog.size() > GRP_ATT_LOG_MAX)
+            sGrpAttLog.pop_front();
+    }
+#endif
+    return true;
+}
+
 int SubsData::getTotalSize(int type)
 {
     int size = 0;
@@ -3495,57 +3525,6 @@ inline string SubsData::getIssiDesc(int issi)
     return "";
 }
 
-void SubsData::removeBranchRange(int min, int max, Int2IntMapT &data)
-{
-    auto it = data.find(min);
-    if (it == data.end())
-        it = data.begin();
-    while (it != data.end())
-    {
-        if (it->first > max)
-            break; //beyond range - done
-        if (it->second < min)
-        {
-            ++it; //below range - go next
-            continue;
-        }
-        //overlap
-        if (it->second >= max)
-        {
-            //split/shrink/erase existing depending on it->first
-            if (it->second > max)
-                data[max + 1] = it->second; //split or shrink
-            //note: after element insertion above, 'it' remains valid because
-            //the new element is higher, but must not be used for continued
-            //iteration
-            max = 0; //done after truncating/erasing below
-        }
-        if (it->first < min)
-        {
-            it->second = min - 1; //truncate
-            ++it;
-        }
-        else
-        {
-            it = data.erase(it);
-        }
-        if (max == 0)
-            break;
-    }
-}
-
-void SubsData::branchRangeToIds(const Int2IntMapT &data, IdSetT &ids)
-{
-    int i;
-    for (auto &it : data)
-    {
-        for (i=it.first; i<=it.second; ++i)
-        {
-            ids.insert(i);
-        }
-    }
-}
-
 int SubsData::getBranchIdCount(int branch, int type)
 {
     int n = 0;
@@ -3561,12 +3540,7 @@ int SubsData::getBranchIdCount(int branch, int type)
                 break;
             default:
                 if (sBranchMap[branch].idMap.count(type) != 0)
-                {
-                    for (const auto &it : sBranchMap[branch].idMap[type])
-                    {
-                        n += (it.second - it.first + 1);
-                    }
-                }
+                    n = sBranchMap[branch].idMap[type].size();
                 break;
         }
     }
@@ -3592,17 +3566,7 @@ string SubsData::getBranchIdsHaveLock(int branch, int type)
             default:
             {
                 if (sBranchMap[branch].idMap.count(type) != 0)
-                {
-                    ostringstream oss;
-                    for (const auto &it : sBranchMap[branch].idMap[type])
-                    {
-                        oss << it.first;
-                        if (it.second != it.first)
-                            oss << '-' << it.second;
-                        oss << ' ';
-                    }
-                    return oss.str();
-                }
+                    return sBranchMap[branch].idMap[type].toString(" ");
                 break;
             }
         }
@@ -3702,68 +3666,3 @@ void SubsData::getGrpNames(const IdSetT &gssis, Ssi2DescMapT &groups)
     }
 }
 #endif //SERVERAPP
-
-bool SubsData::parseBranchRanges(const string &str, Int2IntMapT &data)
-{
-    if (str.empty())
-        return false;
-    int min;
-    int max;
-    char c;
-    string token;
-    istringstream is(str);
-    while (getline(is, token, ' '))
-    {
-        if (token.empty())
-            continue;
-        istringstream ist(token);
-        if (!(ist >> min) || min <= 0)
-            continue; //invalid
-        //either one value or range min-max
-        if (!(ist >> c >> max) || c != '-' || max < min)
-            max = min;
-        //entries are not sorted and may overlap
-        addBranchRange(min, max, data);
-    }
-    return !data.empty();
-}
-
-void SubsData::addBranchRange(int min, int max, Int2IntMapT &data)
-{
-    auto it = data.find(min);
-    if (it == data.end())
-        it = data.begin();
-    while (it != data.end())
-    {
-        if (it->first > max + 1)
-            break; //beyond range - done
-        if (it->second < min - 1)
-        {
-            ++it; //below range - go next
-        }
-        //overlap or adjacent
-        else if (it->first <= min)
-        {
-            if (it->second >= max)
-            {
-                min = 0; //covered by existing - done
-                break;
-            }
-            min = it->first; //will extend existing - go next to check overlap
-            ++it;
-        }
-        //current starts within (min,max+1]
-        else if (it->second > max)
-        {
-            max = it->second; //extend range, remove existing, and done
-            data.erase(it);
-            break;
-        }
-        else
-        {
-            it = data.erase(it); //current swallowed - delete and go next
-        }
-    }
-    if (min != 0)
-        data[min] = max;
-}
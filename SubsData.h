@@ -10,6 +10,7 @@
 #ifndef SUBSDATA_H
 #define SUBSDATA_H
 
+#include <deque>
 #include <map>
 #include <queue>
 #include <set>
@@ -17,6 +18,7 @@
 #include <vector>
 #include <time.h>   //time_t, time()
 
+#include "IdRangeSet.h"
 #include "MsgSp.h"
 #include "PalLock.h"
 
@@ -123,6 +125,17 @@ public:
     typedef std::map<int, std::string> Ssi2DescMapT;
     //branch ID names in hexadecimal-encoded UTF8 Unicode
     typedef std::map<int, std::string> BranchMapT;
+
+    //change in group attachments, including unconfirmed ones
+    struct GrpAttChange
+    {
+        GrpAttChange(int g, int i, bool a) : gssi(g), issi(i), attached(a) {}
+
+        int  gssi;
+        int  issi;
+        bool attached;  //false if detached
+    };
+    typedef std::vector<GrpAttChange> GrpAttChangesT;
 #endif //SERVERAPP
     //key is eTerminalType
     typedef std::map<int, Ssi2DescMapT> IssiType2DescMapT;
@@ -852,7 +865,7 @@ public:
      *
      * @param[in] type   Client type - MsgSp::Value::SUBS_TYPE_DISPATCHER/MOBILE.
      * @param[in] ranges Space-separated ID ranges received from server in the
-     *                   format as expected by parseBranchRanges().
+     *                   format as expected by IdRangeSet::parse().
      */
     static void setClientRanges(int type, const std::string &ranges);
 
@@ -1048,9 +1061,27 @@ public:
      *
      * @param[out] data Attached member ISSIs of each group. Existing content is
      *                  overwritten.
+     * @param[out] seq  (Client only) The sequence number of the last change
+     *                  included in data, for getGrpAttChanges(), if required.
      * @return true if data not empty.
      */
-    static bool getGrpAttachedMembers(Int2IdsMapT &data);
+    static bool getGrpAttachedMembers(Int2IdsMapT &data, long long *seq = 0);
+
+#ifndef SERVERAPP
+    /**
+     * Gets the group attachment changes after a given change, to update a
+     * copy of getGrpAttachedMembers() data without rebuilding it.
+     * Only the latest GRP_ATT_LOG_MAX changes are kept, and all are
+     * discarded on a data download.
+     *
+     * @param[in,out] seq     The sequence number of the last change already
+     *                        applied. Set to that of the last change.
+     * @param[out]    changes The changes, oldest first.
+     * @return false if some changes are no longer available, and the copy
+     *         must be rebuilt with getGrpAttachedMembers().
+     */
+    static bool getGrpAttChanges(long long &seq, GrpAttChangesT &changes);
+#endif
 
     /**
      * Gets attached members of a group.
@@ -1184,9 +1215,9 @@ private:
     static std::queue<MsgSp *> sMonQueue;
     static PalLock::LockT      sDataLock;
 
-    typedef std::map<int, int>         Int2IntMapT;
-    //ID ranges: key = type, value = min:max
-    typedef std::map<int, Int2IntMapT> RangeMapT;
+    typedef std::map<int, int>        Int2IntMapT;
+    //ID ranges: key = type
+    typedef std::map<int, IdRangeSet> RangeMapT;
 
 #ifdef SERVERAPP
     typedef std::set<std::string> StrSetT;
@@ -1218,24 +1249,13 @@ private:
                             return true;
                         for (const auto &it : idMap)
                         {
-                            for (const auto &it2 : it.second)
-                            {
-                                if (id < it2.first)
-                                    break;
-                                if (id <= it2.second)
-                                    return true;
-                            }
+                            if (it.second.contains(id))
+                                return true;
                         }
                     }
                     else if (idMap.count(type) != 0)
                     {
-                        for (const auto &it : idMap.at(type))
-                        {
-                            if (id < it.first)
-                                break;
-                            if (id <= it.second)
-                                return true;
-                        }
+                        return idMap.at(type).contains(id);
                     }
                     break;
             }
@@ -1259,14 +1279,7 @@ private:
                     return svrUsrs.size();
                 default:
                     if (idMap.count(type) != 0)
-                    {
-                        int n = 0;
-                        for (const auto &it : idMap.at(type))
-                        {
-                            n += (it.second - it.first + 1);
-                        }
-                        return n;
-                    }
+                        return idMap.at(type).size();
                     break;
             }
             return 0;
@@ -1277,16 +1290,7 @@ private:
         {
             out = cids;
             if (idMap.count(BRID_MOB) != 0)
-            {
-                int i;
-                for (const auto &it : idMap.at(BRID_MOB))
-                {
-                    for (i=it.first; i<=it.second; ++i)
-                    {
-                        out.insert(i);
-                    }
-                }
-            }
+                idMap.at(BRID_MOB).getIds(out);
         }
     };
     typedef std::map<int, BranchData> BranchMapT; //key is branch
@@ -1299,6 +1303,13 @@ private:
 #else
     //key is MsgSp::Value::SUBS_TYPE_DISPATCHER/MOBILE
     static RangeMapT sValidClients;
+
+    typedef std::deque<GrpAttChange> GrpAttLogT;
+
+    static const size_t GRP_ATT_LOG_MAX = 100000;
+
+    static long long  sGrpAttSeq; //of the last change
+    static GrpAttLogT sGrpAttLog; //the latest changes
 #endif //SERVERAPP
 
     static BranchMapT sBranchMap;
@@ -1324,6 +1335,20 @@ private:
      */
     static void processMonMsg(MsgSp *msg);
 
+    /**
+     * Adds an ISSI to or removes it from a group attachment list.
+     * On client, a resulting change in the combined confirmed and unconfirmed
+     * attachments is logged for getGrpAttChanges().
+     * Caller must be holding sDataLock.
+     *
+     * @param[in] type   SUBS_GSSI_ATTACH_LIST or SUBS_GSSI_ATTACH_LIST_UNC.
+     * @param[in] gssi   The GSSI.
+     * @param[in] issi   The ISSI.
+     * @param[in] attach true to add.
+     * @return true if the list changed.
+     */
+    static bool grpAttUpdate(int type, int gssi, int issi, bool attach);
+
     /**
      * Gets the total size of Subscriber data lists of a given type. E.g. the
      * total number of divisions across all VPNs, or the total number of
@@ -1434,23 +1459,6 @@ private:
      */
     static std::string getIssiDesc(int issi);
 
-    /**
-     * Removes a range of IDs from a data range map.
-     *
-     * @param[in]     min  Range start.
-     * @param[in]     max  Range end.
-     * @param[in,out] data The data map.
-     */
-    static void removeBranchRange(int min, int max, Int2IntMapT &data);
-
-    /**
-     * Collects all IDs from a data range map.
-     *
-     * @param[in]  data The data map.
-     * @param[out] ids  The IDs.
-     */
-    static void branchRangeToIds(const Int2IntMapT &data, IdSetT &ids);
-
     /**
      * Gets the number of IDs in a branch.
      * Caller must be holding sDataLock.
@@ -1541,26 +1549,5 @@ private:
      */
     static void getGrpNames(const IdSetT &gssis, Ssi2DescMapT &groups);
 #endif //SERVERAPP
-
-    /**
-     * Parses a string of space-separated ID ranges into a data range map.
-     * A range can be a single value or "<start>-<end>":
-     *     id1 id2-id3 id4-id5 ...
-     * Map key is the range start, and the value is the range end.
-     *
-     * @param[in]  str  The input string.
-     * @param[out] data The map.
-     * @return true if output not empty.
-     */
-    static bool parseBranchRanges(const std::string &str, Int2IntMapT &data);
-
-    /**
-     * Adds a range of IDs into a data range map.
-     *
-     * @param[in]     min  Range start.
-     * @param[in]     max  Range end.
-     * @param[in,out] data The data map.
-     */
-    static void addBranchRange(int min, int max, Int2IntMapT &data);
 };
 #endif //SUBSDATA_H
@@ -0,0 +1,681 @@
+/**
+ * Streaming table writer implementation.
+ *
+ * Copyright (C) Sapura Secured Technologies, 2026. All Rights Reserved.
+ *
+ * @file
+ * @version $Id$
+ * @author agent <agent@local>
+ */
+#include <QDateTime>
+#include <QObject>
+#include <QRegularExpression>
+
+#include "TableWriter.h"
+
+static const int        CHUNK_SIZE      = 65536;
+static const int        MAX_SHEET_NAME  = 31;
+static const int        HEADING_COLS    = 5;  //merged across A:E
+static const int        ROW_HEIGHT      = 15; //points
+static const quint32    ZIP_LOCAL_SIG   = 0x04034B50;
+static const quint32    ZIP_CENTRAL_SIG = 0x02014B50;
+static const quint32    ZIP_END_SIG     = 0x06054B50;
+static const quint16    ZIP_VERSION     = 20;
+static const quint16    ZIP_FLAG_UTF8   = 0x0800;
+static const QByteArray XML_DECL("<?xml version=\"1.0\" encoding=\"UTF-8\" "
+                                 "standalone=\"yes\"?>\r\n");
+static const QByteArray XMLNS_MAIN("http://schemas.openxmlformats.org/"
+                                   "spreadsheetml/2006/main");
+static const QByteArray XMLNS_REL("http://schemas.openxmlformats.org/"
+                                  "officeDocument/2006/relationships");
+static const QByteArray CONTENT_TYPE("application/vnd.openxmlformats-"
+                                     "officedocument.spreadsheetml.");
+
+static inline void putU16(QByteArray &ba, quint16 val)
+{
+    ba.append(char(val & 0xFF)).append(char(val >> 8));
+}
+
+static inline void putU32(QByteArray &ba, quint32 val)
+{
+    putU16(ba, val & 0xFFFF);
+    putU16(ba, val >> 16);
+}
+
+TableWriter::TableWriter(int format) :
+mFormat(format), mRow(0), mDataRow(0), mDosTime(0), mDosDate(0),
+mSheetData(0), mSharedCount(0)
+{
+    mZipEntry.crc = 0;
+    mZipEntry.size = 0;
+    mZipEntry.offset = 0;
+}
+
+TableWriter::~TableWriter()
+{
+    if (mFile.isOpen())
+        abort();
+    delete mSheetData;
+}
+
+bool TableWriter::open(const QString &filename)
+{
+    mFile.setFileName(filename);
+    if (!mFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        mError = mFile.errorString();
+        return false;
+    }
+    QDateTime dt(QDateTime::currentDateTime());
+    mDosTime = (dt.time().hour() << 11) | (dt.time().minute() << 5) |
+               (dt.time().second() / 2);
+    mDosDate = ((dt.date().year() - 1980) << 9) | (dt.date().month() << 5) |
+               dt.date().day();
+    //UTF-8 BOM for Excel to recognize the encoding
+    if (mFormat == FORMAT_CSV)
+        return write(&mFile, QByteArray("\xEF\xBB\xBF"));
+    return true;
+}
+
+bool TableWriter::beginTable(const QString     &name,
+                             const QStringList &headings,
+                             const QStringList &cols)
+{
+    if (!mError.isEmpty())
+        return false;
+    mHeadings = headings;
+    mCols = cols;
+    if (mFormat == FORMAT_CSV)
+    {
+        QByteArray data;
+        if (!mSheetNames.isEmpty())
+            data.append("\r\n");
+        mSheetNames << name;
+        if (!name.isEmpty())
+            data.append(toCsv(name)).append("\r\n");
+        for (const auto &s : cols)
+        {
+            data.append(toCsv(s)).append(',');
+        }
+        data.chop(1);
+        mRow = 0;
+        return write(&mFile, data.append("\r\n"));
+    }
+    //worksheet name must be unique, without certain characters
+    QString nm(name);
+    nm.remove(QRegularExpression("[\\[\\]:*?/\\\\]"));
+    nm = nm.trimmed().left(MAX_SHEET_NAME);
+    if (nm.isEmpty())
+        nm = QString("Sheet%1").arg(mSheetNames.size() + 1);
+    QString s(nm);
+    int i = 1;
+    while (mSheetNames.contains(s, Qt::CaseInsensitive))
+    {
+        QString sfx(QString(" (%1)").arg(++i));
+        s = nm.left(MAX_SHEET_NAME - sfx.size()) + sfx;
+    }
+    mSheetNames << s;
+    delete mSheetData;
+    mSheetData = new QTemporaryFile();
+    if (!mSheetData->open())
+    {
+        mError = mSheetData->errorString();
+        return false;
+    }
+    mColWidths.clear();
+    for (const auto &c : cols)
+    {
+        mColWidths.push_back(c.size());
+    }
+    //headings, blank row for row count, column names, then data
+    mDataRow = headings.size() + 4;
+    mRow = mDataRow - 1;
+    return true;
+}
+
+bool TableWriter::addRow(const QStringList &row)
+{
+    if (!mError.isEmpty())
+        return false;
+    ++mRow;
+    QByteArray data;
+    if (mFormat == FORMAT_CSV)
+    {
+        for (const auto &s : row)
+        {
+            data.append(toCsv(s)).append(',');
+        }
+        data.chop(1);
+        return write(&mFile, data.append("\r\n"));
+    }
+    data.append("<row r=\"").append(QByteArray::number(mRow)).append("\">");
+    int col = 0;
+    int len;
+    for (const auto &s : row)
+    {
+        if (++col > mColWidths.size())
+            mColWidths.push_back(0);
+        if (s.isEmpty())
+            continue;
+        data.append(getCell(mRow, col, s, STYLE_NORMAL));
+        //width of longest line
+        len = 0;
+        for (const auto &c : s)
+        {
+            if (c == '\n')
+            {
+                len = 0;
+                continue;
+            }
+            if (++len > mColWidths[col - 1])
+                mColWidths[col - 1] = len;
+        }
+    }
+    return write(mSheetData, data.append("</row>"));
+}
+
+bool TableWriter::endTable()
+{
+    if (!mError.isEmpty())
+        return false;
+    if (mFormat == FORMAT_CSV)
+        return true;
+    if (mSheetData == 0 ||
+        !zipBegin(QString("xl/worksheets/sheet%1.xml")
+                  .arg(mSheetNames.size())))
+        return false;
+    QByteArray data(XML_DECL);
+    data.append("<worksheet xmlns=\"").append(XMLNS_MAIN).append("\">");
+    int col;
+    if (!mColWidths.isEmpty())
+    {
+        data.append("<cols>");
+        for (col=1; col<=mColWidths.size(); ++col)
+        {
+            data.append(QString("<col min=\"%1\" max=\"%1\" width=\"%2\" "
+                                "customWidth=\"1\"/>")
+                        .arg(col)
+                        .arg(qMin(mColWidths[col - 1], int(MAX_COL_WIDTH)) + 2)
+                        .toLatin1());
+        }
+        data.append("</cols>");
+    }
+    data.append("<sheetData>");
+    //headings - organization, application, title, description
+    int row = 0;
+    int n;
+    int style;
+    for (const auto &s : mHeadings)
+    {
+        ++row;
+        data.append("<row r=\"").append(QByteArray::number(row)).append('"');
+        n = s.count('\n');
+        if (n != 0)
+            data.append(" ht=\"")
+                .append(QByteArray::number((n + 1) * ROW_HEIGHT))
+                .append("\" customHeight=\"1\"");
+        switch (row)
+        {
+            case 1:
+            case 3:
+                style = STYLE_BOLD;
+                break;
+            case 2:
+                style = STYLE_ITALIC;
+                break;
+            default:
+                style = STYLE_BOLD_WRAP;
+                break;
+        }
+        data.append('>').append(getCell(row, 1, s, style)).append("</row>");
+    }
+    //row count, then column names
+    row = mDataRow - 2;
+    data.append("<row r=\"").append(QByteArray::number(row))
+        .append("\"><c r=\"").append(getCellRef(row, 1)).append("\" s=\"")
+        .append(QByteArray::number(STYLE_LEFT)).append("\"><v>")
+        .append(QByteArray::number(mRow - mDataRow + 1))
+        .append("</v></c></row>");
+    ++row;
+    data.append("<row r=\"").append(QByteArray::number(row)).append("\">");
+    col = 0;
+    for (const auto &s : mCols)
+    {
+        data.append(getCell(row, ++col, s, STYLE_COLUMN));
+    }
+    if (!zipWrite(data.append("</row>")))
+        return false;
+    if (!mSheetData->flush() || !mSheetData->seek(0))
+    {
+        mError = mSheetData->errorString();
+        return false;
+    }
+    while (!mSheetData->atEnd())
+    {
+        data = mSheetData->read(CHUNK_SIZE);
+        if (data.isEmpty())
+        {
+            mError = mSheetData->errorString();
+            return false;
+        }
+        if (!zipWrite(data))
+            return false;
+    }
+    delete mSheetData;
+    mSheetData = 0;
+    data = "</sheetData>";
+    if (!mHeadings.isEmpty())
+    {
+        data.append("<mergeCells count=\"")
+            .append(QByteArray::number(mHeadings.size())).append("\">");
+        for (row=1; row<=mHeadings.size(); ++row)
+        {
+            data.append("<mergeCell ref=\"").append(getCellRef(row, 1))
+                .append(':').append(getCellRef(row, HEADING_COLS))
+                .append("\"/>");
+        }
+        data.append("</mergeCells>");
+    }
+    return (zipWrite(data.append("</worksheet>")) && zipEnd());
+}
+
+bool TableWriter::close()
+{
+    if (!mError.isEmpty() || !mFile.isOpen())
+        return false;
+    if (mFormat == FORMAT_XLSX)
+    {
+        //a workbook must have at least one worksheet
+        if (mSheetNames.isEmpty() &&
+            (!beginTable("", QStringList(), QStringList()) || !endTable()))
+            return false;
+        int n = mSheetNames.size();
+        int i;
+        QByteArray data(XML_DECL);
+        data.append("<Types xmlns=\"http://schemas.openxmlformats.org/"
+                    "package/2006/content-types\">"
+                    "<Default Extension=\"rels\" ContentType=\""
+                    "application/vnd.openxmlformats-package.relationships"
+                    "+xml\"/>"
+                    "<Default Extension=\"xml\" ContentType=\""
+                    "application/xml\"/>"
+                    "<Override PartName=\"/xl/workbook.xml\" ContentType=\"")
+            .append(CONTENT_TYPE).append("sheet.main+xml\"/>");
+        for (i=1; i<=n; ++i)
+        {
+            data.append("<Override PartName=\"/xl/worksheets/sheet")
+                .append(QByteArray::number(i))
+                .append(".xml\" ContentType=\"").append(CONTENT_TYPE)
+                .append("worksheet+xml\"/>");
+        }
+        data.append("<Override PartName=\"/xl/styles.xml\" ContentType=\"")
+            .append(CONTENT_TYPE).append("styles+xml\"/>"
+                    "<Override PartName=\"/xl/sharedStrings.xml\" "
+                    "ContentType=\"").append(CONTENT_TYPE)
+            .append("sharedStrings+xml\"/></Types>");
+        if (!zipAdd("[Content_Types].xml", data))
+            return false;
+        data = XML_DECL;
+        data.append("<Relationships xmlns=\"http://schemas.openxmlformats.org/"
+                    "package/2006/relationships\"><Relationship Id=\"rId1\" "
+                    "Type=\"").append(XMLNS_REL)
+            .append("/officeDocument\" Target=\"xl/workbook.xml\"/>"
+                    "</Relationships>");
+        if (!zipAdd("_rels/.rels", data))
+            return false;
+        data = XML_DECL;
+        data.append("<workbook xmlns=\"").append(XMLNS_MAIN)
+            .append("\" xmlns:r=\"").append(XMLNS_REL).append("\"><sheets>");
+        for (i=1; i<=n; ++i)
+        {
+            data.append("<sheet name=\"").append(toXml(mSheetNames[i - 1]))
+                .append("\" sheetId=\"").append(QByteArray::number(i))
+                .append("\" r:id=\"rId").append(QByteArray::number(i))
+                .append("\"/>");
+        }
+        if (!zipAdd("xl/workbook.xml", data.append("</sheets></workbook>")))
+            return false;
+        data = XML_DECL;
+        data.append("<Relationships xmlns=\"http://schemas.openxmlformats.org/"
+                    "package/2006/relationships\">");
+        for (i=1; i<=n; ++i)
+        {
+            data.append("<Relationship Id=\"rId")
+                .append(QByteArray::number(i)).append("\" Type=\"")
+                .append(XMLNS_REL).append("/worksheet\" Target=\"worksheets/"
+                                          "sheet")
+                .append(QByteArray::number(i)).append(".xml\"/>");
+        }
+        data.append("<Relationship Id=\"rId").append(QByteArray::number(n + 1))
+            .append("\" Type=\"").append(XMLNS_REL)
+            .append("/styles\" Target=\"styles.xml\"/><Relationship Id=\"rId")
+            .append(QByteArray::number(n + 2)).append("\" Type=\"")
+            .append(XMLNS_REL).append("/sharedStrings\" "
+                                      "Target=\"sharedStrings.xml\"/>"
+                                      "</Relationships>");
+        if (!zipAdd("xl/_rels/workbook.xml.rels", data))
+            return false;
+        //fonts - normal, bold, italic, bold white
+        //fills - none, gray125 (reserved), dark gray
+        //cellXfs in eStyle order, all top-aligned
+        data = XML_DECL;
+        data.append("<styleSheet xmlns=\"").append(XMLNS_MAIN)
+            .append("\"><fonts count=\"4\">"
+                    "<font><sz val=\"11\"/><name val=\"Calibri\"/></font>"
+                    "<font><b/><sz val=\"11\"/><name val=\"Calibri\"/></font>"
+                    "<font><i/><sz val=\"11\"/><name val=\"Calibri\"/></font>"
+                    "<font><b/><sz val=\"11\"/><color rgb=\"FFFFFFFF\"/>"
+                    "<name val=\"Calibri\"/></font></fonts>"
+                    "<fills count=\"3\">"
+                    "<fill><patternFill patternType=\"none\"/></fill>"
+                    "<fill><patternFill patternType=\"gray125\"/></fill>"
+                    "<fill><patternFill patternType=\"solid\">"
+                    "<fgColor rgb=\"FF808080\"/><bgColor indexed=\"64\"/>"
+                    "</patternFill></fill></fills>"
+                    "<borders count=\"1\"><border><left/><right/><top/>"
+                    "<bottom/><diagonal/></border></borders>"
+                    "<cellStyleXfs count=\"1\"><xf numFmtId=\"0\" "
+                    "fontId=\"0\" fillId=\"0\" borderId=\"0\"/></cellStyleXfs>"
+                    "<cellXfs count=\"7\">"
+                    "<xf numFmtId=\"0\" fontId=\"0\" fillId=\"0\" "
+                    "borderId=\"0\" xfId=\"0\" applyAlignment=\"1\">"
+                    "<alignment vertical=\"top\"/></xf>"
+                    "<xf numFmtId=\"0\" fontId=\"1\" fillId=\"0\" "
+                    "borderId=\"0\" xfId=\"0\" applyFont=\"1\" "
+                    "applyAlignment=\"1\"><alignment vertical=\"top\"/></xf>"
+                    "<xf numFmtId=\"0\" fontId=\"2\" fillId=\"0\" "
+                    "borderId=\"0\" xfId=\"0\" applyFont=\"1\" "
+                    "applyAlignment=\"1\"><alignment vertical=\"top\"/></xf>"
+                    "<xf numFmtId=\"0\" fontId=\"3\" fillId=\"2\" "
+                    "borderId=\"0\" xfId=\"0\" applyFont=\"1\" "
+                    "applyFill=\"1\" applyAlignment=\"1\">"
+                    "<alignment vertical=\"top\"/></xf>"
+                    "<xf numFmtId=\"0\" fontId=\"0\" fillId=\"0\" "
+                    "borderId=\"0\" xfId=\"0\" applyAlignment=\"1\">"
+                    "<alignment vertical=\"top\" wrapText=\"1\"/></xf>"
+                    "<xf numFmtId=\"0\" fontId=\"1\" fillId=\"0\" "
+                    "borderId=\"0\" xfId=\"0\" applyFont=\"1\" "
+                    "applyAlignment=\"1\">"
+                    "<alignment vertical=\"top\" wrapText=\"1\"/></xf>"
+                    "<xf numFmtId=\"0\" fontId=\"0\" fillId=\"0\" "
+                    "borderId=\"0\" xfId=\"0\" applyAlignment=\"1\">"
+                    "<alignment horizontal=\"left\" vertical=\"top\"/></xf>"
+                    "</cellXfs><cellStyles count=\"1\"><cellStyle "
+                    "name=\"Normal\" xfId=\"0\" builtinId=\"0\"/>"
+                    "</cellStyles></styleSheet>");
+        if (!zipAdd("xl/styles.xml", data))
+            return false;
+        data = XML_DECL;
+        data.append("<sst xmlns=\"").append(XMLNS_MAIN).append("\" count=\"")
+            .append(QByteArray::number(mSharedCount))
+            .append("\" uniqueCount=\"")
+            .append(QByteArray::number(mShared.size())).append("\">");
+        if (!zipBegin("xl/sharedStrings.xml"))
+            return false;
+        for (const auto &s : mShared)
+        {
+            data.append("<si><t xml:space=\"preserve\">").append(toXml(s))
+                .append("</t></si>");
+            if (data.size() >= CHUNK_SIZE)
+            {
+                if (!zipWrite(data))
+                    return false;
+                data.clear();
+            }
+        }
+        if (!zipWrite(data.append("</sst>")) || !zipEnd())
+            return false;
+        //central directory
+        quint32 cdOffset = mFile.pos();
+        for (const auto &e : mZipEntries)
+        {
+            data.clear();
+            putU32(data, ZIP_CENTRAL_SIG);
+            putU16(data, ZIP_VERSION); //made by
+            putU16(data, ZIP_VERSION); //needed to extract
+            putU16(data, ZIP_FLAG_UTF8);
+            putU16(data, 0);           //stored
+            putU16(data, mDosTime);
+            putU16(data, mDosDate);
+            putU32(data, e.crc);
+            putU32(data, e.size);      //compressed
+            putU32(data, e.size);
+            putU16(data, e.name.size());
+            putU16(data, 0);           //extra field length
+            putU16(data, 0);           //comment length
+            putU16(data, 0);           //disk number
+            putU16(data, 0);           //internal attributes
+            putU32(data, 0);           //external attributes
+            putU32(data, e.offset);
+            if (!write(&mFile, data.append(e.name)))
+                return false;
+        }
+        if (mFile.pos() > 0xFFFFFFFFLL)
+        {
+            mError = QObject::tr("File too large");
+            return false;
+        }
+        data.clear();
+        putU32(data, ZIP_END_SIG);
+        putU16(data, 0);               //disk number
+        putU16(data, 0);               //disk with central directory
+        putU16(data, mZipEntries.size());
+        putU16(data, mZipEntries.size());
+        putU32(data, quint32(mFile.pos()) - cdOffset);
+        putU32(data, cdOffset);
+        putU16(data, 0);               //comment length
+        if (!write(&mFile, data))
+            return false;
+    }
+    if (!mFile.flush())
+    {
+        mError = mFile.errorString();
+        return false;
+    }
+    mFile.close();
+    return true;
+}
+
+void TableWriter::abort()
+{
+    mFile.close();
+    mFile.remove();
+    delete mSheetData;
+    mSheetData = 0;
+}
+
+bool TableWriter::write(QIODevice *dev, const QByteArray &data)
+{
+    if (dev->write(data) == data.size())
+        return true;
+    mError = dev->errorString();
+    return false;
+}
+
+QByteArray TableWriter::toCsv(const QString &val)
+{
+    if (val.isEmpty())
+        return QByteArray();
+    if (!val.contains(',') && !val.contains('"') && !val.contains('\n') &&
+        !val.contains('\r') && !val.front().isSpace() &&
+        !val.back().isSpace())
+        return val.toUtf8();
+    QString s(val);
+    return '"' + s.replace('"', "\"\"").toUtf8() + '"';
+}
+
+QByteArray TableWriter::toXml(const QString &val)
+{
+    QString s;
+    s.reserve(val.size());
+    for (const auto &c : val)
+    {
+        switch (c.unicode())
+        {
+            case '&':
+                s.append("&amp;");
+                break;
+            case '<':
+                s.append("&lt;");
+                break;
+            case '>':
+                s.append("&gt;");
+                break;
+            case '"':
+                s.append("&quot;");
+                break;
+            case '\t':
+            case '\n':
+            case '\r':
+                s.append(c);
+                break;
+            case 0xFFFE:
+            case 0xFFFF:
+                break; //not allowed in XML
+            default:
+                if (c.unicode() >= 0x20)
+                    s.append(c);
+                break;
+        }
+    }
+    return s.toUtf8();
+}
+
+QByteArray TableWriter::getCellRef(int row, int col)
+{
+    QByteArray ref;
+    for (; col>0; col=(col - 1)/26)
+    {
+        ref.prepend(char('A' + (col - 1) % 26));
+    }
+    return ref.append(QByteArray::number(row));
+}
+
+QByteArray TableWriter::getCell(int            row,
+                                int            col,
+                                const QString &val,
+                                int            style)
+{
+    QByteArray cell("<c r=\"");
+    cell.append(getCellRef(row, col)).append('"');
+    if (style != STYLE_NORMAL)
+        cell.append(" s=\"").append(QByteArray::number(style)).append('"');
+    if (val.size() <= MAX_SHARED_LEN)
+    {
+        int idx = -1;
+        auto it = mSharedIdx.constFind(val);
+        if (it != mSharedIdx.constEnd())
+        {
+            idx = it.value();
+        }
+        else if (mShared.size() < MAX_SHARED_COUNT)
+        {
+            idx = mShared.size();
+            mSharedIdx.insert(val, idx);
+            mShared << val;
+        }
+        if (idx >= 0)
+        {
+            ++mSharedCount;
+            return cell.append(" t=\"s\"><v>").append(QByteArray::number(idx))
+                       .append("</v></c>");
+        }
+    }
+    return cell.append(" t=\"inlineStr\"><is><t xml:space=\"preserve\">")
+               .append(toXml(val)).append("</t></is></c>");
+}
+
+bool TableWriter::zipBegin(const QString &name)
+{
+    //ZIP64 not supported
+    if (mFile.pos() > 0xFFFFFFFFLL)
+    {
+        mError = QObject::tr("File too large");
+        return false;
+    }
+    mZipEntry.name = name.toUtf8();
+    mZipEntry.crc = 0;
+    mZipEntry.size = 0;
+    mZipEntry.offset = mFile.pos();
+    //CRC and sizes are set in zipEnd()
+    QByteArray data;
+    putU32(data, ZIP_LOCAL_SIG);
+    putU16(data, ZIP_VERSION);
+    putU16(data, ZIP_FLAG_UTF8);
+    putU16(data, 0);                   //stored
+    putU16(data, mDosTime);
+    putU16(data, mDosDate);
+    putU32(data, 0);                   //CRC
+    putU32(data, 0);                   //compressed size
+    putU32(data, 0);                   //size
+    putU16(data, mZipEntry.name.size());
+    putU16(data, 0);                   //extra field length
+    return write(&mFile, data.append(mZipEntry.name));
+}
+
+bool TableWriter::zipWrite(const QByteArray &data)
+{
+    if (quint64(mZipEntry.size) + data.size() > 0xFFFFFFFFULL)
+    {
+        mError = QObject::tr("File too large");
+        return false;
+    }
+    mZipEntry.crc = crc32(mZipEntry.crc, data);
+    mZipEntry.size += data.size();
+    return write(&mFile, data);
+}
+
+bool TableWriter::zipEnd()
+{
+    qint64 pos = mFile.pos();
+    QByteArray data;
+    putU32(data, mZipEntry.crc);
+    putU32(data, mZipEntry.size);
+    putU32(data, mZipEntry.size);
+    //offset of CRC in local header
+    if (!mFile.seek(mZipEntry.offset + 14) || !write(&mFile, data) ||
+        !mFile.seek(pos))
+    {
+        if (mError.isEmpty())
+            mError = mFile.errorString();
+        return false;
+    }
+    mZipEntries.push_back(mZipEntry);
+    return true;
+}
+
+bool TableWriter::zipAdd(const QString &name, const QByteArray &data)
+{
+    return (zipBegin(name) && zipWrite(data) && zipEnd());
+}
+
+quint32 TableWriter::crc32(quint32 crc, const QByteArray &data)
+{
+    static const struct CrcTable
+    {
+        CrcTable()
+        {
+            quint32 c;
+            int     i;
+            int     j;
+            for (i=0; i<256; ++i)
+            {
+                c = i;
+                for (j=0; j<8; ++j)
+                {
+                    c = (c & 1)? (0xEDB88320 ^ (c >> 1)): (c >> 1);
+                }
+                val[i] = c;
+            }
+        }
+
+        quint32 val[256];
+    } tbl;
+
+    crc = ~crc;
+    for (auto b : data)
+    {
+        crc = tbl.val[(crc ^ quint8(b)) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
@@ -0,0 +1,234 @@
+/**
+ * Streaming writer for table exports in Excel (XLSX) or CSV format.
+ * Rows are written out as they are added, so memory use does not depend on
+ * the number of rows. For XLSX, the data of each worksheet goes to a
+ * temporary file until the worksheet ends, and the workbook is packaged with
+ * uncompressed ZIP entries. Short repeated strings go to the shared strings
+ * table up to a limit, and other strings are written inline.
+ * Not thread-safe, but may be used in any thread.
+ *
+ * Copyright (C) Sapura Secured Technologies, 2026. All Rights Reserved.
+ *
+ * @file
+ * @version $Id$
+ * @author agent <agent@local>
+ */
+#ifndef TABLEWRITER_H
+#define TABLEWRITER_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QTemporaryFile>
+#include <QVector>
+
+class TableWriter
+{
+public:
+    enum eFormat
+    {
+        FORMAT_CSV,
+        FORMAT_XLSX
+    };
+
+    /**
+     * Constructor.
+     *
+     * @param[in] format eFormat.
+     */
+    explicit TableWriter(int format);
+
+    /**
+     * Destructor. Aborts if not closed.
+     */
+    ~TableWriter();
+
+    /**
+     * Creates the output file.
+     *
+     * @param[in] filename The file path.
+     * @return true if successful.
+     */
+    bool open(const QString &filename);
+
+    /**
+     * Begins a table, in a new worksheet for XLSX.
+     * For XLSX, the heading lines are written in the first rows, followed
+     * by the row count and the column names. For CSV, only the table name,
+     * if any, and the column names are written.
+     *
+     * @param[in] name     The table name, used as the worksheet name.
+     * @param[in] headings The heading lines - organization (bold),
+     *                     application and timestamp (italic), title (bold)
+     *                     and optional description (bold).
+     * @param[in] cols     The column names.
+     * @return true if successful.
+     */
+    bool beginTable(const QString     &name,
+                    const QStringList &headings,
+                    const QStringList &cols);
+
+    /**
+     * Adds a row to the current table.
+     *
+     * @param[in] row The cell values.
+     * @return true if successful.
+     */
+    bool addRow(const QStringList &row);
+
+    /**
+     * Ends the current table.
+     *
+     * @return true if successful.
+     */
+    bool endTable();
+
+    /**
+     * Completes and closes the file.
+     *
+     * @return true if successful.
+     */
+    bool close();
+
+    /**
+     * Closes and deletes the file.
+     */
+    void abort();
+
+    const QString &getError() const { return mError; }
+
+private:
+    //cell styles, in the order of cellXfs in styles.xml
+    enum eStyle
+    {
+        STYLE_NORMAL,
+        STYLE_BOLD,
+        STYLE_ITALIC,
+        STYLE_COLUMN,
+        STYLE_WRAP,
+        STYLE_BOLD_WRAP,
+        STYLE_LEFT
+    };
+
+    struct ZipEntryT
+    {
+        QByteArray name;
+        quint32    crc;
+        quint32    size;
+        quint32    offset;   //of local header
+    };
+
+    //strings longer than this are written inline
+    static const int MAX_SHARED_LEN   = 64;
+    static const int MAX_SHARED_COUNT = 100000;
+    static const int MAX_COL_WIDTH    = 80;
+
+    int                     mFormat;
+    int                     mRow;         //1-based, last written row
+    int                     mDataRow;     //1-based, first data row
+    quint16                 mDosTime;     //ZIP entry timestamp
+    quint16                 mDosDate;
+    QString                 mError;
+    QFile                   mFile;
+    QTemporaryFile         *mSheetData;   //XLSX rows of current sheet
+    QStringList             mHeadings;    //of current table
+    QStringList             mCols;
+    QVector<int>            mColWidths;
+    QStringList             mSheetNames;
+    QHash<QString, int>     mSharedIdx;   //value is index in mShared
+    QStringList             mShared;
+    int                     mSharedCount; //number of references
+    QVector<ZipEntryT>      mZipEntries;
+    ZipEntryT               mZipEntry;    //current
+
+    /**
+     * Writes the data or sets the error.
+     *
+     * @param[in] dev  The device.
+     * @param[in] data The data.
+     * @return true if successful.
+     */
+    bool write(QIODevice *dev, const QByteArray &data);
+
+    /**
+     * Converts a value to a CSV field.
+     *
+     * @param[in] val The value.
+     * @return The field, quoted if necessary.
+     */
+    static QByteArray toCsv(const QString &val);
+
+    /**
+     * Converts a value to XML text.
+     *
+     * @param[in] val The value.
+     * @return The escaped value, without invalid characters.
+     */
+    static QByteArray toXml(const QString &val);
+
+    /**
+     * Gets the XLSX cell reference.
+     *
+     * @param[in] row The 1-based row.
+     * @param[in] col The 1-based column.
+     * @return The reference, e.g. "B7".
+     */
+    static QByteArray getCellRef(int row, int col);
+
+    /**
+     * Gets the XLSX cell for a string value, adding it to the shared strings
+     * table if applicable.
+     *
+     * @param[in] row   The 1-based row.
+     * @param[in] col   The 1-based column.
+     * @param[in] val   The value.
+     * @param[in] style eStyle.
+     * @return The cell XML.
+     */
+    QByteArray getCell(int row, int col, const QString &val, int style);
+
+    /**
+     * Starts a ZIP entry. Must be followed by zipWrite() calls and
+     * zipEnd().
+     *
+     * @param[in] name The entry name.
+     * @return true if successful.
+     */
+    bool zipBegin(const QString &name);
+
+    /**
+     * Writes data into the current ZIP entry.
+     *
+     * @param[in] data The data.
+     * @return true if successful.
+     */
+    bool zipWrite(const QByteArray &data);
+
+    /**
+     * Ends the current ZIP entry.
+     *
+     * @return true if successful.
+     */
+    bool zipEnd();
+
+    /**
+     * Adds a complete ZIP entry.
+     *
+     * @param[in] name The entry name.
+     * @param[in] data The data.
+     * @return true if successful.
+     */
+    bool zipAdd(const QString &name, const QByteArray &data);
+
+    /**
+     * Calculates a CRC-32.
+     *
+     * @param[in] crc  The CRC of the preceding data, or 0.
+     * @param[in] data The data.
+     * @return The CRC.
+     */
+    static quint32 crc32(quint32 crc, const QByteArray &data);
+};
+#endif //TABLEWRITER_H
@@ -0,0 +1,227 @@
+/**
+ * Image thumbnail cache manager implementation.
+ *
+ * Copyright (C) Sapura Secured Technologies, 2026. All Rights Reserved.
+ *
+ * @file
+ * @version $Id$
+ * @author agent <agent@local>
+ */
+#include <QApplication>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QPointer>
+#include <QStandardPaths>
+#include <QtConcurrent/QtConcurrent>
+
+#include "ThumbnailCache.h"
+
+using namespace std;
+
+ThumbnailCache *ThumbnailCache::sInstance = 0;
+
+ThumbnailCache::ThumbnailCache() :
+QObject(), mScanned(false), mMaxBytes(qint64(DEF_MAX_MB) << 20),
+mTotalSize(0), mSeq(0), mMem(DEF_MAX_MEM_MB << 20)
+{
+    //not at static initialization - the location depends on the
+    //application name
+    mPath = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) +
+            "/mmsThumbs/";
+    mPool.setMaxThreadCount(MAX_THREADS);
+}
+
+ThumbnailCache::~ThumbnailCache()
+{
+    mPool.clear();
+    mPool.waitForDone();
+}
+
+ThumbnailCache &ThumbnailCache::instance()
+{
+    if (sInstance == 0)
+        sInstance = new ThumbnailCache();
+    return *sInstance;
+}
+
+void ThumbnailCache::destroy()
+{
+    delete sInstance;
+    sInstance = 0;
+}
+
+void ThumbnailCache::setQuota(int maxMb, int maxMemMb)
+{
+    mMaxBytes = qint64((maxMb > 0)? maxMb: DEF_MAX_MB) << 20;
+    mMem.setMaxCost(((maxMemMb > 0)? maxMemMb: DEF_MAX_MEM_MB) << 20);
+    if (mScanned)
+        evict();
+}
+
+bool ThumbnailCache::get(const QString &path, int size, QPixmap &pm)
+{
+    QFileInfo fi(path);
+    if (!fi.isFile())
+        return false;
+    SourceT src;
+    src.size = fi.size();
+    src.time = fi.lastModified().toMSecsSinceEpoch();
+    auto it = mSources.find(path);
+    if (it != mSources.end() && it->size == src.size && it->time == src.time)
+    {
+        if (it->hash.isEmpty())
+            return false; //not an image
+        QString key(getKey(it->hash, size));
+        auto *p = mMem.object(key);
+        if (p != 0)
+        {
+            pm = *p;
+            //keep the file from being evicted as least recently used
+            QString fp(mPath + key + ".png");
+            auto eIt = mEntries.constFind(fp);
+            if (eIt != mEntries.constEnd())
+                add(fp, eIt->size);
+            return true;
+        }
+        src.hash = it->hash; //no need to hash again
+    }
+    QString pendingKey(path + "|" + QString::number(size));
+    if (mPending.contains(pendingKey))
+        return false;
+    mPending.insert(pendingKey);
+    QPointer<ThumbnailCache> self(this);
+    QString dir(mPath);
+    QtConcurrent::run(&mPool, [self, dir, path, size, src]
+    {
+        auto *res = new ResultT;
+        res->path = path;
+        res->hash = src.hash;
+        load(dir, size, *res);
+        QMetaObject::invokeMethod(qApp,
+                                  [self, res, size, src]
+                                  {
+                                      if (!self.isNull())
+                                          self->onLoaded(*res, size, src);
+                                      delete res;
+                                  },
+                                  Qt::QueuedConnection);
+    });
+    return false;
+}
+
+QString ThumbnailCache::getKey(const QString &hash, int size)
+{
+    return hash + "_" + QString::number(size);
+}
+
+void ThumbnailCache::load(const QString &dir, int size, ResultT &res)
+{
+    res.fileSize = 0;
+    if (res.hash.isEmpty())
+    {
+        //do not hash a file that is not an image
+        if (QImageReader::imageFormat(res.path).isEmpty())
+            return;
+        QFile file(res.path);
+        QCryptographicHash h(QCryptographicHash::Sha1);
+        if (!file.open(QIODevice::ReadOnly) || !h.addData(&file))
+            return;
+        res.hash = h.result().toHex();
+    }
+    res.filepath = dir + getKey(res.hash, size) + ".png";
+    if (res.img.load(res.filepath, "PNG"))
+    {
+        res.fileSize = QFileInfo(res.filepath).size();
+        return;
+    }
+    QImageReader rdr(res.path);
+    QSize sz(rdr.size());
+    bool scaled = false;
+    if (sz.isValid() && (sz.width() > size || sz.height() > size))
+    {
+        //decode at the thumbnail scale
+        rdr.setScaledSize(sz.scaled(size, size, Qt::KeepAspectRatio));
+        scaled = true;
+    }
+    if (!rdr.read(&res.img))
+    {
+        res.hash.clear();
+        return;
+    }
+    //size unknown before decoding, or scaled size not supported
+    if (!scaled || res.img.width() > size || res.img.height() > size)
+        res.img = res.img.scaled(size, size, Qt::KeepAspectRatio,
+                                 Qt::SmoothTransformation);
+    if (QDir().mkpath(dir) && res.img.save(res.filepath, "PNG"))
+        res.fileSize = QFileInfo(res.filepath).size();
+}
+
+void ThumbnailCache::onLoaded(const ResultT &res, int size, const SourceT &src)
+{
+    mPending.remove(res.path + "|" + QString::number(size));
+    SourceT &s(mSources[res.path]);
+    s = src;
+    s.hash = res.hash;
+    if (res.img.isNull())
+        return;
+    mMem.insert(getKey(res.hash, size), new QPixmap(QPixmap::fromImage(res.img)),
+                res.img.width() * res.img.height() * 4);
+    if (res.fileSize > 0)
+    {
+        scan();
+        add(res.filepath, res.fileSize);
+    }
+    emit ready(res.path, size);
+}
+
+void ThumbnailCache::scan()
+{
+    if (mScanned)
+        return;
+    mScanned = true;
+    QDir dir(mPath);
+    dir.setNameFilters(QStringList() << "*.png");
+    dir.setFilter(QDir::Files);
+    dir.setSorting(QDir::Time | QDir::Reversed); //oldest first
+    for (const auto &fi : dir.entryInfoList())
+    {
+        add(mPath + fi.fileName(), fi.size());
+    }
+}
+
+void ThumbnailCache::add(const QString &filepath, qint64 size)
+{
+    auto it = mEntries.find(filepath);
+    if (it != mEntries.end())
+    {
+        mTotalSize -= it->size;
+        mLru.erase(it->seq);
+    }
+    EntryT &e(mEntries[filepath]);
+    e.size = size;
+    e.seq = ++mSeq;
+    mLru[e.seq] = filepath;
+    mTotalSize += size;
+    evict();
+}
+
+void ThumbnailCache::evict()
+{
+    //keep the most recent thumbnail even if it alone exceeds the quota
+    while (mTotalSize > mMaxBytes && mLru.size() > 1)
+    {
+        auto it = mLru.begin();
+        auto eIt = mEntries.find(it->second);
+        if (eIt != mEntries.end())
+        {
+            mTotalSize -= eIt->size;
+            mEntries.erase(eIt);
+        }
+        QFile::remove(it->second);
+        mLru.erase(it);
+    }
+}
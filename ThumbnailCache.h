@@ -0,0 +1,173 @@
+/**
+ * Image thumbnail cache manager.
+ * Generates thumbnails of local image files in worker threads, decoding
+ * the images directly at the thumbnail scale where the format supports it,
+ * so that a full resolution image is never decoded just for an icon.
+ * Thumbnails are keyed by a hash of the file content, so that copies of the
+ * same file share them and a modified file gets new ones. They are kept in
+ * memory with a cost limit, and in a directory with a size quota, both
+ * evicting the least recently used thumbnails.
+ * Must be used in the GUI thread only.
+ *
+ * Copyright (C) Sapura Secured Technologies, 2026. All Rights Reserved.
+ *
+ * @file
+ * @version $Id$
+ * @author agent <agent@local>
+ */
+#ifndef THUMBNAILCACHE_H
+#define THUMBNAILCACHE_H
+
+#include <map>
+#include <QCache>
+#include <QHash>
+#include <QImage>
+#include <QObject>
+#include <QPixmap>
+#include <QSet>
+#include <QString>
+#include <QThreadPool>
+
+class ThumbnailCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    //thumbnail sizes
+    static const int ICON_SIZE  = 20;
+    static const int IMAGE_SIZE = 300;
+    //defaults for setQuota()
+    static const int DEF_MAX_MB     = 64;
+    static const int DEF_MAX_MEM_MB = 32;
+
+    /**
+     * Instantiates the singleton if it has not been created.
+     *
+     * @return The instance.
+     */
+    static ThumbnailCache &instance();
+
+    /**
+     * Deletes the single instance.
+     */
+    static void destroy();
+
+    /**
+     * Sets the cache quota, and evicts thumbnails beyond it.
+     *
+     * @param[in] maxMb    Maximum total file size in MB. 0 for default.
+     * @param[in] maxMemMb Maximum total memory size in MB. 0 for default.
+     */
+    void setQuota(int maxMb, int maxMemMb = 0);
+
+    /**
+     * Gets a thumbnail from memory. If not there, requests it from a worker
+     * thread, which takes it from the cache directory or generates it, and
+     * emits ready() when done.
+     *
+     * @param[in]  path The image filepath.
+     * @param[in]  size The thumbnail width and height limit, e.g. ICON_SIZE.
+     * @param[out] pm   The thumbnail, if available.
+     * @return true if available, false if not yet, or if the file is not a
+     *         readable image.
+     */
+    bool get(const QString &path, int size, QPixmap &pm);
+
+signals:
+    void ready(const QString &path, int size);
+
+private:
+    //source file identity, to detect modification without hashing again
+    struct SourceT
+    {
+        qint64  size;
+        qint64  time;   //write time, in ms since epoch
+        QString hash;   //empty if not a readable image
+    };
+
+    struct EntryT
+    {
+        qint64  size;
+        quint64 seq;    //last use sequence number
+    };
+
+    struct ResultT
+    {
+        QString path;
+        QString hash;
+        QString filepath;   //thumbnail filepath
+        qint64  fileSize;   //thumbnail file size
+        QImage  img;
+    };
+
+    static const int MAX_THREADS = 2;
+
+    bool                       mScanned;
+    qint64                     mMaxBytes;
+    qint64                     mTotalSize;
+    quint64                    mSeq;        //for LRU
+    QString                    mPath;
+    QHash<QString, SourceT>    mSources;    //key is image filepath
+    QCache<QString, QPixmap>   mMem;        //key is getKey(), cost in bytes
+    QHash<QString, EntryT>     mEntries;    //key is thumbnail filepath
+    std::map<quint64, QString> mLru;        //oldest first, value is filepath
+    QSet<QString>              mPending;    //image filepath and size
+    QThreadPool                mPool;
+
+    static ThumbnailCache *sInstance;
+
+    ThumbnailCache();
+
+    ~ThumbnailCache();
+
+    /**
+     * Gets the key of a thumbnail.
+     *
+     * @param[in] hash The image content hash.
+     * @param[in] size The thumbnail size.
+     * @return The key, also used as the thumbnail filename without suffix.
+     */
+    static QString getKey(const QString &hash, int size);
+
+    /**
+     * Gets a thumbnail from the cache directory or generates it. Runs in a
+     * worker thread.
+     *
+     * @param[in]     dir  The cache directory path, with trailing separator.
+     * @param[in]     size The thumbnail size.
+     * @param[in,out] res  Contains the image filepath, and the content hash
+     *                     if known. The rest is filled in. The image is null
+     *                     on failure.
+     */
+    static void load(const QString &dir, int size, ResultT &res);
+
+    /**
+     * Handles a worker result - stores the thumbnail and emits ready().
+     *
+     * @param[in] res  The result.
+     * @param[in] size The thumbnail size.
+     * @param[in] src  The source file identity when requested.
+     */
+    void onLoaded(const ResultT &res, int size, const SourceT &src);
+
+    /**
+     * Builds the cache index from the cache directory, if not yet done.
+     */
+    void scan();
+
+    /**
+     * Adds a thumbnail to the cache index or marks it as recently used,
+     * and evicts thumbnails beyond the size quota.
+     *
+     * @param[in] filepath The filepath.
+     * @param[in] size     The file size.
+     */
+    void add(const QString &filepath, qint64 size);
+
+    /**
+     * Deletes least recently used thumbnail files until within the size
+     * quota.
+     */
+    void evict();
+};
+#endif //THUMBNAILCACHE_H
@@ -8,8 +8,13 @@
  * @author Rosnin Mustaffa
  */
 #include <assert.h>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QHash>
+#include <QMap>
 
 #include "Md5Digest.h"
+#include "Settings.h"
 #include "ui_Updater.h"
 #include "Version.h"
 #include "Updater.h"
@@ -21,6 +26,16 @@ static const string  LOGPREFIX("Updater:: ");
 static const QString DIR(QStandardPaths::writableLocation(
                                                  QStandardPaths::TempLocation) +
                          "/");
+//manifest filename on server
+static const QString MANIFEST("update.manifest");
+//suffix for partially downloaded file
+static const QString PART_EXT(".part");
+//default maximum concurrent downloads
+static const int     DEF_MAX_DOWNLOADS = 4;
+//maximum attempts for each download job
+static const int     MAX_JOB_TRIES = 3;
+//download inactivity timeout in ms
+static const qint64  TIMEOUT = 90000;
 
 bool     Updater::sIsCreated(false);
 bool     Updater::sLogout(false);
@@ -127,104 +142,26 @@ void Updater::updateApp(bool foreground, MsgSp *msg)
     startDownload();
 }
 
-void Updater::onFinished()
-{
-    bool isMainFile = (mFile != 0 && mFile->fileName() == mMainLocalPath);
-    QNetworkReply::NetworkError err = mReply->error();
-    if (err == QNetworkReply::NoError)
-    {
-        LOGGER_INFO(sLogger, LOGPREFIX << "onFinished:"
-                    << mFile->fileName().toStdString());
-        //file may not be open if already downloaded earlier
-        if (mFile->isOpen())
-        {
-            mFile->flush();
-            mFile->close();
-        }
-        if (isMainFile)
-        {
-            int res = validateMain(true);
-            if (res < 0)
-            {
-                emit finished(mForeground);
-                return;
-            }
-            if (res > 0)
-                --mFileIdx; //retry
-        }
-        delete mFile;
-        mFile = 0;
-        mTimer.stop();
-        mReply->deleteLater();
-        mReply = 0;
-    }
-    else
-    {
-        if (err == QNetworkReply::OperationCanceledError)
-        {
-            LOGGER_INFO(sLogger, LOGPREFIX << "onFinished:"
-                        << "OperationCanceledError\nFile: "
-                        << ((mFile != 0)? mFile->fileName().toStdString(): ""));
-        }
-        else
-        {
-            LOGGER_ERROR(sLogger, LOGPREFIX << "onFinished:"
-                         << mReply->errorString().toStdString() << "\nFile: "
-                         << mReply->url().toString().toStdString());
-            sSkipVersion.clear();
-            if (mForeground)
-                QMessageBox::critical(this, tr("Update Error"),
-                                      tr("Download failed."));
-        }
-        if (mFile != 0)
-        {
-            if (mFile->isOpen())
-            {
-                mFile->close();
-                mFile->remove();
-            }
-            mFile->deleteLater();
-            mFile = 0;
-        }
-        mTimer.stop();
-        mReply->deleteLater();
-        mReply = 0;
-        if (isMainFile)
-        {
-            emit finished(mForeground);
-            return;
-        }
-        //otherwise continue with next file, if any
-    }
-    if (++mFileIdx < mFileList.size())
-    {
-        startDownload();
-    }
-    else if (mForeground)
-    {
-        ui->lblMsg->setText(tr("Click '%1' to begin installation.")
-                            .arg(ui->okButton->text()));
-        ui->lblDownload->setText(tr("Download completed."));
-        ui->okButton->setEnabled(true);
-    }
-    else if (!sLogout)
-    {
-        show();
-    }
-}
-
 Updater::Updater(QWidget *parent) :
-QDialog(parent), ui(new Ui::Updater), mFileIdx(0), mFile(0), mReply(0)
+QDialog(parent), ui(new Ui::Updater), mStopped(false), mBytesTotal(0),
+mBytesDone(0), mManifestReply(0)
 {
     mManager = new QNetworkAccessManager(this);
-    mTimer.setSingleShot(true);
-    mTimer.setInterval(90000); //timeout in 90 seconds
+    mTimer.setInterval(10000);
     connect(&mTimer, &QTimer::timeout, this,
             [this]
             {
-                LOGGER_ERROR(sLogger, LOGPREFIX << "Download timeout for "
-                             << mFile->fileName().toStdString());
-                mReply->abort();
+                qint64 t = QDateTime::currentMSecsSinceEpoch() - TIMEOUT;
+                for (auto j : mJobs)
+                {
+                    if (j->lastActive < t)
+                    {
+                        LOGGER_ERROR(sLogger, LOGPREFIX << "Download timeout "
+                                     "for " << mFiles[j->fileIdx].name
+                                                    .toStdString());
+                        j->reply->abort();
+                    }
+                }
             });
     ui->setupUi(this);
     ui->lblMsg->setWordWrap(true);
@@ -246,9 +183,10 @@ QDialog(parent), ui(new Ui::Updater), mFileIdx(0), mFile(0), mReply(0)
     connect(ui->cancelButton, &QPushButton::clicked, this,
             [this]
             {
-                //cancel upgrade process
-                if (mReply != 0)
-                    mReply->abort();
+                //cancel upgrade process - partial files are kept for
+                //resumption
+                if (!mStopped)
+                    stop();
                 else
                     emit finished(mForeground);
             });
@@ -257,16 +195,19 @@ QDialog(parent), ui(new Ui::Updater), mFileIdx(0), mFile(0), mReply(0)
 Updater::~Updater()
 {
     mTimer.stop();
-    if (mReply != 0)  //app exit while download still in progress
-        mReply->deleteLater();
-    if (mFile != 0)
+    //app exit while download still in progress - partial files are kept for
+    //resumption
+    for (auto j : mJobs)
     {
-        if (mFile->isOpen())
-        {
-            mFile->close();
-            mFile->remove();
-        }
-        delete mFile;
+        j->reply->disconnect(this);
+        j->reply->abort();
+        j->reply->deleteLater();
+    }
+    qDeleteAll(mJobs);
+    qDeleteAll(mJobQueue);
+    for (auto &f : mFiles)
+    {
+        delete f.file;
     }
     delete mManager;
     delete ui;
@@ -296,71 +237,574 @@ bool Updater::start(MsgSp *msg, const QString &extRegExp)
     }
     mMainLocalPath = DIR + mFileList.at(idx);
     mMainDownloadCount = 4;  //maximum attempts
-    mFileIdx = 0;
+    mMaxDownloads = Settings::instance().get<int>(
+                                              Props::FLD_CFG_UPD_MAXDOWNLOADS);
+    if (mMaxDownloads <= 0)
+        mMaxDownloads = DEF_MAX_DOWNLOADS;
     mFilePath = QString::fromStdString(
                                   msg->getFieldString(MsgSp::Field::FILE_PATH));
     if (!mFilePath.endsWith('/'))
         mFilePath.append('/');
     mMainChksum = msg->getFieldString(MsgSp::Field::CHECKSUM);
+    mVersion = QString::fromStdString(
+                                    msg->getFieldString(MsgSp::Field::VERSION));
     return true;
 }
 
 void Updater::startDownload()
 {
-    //set url file path
-    QUrl url(mFilePath + mFileList.at(mFileIdx));
-    //set a file for the download
-    mFile = new QFile(DIR + mFileList.at(mFileIdx));
-    if (mFile->exists() &&
-        (mFile->fileName() != mMainLocalPath || validateMain(false) == 0))
-    {
-        //ensure mReply->error() returns NoError
-        mReply = mManager->head(QNetworkRequest(url));
-        ui->progressBar->setValue(ui->progressBar->maximum());
-        onFinished();
-        return;
+    QNetworkRequest req(QUrl(mFilePath + MANIFEST));
+    req.setSslConfiguration(QSslConfiguration::defaultConfiguration());
+    mManifestReply = mManager->get(req);
+    mManifestReply->ignoreSslErrors();
+    connect(mManifestReply, &QNetworkReply::finished, this,
+            [this]
+            {
+                QNetworkReply *r = mManifestReply;
+                mManifestReply = 0;
+                r->deleteLater();
+                if (mStopped)
+                    return;
+                if (r->error() == QNetworkReply::NoError)
+                {
+                    plan(r->readAll());
+                }
+                else
+                {
+                    //older server without manifest
+                    LOGGER_INFO(sLogger, LOGPREFIX << "startDownload: "
+                                "No manifest, " << r->errorString()
+                                                    .toStdString());
+                    plan(QByteArray());
+                }
+            });
+}
+
+void Updater::plan(const QByteArray &data)
+{
+    //manifest lines indexed by filename
+    QMap<QString, QStringList> manifest;
+    QStringList l;
+    for (const auto &line : QString::fromUtf8(data).split('\n'))
+    {
+        l = line.trimmed().split('\t');
+        if (l.size() == 4 && !l.at(0).startsWith('#'))
+            manifest[l.at(0)] = l;
+    }
+    mFiles.resize(mFileList.size());
+    int i = 0;
+    for (; i<mFileList.size(); ++i)
+    {
+        FileT &f(mFiles[i]);
+        f.name = mFileList.at(i);
+        f.localPath = DIR + f.name;
+        if (manifest.contains(f.name))
+        {
+            l = manifest.value(f.name);
+            f.size = l.at(1).toLongLong();
+            f.chunkSize = l.at(2).toLongLong();
+            f.digests = l.at(3).split(',', QString::SkipEmptyParts);
+            if (f.size < 0 || f.chunkSize <= 0 ||
+                f.digests.size() != (f.size + f.chunkSize - 1)/f.chunkSize)
+            {
+                LOGGER_ERROR(sLogger, LOGPREFIX << "plan: Invalid manifest "
+                             "entry for " << f.name.toStdString());
+                f.size = -1;
+            }
+        }
+        if (!planFile(i, true) || mStopped)
+        {
+            if (mStopped)
+                return;
+            if (f.localPath == mMainLocalPath)
+            {
+                stop();
+                return;
+            }
+            f.done = true; //continue without it
+        }
     }
-    if (!mFile->open(QIODevice::WriteOnly))
+    LOGGER_INFO(sLogger, LOGPREFIX << "plan: " << mJobQueue.size()
+                << " downloads, " << mBytesTotal << " bytes, max concurrent "
+                << mMaxDownloads);
+    mTimer.start();
+    startJobs();
+}
+
+bool Updater::planFile(int idx, bool reuse)
+{
+    FileT &f(mFiles[idx]);
+    bool isMain = (f.localPath == mMainLocalPath);
+    if (reuse && QFile::exists(f.localPath))
     {
-        LOGGER_ERROR(sLogger, LOGPREFIX << "startDownload: Error writing file "
-                     << mFile->fileName().toStdString() << ": "
-                     << mFile->errorString().toStdString());
+        if ((f.size < 0)? (!isMain || validateMain(false) == 0):
+                          isMatching(f, f.localPath))
+        {
+            LOGGER_INFO(sLogger, LOGPREFIX << "planFile: Already downloaded "
+                        << f.name.toStdString());
+            f.done = true;
+            return true;
+        }
+    }
+    //partial file is per version to avoid resuming a different one
+    QString partPath(f.localPath + "_" + mVersion + PART_EXT);
+    if (!reuse)
+        QFile::remove(partPath);
+    //digests of existing content - partial file, then old file
+    std::vector<std::string> partDigests;
+    QHash<QString, qint64> oldChunks; //digest to offset
+    if (f.size >= 0 && reuse)
+    {
+        md5DigestChunks(partPath.toStdString(), f.chunkSize, partDigests);
+        std::vector<std::string> v;
+        if (md5DigestChunks(f.localPath.toStdString(), f.chunkSize, v) > 0)
+        {
+            qint64 offset = 0;
+            for (const auto &d : v)
+            {
+                oldChunks.insert(QString::fromStdString(d), offset);
+                offset += f.chunkSize;
+            }
+        }
+    }
+    delete f.file;
+    f.file = new QFile(partPath);
+    if (!f.file->open(QIODevice::ReadWrite) ||
+        (f.size >= 0 && !f.file->resize(f.size)))
+    {
+        LOGGER_ERROR(sLogger, LOGPREFIX << "planFile: Error writing file "
+                     << partPath.toStdString() << ": "
+                     << f.file->errorString().toStdString());
         if (mForeground)
             QMessageBox::critical(this, tr("Update Error"),
                                   tr("Unable to save file %1: %2.")
-                                      .arg(mFile->fileName(),
-                                           mFile->errorString()));
-        delete mFile;
-        mFile = 0;
-        emit finished(mForeground);
+                                      .arg(partPath, f.file->errorString()));
+        delete f.file;
+        f.file = 0;
+        return false;
+    }
+    if (f.size < 0)
+    {
+        //whole file, resuming from the partial file end
+        auto *j = new JobT(idx, f.file->size(), -1);
+        mJobQueue << j;
+        ++f.jobs;
+        return true;
+    }
+    QFile old(f.localPath);
+    if (!oldChunks.isEmpty())
+        old.open(QIODevice::ReadOnly);
+    qint64 start = 0;
+    qint64 len;
+    int    reused = 0;
+    int    i = 0;
+    for (; i<f.digests.size(); ++i, start+=f.chunkSize)
+    {
+        len = qMin(f.chunkSize, f.size - start);
+        const QString &d(f.digests.at(i));
+        if (size_t(i) < partDigests.size() &&
+            d == QString::fromStdString(partDigests[i]))
+        {
+            ++reused;
+            continue;
+        }
+        auto it = oldChunks.find(d);
+        if (it != oldChunks.end() && old.isOpen() && old.seek(it.value()))
+        {
+            QByteArray data(old.read(len));
+            if (data.size() == len && f.file->seek(start) &&
+                f.file->write(data) == len)
+            {
+                ++reused;
+                continue;
+            }
+        }
+        auto *j = new JobT(idx, start, len);
+        j->hash = new QCryptographicHash(QCryptographicHash::Md5);
+        mJobQueue << j;
+        ++f.jobs;
+        mBytesTotal += len;
+    }
+    LOGGER_INFO(sLogger, LOGPREFIX << "planFile: " << f.name.toStdString()
+                << " chunks " << f.digests.size() << ", reused " << reused);
+    if (f.jobs == 0)
+        completeFile(idx);
+    return true;
+}
+
+void Updater::startJobs()
+{
+    if (mStopped)
         return;
+    while (mJobs.size() < mMaxDownloads && !mJobQueue.isEmpty())
+    {
+        JobT *j = mJobQueue.takeFirst();
+        FileT &f(mFiles[j->fileIdx]);
+        QNetworkRequest req(QUrl(mFilePath + f.name));
+        req.setSslConfiguration(QSslConfiguration::defaultConfiguration());
+        if (j->len > 0)
+            req.setRawHeader("Range", QString("bytes=%1-%2")
+                                          .arg(j->start)
+                                          .arg(j->start + j->len - 1)
+                                          .toLatin1());
+        else if (j->start > 0)
+            req.setRawHeader("Range",
+                             QString("bytes=%1-").arg(j->start).toLatin1());
+        j->pos = j->start;
+        j->end = -1;
+        j->checked = false;
+        j->discard = false;
+        if (j->hash != 0)
+            j->hash->reset();
+        j->lastActive = QDateTime::currentMSecsSinceEpoch();
+        j->reply = mManager->get(req);
+        j->reply->ignoreSslErrors();
+        connect(j->reply, &QNetworkReply::readyRead, this,
+                [this, j] { onJobData(j); });
+        connect(j->reply, &QNetworkReply::finished, this,
+                [this, j] { onJobFinished(j); });
+        mJobs << j;
+        LOGGER_DEBUG(sLogger, LOGPREFIX << "startJobs: "
+                     << f.name.toStdString() << " from " << j->start
+                     << " length " << j->len);
     }
-    LOGGER_INFO(sLogger, LOGPREFIX << "startDownload:"
-                << mFile->fileName().toStdString());
-    QNetworkRequest req(url);
-    req.setSslConfiguration(QSslConfiguration::defaultConfiguration());
-    //post a request to obtain the contents of the target
-    mReply = mManager->get(req);
-    mReply->ignoreSslErrors();
-    connect(mReply, &QNetworkReply::readyRead, this,
-            [this]
+    if (!mJobs.isEmpty())
+        return;
+    for (const auto &f : mFiles)
+    {
+        if (!f.done)
+            return;
+    }
+    mTimer.stop();
+    if (mForeground)
+    {
+        ui->progressBar->setMaximum(100);
+        ui->progressBar->setValue(100);
+        ui->lblMsg->setText(tr("Click '%1' to begin installation.")
+                            .arg(ui->okButton->text()));
+        ui->lblDownload->setText(tr("Download completed."));
+        ui->okButton->setEnabled(true);
+    }
+    else if (!sLogout)
+    {
+        show();
+    }
+}
+
+void Updater::onJobData(JobT *job)
+{
+    FileT &f(mFiles[job->fileIdx]);
+    if (!job->checked)
+    {
+        job->checked = true;
+        int status = job->reply->attribute(
+                            QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        if (status == 200 && (job->start > 0 || job->len > 0))
+        {
+            //server ignored range - take the whole file from this reply
+            LOGGER_INFO(sLogger, LOGPREFIX << "onJobData: No range support, "
+                        "downloading whole " << f.name.toStdString());
+            dropJobs(job->fileIdx, job);
+            if (job->len > 0)
+                mBytesTotal -= job->len;
+            job->start = 0;
+            job->pos = 0;
+            job->len = -1;
+            delete job->hash;
+            job->hash = 0;
+            f.file->resize(0);
+        }
+        if (status == 206)
+        {
+            //Content-Range: bytes <first>-<last>/<size>
+            QByteArray cr(job->reply->rawHeader("Content-Range"));
+            int i = cr.indexOf('-');
+            if (i < 0 || cr.mid(6, i - 6).trimmed().toLongLong() != job->start)
             {
-                mTimer.start();
-                //write the received data into file
-                if (mFile->isOpen())
-                    mFile->write(mReply->readAll());
-            });
-    //for progressBar indicator
-    connect(mReply, &QNetworkReply::downloadProgress, this,
-            [this](qint64 bytesRead, qint64 totalBytes)
+                LOGGER_ERROR(sLogger, LOGPREFIX << "onJobData: Invalid "
+                             "Content-Range '" << cr.toStdString() << "' for "
+                             << f.name.toStdString() << " from "
+                             << job->start);
+                job->discard = true;
+            }
+            else if (job->len < 0)
             {
-                if (totalBytes != 0)
-                {
-                    ui->progressBar->setMaximum(totalBytes);
-                    ui->progressBar->setValue(bytesRead);
-                }
-            });
-    connect(mReply, SIGNAL(finished()), SLOT(onFinished()));
+                bool ok;
+                job->end = cr.mid(cr.indexOf('/') + 1).toLongLong(&ok);
+                if (!ok)
+                    job->end = -1; //'*'
+            }
+        }
+        else if (status == 200)
+        {
+            //the length is of the encoded body if content-encoded
+            QByteArray enc(job->reply->rawHeader("Content-Encoding"));
+            qint64 len = job->reply->header(
+                                QNetworkRequest::ContentLengthHeader)
+                             .toLongLong();
+            if ((enc.isEmpty() || enc == "identity") && len > 0)
+                job->end = len;
+        }
+        else
+        {
+            //error body, or redirection which is not followed - the status
+            //is handled in onJobFinished()
+            job->discard = true;
+        }
+    }
+    if (job->discard)
+    {
+        job->reply->readAll();
+        return;
+    }
+    job->lastActive = QDateTime::currentMSecsSinceEpoch();
+    QByteArray data(job->reply->readAll());
+    if (job->len > 0 && job->pos - job->start + data.size() > job->len)
+        data.truncate(job->len - (job->pos - job->start)); //excess
+    if (!f.file->seek(job->pos) || f.file->write(data) != data.size())
+    {
+        LOGGER_ERROR(sLogger, LOGPREFIX << "onJobData: Error writing file "
+                     << f.file->fileName().toStdString() << ": "
+                     << f.file->errorString().toStdString());
+        job->reply->abort();
+        return;
+    }
+    if (job->hash != 0)
+        job->hash->addData(data);
+    job->pos += data.size();
+    mBytesDone += data.size();
+    if (job->len < 0 && job->pos - job->start == data.size())
+    {
+        //first data of whole file
+        qint64 len = job->reply->header(QNetworkRequest::ContentLengthHeader)
+                         .toLongLong();
+        if (len > 0)
+            mBytesTotal += len;
+    }
+    if (mForeground && mBytesTotal > 0)
+    {
+        ui->progressBar->setMaximum(100);
+        ui->progressBar->setValue(qMin(mBytesDone * 100/mBytesTotal, 100LL));
+    }
+}
+
+void Updater::onJobFinished(JobT *job)
+{
+    mJobs.removeOne(job);
+    QNetworkReply *reply = job->reply;
+    job->reply = 0;
+    reply->deleteLater();
+    if (mStopped)
+    {
+        delete job;
+        return;
+    }
+    FileT &f(mFiles[job->fileIdx]);
+    if (f.file == 0)
+    {
+        //dropped, or file already failed
+        delete job;
+        startJobs();
+        return;
+    }
+    int status =
+            reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    bool ok = (reply->error() == QNetworkReply::NoError && !job->discard &&
+               (status == 200 || status == 206));
+    if (!ok && job->len < 0 && job->start > 0 && status == 416)
+    {
+        //partial file complete if its size is as in
+        //Content-Range: bytes */<size>
+        QByteArray cr(reply->rawHeader("Content-Range"));
+        qint64 size = cr.mid(cr.indexOf('/') + 1).toLongLong();
+        ok = (size > 0 && size == f.file->size());
+        if (!ok)
+        {
+            LOGGER_ERROR(sLogger, LOGPREFIX << "onJobFinished: Partial file "
+                         "size " << f.file->size() << " invalid for "
+                         << f.name.toStdString() << " size " << size
+                         << " - restarting");
+            //retry from the beginning
+            f.file->resize(0);
+            job->start = 0;
+            job->pos = 0;
+        }
+    }
+    else if (!ok)
+    {
+        LOGGER_ERROR(sLogger, LOGPREFIX << "onJobFinished: "
+                     << ((reply->error() == QNetworkReply::NoError)?
+                         QString("HTTP status %1").arg(status):
+                         reply->errorString()).toStdString()
+                     << "\nFile: "
+                     << reply->url().toString().toStdString() << " from "
+                     << job->start);
+    }
+    else if (job->len < 0 && job->end >= 0 && job->pos != job->end)
+    {
+        LOGGER_ERROR(sLogger, LOGPREFIX << "onJobFinished: Incomplete "
+                     "download of " << f.name.toStdString() << ", "
+                     << job->pos << " of " << job->end << " bytes");
+        ok = false;
+    }
+    else if (job->hash != 0 &&
+             (job->pos - job->start != job->len ||
+              f.digests.at(job->start/f.chunkSize) !=
+                  QString::fromLatin1(job->hash->result().toHex())))
+    {
+        LOGGER_ERROR(sLogger, LOGPREFIX << "onJobFinished: Chunk digest "
+                     "failed for " << f.name.toStdString() << " from "
+                     << job->start);
+        ok = false;
+    }
+    if (ok)
+    {
+        int idx = job->fileIdx;
+        delete job;
+        if (--f.jobs == 0)
+            completeFile(idx);
+    }
+    else if (++job->tries < MAX_JOB_TRIES)
+    {
+        if (job->len > 0)
+        {
+            mBytesDone -= job->pos - job->start;
+        }
+        else if (job->checked)
+        {
+            //resume whole file download
+            job->start = job->pos;
+        }
+        mJobQueue << job; //retry
+    }
+    else
+    {
+        int idx = job->fileIdx;
+        delete job;
+        dropJobs(idx, 0);
+        f.jobs = 0;
+        f.done = true;
+        delete f.file; //keep partial file for resumption
+        f.file = 0;
+        if (f.localPath == mMainLocalPath)
+        {
+            sSkipVersion.clear();
+            if (mForeground)
+                QMessageBox::critical(this, tr("Update Error"),
+                                      tr("Download failed."));
+            stop();
+            return;
+        }
+        //otherwise continue with other files
+    }
+    startJobs();
+}
+
+void Updater::completeFile(int idx)
+{
+    FileT &f(mFiles[idx]);
+    f.file->close();
+    QString partPath(f.file->fileName());
+    delete f.file;
+    f.file = 0;
+    bool ok = (f.size < 0 || isMatching(f, partPath));
+    if (ok)
+    {
+        QFile::remove(f.localPath);
+        ok = QFile::rename(partPath, f.localPath);
+    }
+    if (ok && f.localPath == mMainLocalPath)
+    {
+        int res = validateMain(true);
+        if (res < 0)
+        {
+            stop();
+            return;
+        }
+        if (res > 0)
+        {
+            if (!planFile(idx, false))
+                stop();
+            return;
+        }
+    }
+    else if (!ok)
+    {
+        LOGGER_ERROR(sLogger, LOGPREFIX << "completeFile: Failed for "
+                     << f.name.toStdString());
+        QFile::remove(partPath);
+        if (f.localPath == mMainLocalPath)
+        {
+            if (validateMain(true) >= 0 && planFile(idx, false))
+                return;
+            stop();
+            return;
+        }
+    }
+    LOGGER_INFO(sLogger, LOGPREFIX << "completeFile: "
+                << f.localPath.toStdString());
+    f.done = true;
+}
+
+void Updater::stop()
+{
+    mStopped = true;
+    mTimer.stop();
+    if (mManifestReply != 0)
+        mManifestReply->abort();
+    qDeleteAll(mJobQueue);
+    mJobQueue.clear();
+    //aborted jobs are deleted in onJobFinished()
+    for (auto j : mJobs)
+    {
+        j->reply->abort();
+    }
+    emit finished(mForeground);
+}
+
+void Updater::dropJobs(int idx, JobT *except)
+{
+    for (auto it=mJobQueue.begin(); it!=mJobQueue.end(); )
+    {
+        if ((*it)->fileIdx == idx && *it != except)
+        {
+            if ((*it)->len > 0)
+                mBytesTotal -= (*it)->len;
+            delete *it;
+            it = mJobQueue.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    FileT &f(mFiles[idx]);
+    for (auto j : mJobs)
+    {
+        if (j->fileIdx == idx && j != except)
+        {
+            //ignored in onJobFinished()
+            j->reply->disconnect(this);
+            j->reply->abort();
+            j->reply->deleteLater();
+            mBytesDone -= j->pos - j->start;
+            if (j->len > 0)
+                mBytesTotal -= j->len;
+        }
+    }
+    for (auto it=mJobs.begin(); it!=mJobs.end(); )
+    {
+        if ((*it)->fileIdx == idx && *it != except)
+        {
+            delete *it;
+            it = mJobs.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    f.jobs = (except != 0)? 1: 0;
 }
 
 void Updater::runUpdate()
@@ -387,7 +831,7 @@ void Updater::runUpdate()
 
 int Updater::validateMain(bool decrementCount)
 {
-    if (mFile->size() > 15000000) //basic size check
+    if (QFileInfo(mMainLocalPath).size() > 15000000) //basic size check
     {
         if (mMainChksum.empty() ||
             mMainChksum == md5DigestFile(mMainLocalPath.toStdString()))
@@ -398,13 +842,9 @@ int Updater::validateMain(bool decrementCount)
     if (decrementCount && --mMainDownloadCount <= 0)
     {
         LOGGER_ERROR(sLogger, LOGPREFIX << "validateMain: "
-                     << mFile->fileName().toStdString()
+                     << mMainLocalPath.toStdString()
                      << " max failed attempts - aborting");
-        mFile->remove();
-        delete mFile;
-        mFile = 0;
-        mReply->deleteLater();
-        mReply = 0;
+        QFile::remove(mMainLocalPath);
         sSkipVersion.clear();
         if (mForeground)
             QMessageBox::critical(this, tr("Update Error"),
@@ -413,9 +853,25 @@ int Updater::validateMain(bool decrementCount)
         return -1;
     }
     LOGGER_ERROR(sLogger, LOGPREFIX << "validateMain: "
-                 << mFile->fileName().toStdString() << " size=" << mFile->size()
+                 << mMainLocalPath.toStdString() << " size="
+                 << QFileInfo(mMainLocalPath).size()
                  << " - possibly corrupted and deleted - retry "
                  << mMainDownloadCount);
-    mFile->remove();
+    QFile::remove(mMainLocalPath);
     return 1;
 }
+
+bool Updater::isMatching(const FileT &f, const QString &path)
+{
+    std::vector<std::string> v;
+    if (md5DigestChunks(path.toStdString(), f.chunkSize, v) != f.size ||
+        int(v.size()) != f.digests.size())
+        return false;
+    int i = 0;
+    for (const auto &d : v)
+    {
+        if (f.digests.at(i++) != QString::fromStdString(d))
+            return false;
+    }
+    return true;
+}
@@ -1,5 +1,13 @@
 /**
  * Class to download updated file.
+ * Downloads the files concurrently up to a configured limit.
+ * If the server has a manifest of per-file chunk digests, only the chunks
+ * that differ from a previously downloaded or partially downloaded copy are
+ * fetched with HTTP range requests, and each fetched chunk is verified.
+ * Without a manifest, whole files are fetched, resuming a partial download
+ * if the server supports range requests.
+ * Manifest format, one file per line with tab separators:
+ *   <filename> <size> <chunk size> <comma-separated lowercase MD5 digests>
  *
  * Copyright (C) Sapura Secured Technologies, 2019-2025. All Rights Reserved.
  *
@@ -10,6 +18,7 @@
 #ifndef UPDATER_H
 #define UPDATER_H
 
+#include <QCryptographicHash>
 #include <QDialog>
 #include <QDir>
 #include <QFile>
@@ -21,6 +30,7 @@
 #include <QStandardPaths>
 #include <QTimer>
 #include <QUrl>
+#include <QVector>
 
 #include "Logger.h"
 #include "MsgSp.h"
@@ -75,25 +85,62 @@ public:
 signals:
     void finished(bool doExit);
 
-private slots:
-    /**
-     * Handles download finished event.
-     */
-    void onFinished();
-
 private:
+    //a file in the update
+    struct FileT
+    {
+        FileT() : size(-1), chunkSize(0), file(0), jobs(0), done(false) {}
+
+        qint64      size;       //from manifest, -1 if not in manifest
+        qint64      chunkSize;
+        QString     name;
+        QString     localPath;
+        QStringList digests;    //from manifest
+        QFile      *file;       //partial file being written
+        int         jobs;       //queued and active download jobs
+        bool        done;
+    };
+
+    //a download of a file chunk, or a whole file
+    struct JobT
+    {
+        JobT(int f, qint64 s, qint64 l) :
+            fileIdx(f), start(s), len(l), pos(s), end(-1), lastActive(0),
+            tries(0), checked(false), discard(false), reply(0), hash(0) {}
+
+        ~JobT() { delete hash; }
+
+        int                 fileIdx;
+        qint64              start;
+        qint64              len;        //-1 for whole file from start
+        qint64              pos;        //next write position
+        qint64              end;        //whole file size from reply, or -1
+        qint64              lastActive; //last data time in ms since epoch
+        int                 tries;
+        bool                checked;    //reply status checked
+        bool                discard;    //reply body is not file data
+        QNetworkReply      *reply;
+        QCryptographicHash *hash;       //chunk digest, 0 for whole file
+    };
+
     Ui::Updater           *ui;
     int                    mMainDownloadCount;
-    int                    mFileIdx;
+    int                    mMaxDownloads;
     bool                   mForeground;
+    bool                   mStopped;        //cancelled or failed
+    qint64                 mBytesTotal;
+    qint64                 mBytesDone;
     std::string            mMainChksum;
     QString                mMainLocalPath;
+    QString                mVersion;
     QString                mFilePath;
     QStringList            mFileList;       //files to download
-    QTimer                 mTimer;
-    QFile                 *mFile;
+    QTimer                 mTimer;          //timeout checker
+    QVector<FileT>         mFiles;
+    QList<JobT *>          mJobQueue;
+    QList<JobT *>          mJobs;           //active
     QNetworkAccessManager *mManager;
-    QNetworkReply         *mReply;
+    QNetworkReply         *mManifestReply;
 
     static bool            sIsCreated;
     static bool            sLogout;         //true if user logged out
@@ -124,10 +171,73 @@ private:
     bool start(MsgSp *msg, const QString &extRegExp);
 
     /**
-     * Starts downloading one file in the file list as indexed by mFileIdx.
+     * Starts the download by fetching the manifest.
      */
     void startDownload();
 
+    /**
+     * Parses the manifest, if fetched, and plans the download jobs for all
+     * files.
+     *
+     * @param[in] data The manifest content. Empty if not available.
+     */
+    void plan(const QByteArray &data);
+
+    /**
+     * Plans the download jobs for a file. Reuses chunks from a partial
+     * download and the previously downloaded file, so that only differing
+     * chunks are queued.
+     *
+     * @param[in] idx   The file index in mFiles.
+     * @param[in] reuse false to download everything again.
+     * @return false on file error.
+     */
+    bool planFile(int idx, bool reuse);
+
+    /**
+     * Starts queued jobs up to the concurrent limit, or completes the update
+     * when all are done.
+     */
+    void startJobs();
+
+    /**
+     * Handles data received for a job. Only the body of a 200 or 206 reply
+     * is written to the file - any other is discarded, and the job then
+     * fails in onJobFinished().
+     *
+     * @param[in] job The job.
+     */
+    void onJobData(JobT *job);
+
+    /**
+     * Handles job download finished event.
+     *
+     * @param[in] job The job.
+     */
+    void onJobFinished(JobT *job);
+
+    /**
+     * Finalizes a file whose jobs are all done - verifies the content and
+     * renames the partial file.
+     *
+     * @param[in] idx The file index in mFiles.
+     */
+    void completeFile(int idx);
+
+    /**
+     * Aborts all jobs and reports the update as finished.
+     */
+    void stop();
+
+    /**
+     * Removes all jobs of a file from the queue, and aborts its active
+     * jobs.
+     *
+     * @param[in] idx    The file index in mFiles.
+     * @param[in] except The job to keep. 0 for none.
+     */
+    void dropJobs(int idx, JobT *except);
+
     /**
      * Runs the downloaded update in a new detached process and emits a signal.
      */
@@ -141,5 +251,14 @@ private:
      * @return 0 for valid file. Positive value to retry. Negative for failure.
      */
     int validateMain(bool decrementCount);
+
+    /**
+     * Checks whether a file content matches its manifest digests.
+     *
+     * @param[in] f    The file data.
+     * @param[in] path The file path.
+     * @return true if matching.
+     */
+    static bool isMatching(const FileT &f, const QString &path);
 };
 #endif //UPDATER_H
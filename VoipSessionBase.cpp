@@ -8,7 +8,6 @@
  * @author Ahmad Syukri
  */
 #include <assert.h>
-#include <string.h> //memset
 
 #include "Md5Digest.h"
 #if defined(SNMP) && defined(SERVERAPP)
@@ -209,11 +208,8 @@ void VoipSessionBase::recvThread()
     time_t  lastRcvTime = time(0);
     time_t  now;
 #ifdef SIPTCP
-    int     len = 0;         //content body length
     time_t  connTime = lastRcvTime;
-    size_t  termLen = MsgSip::Value::TERMINATOR.length();
-    size_t  pos;
-    string  dataStr;
+    MsgSip::Framer framer;
 #else
     int     rmtPort;
     string  rmtIp;
@@ -226,7 +222,6 @@ void VoipSessionBase::recvThread()
     SNMP_SEND_DISC(snmpSent, SnmpAgent::TRAP_VOIP_STAT);
     while (mState != STATE_STOPPED)
     {
-        memset(buf, 0, BUFFER_SIZE_BYTES);
 #ifdef SIPTCP
         bytesRcvd = mSocket->recv(buf, sizeof(buf), 5);
         now = time(0);
@@ -267,45 +262,27 @@ void VoipSessionBase::recvThread()
             }
             mSsiCallMap.clear();
             mRegMap.clear();
-            dataStr.clear();
+            framer.clear();
             if (!connectToServer())
                 break;
             SNMP_SEND_CONN(snmpSent, SnmpAgent::TRAP_VOIP_STAT);
             connTime = time(0);
-            len = 0;
             timeoutSecs = TIMEOUT_DEF;
             lastRcvTime = connTime;
-            delete msg;
             continue;
         }
-        dataStr.append(buf, bytesRcvd);
-        pos = dataStr.find(MsgSip::Value::TERMINATOR);
-        while (pos != string::npos || (len > 0 && dataStr.size() >= len))
+        framer.append(buf, bytesRcvd);
+        while (framer.next(msg))
         {
-            id = dataStr.size(); //temp use
-            if (len == 0)
-            {
-                //no pending content body - get next msg
-                msg = MsgSip::parse(dataStr, len);
-                if (msg == 0)
-                    LOGX(ERROR, "recvThread: Failed to parse message: <<\n"
-                         << dataStr << "\n>>");
-                //erase consumed data
-                dataStr.erase(0, pos + termLen); //may clear it
-            }
-            else if (id >= len)
+            if (msg == 0)
             {
-                msg->setContentBody(dataStr.substr(0, len));
-                dataStr.erase(0, len); //may clear it
-                len = 0;
-            }
-            pos = (dataStr.empty())? string::npos:
-                                     dataStr.find(MsgSip::Value::TERMINATOR);
-            if (msg == 0 || len > 0)
+                LOGX(ERROR, "recvThread: Failed to parse message: <<\n"
+                     << framer.getRejected() << "\n>>");
                 continue;
+            }
 
 #else //SIPTCP
-        { //just to match SIPTCP 'while (pos != string::npos...)' brace
+        { //just to match SIPTCP 'while (framer.next(msg))' brace
             bytesRcvd = mSocket->recv(buf, BUFFER_SIZE_BYTES, 10, &rmtIp,
                                       &rmtPort);
             now = time(0);
@@ -550,7 +527,7 @@ void VoipSessionBase::recvThread()
                     }
                 }
             }
-        } //SIPTCP: while (pos != string::npos...), otherwise standalone braces
+        } //SIPTCP: while (framer.next(msg)), otherwise standalone braces
     } //while (mState != STATE_STOPPED)
     delete msg;
 #ifdef MOBILE
@@ -730,19 +707,14 @@ inline void VoipSessionBase::setState(int state)
 
 void VoipSessionBase::sendToServer(MsgSip &msg)
 {
-    int   n;
-    char *data = msg.getBytes(n);
-    if (data == 0)
-    {
-        LOGX(ERROR, "sendToServer: Error serializing message\n" << msg);
-        return;
-    }
+    //reused per sending thread to avoid an allocation per message
+    static thread_local string data;
+    int n = msg.serialize(data).size();
 #ifdef SIPTCP
-    n = mSocket->send(data, n);
+    n = mSocket->send(data.data(), n);
 #else
-    n = mSocket->send(data, n, mServerIp, mServerPort);
+    n = mSocket->send(data.data(), n, mServerIp, mServerPort);
 #endif
-    delete [] data;
     if (n < 0)
     {
         LOGX(ERROR, "sendToServer: Error " << n << Socket::getErrorStr(-n)
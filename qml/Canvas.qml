@@ -30,6 +30,8 @@ Item
     signal rscSelect(variant rscList);
     signal searchCtrDone(variant key, variant resList, point ctr, string lbl);
     signal searchDone(variant key, variant resList);
+    signal terminalRemoved(int issi);
+    signal terminalStateChanged(int issi, string state);
 
     readonly property int     cPRECISION  : 3;
     readonly property double  cZOOM_DEF   : 6.0;
@@ -76,6 +78,10 @@ Item
     property double mZoomMin    : mGisInt.getZoomMin();
 
     property variant mResLst;
+    property var     mIconFiles : ({}); //icon file existence cache
+    //tracking and trailing paths - key is ISSI
+    property var     mTrackPaths: ({});
+    property var     mTrailPaths: ({});
     property variant mRscFilter : [];
     //terminal type visibility filter - indexed by SubsData::eTerminalType
     property variant mRscShow   : [ true, true, true, true, true, true,
@@ -95,11 +101,10 @@ Item
     {
         id: mGisInt;
 
-        onTileDownloaded:
-            console.log("Tile download finished, saved to: " + filePath);
+        onTileDownloaded: mMap.tileDownloaded(filePath);
 
         onTileDownloadFailed:
-            console.log("Tile download failed: " + url + "\nError: " + error);
+            console.log("Tile download failed: " + url + "\nError: " + err);
     }
 
     Loader { id: mLoader; anchors.fill: parent; }
@@ -134,6 +139,11 @@ Item
         id: mResModel; onDataChanged: { mMap.update(); }
     }
 
+    ListModel //resource cluster model
+    {
+        id: mClusterModel; onDataChanged: { mMap.update(); }
+    }
+
     ListModel //tracking model data
     {
         id: mTrackModel; onDataChanged: { mMap.update(); }
@@ -585,6 +595,42 @@ Item
         return -1;
     }
 
+    /**
+     * Builds an index of all items in a model, for bulk updates without a
+     * search per item.
+     *
+     * @param[in] model The model.
+     * @return The index as an object with item ID keys and index values.
+     */
+    function indexItems(model: ListModel)
+    {
+        let res = {};
+        let i = model.count - 1;
+        for (; i>=0; --i)
+        {
+            res[model.get(i).id] = i;
+        }
+        return res;
+    }
+
+    /**
+     * Checks whether an icon file exists in the resources, remembering the
+     * result to avoid repeated lookups through GisQmlInt.
+     *
+     * @param[in] f The file path, without the leading ':'.
+     * @return true if exists.
+     */
+    function iconExists(f: string)
+    {
+        let res = mIconFiles[f];
+        if (res === undefined)
+        {
+            res = mGisInt.fileExists(":" + f);
+            mIconFiles[f] = res;
+        }
+        return res;
+    }
+
     /**
      * Deletes an item in a model.
      *
@@ -648,9 +694,11 @@ Item
                 break;
             case GisQmlInt.TYPEID_TRACKING:
                 mTrackModel.clear();
+                mTrackPaths = {};
                 break;
             case GisQmlInt.TYPEID_TRAILING:
                 mTrailModel.clear();
+                mTrailPaths = {};
                 break;
             default:
                 break; //do nothing
@@ -949,67 +997,18 @@ Item
     }
 
     /**
-     * Gets resources with trailing enabled.
-     *
-     * @return Space-separated ISSIs.
-     */
-    function getTrailings()
-    {
-        display.text = "";
-        let n = mResModel.count;
-        if (n == 0)
-            return "";
-        for (var i=0; i<n; ++i)
-        {
-            if (mResModel.get(i).trail)
-                display.text += ' ' + mResModel.get(i).id;
-        }
-        return (display.text.length === 0)? "": display.text.substring(1);
-    }
-
-    /**
-     * Enables/disables resource trailing.
-     *
-     * @param[in] issi    The resource ISSI.
-     * @param[in] enabled true to enable.
-     */
-    function terminalTrailing(issi: int, enabled: bool)
-    {
-        let idx = findItem(mResModel, issi);
-        if (idx >= 0)
-            mResModel.set(idx, { trail: enabled });
-        if (enabled)
-        {
-            //get resource current coordinates
-            let currCoor = toGeoCoordinate(mResModel.get(idx).lat,
-                                           mResModel.get(idx).lon);
-            mTrailModel.append({ id     : issi,
-                                 from   : currCoor,
-                                 to     : currCoor,
-                                 rot    : 0,
-                                 isFirst: true,
-                                 isLast : true });
-        }
-        else
-        {
-            let i = mTrailModel.count - 1;
-            for (; i>=0; --i)
-            {
-                if (mTrailModel.get(i).id === issi)
-                    mTrailModel.remove(i);
-            }
-        }
-    }
-
-    /**
-     * Checks whether a resource trailing property is enabled.
+     * Gets the current coordinates of a resource.
      *
      * @param[in] issi The resource ISSI.
-     * @return true if enabled.
+     * @return [lat, lon], or empty list if not found.
      */
-    function isTrailing(issi: int)
+    function getTerminalCoords(issi: int)
     {
-        return (findItem(mTrailModel, issi) >= 0);
+        let idx = findItem(mResModel, issi);
+        if (idx < 0)
+            return [];
+        let d = mResModel.get(idx);
+        return [ d.lat, d.lon ];
     }
 
     /**
@@ -1028,6 +1027,7 @@ Item
                           { state : val,
                             imgSrc: "qrc:///Qml/qml/terminal/" +
                                     mResModel.get(i).sType + val + ".png" });
+            terminalStateChanged(mResModel.get(i).id, val);
         }
         else
         {
@@ -1120,23 +1120,11 @@ Item
                                imgSrc: "qrc:///Qml/qml/terminal/" + tpStr +
                                        ".png",
                                blink : false,
-                               trail : false });
+                               clst  : false });
         }
         else
         {
             let d = mResModel.get(idx);
-            if (d.trail)
-            {
-                let prev = toGeoCoordinate(d.lat, d.lon); //last location
-                mTrailModel.set(findItem(mTrailModel, issi), { isLast: false });
-                let curr = toGeoCoordinate(lat, lon);
-                mTrailModel.append({ id     : issi,
-                                     from   : prev,
-                                     to     : curr,
-                                     rot    : prev.azimuthTo(curr),
-                                     isFirst: false,
-                                     isLast : true });
-            }
             if (idx < mResModel.count - 1)
             {
                 //move item to end just to ensure it appears on top
@@ -1177,7 +1165,10 @@ Item
             t = now - t/1000;
             //change resource state or remove resource
             if (mStaleLast > 0 && t >= mStaleLast)
+            {
+                terminalRemoved(mResModel.get(i).id);
                 mResModel.remove(i);
+            }
             else if (mStale1 > 0 && t >= mStale1)
                 terminalSetParam(i, -1, "_stale1");
         }
@@ -1189,9 +1180,13 @@ Item
     function updateResourceLabels()
     {
         let i = mResModel.count - 1;
+        let lbl;
         for (; i>=0; --i)
         {
-            mResModel.set(i, { lblTxt: mGisInt.rscLbl(mResModel.get(i).id) });
+            //labels are cached, so only changed ones need an update
+            lbl = mGisInt.rscLbl(mResModel.get(i).id);
+            if (lbl !== mResModel.get(i).lblTxt)
+                mResModel.setProperty(i, "lblTxt", lbl);
         }
     }
 
@@ -1248,43 +1243,74 @@ Item
                         lat  : double,
                         lon  : double)
     {
-        cat = cat.toLowerCase();
-        let dir = "/Qml/qml/incident" +
-                  ((type === GisQmlInt.TYPEID_INCIDENT_REPORT)? "_report/": "/");
-        let f = dir + cat + state + ".png";
-        if (!mGisInt.fileExists(":" + f))
+        incidentLoad(type, [id, cat, state, lat, lon]);
+    }
+
+    /**
+     * Adds/updates incident or incident report points in bulk, with a single
+     * model insertion for all new points.
+     *
+     * @param[in] type  Model type - GisQmlInt.TYPEID_INCIDENT/INCIDENT_REPORT.
+     * @param[in] items The incidents as
+     *                  [id1, cat1, state1, lat1, lon1, id2, ...].
+     */
+    function incidentLoad(type: int, items: var)
+    {
+        let isRpt = (type === GisQmlInt.TYPEID_INCIDENT_REPORT);
+        let model = (isRpt)? mIncRptModel: mIncModel;
+        let dir = "/Qml/qml/incident" + ((isRpt)? "_report/": "/");
+        let idxMap = {};
+        let idx;
+        //reports are always appended, and the whole model is indexed only
+        //for bulk changes, to avoid it for a single item
+        if (!isRpt && items.length > 5)
         {
-            cat = "default";
-            f = dir + cat + state + ".png";
+            idxMap = indexItems(model);
         }
-        if (type === GisQmlInt.TYPEID_INCIDENT_REPORT)
+        else if (!isRpt && items.length === 5)
         {
-            mIncRptModel.append({ id    : id,
-                                  lat   : lat,
-                                  lon   : lon,
-                                  cat   : cat,
-                                  imgSrc: "qrc://" + f });
+            idx = findItem(model, items[0]);
+            if (idx >= 0)
+                idxMap[items[0]] = idx;
         }
-        else
+        let newItems = [];
+        let cat;
+        let f;
+        let d;
+        let i = 0;
+        for (; i+4<items.length; i+=5)
         {
-            let idx = findItem(mIncModel, id);
-            if (idx < 0) //new incident
+            cat = String(items[i + 1]).toLowerCase();
+            f = dir + cat + items[i + 2] + ".png";
+            if (!iconExists(f))
+            {
+                cat = "default";
+                f = dir + cat + items[i + 2] + ".png";
+            }
+            d = { lat   : items[i + 3],
+                  lon   : items[i + 4],
+                  cat   : cat,
+                  imgSrc: "qrc://" + f };
+            idx = idxMap[items[i]];
+            if (idx === undefined)
             {
-                mIncModel.append({ id    : id,
-                                   lat   : lat,
-                                   lon   : lon,
-                                   cat   : cat,
-                                   imgSrc: "qrc://" + f });
+                d.id = items[i];
+                if (!isRpt)
+                    idxMap[d.id] = model.count + newItems.length;
+                newItems.push(d);
+            }
+            else if (idx >= model.count) //repeated in this batch
+            {
+                d.id = items[i];
+                newItems[idx - model.count] = d;
             }
             else
             {
-                mIncModel.set(idx,
-                              { lat   : lat,
-                                lon   : lon,
-                                cat   : cat,
-                                imgSrc: "qrc://" + f });
+                model.set(idx, d);
             }
         }
+        if (newItems.length > 0)
+            model.append(newItems);
     }
 
     /**
@@ -1312,42 +1338,76 @@ Item
                        lat     : double,
                        lon     : double)
     {
-        cat = cat.toLowerCase();
-        let idx = findItem(mPoiModel, key);
-        let f = "/Qml/qml/userPoi/" + cat + ".png";
-        if (!mGisInt.fileExists(":" + f))
+        poiLoad([key, isPublic, longName, shrtName, cat, addr, desc, owner,
+                 lat, lon]);
+    }
+
+    /**
+     * Adds/updates POI points in bulk, with a single model insertion for all
+     * new points.
+     *
+     * @param[in] items The POIs as [key1, isPublic1, longName1, shrtName1,
+     *                  cat1, addr1, desc1, owner1, lat1, lon1, key2, ...].
+     */
+    function poiLoad(items: var)
+    {
+        let idxMap = {};
+        let idx;
+        //index the whole model only for bulk changes, to avoid it for a
+        //single item
+        if (items.length > 10)
         {
-            cat = "others";
-            f = "/Qml/qml/userPoi/others.png";
+            idxMap = indexItems(mPoiModel);
         }
-        if (idx < 0) //new POI
+        else if (items.length === 10)
         {
-            mPoiModel.append({ id      : key,
-                               lgName  : longName,
-                               shName  : shrtName,
-                               cat     : cat,
-                               addr    : addr,
-                               desc    : desc,
-                               owner   : owner,
-                               isPublic: isPublic,
-                               lat     : lat,
-                               lon     : lon,
-                               imgSrc  : "qrc://" + f });
+            idx = findItem(mPoiModel, items[0]);
+            if (idx >= 0)
+                idxMap[items[0]] = idx;
         }
-        else
+        let newItems = [];
+        let cat;
+        let f;
+        let d;
+        let i = 0;
+        for (; i+9<items.length; i+=10)
         {
-            mPoiModel.set(idx,
-                          { lgName  : longName,
-                            shName  : shrtName,
-                            cat     : cat,
-                            addr    : addr,
-                            desc    : desc,
-                            owner   : owner,
-                            isPublic: isPublic,
-                            lat     : lat,
-                            lon     : lon,
-                            imgSrc  : "qrc://" + f });
+            cat = String(items[i + 4]).toLowerCase();
+            f = "/Qml/qml/userPoi/" + cat + ".png";
+            if (!iconExists(f))
+            {
+                cat = "others";
+                f = "/Qml/qml/userPoi/others.png";
+            }
+            d = { lgName  : items[i + 2],
+                  shName  : items[i + 3],
+                  cat     : cat,
+                  addr    : items[i + 5],
+                  desc    : items[i + 6],
+                  owner   : items[i + 7],
+                  isPublic: items[i + 1],
+                  lat     : items[i + 8],
+                  lon     : items[i + 9],
+                  imgSrc  : "qrc://" + f };
+            idx = idxMap[items[i]];
+            if (idx === undefined) //new POI
+            {
+                d.id = items[i];
+                idxMap[d.id] = mPoiModel.count + newItems.length;
+                newItems.push(d);
+            }
+            else if (idx >= mPoiModel.count) //repeated in this batch
+            {
+                d.id = items[i];
+                newItems[idx - mPoiModel.count] = d;
+            }
+            else
+            {
+                mPoiModel.set(idx, d);
+            }
         }
+        if (newItems.length > 0)
+            mPoiModel.append(newItems);
     }
 
     /**
@@ -1528,56 +1588,115 @@ Item
     }
 
     /**
-     * Adds a tracking line.
+     * Applies resource cluster changes.
      *
-     * @param[in] issi The ISSI.
-     * @param[in] lat  The coordinates latitude.
-     * @param[in] lon  The coordinates longitude.
+     * @param[in] clusters The new or changed clusters, each with id, count,
+     *                     lat, lon, and states as GisCluster::eState flags.
+     * @param[in] removed  The removed cluster IDs.
+     * @param[in] members  The resources whose clustered status changed, as
+     *                     [issi1, clustered1, issi2, clustered2, ...].
      */
-    function addTrackingLine(issi: int, lat: double, lon: double)
+    function clusterUpdate(clusters: var, removed: var, members: var)
     {
-        let coor = toGeoCoordinate(lat, lon);
-        let idx = findItem(mTrackModel, issi);
-        if (idx < 0) //new tracking
+        let i;
+        let idx;
+        let c;
+        let d;
+        for (i=removed.length-1; i>=0; --i)
         {
-            mTrackModel.append({ id     : issi,
-                                 from   : coor,
-                                 to     : coor,
-                                 rot    : 0,
-                                 lblTxt : "",
-                                 isFirst: true });
+            idx = findItem(mClusterModel, removed[i]);
+            if (idx >= 0)
+                mClusterModel.remove(idx);
         }
-        else
+        for (i=clusters.length-1; i>=0; --i)
         {
-            //get resource last locations
-            let prevCoor = toGeoCoordinate(mTrackModel.get(idx).to.latitude,
-                                           mTrackModel.get(idx).to.longitude);
-            mTrackModel.set(idx, { lblTxt: "" });
-            mTrackModel.append({ id     : issi,
-                                 from   : prevCoor,
-                                 to     : coor,
-                                 rot    : prevCoor.azimuthTo(coor),
-                                 lblTxt : String(issi),
-                                 isFirst: false });
+            c = clusters[i];
+            d = { id     : c.id,
+                  count  : c.count,
+                  lat    : c.lat,
+                  lon    : c.lon,
+                  inCall : (c.states & 1) !== 0,
+                  stale  : (c.states & 2) !== 0,
+                  invalid: (c.states & 4) !== 0 };
+            idx = findItem(mClusterModel, c.id);
+            if (idx < 0)
+                mClusterModel.append(d);
+            else
+                mClusterModel.set(idx, d);
+        }
+        let n = members.length;
+        //index only for bulk changes, to avoid a search per resource
+        let ids = (n > 20)? indexItems(mResModel): null;
+        for (i=0; i<n; i+=2)
+        {
+            idx = (ids === null)? findItem(mResModel, members[i]):
+                                  ids[members[i]];
+            if (idx !== undefined && idx >= 0)
+                mResModel.setProperty(idx, "clst", members[i + 1]);
         }
     }
 
     /**
-     * Deletes tracking line segments for an ISSI.
+     * Sets or removes the tracking or trailing path of an ISSI, drawn as a
+     * single line.
      *
-     * @param[in] issi The ISSI.
-     * @param[in] num  The number of line segments to delete.
+     * @param[in] type   GisQmlInt.TYPEID_TRACKING or TYPEID_TRAILING.
+     * @param[in] issi   The ISSI.
+     * @param[in] coords The coordinates as [lat1, lon1, lat2, lon2, ...].
+     *                   Empty to remove.
      */
-    function deleteItemLastNodes(issi: int, num: int)
-    {
-        let idx = -1;
-        for (; num>0; --num)
+    function pathUpdate(type: int, issi: int, coords: var)
+    {
+        let isTrack = (type === GisQmlInt.TYPEID_TRACKING);
+        let model = (isTrack)? mTrackModel: mTrailModel;
+        let paths = (isTrack)? mTrackPaths: mTrailPaths;
+        let idx = findItem(model, issi);
+        let n = coords.length;
+        if (n < 2)
         {
-            idx = findItem(mTrackModel, issi);
-            mTrackModel.remove(idx);
+            if (idx >= 0)
+                model.remove(idx);
+            delete paths[issi];
+            return;
         }
-        idx = findItem(mTrackModel, issi);
-        mTrackModel.set(idx, { lblTxt: String(issi) });
+        let path = [];
+        for (let i=0; i<n; i+=2)
+        {
+            path.push(toGeoCoordinate(coords[i], coords[i + 1]));
+        }
+        paths[issi] = path;
+        n = path.length;
+        let d = { from   : path[0],
+                  to     : path[n - 1],
+                  rot    : (n > 1)? path[n - 2].azimuthTo(path[n - 1]): 0,
+                  isFirst: (n === 1) };
+        if (idx < 0)
+        {
+            d.id = issi;
+            d.rev = 0;
+            d.lblTxt = String(issi);
+            model.append(d);
+        }
+        else
+        {
+            //revision change makes the line delegate get the new path
+            d.rev = model.get(idx).rev + 1;
+            model.set(idx, d);
+        }
+    }
+
+    /**
+     * Gets a tracking or trailing path.
+     *
+     * @param[in] paths mTrackPaths or mTrailPaths.
+     * @param[in] issi  The ISSI.
+     * @param[in] rev   The path revision. Only for binding re-evaluation.
+     * @return The coordinates.
+     */
+    function getPath(paths: var, issi: int, rev: int)
+    {
+        let res = paths[issi];
+        return (res === undefined)? []: res;
     }
 
     /**
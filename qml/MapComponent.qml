@@ -188,11 +188,13 @@ Map
             coordinate : toGeoCoordinate(lat, lon);
             sourceItem : Image
             {
-                id    : imgPoi;
-                cache : false;
-                height: cICON_HEIGHT;
-                width : cICON_WIDTH;
-                source: imgSrc;
+                id          : imgPoi;
+                //static icons shared by many items - decode once, off the
+                //GUI thread
+                asynchronous: true;
+                height      : cICON_HEIGHT;
+                width       : cICON_WIDTH;
+                source      : imgSrc;
             }
             visible    : mImgPoiView;
         }
@@ -227,11 +229,13 @@ Map
             coordinate : toGeoCoordinate(lat, lon);
             sourceItem : Image
             {
-                id    : imgIncident;
-                cache : false;
-                height: cICON_HEIGHT;
-                width : cICON_WIDTH;
-                source: imgSrc;
+                id          : imgIncident;
+                //static icons shared by many items - decode once, off the
+                //GUI thread
+                asynchronous: true;
+                height      : cICON_HEIGHT;
+                width       : cICON_WIDTH;
+                source      : imgSrc;
             }
             visible    : mImgIncView;
         }
@@ -322,7 +326,7 @@ Map
                 }
                 layer
                 {
-                    enabled: blink;
+                    enabled: blink && !clst;
                     effect : Glow
                     {
                         radius : 10;
@@ -333,7 +337,7 @@ Map
                 SequentialAnimation
                 {
                     loops  : Animation.Infinite;
-                    running: blink;
+                    running: blink && !clst;
                     PropertyAnimation
                     {
                         duration  : 250;
@@ -352,7 +356,7 @@ Map
                     }
                 }
             }
-            visible    : mImgRscView && mRscShow[iType] &&
+            visible    : mImgRscView && !clst && mRscShow[iType] &&
                          (mRscFilter.length === 0 ||
                           mRscFilter.indexOf(id) >= 0);
         }
@@ -374,22 +378,58 @@ Map
                 styleColor: (mGisInt.isDarkMode())? "royalblue": "white";
                 text      : lblTxt;
             }
-            visible    : mLblRscView && mRscShow[iType] &&
+            visible    : mLblRscView && !clst && mRscShow[iType] &&
                          (mRscFilter.length === 0 ||
                           mRscFilter.indexOf(id) >= 0);
         }
     }
 
+    MapItemView //resource cluster
+    {
+        model   : mClusterModel;
+        delegate: MapQuickItem
+        {
+            anchorPoint: toPoint(imgCluster.width/2, imgCluster.height/2);
+            coordinate : toGeoCoordinate(lat, lon);
+            sourceItem : Rectangle
+            {
+                id          : imgCluster;
+                border.color: (inCall)? "#2FF923": "white";
+                border.width: (inCall)? 3: cBORDER_WIDTH;
+                color       : (invalid)? "firebrick":
+                              (stale)?   "gray": "royalblue";
+                height      : width;
+                opacity     : 0.85;
+                radius      : width/2;
+                width       : Math.max(cICON_WIDTH, lblCluster.width + 12);
+                Text
+                {
+                    id              : lblCluster;
+                    anchors.centerIn: parent;
+                    color           : "white";
+                    font.bold       : true;
+                    text            : count;
+                }
+                MouseArea
+                {
+                    anchors.fill: parent;
+                    //zoom in on the cluster
+                    onClicked   : setGeomCenter(lat, lon,
+                                                Math.floor(mZoom) + 2);
+                }
+            }
+            visible    : mImgRscView;
+        }
+    }
+
     MapItemView //tracking line
     {
         model   : mTrackModel;
         delegate: MapPolyline
         {
             line { color: "aqua"; width: cLINE_WIDTH1; }
-            path: [ toGeoCoordinate(from.latitude, from.longitude),
-                    toGeoCoordinate(to.latitude, to.longitude) ]
-            //only visible if position has changed
-            visible: from !== to && mImgTrcView;
+            path   : getPath(mTrackPaths, id, rev);
+            visible: !isFirst && mImgTrcView;
         }
     }
 
@@ -406,8 +446,7 @@ Map
                 height: cMARKER_HEIGHT;
                 width : cMARKER_WIDTH;
             }
-            //only visible for first tracking data
-            visible: isFirst && mImgTrcView;
+            visible: mImgTrcView;
         }
     }
 
@@ -426,8 +465,8 @@ Map
                     Translate { x: -cARROW_WIDTH; y: -cARROW_HEIGHT/2; },
                     Rotation { angle: (rot - 90); } ]
             }
-            //only visible if position has changed and not first position
-            visible: !isFirst && from !== to && mImgTrcView;
+            //only visible if position has changed
+            visible: !isFirst && mImgTrcView;
         }
     }
 
@@ -453,9 +492,8 @@ Map
         delegate: MapPolyline
         {
             line { color: "orange"; width: cLINE_WIDTH1; }
-            path: [ toGeoCoordinate(from.latitude, from.longitude),
-                    toGeoCoordinate(to.latitude, to.longitude) ]
-            visible: mImgTrlView;
+            path   : getPath(mTrailPaths, id, rev);
+            visible: !isFirst && mImgTrlView;
         }
     }
 
@@ -472,28 +510,7 @@ Map
                 height: cMARKER_HEIGHT;
                 width : cMARKER_WIDTH;
             }
-            //only visible for first trailing data
-            visible: isFirst && mImgTrlView;
-        }
-    }
-
-    MapItemView //trailing arrow head marker
-    {
-        model   : mTrailModel;
-        delegate: MapQuickItem
-        {
-            coordinate: toGeoCoordinate(to.latitude, to.longitude);
-            sourceItem: Image
-            {
-                source: cIMG_ARROW;
-                height: cARROW_HEIGHT;
-                width : cARROW_WIDTH;
-                transform: [
-                    Translate { x: -cARROW_WIDTH; y: -cARROW_HEIGHT/2; },
-                    Rotation { angle: (rot - 90); } ]
-            }
-            //not visible for first and last position
-            visible: !isFirst && !isLast && mImgTrlView;
+            visible: mImgTrlView;
         }
     }
 
@@ -924,13 +941,142 @@ Map
         }
     }
 
-    //temporary function to get online server address simulating
-    //mGisInt.getMapPath() for seamarker (!isWms)
+    //gets tile server address - configurable for seamarker (!isWms)
     function getSvrAddress(isWms: Boolean)
     {
         if (isWms)
             return mGisInt.getMapPath();
-        return "https://tiles.openseamap.org/";
+        return mGisInt.getSeaTilePath();
+    }
+
+    /**
+     * Gets a tile image source. If not cached, queues it for download, and
+     * the source is set by tileDownloaded() on completion.
+     *
+     * @param[in] isWms    true for sea depth (WMS), false for sea marker.
+     * @param[in] z        The zoom level.
+     * @param[in] x        The tile X, already wrapped.
+     * @param[in] y        The tile Y, already converted for WMS.
+     * @param[in] priority The download priority - GisQmlInt.TILE_PRIO_*.
+     * @return Object with file (cache filepath) and src (empty if not
+     *         cached).
+     */
+    function getTileSrc(isWms: bool, z: int, x: int, y: int, priority: int)
+    {
+        const tileFileName = ((isWms)? "sd_": "sm_") +
+                             mTileName.replace("{z}", z)
+                                      .replace("{x}", x)
+                                      .replace("{y}", y);
+        const filePath = mGisInt.getCachePath() + tileFileName;
+        if (mGisInt.isTileCached(filePath))
+            return { file: filePath, src: `file:///${filePath}` };
+        const tileUrl = getSvrAddress(isWms) +
+                        ((isWms)? mWmsUrl: mTmsUrl).replace("{z}", z)
+                                                   .replace("{x}", x)
+                                                   .replace("{y}", y);
+        mGisInt.downloadTile(tileUrl, filePath, priority);
+        return { file: filePath, src: "" };
+    }
+
+    /**
+     * Queues a tile for prefetch if it is valid and not cached.
+     *
+     * @param[in] isWms true for sea depth (WMS), false for sea marker.
+     * @param[in] z     The zoom level.
+     * @param[in] x     The tile X.
+     * @param[in] y     The tile Y, before conversion for WMS.
+     */
+    function prefetchTile(isWms: bool, z: int, x: int, y: int)
+    {
+        if (z < mZoomMin || z > mZoomMax)
+            return;
+        const maxTiles = Math.pow(2, z);
+        if (y < cGeoMinY[z] || y >= maxTiles)
+            return;
+        getTileSrc(isWms, z, (x + maxTiles) % maxTiles,
+                   (isWms)? maxTiles - 1 - y: y,
+                   GisQmlInt.TILE_PRIO_PREFETCH);
+    }
+
+    /**
+     * Queues tiles for prefetch, after those in the viewport:
+     * -ring around the viewport,
+     * -3x3 tiles around the center of the viewport at the next zoom level,
+     * -viewport at the previous zoom level,
+     * -around incident locations at the current zoom level.
+     *
+     * @param[in] isWms  true for sea depth (WMS), false for sea marker.
+     * @param[in] z      The zoom level.
+     * @param[in] startX Viewport start tile X, including extra column.
+     * @param[in] startY Viewport start tile Y, including extra row.
+     * @param[in] endX   Viewport end tile X, including extra column.
+     * @param[in] endY   Viewport end tile Y, including extra row.
+     */
+    function prefetchSeaTiles(isWms: bool, z: int, startX: int, startY: int,
+                              endX: int, endY: int)
+    {
+        let x;
+        let y;
+        for (x=startX-1; x<=endX+1; ++x)
+        {
+            prefetchTile(isWms, z, x, startY - 1);
+            prefetchTile(isWms, z, x, endY + 1);
+        }
+        for (y=startY; y<=endY; ++y)
+        {
+            prefetchTile(isWms, z, startX - 1, y);
+            prefetchTile(isWms, z, endX + 1, y);
+        }
+        const ctrX = getTileX(center.longitude, z);
+        const ctrY = getTileY(center.latitude, z);
+        //zoom in - children of the 3x3 center tiles, i.e. 6x6 tiles
+        for (x=2*ctrX-2; x<=2*ctrX+3; ++x)
+        {
+            for (y=2*ctrY-2; y<=2*ctrY+3; ++y)
+            {
+                prefetchTile(isWms, z + 1, x, y);
+            }
+        }
+        //zoom out - parents of the viewport
+        for (x=Math.floor(startX/2); x<=Math.floor(endX/2); ++x)
+        {
+            for (y=Math.floor(startY/2); y<=Math.floor(endY/2); ++y)
+            {
+                prefetchTile(isWms, z - 1, x, y);
+            }
+        }
+        let i = 0;
+        for (; i<mIncModel.count; ++i)
+        {
+            const inc = mIncModel.get(i);
+            const incX = getTileX(inc.lon, z);
+            const incY = getTileY(inc.lat, z);
+            for (x=incX-1; x<=incX+1; ++x)
+            {
+                for (y=incY-1; y<=incY+1; ++y)
+                {
+                    prefetchTile(isWms, z, x, y);
+                }
+            }
+        }
+    }
+
+    /**
+     * Sets the source of downloaded tiles in the tile models.
+     *
+     * @param[in] filePath The tile filepath.
+     */
+    function tileDownloaded(filePath: string)
+    {
+        for (let model of [mSeaDepthModel, mSeaMarkerModel])
+        {
+            let i = model.count - 1;
+            for (; i>=0; --i)
+            {
+                if (model.get(i).file === filePath)
+                    model.setProperty(i, "src", `file:///${filePath}`);
+            }
+        }
     }
 
     function updateSeaTiles(model: ListModel, isWms: bool)
@@ -944,14 +1090,16 @@ Map
                        Math.floor(widthInTiles/2) - 1;  //add extra left column
         const startY = getTileY(center.latitude, z) -
                        Math.floor(heightInTiles/2) - 1; //add extra top row
+        const endX = startX + widthInTiles + 1;  //add extra right column
+        const endY = startY + heightInTiles + 1; //add extra bottom row
         const maxTiles = Math.pow(2, z); //total number of tiles at zoom level
         let tiles = [];
         let newTiles = {};
         //calculate required tiles
-        let x = startX + widthInTiles + 1; //add extra right column
+        let x = endX;
         for (; x>=startX; --x)
         {
-            let y = startY + heightInTiles + 1; //add extra bottom row
+            let y = endY;
             for (; y>=startY; --y)
             {
                 let tileX = (x + maxTiles) % maxTiles;;
@@ -986,33 +1134,16 @@ Map
             let tileKey = `${tile.x}_${tile.y}`;
             if (!newTiles[tileKey])
                 continue;
-            let tileUrl = (isWms)? mWmsUrl.replace("{z}", z)
-                                          .replace("{x}", tile.x)
-                                          .replace("{y}", tile.y):
-                                   mTmsUrl.replace("{z}", z)
-                                          .replace("{x}", tile.x)
-                                          .replace("{y}", tile.y);
-            const tileFileName = ((isWms)? "sd_": "sm_") +
-                                 mTileName.replace("{z}", z)
-                                          .replace("{x}", tile.x)
-                                          .replace("{y}", tile.y);
-            let filePath = mGisInt.getCachePath() + tileFileName;
-            if (mGisInt.fileExists(filePath))
-            {
-                filePath = `file:///${filePath}`;
-            }
-            else
-            {
-                tileUrl = getSvrAddress(isWms) + tileUrl;
-                mGisInt.downloadTile(tileUrl, filePath);
-                filePath = tileUrl; //use online tile while downloading
-            }
-            model.append({ x  : tile.x,
-                           y  : tile.y,
-                           lat: tile.lat,
-                           lon: tile.lon,
-                           src: filePath });
+            const t = getTileSrc(isWms, z, tile.x, tile.y,
+                                 GisQmlInt.TILE_PRIO_VIEW);
+            model.append({ x   : tile.x,
+                           y   : tile.y,
+                           lat : tile.lat,
+                           lon : tile.lon,
+                           file: t.file,
+                           src : t.src });
         }
+        prefetchSeaTiles(isWms, z, startX, startY, endX, endY);
     }
 
     function getTileX(lon, zoom: Number)
@@ -1046,6 +1177,7 @@ Map
                                 btmRight.latitude, btmRight.longitude);
             if (mSeaMap && !mOvr)
             {
+                mGisInt.newTileView();
                 if (mLyrSeaDepth)
                     updateSeaTiles(mSeaDepthModel, true);
                 if (mZoom > 8 && mLyrSeaMarker)
@@ -2,7 +2,9 @@
  * @file
  * @version $Id: testclient.cpp 1647 2022-10-05 03:18:44Z zulzaidi $
  */
-#include <algorithm>    //count
+#include <algorithm>    //count, nth_element, sort, transform
+#include <chrono>
+#include <deque>
 #include <fstream>
 #include <iomanip>      //setw, setfill
 #include <iostream>
@@ -12,17 +14,26 @@
 #include <string>
 
 #include <assert.h>
+#include <dirent.h>
 #include <errno.h>
 #include <signal.h>
+#include <sys/stat.h>
 #include <unistd.h>     //getpid()
 
+#include "AudioMixer.h"
 #include "Logger.h"
+#include "IdRangeSet.h"
+#include "Md5Digest.h"
+#include "MsgSip.h"
 #include "MsgSp.h"
+#include "PalLock.h"
 #include "PalSem.h"
 #include "PalSocket.h"      //just for finalize()
+#include "PalThread.h"
 #include "ServerSession.h"
 #include "StatusCodes.h"
 #include "SubsData.h"
+#include "TcpSocket.h"
 #include "Utils.h"
 #include "version.h"
 
@@ -30,6 +41,8 @@ using namespace std;
 
 static const string USERNAMEBASE("0");
 static const int    MAXCLIENTS = 1000;
+//maximum wait for CALL_PROCEEDING in the call scenario
+static const int    CALL_ID_TIMEOUT_MS = 5000;
 //dummy gps data
 static const string GPSDATA[] =
 {
@@ -70,10 +83,261 @@ SubsData::IdMapT       gFleet2GrpsMap;
 //description of each SSI
 SubsData::Ssi2DescMapT gSsi2DescMap;
 
+//load test statistics ======================================================
+//Counts sent and received messages per type, and records latencies:
+//-request-response: from sending a request to receiving the response with its
+// message ID in MSG_ACK, or failing that, the next response of the same type
+// for the same client,
+//-stand-in server push: from the push to callback, using the push time in
+// TIMESTAMP (same process, so same clock).
+//A response may arrive before its sender gets the message ID, so unmatched
+//responses are kept until the request is recorded.
+class LoadStats
+{
+public:
+    LoadStats()
+    {
+        PalLock::init(&mLock);
+        reset();
+    }
+
+    ~LoadStats() { PalLock::destroy(&mLock); }
+
+    /**
+     * Gets the current monotonic time.
+     *
+     * @return The time in microseconds.
+     */
+    static int64_t nowUs()
+    {
+        return chrono::duration_cast<chrono::microseconds>(
+                       chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /**
+     * Clears all statistics and sets the start time.
+     */
+    void reset()
+    {
+        PalLock::take(&mLock);
+        mStats.clear();
+        mPending.clear();
+        mFifo.clear();
+        mEarly.clear();
+        mBenches.clear();
+        mStartUs = nowUs();
+        PalLock::release(&mLock);
+    }
+
+    /**
+     * Records a sent request.
+     *
+     * @param[in] cid    The client ID.
+     * @param[in] msgId  The message ID, or <= 0 if not known.
+     * @param[in] type   The message type.
+     * @param[in] sendUs The time just before sending. See nowUs().
+     */
+    void sent(int cid, int msgId, int type, int64_t sendUs)
+    {
+        PalLock::take(&mLock);
+        ++mStats[type].sent;
+        if (msgId <= 0)
+        {
+            mFifo[make_pair(cid, type)].push_back(sendUs);
+        }
+        else
+        {
+            auto it = mEarly.find(key(cid, msgId));
+            if (it == mEarly.end())
+            {
+                mPending[key(cid, msgId)] = make_pair(type, sendUs);
+            }
+            else
+            {
+                if (it->second >= sendUs)
+                    mStats[type].latUs.push_back(
+                                 static_cast<uint32_t>(it->second - sendUs));
+                mEarly.erase(it);
+            }
+        }
+        PalLock::release(&mLock);
+    }
+
+    /**
+     * Records a received message, and its latency if it is a response or a
+     * stand-in server push.
+     *
+     * @param[in] cid      The client ID.
+     * @param[in] msg      The message.
+     * @param[in] isPushed true if from a stand-in server push.
+     */
+    void received(int cid, const MsgSp &msg, bool isPushed)
+    {
+        int64_t t = nowUs();
+        int     type = msg.getType();
+        int64_t sentUs = 0;
+        PalLock::take(&mLock);
+        ++mStats[type].received;
+        int ack = msg.getFieldInt(MsgSp::Field::MSG_ACK);
+        auto it = (ack > 0)? mPending.find(key(cid, ack)): mPending.end();
+        if (it != mPending.end())
+        {
+            type = it->second.first; //attribute to request type
+            sentUs = it->second.second;
+            mPending.erase(it);
+        }
+        else if (isPushed)
+        {
+            msg.getFieldVal(MsgSp::Field::TIMESTAMP, sentUs);
+        }
+        else
+        {
+            auto fit = mFifo.find(make_pair(cid, type));
+            if (fit != mFifo.end() && !fit->second.empty())
+            {
+                sentUs = fit->second.front();
+                fit->second.pop_front();
+            }
+            else if (ack > 0 && mEarly.size() < MAX_EARLY)
+            {
+                mEarly[key(cid, ack)] = t;
+            }
+        }
+        if (sentUs > 0 && t >= sentUs)
+            mStats[type].latUs.push_back(static_cast<uint32_t>(t - sentUs));
+        PalLock::release(&mLock);
+    }
+
+    /**
+     * Records a benchmark result, e.g. from a scenario that measures
+     * processing cost without a server.
+     *
+     * @param[in] name  The result name.
+     * @param[in] value The value.
+     * @param[in] unit  The value unit.
+     */
+    void bench(const string &name, double value, const string &unit)
+    {
+        PalLock::take(&mLock);
+        mBenches.push_back(Bench(name, value, unit));
+        PalLock::release(&mLock);
+    }
+
+    /**
+     * Writes the statistics as JSON.
+     *
+     * @param[in] os       The output stream.
+     * @param[in] scenario The scenario name.
+     * @param[in] clients  The number of clients.
+     */
+    void toJson(ostream &os, const string &scenario, int clients)
+    {
+        PalLock::take(&mLock);
+        double secs = (nowUs() - mStartUs) / 1000000.0;
+        if (secs <= 0)
+            secs = 1e-6;
+        os << "{\n  \"scenario\": \"" << scenario << "\",\n  \"clients\": "
+           << clients << ",\n  \"duration_s\": " << secs
+           << ",\n  \"pending\": " << mPending.size()
+           << ",\n  \"types\": [";
+        const char *sep = "\n";
+        for (auto &it : mStats)
+        {
+            TypeStats &ts(it.second);
+            os << sep << "    {\"type\": \"" << MsgSp::getTypeName(it.first)
+               << "\", \"id\": " << it.first << ", \"sent\": " << ts.sent
+               << ", \"received\": " << ts.received
+               << ", \"tx_per_s\": " << ts.sent / secs
+               << ", \"rx_per_s\": " << ts.received / secs
+               << ", \"samples\": " << ts.latUs.size()
+               << ", \"p50_us\": " << percentile(ts.latUs, 50)
+               << ", \"p99_us\": " << percentile(ts.latUs, 99)
+               << ", \"max_us\": " << percentile(ts.latUs, 100) << '}';
+            sep = ",\n";
+        }
+        os << "\n  ],\n  \"benchmarks\": [";
+        sep = "\n";
+        for (auto &b : mBenches)
+        {
+            os << sep << "    {\"name\": \"" << b.name << "\", \"value\": "
+               << b.value << ", \"unit\": \"" << b.unit << "\"}";
+            sep = ",\n";
+        }
+        os << "\n  ]\n}" << endl;
+        PalLock::release(&mLock);
+    }
+
+private:
+    struct TypeStats
+    {
+        TypeStats() : sent(0), received(0) {}
+
+        uint64_t         sent;
+        uint64_t         received;
+        vector<uint32_t> latUs;     //latency samples
+    };
+    struct Bench
+    {
+        Bench(const string &n, double v, const string &u) :
+        name(n), unit(u), value(v) {}
+
+        string name;
+        string unit;
+        double value;
+    };
+    typedef map<int, TypeStats>                     StatsMapT;
+    //key from key() to request type and send time
+    typedef map<int64_t, pair<int, int64_t> >       PendingMapT;
+    //client ID and type to send times, for requests without message ID
+    typedef map<pair<int, int>, deque<int64_t> >    FifoMapT;
+
+    //limit on unmatched responses kept, because some are for requests not
+    //recorded here, e.g. those sent by ServerSession after login
+    static const size_t MAX_EARLY = 10000;
+
+    int64_t                 mStartUs;
+    StatsMapT               mStats;
+    PendingMapT             mPending;
+    FifoMapT                mFifo;
+    map<int64_t, int64_t>   mEarly;     //key() to receive time
+    vector<Bench>           mBenches;
+    PalLock::LockT          mLock;
+
+    static int64_t key(int cid, int msgId)
+    {
+        return (static_cast<int64_t>(cid) << 32) | msgId;
+    }
+
+    /**
+     * Gets a percentile value. Partially reorders the samples.
+     *
+     * @param[in] v   The samples.
+     * @param[in] pct The percentile.
+     * @return The value, or 0 if no samples.
+     */
+    static uint32_t percentile(vector<uint32_t> &v, int pct)
+    {
+        if (v.empty())
+            return 0;
+        size_t n = (v.size() - 1) * pct / 100;
+        nth_element(v.begin(), v.begin() + n, v.end());
+        return v[n];
+    }
+};
+
+static LoadStats gLoadStats;
+
 //forward declare
 class Client;
+class StandinServer;
+class UpdateServer;
 void serverMsg(Client *cl, MsgSp *msg);
 
+static StandinServer *gStandin = 0;
+//stand-in redundant server, for the failover scenario
+static StandinServer *gStandin2 = 0;
+static UpdateServer  *gUpdateSvr = 0;
+
 typedef map<int, Client *> ClientsMapT;
 
 class Client
@@ -101,6 +365,8 @@ public:
 
     bool isValid() const { return (mSs->isValid()); }
 
+    int getId() const { return mId; }
+
     const string &getUserId() const { return mUserId; }
 
     void setCallId(int callId) { mCallId = callId; }
@@ -149,6 +415,10 @@ void Client::ssCallback(void *obj, MsgSp *msg)
 void serverMsg(Client *cl, MsgSp *msg)
 {
     LOGGER_DEBUG(gLogger, *cl << "Received " << msg->getName());
+    gLoadStats.received(cl->getId(), *msg,
+                        (gStandin != 0 &&
+                         msg->hasField(MsgSp::Field::TIMESTAMP) &&
+                         !msg->hasField(MsgSp::Field::MSG_ACK)));
     int    val;
     string str;
     string callPartyType;
@@ -294,6 +564,22 @@ void serverMsg(Client *cl, MsgSp *msg)
                         << msg->getFieldString(MsgSp::Field::SSI_LIST));
             break;
         }
+        case MsgSp::Type::GPS_LOC:
+        {
+            LOGGER_DEBUG(gLogger, *cl << msg->getName() << " from "
+                         << msg->getFieldInt(MsgSp::Field::CALLING_PARTY));
+            break;
+        }
+        case MsgSp::Type::GPS_MON_START:
+        case MsgSp::Type::GPS_MON_STOP:
+        {
+            LOGGER_INFO(gLogger, *cl << msg->getName() << ' '
+                        << ((msg->isResultSuccessful())? "successful":
+                                                         "failed")
+                        << " for "
+                        << msg->getFieldString(MsgSp::Field::ISSI_LIST));
+            break;
+        }
         case MsgSp::Type::MON_SUBS_DEFINE:
         {
             if (msg->getFieldInt(MsgSp::Field::SUBS_CONTENT_TYPE) ==
@@ -567,14 +853,1343 @@ void testSend(Client *cl, int msgType)
     }
 }
 
+//local update stand-in =====================================================
+//Minimal HTTP file server for client update tests.
+//Serves the files in a directory with byte range support, and writes the
+//update manifest of per-file chunk digests used by the client Updater.
+//The stand-in server announces the files as a new client version on login.
+static string toLower(string str)
+{
+    transform(str.begin(), str.end(), str.begin(), ::tolower);
+    return str;
+}
+
+class UpdateServer
+{
+public:
+    UpdateServer(const string &dir, int port) :
+    mPort(port), mDir(dir), mSocket(0)
+    {
+        if (!mDir.empty() && mDir.back() != '/')
+            mDir.append("/");
+    }
+
+    /**
+     * Writes the manifest and starts listening.
+     *
+     * @return true if successful.
+     */
+    bool start()
+    {
+        if (!writeManifest())
+            return false;
+        mSocket = new TcpSocket(0, mPort);
+        int res = mSocket->listen();
+        if (res != 0)
+        {
+            LOGGER_ERROR(gLogger, "UpdateServer: Failed to listen on port "
+                         << mPort << ", " << Socket::getErrorStr(res));
+            return false;
+        }
+        PalThread::ThreadT thrd;
+        PalThread::start(&thrd, startAcceptThread, this);
+        LOGGER_INFO(gLogger, "UpdateServer: Serving " << mDir << " on port "
+                    << mPort);
+        return true;
+    }
+
+    /**
+     * Adds the update fields to a VERSION_CLIENT message.
+     *
+     * @param[in,out] msg The message.
+     */
+    void setVersionMsg(MsgSp &msg) const
+    {
+        msg.addField(MsgSp::Field::VERSION, VERSION);
+        msg.addField(MsgSp::Field::FILE_PATH,
+                     "http://" + Socket::LOCALHOST + ":" +
+                     Utils::toString(mPort) + "/");
+        msg.addField(MsgSp::Field::FILE_LIST,
+                     Utils::toString(mFiles, MsgSp::Value::LIST_DELIMITER));
+        if (!mChksum.empty())
+            msg.addField(MsgSp::Field::CHECKSUM, mChksum);
+    }
+
+private:
+    struct ConnThreadParam
+    {
+        ConnThreadParam(UpdateServer *s, TcpSocket *t) : svr(s), sock(t) {}
+
+        UpdateServer *svr;
+        TcpSocket    *sock;
+    };
+
+    //must match the Updater
+    static const string    MANIFEST;
+    static const string    VERSION;
+    static const long long CHUNK_SIZE = 1048576;
+
+    int             mPort;
+    string          mDir;
+    string          mChksum;   //main file
+    vector<string>  mFiles;
+    TcpSocket      *mSocket;
+
+    static void *startAcceptThread(void *arg)
+    {
+        static_cast<UpdateServer *>(arg)->acceptThread();
+        return 0;
+    }
+
+    static void *startConnThread(void *arg)
+    {
+        ConnThreadParam *p = static_cast<ConnThreadParam *>(arg);
+        p->svr->serve(*p->sock);
+        delete p->sock;
+        delete p;
+        return 0;
+    }
+
+    /**
+     * Writes the manifest for all regular files in the directory, and
+     * computes the main file checksum.
+     *
+     * @return true if successful.
+     */
+    bool writeManifest();
+
+    void acceptThread();
+
+    /**
+     * Serves one HTTP request, and closes the connection.
+     *
+     * @param[in] sock The socket.
+     */
+    void serve(TcpSocket &sock);
+
+    /**
+     * Sends an HTTP response header.
+     *
+     * @param[in] sock   The socket.
+     * @param[in] status The status line without the protocol.
+     * @param[in] hdrs   Additional header lines, each terminated by CRLF.
+     * @param[in] len    The content length.
+     * @return true if successful.
+     */
+    static bool sendHeader(TcpSocket    &sock,
+                           const string &status,
+                           const string &hdrs,
+                           long long     len);
+};
+
+const string UpdateServer::MANIFEST("update.manifest");
+const string UpdateServer::VERSION("99.99");
+
+bool UpdateServer::writeManifest()
+{
+    DIR *dir = opendir(mDir.c_str());
+    if (dir == 0)
+    {
+        LOGGER_ERROR(gLogger, "UpdateServer: Failed to open directory "
+                     << mDir);
+        return false;
+    }
+    struct dirent *ent;
+    struct stat    st;
+    string         name;
+    while ((ent = readdir(dir)) != 0)
+    {
+        name = ent->d_name;
+        if (name == MANIFEST || stat((mDir + name).c_str(), &st) != 0 ||
+            !S_ISREG(st.st_mode))
+            continue;
+        mFiles.push_back(name);
+    }
+    closedir(dir);
+    sort(mFiles.begin(), mFiles.end());
+    ofstream ofs((mDir + MANIFEST).c_str());
+    if (!ofs)
+    {
+        LOGGER_ERROR(gLogger, "UpdateServer: Failed to create " << mDir
+                     << MANIFEST);
+        return false;
+    }
+    vector<string> digests;
+    long long      size;
+    for (const auto &f : mFiles)
+    {
+        size = md5DigestChunks(mDir + f, CHUNK_SIZE, digests);
+        if (size < 0)
+            continue;
+        ofs << f << '\t' << size << '\t' << CHUNK_SIZE << '\t'
+            << Utils::toString(digests, ',') << '\n';
+        if (mChksum.empty() && f.size() > 4 &&
+            toLower(f.substr(f.size() - 4)) == ".exe")
+            mChksum = md5DigestFile(mDir + f);
+    }
+    LOGGER_INFO(gLogger, "UpdateServer: Manifest for " << mFiles.size()
+                << " files");
+    return true;
+}
+
+void UpdateServer::acceptThread()
+{
+    string  ip;
+    int     port;
+    SocketT sock;
+    for (;;)
+    {
+        sock = mSocket->accept(ip, port);
+        if (sock < 0 || sock == INVALID_SOCKET)
+        {
+            LOGGER_ERROR(gLogger, "UpdateServer: accept() failed, "
+                         << Socket::getErrorStr(sock));
+            break;
+        }
+        PalThread::ThreadT thrd;
+        PalThread::start(&thrd, startConnThread,
+                         new ConnThreadParam(this, new TcpSocket(sock, port)));
+    }
+}
+
+void UpdateServer::serve(TcpSocket &sock)
+{
+    char   buf[65536];
+    int    len;
+    string req;
+    while (req.find("\r\n\r\n") == string::npos)
+    {
+        len = sock.recv(buf, sizeof(buf), 10);
+        if (len <= 0 || req.size() > 16384)
+            return;
+        req.append(buf, len);
+    }
+    string method;
+    string path;
+    istringstream is(req);
+    is >> method >> path;
+    if (method != "GET" && method != "HEAD")
+    {
+        sendHeader(sock, "405 Method Not Allowed", "", 0);
+        return;
+    }
+    //no subdirectories
+    path.erase(0, path.rfind('/') + 1);
+    path = mDir + path;
+    ifstream ifs(path.c_str(), ios::binary);
+    struct stat st;
+    if (!ifs || stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode))
+    {
+        sendHeader(sock, "404 Not Found", "", 0);
+        return;
+    }
+    long long size = st.st_size;
+    long long start = 0;
+    long long end = size - 1;
+    bool      isRange = false;
+    //"Range: bytes=<start>-[<end>]"
+    size_t pos = toLower(req).find("\r\nrange: bytes=");
+    if (pos != string::npos)
+    {
+        istringstream rs(req.substr(pos + 15));
+        char c;
+        if (rs >> start >> c && c == '-')
+        {
+            isRange = true;
+            if (!(rs >> end) || end >= size)
+                end = size - 1;
+            if (start >= size || start > end)
+            {
+                sendHeader(sock, "416 Range Not Satisfiable",
+                           "Content-Range: bytes */" + Utils::toString(size) +
+                           "\r\n", 0);
+                return;
+            }
+        }
+        else
+        {
+            start = 0;
+        }
+    }
+    long long n = end - start + 1;
+    bool ok;
+    if (isRange)
+        ok = sendHeader(sock, "206 Partial Content",
+                        "Content-Range: bytes " + Utils::toString(start) +
+                        "-" + Utils::toString(end) + "/" +
+                        Utils::toString(size) + "\r\n", n);
+    else
+        ok = sendHeader(sock, "200 OK", "", n);
+    if (!ok || method == "HEAD")
+        return;
+    ifs.seekg(start);
+    while (n > 0 && ifs)
+    {
+        ifs.read(buf, (n < (long long) sizeof(buf))? n: sizeof(buf));
+        len = static_cast<int>(ifs.gcount());
+        if (len <= 0 || sock.send(buf, len) != len)
+            break;
+        n -= len;
+    }
+    LOGGER_DEBUG(gLogger, "UpdateServer: Served " << path << ' ' << start
+                 << '-' << end << ((n == 0)? "": " - incomplete"));
+}
+
+bool UpdateServer::sendHeader(TcpSocket    &sock,
+                              const string &status,
+                              const string &hdrs,
+                              long long     len)
+{
+    ostringstream oss;
+    oss << "HTTP/1.1 " << status << "\r\n"
+        << "Accept-Ranges: bytes\r\n"
+        << hdrs
+        << "Content-Length: " << len << "\r\n"
+        << "Content-Type: application/octet-stream\r\n"
+        << "Connection: close\r\n\r\n";
+    return (sock.send(oss.str()) > 0);
+}
+
+//local stand-in server =====================================================
+//Minimal deterministic server for load tests without network access.
+//Performs the login handshake with the same message encryption as a real
+//server, answers the requests used in load scenarios, and pushes messages to
+//all logged-in clients on request.
+class StandinServer
+{
+public:
+    //monitoring of a user, as set by the MON and GPS_MON messages
+    struct MonState
+    {
+        MonState() : gpsAll(false) {}
+
+        bool operator==(const MonState &other) const
+        {
+            return (issis == other.issis && gssis == other.gssis &&
+                    gpsAll == other.gpsAll &&
+                    (gpsAll || gpsIssis == other.gpsIssis));
+        }
+
+        bool operator!=(const MonState &other) const
+        {
+            return !(*this == other);
+        }
+
+        IdRangeSet issis;
+        IdRangeSet gssis;
+        IdRangeSet gpsIssis;
+        bool       gpsAll;  //GPS_MON_START without ISSI_LIST
+    };
+    //username to monitoring
+    typedef map<string, MonState> MonMapT;
+
+    StandinServer(int port) :
+    mPort(port), mCallId(0), mStopped(false), mSocket(0)
+    {
+        PalLock::init(&mLock);
+    }
+
+    int getPort() const { return mPort; }
+
+    /**
+     * Starts listening.
+     *
+     * @return true if successful.
+     */
+    bool start()
+    {
+        mSocket = new TcpSocket(0, mPort);
+        int res = mSocket->listen();
+        if (res != 0)
+        {
+            LOGGER_ERROR(gLogger, "StandinServer: Failed to listen on port "
+                         << mPort << ", " << Socket::getErrorStr(res));
+            return false;
+        }
+        PalThread::ThreadT thrd;
+        PalThread::start(&thrd, startAcceptThread, this);
+        LOGGER_INFO(gLogger, "StandinServer: Listening on port " << mPort);
+        return true;
+    }
+
+    /**
+     * Sends messages to all logged-in clients at a fixed rate.
+     * Each message has TIMESTAMP set to the send time for latency measurement.
+     *
+     * @param[in] type  The message type.
+     * @param[in] count The number of messages per client.
+     * @param[in] rate  The number of messages per second per client.
+     */
+    void storm(int type, int count, int rate);
+
+    /**
+     * Stops accepting connections and disconnects all clients, as in a
+     * server failure.
+     */
+    void stop();
+
+    /**
+     * Gets the logged-in users with their monitoring.
+     *
+     * @param[out] monMap The monitoring of each logged-in user.
+     */
+    void getUsers(MonMapT &monMap);
+
+private:
+    struct Conn
+    {
+        Conn(SocketT sock, const string &ip, int port) :
+        socket(sock), remoteIp(ip), remotePort(port), msgId(0),
+        isLoggedIn(false)
+        {
+            PalLock::init(&sendLock);
+        }
+
+        ~Conn() { PalLock::destroy(&sendLock); }
+
+        TcpSocket       socket;
+        string          remoteIp;
+        int             remotePort;
+        int             msgId;
+        bool            isLoggedIn;
+        string          username;
+        string          key;
+        PalLock::LockT  sendLock;
+    };
+
+    struct ConnThreadParam
+    {
+        ConnThreadParam(StandinServer *s, Conn *c) : svr(s), conn(c) {}
+
+        StandinServer *svr;
+        Conn          *conn;
+    };
+
+    int             mPort;
+    int             mCallId;
+    bool            mStopped;
+    TcpSocket      *mSocket;
+    set<Conn *>     mConns;
+    MonMapT         mMon;
+    PalLock::LockT  mLock;    //guards mConns, mMon and mCallId
+
+    static void *startAcceptThread(void *arg)
+    {
+        static_cast<StandinServer *>(arg)->acceptThread();
+        return 0;
+    }
+
+    static void *startConnThread(void *arg)
+    {
+        ConnThreadParam *p = static_cast<ConnThreadParam *>(arg);
+        p->svr->connThread(p->conn);
+        delete p;
+        return 0;
+    }
+
+    void acceptThread();
+
+    void connThread(Conn *conn);
+
+    /**
+     * Processes a received message.
+     *
+     * @param[in] conn The connection.
+     * @param[in] msg  The message.
+     */
+    void process(Conn *conn, const MsgSp &msg);
+
+    /**
+     * Records a monitoring change of a user.
+     *
+     * @param[in] conn The connection.
+     * @param[in] msg  The MON or GPS_MON message.
+     */
+    void setMon(Conn *conn, const MsgSp &msg);
+
+    /**
+     * Sends a message, with a new MSG_ID.
+     *
+     * @param[in] conn The connection.
+     * @param[in] msg  The message.
+     * @return true if successful.
+     */
+    bool send(Conn *conn, MsgSp &msg);
+};
+
+void StandinServer::acceptThread()
+{
+    string  ip;
+    int     port;
+    SocketT sock;
+    for (;;)
+    {
+        sock = mSocket->accept(ip, port);
+        if (sock < 0 || sock == INVALID_SOCKET)
+        {
+            if (!mStopped)
+                LOGGER_ERROR(gLogger, "StandinServer: accept() failed, "
+                             << Socket::getErrorStr(sock));
+            break;
+        }
+        Conn *conn = new Conn(sock, ip, port);
+        PalLock::take(&mLock);
+        mConns.insert(conn);
+        PalLock::release(&mLock);
+        PalThread::ThreadT thrd;
+        PalThread::start(&thrd, startConnThread,
+                         new ConnThreadParam(this, conn));
+    }
+}
+
+void StandinServer::connThread(Conn *conn)
+{
+    LOGGER_DEBUG(gLogger, "StandinServer: Connection from " << conn->remoteIp
+                 << ':' << conn->remotePort);
+    conn->key = MsgSp::getKey(MsgSp::getTypeName(MsgSp::Type::LOGIN));
+    char   buf[4096];
+    int    len;
+    int    bytesRcvd;
+    string str;
+    MsgSp *msg;
+    for (;;)
+    {
+        bytesRcvd = conn->socket.recv(buf, sizeof(buf));
+        if (bytesRcvd <= 0)
+            break;
+        len = MsgSp::getMsgLen(str.append(buf, bytesRcvd));
+        while ((int) str.size() >= len + MsgSp::LEN_SIZE)
+        {
+            msg = MsgSp::parse(str.substr(MsgSp::LEN_SIZE, len), conn->key);
+            str.erase(0, len + MsgSp::LEN_SIZE);
+            len = MsgSp::getMsgLen(str);
+            if (msg == 0)
+            {
+                LOGGER_ERROR(gLogger, "StandinServer: Message parsing failed "
+                             "from " << conn->remoteIp << ':'
+                             << conn->remotePort);
+                continue;
+            }
+            process(conn, *msg);
+            delete msg;
+        }
+    }
+    LOGGER_DEBUG(gLogger, "StandinServer: Disconnected " << conn->remoteIp
+                 << ':' << conn->remotePort);
+    PalLock::take(&mLock);
+    mConns.erase(conn);
+    //a real server drops the monitoring with the session
+    if (conn->isLoggedIn)
+        mMon.erase(conn->username);
+    PalLock::release(&mLock);
+    delete conn;
+}
+
+void StandinServer::process(Conn *conn, const MsgSp &msg)
+{
+    MsgSp *resp;
+    switch (msg.getType())
+    {
+        case MsgSp::Type::LOGIN:
+        {
+            //must match ServerSession handling of LOGIN response
+            string addr(msg.getFieldString(MsgSp::Field::DESC));
+            if (addr.empty())
+                addr = conn->remoteIp + ":" + Utils::toString(conn->remotePort);
+            conn->username = msg.getFieldString(MsgSp::Field::USERNAME);
+            conn->key = MsgSp::getKey(addr + conn->username);
+            string challenge("0123456789abcdef");
+            MsgSp m(MsgSp::Type::LOGIN);
+            m.addField(MsgSp::Field::CHALLENGE, challenge);
+            m.addField(MsgSp::Field::MSG_ACK, msg.getMsgId());
+            send(conn, m);
+            conn->key = MsgSp::getKey(Utils::scramble(conn->remotePort,
+                                                      challenge, conn->key));
+            return;
+        }
+        case MsgSp::Type::PASSWORD:
+        {
+            resp = new MsgSp(MsgSp::Type::PASSWORD);
+            resp->addField(MsgSp::Field::KEEPALIVE_PERIOD, 30);
+            resp->addField(MsgSp::Field::FLEET, gFleetId);
+            resp->addField(MsgSp::Field::VOIP_GW, Socket::LOCALHOST);
+            conn->isLoggedIn = true;
+            break;
+        }
+        case MsgSp::Type::SYS_KEEPALIVE:
+        case MsgSp::Type::LOGOUT:
+        {
+            resp = new MsgSp(msg.getType());
+            break;
+        }
+        case MsgSp::Type::GPS_MON_START:
+        case MsgSp::Type::GPS_MON_STOP:
+        case MsgSp::Type::MON_START:
+        case MsgSp::Type::MON_STOP:
+        {
+            setMon(conn, msg);
+            resp = new MsgSp(msg);
+            resp->removeField(MsgSp::Field::MSG_ID);
+            break;
+        }
+        case MsgSp::Type::SDS_TRANSFER:
+        {
+            resp = new MsgSp(MsgSp::Type::SDS_RPT);
+            resp->addField(MsgSp::Field::CALLED_PARTY,
+                           msg.getFieldString(MsgSp::Field::CALLED_PARTY));
+            resp->addField(MsgSp::Field::DELIVERY_STATUS,
+                           MsgSp::Value::DEL_STAT_MSG_RCVD);
+            break;
+        }
+        case MsgSp::Type::STATUS:
+        {
+            resp = new MsgSp(MsgSp::Type::STATUS_RPT);
+            resp->addField(MsgSp::Field::CALLED_PARTY,
+                           msg.getFieldString(MsgSp::Field::CALLED_PARTY));
+            break;
+        }
+        case MsgSp::Type::CALL_SETUP:
+        {
+            resp = new MsgSp(MsgSp::Type::CALL_PROCEEDING);
+            PalLock::take(&mLock);
+            resp->addField(MsgSp::Field::CALL_ID, ++mCallId);
+            PalLock::release(&mLock);
+            break;
+        }
+        case MsgSp::Type::CALL_DISCONNECT:
+        {
+            resp = new MsgSp(MsgSp::Type::CALL_RELEASE);
+            resp->addField(MsgSp::Field::CALL_ID,
+                           msg.getFieldString(MsgSp::Field::CALL_ID));
+            resp->addField(MsgSp::Field::DISCONNECT_CAUSE,
+                           MsgSp::Value::DC_USER_REQUESTED);
+            break;
+        }
+        default:
+        {
+            //not needed in load scenarios, e.g. data requests after login
+            return;
+        }
+    }
+    resp->addField(MsgSp::Field::MSG_ACK, msg.getMsgId());
+    send(conn, *resp);
+    delete resp;
+    if (msg.getType() == MsgSp::Type::PASSWORD && gUpdateSvr != 0)
+    {
+        //announce the update files as a new version
+        MsgSp m(MsgSp::Type::VERSION_CLIENT);
+        gUpdateSvr->setVersionMsg(m);
+        send(conn, m);
+    }
+}
+
+bool StandinServer::send(Conn *conn, MsgSp &msg)
+{
+    PalLock::take(&conn->sendLock);
+    msg.addField(MsgSp::Field::MSG_ID, ++conn->msgId);
+    bool res = (conn->socket.send(msg.serialize(conn->key)) > 0);
+    PalLock::release(&conn->sendLock);
+    return res;
+}
+
+void StandinServer::setMon(Conn *conn, const MsgSp &msg)
+{
+    int        type = msg.getType();
+    bool       isGps = (type == MsgSp::Type::GPS_MON_START ||
+                        type == MsgSp::Type::GPS_MON_STOP);
+    IdRangeSet ssis(msg.getFieldString((isGps)? MsgSp::Field::ISSI_LIST:
+                                                MsgSp::Field::SSI_LIST));
+    PalLock::take(&mLock);
+    MonState   &mon(mMon[conn->username]);
+    IdRangeSet &monSsis((isGps)? mon.gpsIssis:
+                        (msg.getFieldInt(MsgSp::Field::AFFECTED_USER_TYPE) ==
+                         MsgSp::Value::IDENTITY_TYPE_GSSI)? mon.gssis:
+                                                            mon.issis);
+    switch (type)
+    {
+        case MsgSp::Type::GPS_MON_START:
+            if (ssis.empty())
+                mon.gpsAll = true;
+            //fallthrough
+        case MsgSp::Type::MON_START:
+            monSsis.unite(ssis);
+            break;
+        default:
+            if (!ssis.empty())
+            {
+                monSsis.subtract(ssis);
+            }
+            else if (isGps)
+            {
+                mon.gpsAll = false;
+                mon.gpsIssis.clear();
+            }
+            else
+            {
+                mon.issis.clear();
+                mon.gssis.clear();
+            }
+            break;
+    }
+    PalLock::release(&mLock);
+}
+
+void StandinServer::stop()
+{
+    LOGGER_INFO(gLogger, "StandinServer: Stopping on port " << mPort);
+    PalLock::take(&mLock);
+    mStopped = true;
+    //shutdown() wakes up the blocked accept() and recv(), which then end
+    //their threads
+    if (mSocket != 0)
+        ::shutdown(mSocket->getSock(), SHUT_RDWR);
+    for (auto conn : mConns)
+    {
+        ::shutdown(conn->socket.getSock(), SHUT_RDWR);
+    }
+    PalLock::release(&mLock);
+}
+
+void StandinServer::getUsers(MonMapT &monMap)
+{
+    monMap.clear();
+    PalLock::take(&mLock);
+    for (auto conn : mConns)
+    {
+        if (!conn->isLoggedIn)
+            continue;
+        auto it = mMon.find(conn->username);
+        monMap[conn->username] = (it != mMon.end())? it->second: MonState();
+    }
+    PalLock::release(&mLock);
+}
+
+void StandinServer::storm(int type, int count, int rate)
+{
+    if (count <= 0 || rate <= 0)
+        return;
+    int64_t startUs = LoadStats::nowUs();
+    int64_t dt;
+    int     i = 0;
+    for (; i<count; ++i)
+    {
+        dt = startUs + i * 1000000LL / rate - LoadStats::nowUs();
+        if (dt > 0)
+            usleep(static_cast<useconds_t>(dt));
+        PalLock::take(&mLock);
+        for (auto conn : mConns)
+        {
+            if (!conn->isLoggedIn)
+                continue;
+            MsgSp m(type);
+            m.addField(MsgSp::Field::CALLING_PARTY, 3200000 + i % 1000);
+            m.addField(MsgSp::Field::CALLING_PARTY_TYPE,
+                       MsgSp::Value::IDENTITY_TYPE_ISSI);
+            m.addField(MsgSp::Field::CALLED_PARTY, conn->username);
+            m.addField(MsgSp::Field::STATUS_CODE, 32768 + i % 100);
+            m.addField(MsgSp::Field::LOCATION_LAT, "3.188905");
+            m.addField(MsgSp::Field::LOCATION_LONG, "101.734614");
+            m.addField(MsgSp::Field::TIMESTAMP, LoadStats::nowUs());
+            send(conn, m);
+        }
+        PalLock::release(&mLock);
+    }
+}
+
+//scenario runner ===========================================================
+/**
+ * Sleeps until a paced send time.
+ *
+ * @param[in] startUs The start time. See LoadStats::nowUs().
+ * @param[in] i       The send index.
+ * @param[in] rate    The number of sends per second.
+ */
+static void pace(int64_t startUs, int i, int rate)
+{
+    int64_t dt = startUs + i * 1000000LL / rate - LoadStats::nowUs();
+    if (dt > 0)
+        usleep(static_cast<useconds_t>(dt));
+}
+
+/**
+ * Waits for clients to get a call ID from CALL_PROCEEDING or CALL_SETUP.
+ *
+ * @param[in] clientsMap The clients.
+ * @param[in] timeoutMs  The maximum waiting time in milliseconds.
+ * @return The number of clients with a call ID.
+ */
+static int waitCallIds(const ClientsMapT &clientsMap, int timeoutMs)
+{
+    int     count = 0;
+    int64_t endUs = LoadStats::nowUs() + timeoutMs * 1000LL;
+    for (;;)
+    {
+        count = 0;
+        for (auto &it : clientsMap)
+        {
+            if (it.second->getCallId() != 0)
+                ++count;
+        }
+        if (count == (int) clientsMap.size() || LoadStats::nowUs() >= endUs)
+            break;
+        usleep(1000);
+    }
+    return count;
+}
+
+/**
+ * Checks whether all clients are logged in to a stand-in server with the
+ * expected monitoring.
+ *
+ * @param[in] clientsMap The clients.
+ * @param[in] svr        The stand-in server.
+ * @param[in] refMap     The expected monitoring of each user. A user not in
+ *                       it is expected to have none.
+ * @return The number of clients that are logged in with the expected
+ *         monitoring.
+ */
+static int checkMon(const ClientsMapT             &clientsMap,
+                    StandinServer                 &svr,
+                    const StandinServer::MonMapT  &refMap)
+{
+    StandinServer::MonMapT monMap;
+    svr.getUsers(monMap);
+    int count = 0;
+    for (auto &it : clientsMap)
+    {
+        auto mit = monMap.find(it.second->getUserId());
+        if (mit == monMap.end())
+            continue;
+        auto rit = refMap.find(mit->first);
+        if (mit->second == ((rit != refMap.end())?
+                                rit->second: StandinServer::MonState()))
+            ++count;
+    }
+    return count;
+}
+
+/**
+ * Stops the main stand-in server after the standby sessions on the
+ * redundant stand-in server have the same monitoring, and waits for all
+ * clients to switch over to the redundant server with the monitoring
+ * intact. Records the switch time in gLoadStats.
+ *
+ * @param[in] clientsMap The clients.
+ * @param[in] timeoutMs  The maximum waiting time in milliseconds, for each
+ *                       of before and after the stop.
+ * @return true if all clients switched over with their monitoring.
+ */
+static bool failover(const ClientsMapT &clientsMap, int timeoutMs)
+{
+    int                    n = clientsMap.size();
+    int                    count = 0;
+    int64_t                endUs = LoadStats::nowUs() + timeoutMs * 1000LL;
+    StandinServer::MonMapT refMap;
+    //wait for standby sessions to log in and mirror the monitoring
+    for (;;)
+    {
+        gStandin->getUsers(refMap);
+        count = checkMon(clientsMap, *gStandin2, refMap);
+        if (count == n || LoadStats::nowUs() >= endUs)
+            break;
+        usleep(10000);
+    }
+    if (count != n)
+    {
+        cout << "Failover: " << count << '/' << n
+             << " standby sessions ready before stop" << endl;
+        return false;
+    }
+    string  addr(":" + Utils::toString(gStandin2->getPort()));
+    int64_t startUs = LoadStats::nowUs();
+    endUs = startUs + timeoutMs * 1000LL;
+    gStandin->stop();
+    for (;;)
+    {
+        count = 0;
+        for (auto &it : clientsMap)
+        {
+            string s(it.second->ss()->getServerAddress());
+            if (s.size() > addr.size() &&
+                s.compare(s.size() - addr.size(), addr.size(), addr) == 0)
+                ++count;
+        }
+        if (count == n)
+            count = checkMon(clientsMap, *gStandin2, refMap);
+        if (count == n || LoadStats::nowUs() >= endUs)
+            break;
+        usleep(1000);
+    }
+    double ms = (LoadStats::nowUs() - startUs) / 1000.0;
+    cout << "Failover: " << count << '/' << n << " clients switched over "
+            "with monitoring in " << ms << " ms" << endl;
+    gLoadStats.bench("failover_clients", count, "clients");
+    if (count != n)
+        return false;
+    gLoadStats.bench("failover", ms, "ms");
+    return true;
+}
+
+/**
+ * Benchmarks SIP call setup message handling without a VOIP server.
+ * Each setup is the INVITE (with SDP), 100 Trying, 180 Ringing, 200 OK (with
+ * SDP) and ACK sequence of VoipSessionClient, with each message serialized
+ * and then parsed back as on receipt. Records the message and setup rates in
+ * gLoadStats.
+ *
+ * @param[in] count The number of call setups.
+ * @return The number of messages per second.
+ */
+static double sipBench(int count)
+{
+    static const string SDP("v=0\r\n"
+                            "o=- 1 1 IN IP4 127.0.0.1\r\n"
+                            "s=-\r\n"
+                            "c=IN IP4 127.0.0.1\r\n"
+                            "t=0 0\r\n"
+                            "m=audio 16384 RTP/AVP 8 0 101\r\n"
+                            "a=rtpmap:8 PCMA/8000\r\n"
+                            "a=rtpmap:0 PCMU/8000\r\n"
+                            "a=rtpmap:101 telephone-event/8000\r\n"
+                            "a=sendrecv\r\n");
+    const string from("<sip:1001@127.0.0.1>;tag=4f3a9c21");
+    const string to("<sip:1002@127.0.0.1>");
+    vector<MsgSip *> msgs;
+    msgs.push_back(new MsgSip(MsgSip::Type::INVITE, "sip:1002@127.0.0.1"));
+    msgs.push_back(new MsgSip(MsgSip::Type::INVITE,
+                              MsgSip::Value::RESP_PROV_TRYING));
+    msgs.push_back(new MsgSip(MsgSip::Type::INVITE,
+                              MsgSip::Value::RESP_PROV_RINGING));
+    msgs.push_back(new MsgSip(MsgSip::Type::INVITE, MsgSip::Value::RESP_OK));
+    msgs.push_back(new MsgSip(MsgSip::Type::ACK, "sip:1002@127.0.0.1"));
+    for (auto m : msgs)
+    {
+        m->addField(MsgSip::Field::VIA,
+                    "SIP/2.0/TCP 127.0.0.1:5060;branch=z9hG4bK1a2b3c4d")
+          .addField(MsgSip::Field::MAX_FORWARDS, 70)
+          .addField(MsgSip::Field::FROM, from)
+          .addField(MsgSip::Field::TO,
+                    (m->getRespCode() > MsgSip::Value::RESP_PROV_TRYING)?
+                        to + ";tag=7d2e61b0": to)
+          .addField(MsgSip::Field::CONTACT, "<sip:1001@127.0.0.1:5060>")
+          .addField(MsgSip::Field::USER_AGENT, "testclient")
+          .addField(MsgSip::Field::CONTENT_LENGTH, 0)
+          .setSeqId(1);
+    }
+    msgs[0]->addField(MsgSip::Field::ALLOW, "INVITE,ACK,BYE,CANCEL,INFO")
+           .addField(MsgSip::Field::CONTENT_TYPE, "application/sdp")
+           .addField(MsgSip::Field::CONTENT_LENGTH, (int) SDP.size())
+           .setContentBody(SDP);
+    msgs[3]->addField(MsgSip::Field::CONTENT_TYPE, "application/sdp")
+           .addField(MsgSip::Field::CONTENT_LENGTH, (int) SDP.size())
+           .setContentBody(SDP);
+#ifdef SIPTCP
+    MsgSip::Framer framer;
+#endif
+    MsgSip *rcvd;
+    string  buf;
+    int     parsed = 0;
+    int     i;
+    int64_t startUs = LoadStats::nowUs();
+    for (i=0; i<count; ++i)
+    {
+        for (auto m : msgs)
+        {
+            m->addField(MsgSip::Field::CALL_ID, 100000 + i);
+            m->serialize(buf);
+#ifdef SIPTCP
+            framer.append(buf.data(), (int) buf.size());
+            while (framer.next(rcvd))
+#else
+            rcvd = MsgSip::parse(buf);
+#endif
+            {
+                if (rcvd != 0)
+                    ++parsed;
+                delete rcvd;
+            }
+        }
+    }
+    double secs = (LoadStats::nowUs() - startUs) / 1000000.0;
+    for (auto m : msgs)
+    {
+        delete m;
+    }
+    if (secs <= 0)
+        secs = 1e-6;
+    if (parsed != count * (int) msgs.size())
+        LOGGER_ERROR(gLogger, "sipBench: Parsed " << parsed << " of "
+                     << count * msgs.size() << " messages");
+    double rate = parsed / secs;
+    gLoadStats.bench("sip_setup_msgs", rate, "msg/s");
+    gLoadStats.bench("sip_setups", count / secs, "setup/s");
+    return rate;
+}
+
+/**
+ * Benchmarks AudioMixer::mix() with a number of active streams. Each frame
+ * pushes FRAME_SAMPLES samples to every stream and mixes one frame, timing
+ * only mix(). Records the result in gLoadStats.
+ *
+ * @param[in] streams The number of streams, up to MAX_STREAMS.
+ * @param[in] frames  The number of frames.
+ * @return The mix time in nanoseconds per stream per frame.
+ */
+static double mixBench(int streams, int frames)
+{
+    const int N = AudioMixer::FRAME_SAMPLES;
+    //heap, because of the stream queues
+    AudioMixer *mixer = new AudioMixer();
+    vector<int> handles;
+    short       in[N];
+    short       out[N];
+    int         i;
+    for (i=0; i<N; ++i)
+    {
+        //triangle wave at 400 Hz
+        in[i] = static_cast<short>(((i % 20 < 10)? i % 20: 20 - i % 20) *
+                                   1000 - 5000);
+    }
+    for (i=0; i<streams; ++i)
+    {
+        handles.push_back(mixer->addStream());
+        //prebuffer to start playing
+        mixer->push(handles.back(), in, N);
+        mixer->push(handles.back(), in, N);
+    }
+    int64_t                           mixNs = 0;
+    chrono::steady_clock::time_point  t;
+    for (i=0; i<frames; ++i)
+    {
+        for (auto h : handles)
+        {
+            mixer->push(h, in, N);
+        }
+        t = chrono::steady_clock::now();
+        mixer->mix(out, N);
+        mixNs += chrono::duration_cast<chrono::nanoseconds>(
+                                   chrono::steady_clock::now() - t).count();
+    }
+    delete mixer;
+    double ns = (streams > 0 && frames > 0)?
+                static_cast<double>(mixNs) / streams / frames: 0;
+    gLoadStats.bench("mix_" + Utils::toString(streams) + "_streams", ns,
+                     "ns/stream/frame");
+    return ns;
+}
+
+/**
+ * Runs a load test scenario file, and writes the statistics as JSON.
+ * Each line is a command, with '#' for comment:
+ *   clients <id range> [<connect interval ms>]
+ *   gps     <issi> <rate/s> <secs>
+ *   sds     <issi> <count> <rate/s>
+ *   status  <issi> <count> <rate/s>
+ *   call    <issi> <count> <rate/s>
+ *   mon     <0:stop|1:start> <issi list> <cycles>
+ *   storm   <msgType> <count> <rate/s>  (stand-in server only)
+ *   sipbench <setups>                   (SIP call setup, no server)
+ *   mixbench <stream counts> <frames>   (audio mixer, no server)
+ *   failover <timeout secs>             (2 stand-in servers only)
+ *   wait    <secs>
+ * Rates are per client.
+ * The scenario fails on an invalid command, or if failover does not
+ * restore all sessions on the redundant server.
+ *
+ * @param[in]     file       The scenario file path.
+ * @param[in]     jsonFile   The output file path, or empty for stdout.
+ * @param[in,out] clientsMap The clients.
+ * @return true if the scenario ran completely.
+ */
+bool runScenario(const string &file,
+                 const string &jsonFile,
+                 ClientsMapT  &clientsMap)
+{
+    ifstream ifs(file.c_str());
+    if (!ifs)
+    {
+        cout << "Failed to open " << file << endl;
+        return false;
+    }
+    gLoadStats.reset();
+    bool    ok = true;
+    bool    passed = true;
+    int     lineNum = 0;
+    int     ssi;
+    int     count;
+    int     rate;
+    int     i;
+    int64_t startUs;
+    int64_t sendUs;
+    string  line;
+    string  cmd;
+    string  strParam;
+    string  voipId;
+    while (ok && getline(ifs, line))
+    {
+        ++lineNum;
+        line = line.substr(0, line.find('#'));
+        istringstream is(line);
+        if (!(is >> cmd))
+            continue;
+        LOGGER_INFO(gLogger, "Scenario " << file << ':' << lineNum << ": "
+                    << line);
+        if (cmd == "clients")
+        {
+            set<int> vals;
+            int interval = (gStandin != 0)? 0: 3000;
+            ok = ((is >> strParam) &&
+                  Utils::fromStringWithRange(strParam, vals) > 0 &&
+                  vals.size() <= MAXCLIENTS);
+            if (!ok)
+                break;
+            is >> interval;
+            for (auto &it : clientsMap)
+            {
+                delete it.second;
+            }
+            clientsMap.clear();
+            for (auto id : vals)
+            {
+                Client *client = new Client(id, &serverMsg,
+                                            (id == *vals.begin()));
+                if (client->isValid())
+                    clientsMap[id] = client;
+                else
+                    delete client;
+                //see ltc
+                if (interval > 0)
+                    usleep(interval * 1000);
+            }
+            //wait for login
+            for (i=0; i<300; ++i)
+            {
+                count = 0;
+                for (auto &it : clientsMap)
+                {
+                    if (it.second->ss()->isLoggedIn())
+                        ++count;
+                }
+                if (count == (int) clientsMap.size())
+                    break;
+                usleep(100000);
+            }
+            cout << count << '/' << vals.size() << " clients logged in"
+                 << endl;
+            //exclude login from statistics
+            gLoadStats.reset();
+        }
+        else if (cmd == "gps")
+        {
+            int secs;
+            ok = ((is >> ssi >> rate >> secs) && ssi > 0 && rate > 0 &&
+                  secs > 0);
+            startUs = LoadStats::nowUs();
+            for (i=0; ok && i<rate*secs; ++i)
+            {
+                pace(startUs, i, rate);
+                for (auto &it : clientsMap)
+                {
+                    sendUs = LoadStats::nowUs();
+                    gLoadStats.sent(it.first,
+                                    it.second->ss()->sdsGps(ssi,
+                                                 GPSDATA[i % GPSDATA_COUNT]),
+                                    MsgSp::Type::SDS_TRANSFER, sendUs);
+                }
+            }
+        }
+        else if (cmd == "sds")
+        {
+            ok = ((is >> ssi >> count >> rate) && ssi > 0 && count > 0 &&
+                  rate > 0);
+            startUs = LoadStats::nowUs();
+            for (i=1; ok && i<=count; ++i)
+            {
+                pace(startUs, i - 1, rate);
+                strParam.assign("From TestClient: Message ")
+                        .append(std::to_string(i));
+                for (auto &it : clientsMap)
+                {
+                    sendUs = LoadStats::nowUs();
+                    gLoadStats.sent(it.first,
+                              it.second->ss()->sds(
+                                      MsgSp::Value::IDENTITY_TYPE_ISSI, ssi,
+                                      strParam),
+                              MsgSp::Type::SDS_TRANSFER, sendUs);
+                }
+            }
+        }
+        else if (cmd == "status")
+        {
+            ok = ((is >> ssi >> count >> rate) && ssi > 0 && count > 0 &&
+                  rate > 0);
+            startUs = LoadStats::nowUs();
+            for (i=1; ok && i<=count; ++i)
+            {
+                pace(startUs, i - 1, rate);
+                for (auto &it : clientsMap)
+                {
+                    sendUs = LoadStats::nowUs();
+                    gLoadStats.sent(it.first,
+                              it.second->ss()->status(
+                                      MsgSp::Value::IDENTITY_TYPE_ISSI, ssi, i),
+                              MsgSp::Type::STATUS, sendUs);
+                }
+            }
+        }
+        else if (cmd == "call")
+        {
+            //signalling only - sent directly instead of through
+            //ServerSession::callSetupInd() to avoid the VOIP session
+            ok = ((is >> ssi >> count >> rate) && ssi > 0 && count > 0 &&
+                  rate > 0);
+            startUs = LoadStats::nowUs();
+            for (i=0; ok && i<count; ++i)
+            {
+                pace(startUs, i, rate);
+                for (auto &it : clientsMap)
+                {
+                    it.second->setCallId(0);
+                    MsgSp *m = new MsgSp(MsgSp::Type::CALL_SETUP);
+                    m->addField(MsgSp::Field::COMM_TYPE,
+                                MsgSp::Value::COMM_TYPE_POINT_TO_POINT);
+                    m->addField(MsgSp::Field::SIMPLEX_DUPLEX,
+                                MsgSp::Value::SIMPLEX_DUPLEX_DUPLEX);
+                    m->addField(MsgSp::Field::HOOK_METHOD,
+                                MsgSp::Value::HOOK_YES);
+                    m->addField(MsgSp::Field::CALLING_PARTY,
+                                it.second->getUserId());
+                    m->addField(MsgSp::Field::CALLED_PARTY_TYPE,
+                                MsgSp::Value::IDENTITY_TYPE_ISSI);
+                    m->addField(MsgSp::Field::CALLED_PARTY, ssi);
+                    sendUs = LoadStats::nowUs();
+                    gLoadStats.sent(it.first, it.second->ss()->sendMsg(m),
+                                    MsgSp::Type::CALL_SETUP, sendUs);
+                }
+                //disconnect only calls that got an ID from CALL_PROCEEDING
+                if (waitCallIds(clientsMap, CALL_ID_TIMEOUT_MS) <
+                    (int) clientsMap.size())
+                    LOGGER_ERROR(gLogger, "Scenario " << file << ':'
+                                 << lineNum << ": Call " << i
+                                 << " without call ID for some clients");
+                for (auto &it : clientsMap)
+                {
+                    if (it.second->getCallId() == 0)
+                        continue;
+                    sendUs = LoadStats::nowUs();
+                    gLoadStats.sent(it.first,
+                                    it.second->ss()->callDisconnect(
+                                                    it.second->getCallId(),
+                                                    ssi),
+                                    MsgSp::Type::CALL_DISCONNECT, sendUs);
+                }
+            }
+        }
+        else if (cmd == "mon")
+        {
+            int doStart;
+            IdRangeSet ssis;
+            ok = ((is >> doStart >> strParam >> count) &&
+                  ssis.parse(strParam) > 0 && count > 0);
+            for (i=0; ok && i<count; ++i)
+            {
+                for (auto &it : clientsMap)
+                {
+                    //aggregated response has no single request ID, so
+                    //record before sending to be ahead of the response
+                    gLoadStats.sent(it.first, 0,
+                                    (doStart != 0)?
+                                        MsgSp::Type::GPS_MON_START:
+                                        MsgSp::Type::GPS_MON_STOP,
+                                    LoadStats::nowUs());
+                    if (doStart != 0)
+                        it.second->ss()->gpsMonitorStart(ssis);
+                    else
+                        it.second->ss()->gpsMonitorStop(ssis);
+                }
+            }
+        }
+        else if (cmd == "storm")
+        {
+            int type;
+            ok = (gStandin != 0 && (is >> type >> count >> rate));
+            if (ok)
+                gStandin->storm(type, count, rate);
+        }
+        else if (cmd == "sipbench")
+        {
+            ok = ((is >> count) && count > 0);
+            if (ok)
+                cout << "SIP call setup: " << sipBench(count) << " msg/s"
+                     << endl;
+        }
+        else if (cmd == "mixbench")
+        {
+            set<int> vals;
+            ok = ((is >> strParam >> count) &&
+                  Utils::fromStringWithRange(strParam, vals) > 0 &&
+                  *vals.begin() > 0 &&
+                  *vals.rbegin() <= AudioMixer::MAX_STREAMS && count > 0);
+            if (!ok)
+                break;
+            for (auto n : vals)
+            {
+                cout << "Mix " << n << " streams: " << mixBench(n, count)
+                     << " ns/stream/frame" << endl;
+            }
+        }
+        else if (cmd == "failover")
+        {
+            int secs;
+            ok = (gStandin2 != 0 && (is >> secs) && secs > 0);
+            if (ok)
+                passed = failover(clientsMap, secs * 1000);
+        }
+        else if (cmd == "wait")
+        {
+            int secs;
+            ok = ((is >> secs) && secs >= 0);
+            if (ok)
+                sleep(secs);
+        }
+        else
+        {
+            ok = false;
+        }
+    } //while
+    if (!ok)
+        cout << "Scenario " << file << ':' << lineNum << ": Invalid command: "
+             << line << endl;
+    if (jsonFile.empty())
+    {
+        gLoadStats.toJson(cout, file, clientsMap.size());
+    }
+    else
+    {
+        ofstream ofs(jsonFile.c_str());
+        gLoadStats.toJson(ofs, file, clientsMap.size());
+        cout << "Results written to " << jsonFile << endl;
+    }
+    return (ok && passed);
+}
+
 void usage(const string &myName)
 {
-    cout << "\nUsage: " << myName << " [-hpqst]\n\n"
+    cout << "\nUsage: " << myName << " [-dfhopqstux]\n\n"
+            "  d dir:  With x, serve the files in dir as a client update\n"
+            "          over HTTP, and announce it on login.\n"
+            "  f file: Run load test scenario file and exit.\n"
             "  h:      Show this message and exit.\n"
+            "  o file: Load test JSON result file. Default is stdout.\n"
             "  p port: Main server port number.\n"
-            "  q port: Redundant server port number.\n"
+            "  q port: Redundant server port number. With x, if different\n"
+            "          from the main server port, also run a local stand-in\n"
+            "          redundant server on it, for the failover scenario.\n"
             "  s IP:   Main server IP.\n"
-            "  t IP:   Redundant server IP."
+            "  t IP:   Redundant server IP.\n"
+            "  u port: Update HTTP server port number. Default is 8080.\n"
+            "  x:      Run local stand-in server on main server port, and\n"
+            "          connect to it."
          << endl;
 }
 
@@ -603,21 +2218,37 @@ int main(int argc, char *argv[])
     int    serverPort2 = 5056;
     string serverIp1(Socket::LOCALHOST);
     string serverIp2(Socket::LOCALHOST);
+    string scenarioFile;
+    string jsonFile;
+    string updateDir;
+    int    updatePort = 8080;
+    bool   doStandin = false;
+    bool   hasPort2 = false;
 
     //process command line options
     int c;
-    while ((c = getopt(argc, argv, "hp:q:s:t:")) != EOF)
+    while ((c = getopt(argc, argv, "d:f:ho:p:q:s:t:u:x")) != EOF)
     {
         switch (c)
         {
+            case 'd':
+                updateDir = string(optarg);
+                break;
+            case 'f':
+                scenarioFile = string(optarg);
+                break;
             case 'h':
                 usage(argv[0]);
                 return 0;
+            case 'o':
+                jsonFile = string(optarg);
+                break;
             case 'p':
                 serverPort1 = Utils::fromString<int>(string(optarg));
                 break;
             case 'q':
                 serverPort2 = Utils::fromString<int>(string(optarg));
+                hasPort2 = true;
                 break;
             case 's':
                 serverIp1 = string(optarg);
@@ -625,6 +2256,12 @@ int main(int argc, char *argv[])
             case 't':
                 serverIp2 = string(optarg);
                 break;
+            case 'u':
+                updatePort = Utils::fromString<int>(string(optarg));
+                break;
+            case 'x':
+                doStandin = true;
+                break;
             default:
                 break; //do nothing
         }
@@ -650,12 +2287,48 @@ int main(int argc, char *argv[])
     string        fnName;
     Client       *client;
 
+    if (doStandin)
+    {
+        serverIp1 = Socket::LOCALHOST;
+        serverIp2 = Socket::LOCALHOST;
+        if (!hasPort2)
+            serverPort2 = serverPort1;
+        gStandin = new StandinServer(serverPort1);
+        if (!gStandin->start())
+        {
+            delete gStandin;
+            delete gLogger;
+            return 1;
+        }
+        if (serverPort2 != serverPort1)
+        {
+            gStandin2 = new StandinServer(serverPort2);
+            if (!gStandin2->start())
+            {
+                //gStandin is not deleted because its threads are running
+                delete gStandin2;
+                delete gLogger;
+                return 1;
+            }
+        }
+        if (!updateDir.empty())
+        {
+            gUpdateSvr = new UpdateServer(updateDir, updatePort);
+            if (!gUpdateSvr->start())
+            {
+                delete gUpdateSvr;
+                gUpdateSvr = 0;
+            }
+        }
+    }
     ServerSession::init(gLogger, serverIp1, serverPort1, serverIp2,
                         serverPort2);
     ServerSession::setVersion(CLIENT_VERSION);
     ClientsMapT clientsMap;
 
-    for (;;)
+    if (!scenarioFile.empty())
+        intParam = (runScenario(scenarioFile, jsonFile, clientsMap))? 0: 1;
+    while (scenarioFile.empty())
     {
         cerr << "SCADC> ";
         getline(cin, input);
@@ -901,13 +2574,13 @@ int main(int argc, char *argv[])
                     if (is >> isGroup)
                     {
                         getline(is, strParam);
-                        set<int> vals;
-                        if (Utils::fromStringWithRange(strParam, vals) > 0)
+                        IdRangeSet vals;
+                        if (vals.parse(strParam) > 0)
                         {
                             boolParam = true;
                             cout << " Client-" << cid << ' '
                                  << "Type-" << ((isGroup)? "GSSI ": "SSI ")
-                                 << Utils::toString(vals, ' ') << endl;
+                                 << vals.toString(" ") << endl;
                             if (intParam != 0)
                                 clientsMap[cid]->ss()->monitorStart(vals,
                                                                     isGroup);
@@ -1141,7 +2814,7 @@ int main(int argc, char *argv[])
             {
                 cout << " Client-" << cid << ' ' << callId << ' ' << ssi
                      << endl;
-                client->ss()->callConnect(callId, ssi);
+                client->ss()->callConnect(callId, ssi, 0);
             }
             else
             {
@@ -1683,6 +3356,22 @@ int main(int argc, char *argv[])
             }
         }
 
+        else if (cmd == "ltrun")
+        {
+            cout << "Load Test Run Scenario" << endl;
+            if (is >> strParam)
+            {
+                string outFile;
+                is >> outFile;
+                runScenario(strParam, outFile, clientsMap);
+            }
+            else
+            {
+                cout << "\nUsage: " << cmd << " <scenario file> [<json file>]"
+                     << endl;
+            }
+        }
+
         //internal function tests ===========================================
         else if (cmd == "ufs")
         {
@@ -1765,7 +3454,8 @@ int main(int argc, char *argv[])
         clientsMap.erase(clientsMap.begin());
     }
 
+    //gStandin is not deleted because its threads may still be running
     delete gLogger;
     PalSocket::finalize();
-    return 0;
+    return (scenarioFile.empty())? 0: intParam;
 }